@@ -45,6 +45,7 @@
 #include <stdbool.h>
 #include <string.h>
 #include "adxl372.h"
+#include "unpack.h"
 
 /******************************************************************************/
 /************************** Functions Implementation **************************/
@@ -592,10 +593,8 @@ int32_t adxl372_get_fifo_xyz_data(struct adxl372_dev *dev,
 				  uint16_t cnt)
 {
 	uint8_t buf[1024];
-	uint16_t i;
 	int32_t ret;
 
-
 	if (cnt > 512)
 		return -1;
 	/*
@@ -609,14 +608,9 @@ int32_t adxl372_get_fifo_xyz_data(struct adxl372_dev *dev,
 	if (ret < 0)
 		return ret;
 
-	for (i = 0; i < cnt * 2; i += 6) {
-		samples->x = ((buf[i] << 4) | (buf[i+1] >> 4));
-		samples->y = ((buf[i+2] << 4) | (buf[i+3] >> 4));
-		samples->z = ((buf[i+4] << 4) | (buf[i+5] >> 4));
-		samples++;
-	}
-
-	return ret;
+	/* The x, y and z fields are consecutive 16-bit words, like the FIFO
+	 * entries, which hold 12-bit data left aligned. */
+	return unpack_be_u16((uint16_t *)samples, buf, cnt, 16, 12, false);
 }
 
 /**
@@ -131,6 +131,44 @@ int32_t ad400x_spi_single_conversion(struct ad400x_dev *dev,
 	return ret;
 }
 
+/**
+ * Start a continuous capture into a ring of buffers.
+ * @param dev - The device structure.
+ * @param offload_init_param - Offload module parameters, with OFFLOAD_RX_EN.
+ * @param param - Ring and consumer of the stream. The msg field is set by the
+ * 		  driver.
+ * @param stream - The stream, stopped with spi_engine_stream_stop().
+ * @return 0 in case of success, negative error code otherwise.
+ */
+int32_t ad400x_read_data_stream(struct ad400x_dev *dev,
+				const struct spi_engine_offload_init_param *offload_init_param,
+				const struct spi_engine_stream_init_param *param,
+				struct spi_engine_stream **stream)
+{
+	int32_t ret;
+	uint32_t commands_data[2] = {0xFF, 0xFF};
+	struct spi_engine_offload_message msg;
+	struct spi_engine_stream_init_param stream_param;
+	uint32_t spi_eng_msg_cmds[3] = {
+		CS_LOW,
+		READ(2),
+		CS_HIGH
+	};
+
+	ret = spi_engine_offload_init(dev->spi_desc, offload_init_param);
+	if (ret < 0)
+		return ret;
+
+	msg.commands = spi_eng_msg_cmds;
+	msg.no_commands = ARRAY_SIZE(spi_eng_msg_cmds);
+	msg.commands_data = commands_data;
+
+	stream_param = *param;
+	stream_param.msg = &msg;
+
+	return spi_engine_stream_start(dev->spi_desc, &stream_param, stream);
+}
+
 /**
  * Initialize the device.
  * @param device - The device structure.
@@ -95,5 +95,10 @@ int32_t ad400x_remove(struct ad400x_dev *dev);
 /* Execute a single conversion */
 int32_t ad400x_spi_single_conversion(struct ad400x_dev *dev,
 				     uint32_t *adc_data);
+/* Start a continuous capture */
+int32_t ad400x_read_data_stream(struct ad400x_dev *dev,
+				const struct spi_engine_offload_init_param *offload_init_param,
+				const struct spi_engine_stream_init_param *param,
+				struct spi_engine_stream **stream);
 
 #endif /* SRC_AD400X_H_ */
@@ -354,6 +354,47 @@ int32_t ad463x_read_data(struct ad463x_dev *dev,
 	return ret;
 }
 
+/**
+ * @brief Start a continuous capture into a ring of buffers.
+ * @param [in] dev - ad463x_dev device handler.
+ * @param [in] param - ring and consumer of the stream. The msg and
+ * 		dcache_invalidate_range fields are set by the driver.
+ * @param [out] stream - the stream, stopped with spi_engine_stream_stop().
+ * @return \ref SUCCESS in case of success, \ref FAILURE otherwise.
+ */
+int32_t ad463x_read_data_stream(struct ad463x_dev *dev,
+				const struct spi_engine_stream_init_param *param,
+				struct spi_engine_stream **stream)
+{
+	int32_t ret;
+	uint32_t commands_data[1] = {0};
+	struct spi_engine_offload_message msg;
+	struct spi_engine_stream_init_param stream_param;
+	uint32_t spi_eng_msg_cmds[3] = {
+		CS_LOW,
+		READ(dev->read_bytes_no),
+		CS_HIGH
+	};
+
+	ret = pwm_enable(dev->trigger_pwm_desc);
+	if (ret != SUCCESS)
+		return ret;
+
+	ret = spi_engine_offload_init(dev->spi_desc, dev->offload_init_param);
+	if (ret != SUCCESS)
+		return ret;
+
+	msg.commands = spi_eng_msg_cmds;
+	msg.no_commands = ARRAY_SIZE(spi_eng_msg_cmds);
+	msg.commands_data = commands_data;
+
+	stream_param = *param;
+	stream_param.msg = &msg;
+	stream_param.dcache_invalidate_range = dev->dcache_invalidate_range;
+
+	return spi_engine_stream_start(dev->spi_desc, &stream_param, stream);
+}
+
 /**
  * @brief Initialize the device.
  * @param [out] device - The device structure.
@@ -295,6 +295,11 @@ int32_t ad463x_read_data(struct ad463x_dev *dev,
 			 uint32_t *buf,
 			 uint16_t samples);
 
+/** Start a continuous capture */
+int32_t ad463x_read_data_stream(struct ad463x_dev *dev,
+				const struct spi_engine_stream_init_param *param,
+				struct spi_engine_stream **stream);
+
 /** Device initialization */
 int32_t ad463x_init(struct ad463x_dev **device,
 		    struct ad463x_init_param *init_param);
@@ -48,6 +48,7 @@
 #include "delay.h"
 #include "error.h"
 #include "util.h"
+#include "regmap.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -64,21 +65,31 @@ const uint8_t ad469x_device_resol[] = {
 	[AD469x_OSR_64] = 19
 };
 
+/* Status and test registers, always accessed over SPI */
+static const struct regmap_range ad469x_volatile_regs[] = {
+	{AD469x_REG_IF_CONFIG_A, AD469x_REG_IF_CONFIG_A},
+	{AD469x_REG_SCRATCH_PAD, AD469x_REG_SCRATCH_PAD},
+	{AD469x_REG_IF_STATUS, AD469x_REG_IF_STATUS},
+	{AD469x_REG_STATUS, AD469x_REG_CLAMP_STATUS2},
+	{AD469x_REG_GPIO_STATE, AD469x_REG_GPIO_STATE},
+};
+
 /******************************************************************************/
 /************************** Functions Implementation **************************/
 /******************************************************************************/
 
 /**
- * Read from device.
- * @param dev - The device structure.
+ * Read a register over SPI.
+ * @param ctx - The device structure.
  * @param reg_addr - The register address.
  * @param reg_data - The register data.
  * @return SUCCESS in case of success, negative error code otherwise.
  */
-int32_t ad469x_spi_reg_read(struct ad469x_dev *dev,
-			    uint16_t reg_addr,
-			    uint8_t *reg_data)
+static int32_t ad469x_bus_reg_read(void *ctx,
+				   uint32_t reg_addr,
+				   uint8_t *reg_data)
 {
+	struct ad469x_dev *dev = ctx;
 	int32_t ret;
 	uint8_t buf[3];
 
@@ -106,16 +117,17 @@ int32_t ad469x_spi_reg_read(struct ad469x_dev *dev,
 }
 
 /**
- * Write to device.
- * @param dev - The device structure.
+ * Write a register over SPI.
+ * @param ctx - The device structure.
  * @param reg_addr - The register address.
  * @param reg_data - The register data.
- * @@eturn SUCCESS in case of success, negative error code otherwise.
+ * @return SUCCESS in case of success, negative error code otherwise.
  */
-int32_t ad469x_spi_reg_write(struct ad469x_dev *dev,
-			     uint16_t reg_addr,
-			     uint8_t reg_data)
+static int32_t ad469x_bus_reg_write(void *ctx,
+				    uint32_t reg_addr,
+				    uint8_t reg_data)
 {
+	struct ad469x_dev *dev = ctx;
 	int32_t ret;
 	uint8_t buf[3];
 
@@ -141,6 +153,34 @@ int32_t ad469x_spi_reg_write(struct ad469x_dev *dev,
 	return ret;
 }
 
+/**
+ * Read from device.
+ * @param dev - The device structure.
+ * @param reg_addr - The register address.
+ * @param reg_data - The register data.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t ad469x_spi_reg_read(struct ad469x_dev *dev,
+			    uint16_t reg_addr,
+			    uint8_t *reg_data)
+{
+	return regmap_read(dev->regmap, reg_addr, reg_data);
+}
+
+/**
+ * Write to device.
+ * @param dev - The device structure.
+ * @param reg_addr - The register address.
+ * @param reg_data - The register data.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t ad469x_spi_reg_write(struct ad469x_dev *dev,
+			     uint16_t reg_addr,
+			     uint8_t reg_data)
+{
+	return regmap_write(dev->regmap, reg_addr, reg_data);
+}
+
 /**
  * SPI read from device using a mask.
  * @param dev - The device structure.
@@ -168,6 +208,8 @@ int32_t ad469x_spi_read_mask(struct ad469x_dev *dev,
 
 /**
  * SPI write to device using a mask.
+ * The bits of mask are cleared, then the bits of data are set, so a bit of
+ * data outside mask is set too.
  * @param dev - The device structure.
  * @param reg_addr - The register address.
  * @param mask - The mask.
@@ -179,17 +221,8 @@ int32_t ad469x_spi_write_mask(struct ad469x_dev *dev,
 			      uint8_t mask,
 			      uint8_t data)
 {
-	uint8_t reg_data;
-	int32_t ret;
-
-	ret = ad469x_spi_reg_read(dev, reg_addr, &reg_data);
-	if (ret != SUCCESS)
-		return ret;
-
-	reg_data &= ~mask;
-	reg_data |= data;
-
-	return ad469x_spi_reg_write(dev, reg_addr, reg_data);
+	/* (reg & ~mask) | data, regmap_update_bits() drops data outside mask */
+	return regmap_update_bits(dev->regmap, reg_addr, mask | data, data);
 }
 
 /**
@@ -751,6 +784,13 @@ int32_t ad469x_read_data(struct ad469x_dev *dev,
 int32_t ad469x_init(struct ad469x_dev **device,
 		    struct ad469x_init_param *init_param)
 {
+	struct regmap_init_param regmap_param = {
+		.max_register = AD469x_REG_AS_SLOT(0x7F),
+		.volatile_ranges = ad469x_volatile_regs,
+		.no_volatile_ranges = ARRAY_SIZE(ad469x_volatile_regs),
+		.reg_read = ad469x_bus_reg_read,
+		.reg_write = ad469x_bus_reg_write,
+	};
 	struct ad469x_dev *dev;
 	int32_t ret;
 	uint8_t data = 0;
@@ -793,37 +833,44 @@ int32_t ad469x_init(struct ad469x_dev **device,
 	dev->temp_enabled = false;
 	memset(dev->ch_slots, 0, sizeof(dev->ch_slots));
 
-	ret = ad469x_spi_reg_write(dev, AD469x_REG_SCRATCH_PAD, AD469x_TEST_DATA);
+	regmap_param.ctx = dev;
+	ret = regmap_init(&dev->regmap, &regmap_param);
 	if (ret != SUCCESS)
 		goto error_spi;
 
+	ret = ad469x_spi_reg_write(dev, AD469x_REG_SCRATCH_PAD, AD469x_TEST_DATA);
+	if (ret != SUCCESS)
+		goto error_regmap;
+
 	ret = ad469x_spi_reg_read(dev, AD469x_REG_SCRATCH_PAD, &data);
 	if (ret != SUCCESS)
-		goto error_spi;
+		goto error_regmap;
 
 	if (data != AD469x_TEST_DATA)
-		goto error_spi;
+		goto error_regmap;
 
 	ret = ad469x_set_reg_access_mode(dev, AD469x_BYTE_ACCESS);
 	if (ret != SUCCESS)
-		goto error_spi;
+		goto error_regmap;
 
 	ret = ad469x_set_busy(dev, AD469x_busy_gp0);
 	if (ret != SUCCESS)
-		goto error_spi;
+		goto error_regmap;
 
 	ret = ad469x_seq_osr_clear(dev);
 	if (ret != SUCCESS)
-		goto error_spi;
+		goto error_regmap;
 
 	ret = pwm_init(&dev->trigger_pwm_desc, init_param->trigger_pwm_init);
 	if (ret != SUCCESS)
-		goto error_spi;
+		goto error_regmap;
 
 	*device = dev;
 
 	return ret;
 
+error_regmap:
+	regmap_remove(dev->regmap);
 error_spi:
 	spi_remove(dev->spi_desc);
 error_gpio:
@@ -852,6 +899,10 @@ int32_t ad469x_remove(struct ad469x_dev *dev)
 	if (ret != SUCCESS)
 		return ret;
 
+	ret = regmap_remove(dev->regmap);
+	if (ret != SUCCESS)
+		return ret;
+
 	ret = spi_remove(dev->spi_desc);
 	if (ret != SUCCESS)
 		return ret;
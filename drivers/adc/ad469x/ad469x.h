@@ -47,6 +47,7 @@
 #include "clk_axi_clkgen.h"
 #include "pwm.h"
 #include "gpio.h"
+#include "regmap.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -228,6 +229,8 @@ struct ad469x_init_param {
 struct ad469x_dev {
 	/* SPI descriptor */
 	spi_desc		*spi_desc;
+	/* Register map */
+	struct regmap		*regmap;
 	/* Clock gen for hdl design structure */
 	struct axi_clkgen	*clkgen;
 	/* Trigger conversion PWM generator descriptor */
@@ -307,6 +307,42 @@ int32_t ad738x_read_data(struct ad738x_dev *dev,
 	return ret;
 }
 
+/**
+ * Start a continuous capture into a ring of buffers.
+ * @param dev - The device structure.
+ * @param param - Ring and consumer of the stream. The msg and
+ * 		  dcache_invalidate_range fields are set by the driver.
+ * @param stream - The stream, stopped with spi_engine_stream_stop().
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t ad738x_read_data_stream(struct ad738x_dev *dev,
+				const struct spi_engine_stream_init_param *param,
+				struct spi_engine_stream **stream)
+{
+	int32_t ret;
+	uint32_t commands_data[2] = {0, 0};
+	struct spi_engine_offload_message msg;
+	struct spi_engine_stream_init_param stream_param;
+	uint32_t spi_eng_msg_cmds[3] = {
+		CS_LOW,
+		WRITE_READ(2),
+		CS_HIGH,
+	};
+
+	ret = spi_engine_offload_init(dev->spi_desc, dev->offload_init_param);
+	if (ret != SUCCESS)
+		return ret;
+
+	msg.commands_data = commands_data;
+	msg.commands = spi_eng_msg_cmds;
+	msg.no_commands = ARRAY_SIZE(spi_eng_msg_cmds);
+
+	stream_param = *param;
+	stream_param.msg = &msg;
+	stream_param.dcache_invalidate_range = dev->dcache_invalidate_range;
+
+	return spi_engine_stream_start(dev->spi_desc, &stream_param, stream);
+}
 
 /**
  * Initialize the device.
@@ -222,4 +222,8 @@ int32_t ad738x_reference_sel(struct ad738x_dev *dev,
 int32_t ad738x_read_data(struct ad738x_dev *dev,
 			 uint32_t *buf,
 			 uint16_t samples);
+/** Start a continuous capture. */
+int32_t ad738x_read_data_stream(struct ad738x_dev *dev,
+				const struct spi_engine_stream_init_param *param,
+				struct spi_engine_stream **stream);
 #endif /* SRC_AD738X_H_ */
@@ -1061,6 +1061,16 @@ int32_t ad9081_init(struct ad9081_phy **dev,
 	phy->ad9081.hal_info.spi_xfer = ad9081_spi_xfer;
 	phy->ad9081.hal_info.log_write = ad9081_log_write;
 
+	if (init_param->reg_cache_enable) {
+		phy->reg_cache = (adi_ad9081_reg_cache_t *)calloc(1,
+				 sizeof(*phy->reg_cache));
+		if (!phy->reg_cache) {
+			ret = FAILURE;
+			goto error_3;
+		}
+		adi_ad9081_hal_reg_cache_enable(&phy->ad9081, phy->reg_cache, 0);
+	}
+
 	ret = gpio_direction_output(phy->gpio_reset, 1);
 	if (ret < 0)
 		goto error_3;
@@ -1084,12 +1094,27 @@ int32_t ad9081_init(struct ad9081_phy **dev,
 		goto error_3;
 	}
 
+	/* merge the read-modify-write sequences of the setup */
+	if (phy->reg_cache)
+		adi_ad9081_hal_reg_cache_enable(&phy->ad9081, phy->reg_cache, 1);
+
 	ret = ad9081_setup(phy);
 	if (ret < 0) {
 		printf("%s: ad9081_setup failed (%"PRId32")\n", __func__, ret);
 		goto error_3;
 	}
 
+	if (phy->reg_cache) {
+		ret = adi_ad9081_hal_reg_cache_enable(&phy->ad9081,
+						      phy->reg_cache, 0);
+		if (ret < 0)
+			goto error_3;
+		printf("%s: %"PRIu32" SPI transfers, %"PRIu32
+		       " cached reads, %"PRIu32" merged writes\n", __func__,
+		       phy->ad9081.hal_info.spi_xfer_cnt, phy->reg_cache->hits,
+		       phy->reg_cache->merged);
+	}
+
 	adi_ad9081_device_api_revision_get(&phy->ad9081, &api_rev[0],
 					   &api_rev[1], &api_rev[2]);
 
@@ -1102,6 +1127,7 @@ int32_t ad9081_init(struct ad9081_phy **dev,
 	return SUCCESS;
 
 error_3:
+	free(phy->reg_cache);
 	spi_remove(phy->spi_desc);
 error_2:
 	gpio_remove(phy->gpio_reset);
@@ -1122,6 +1148,7 @@ int32_t ad9081_remove(struct ad9081_phy *dev)
 
 	ret = gpio_remove(dev->gpio_reset);
 	ret += spi_remove(dev->spi_desc);
+	free(dev->reg_cache);
 	free(dev);
 
 	return ret;
@@ -75,6 +75,7 @@ struct ad9081_phy {
 	struct clk		*jesd_tx_clk;
 	struct clk		*dev_clk;
 	adi_ad9081_device_t	ad9081;
+	adi_ad9081_reg_cache_t	*reg_cache;
 	struct ad9081_jesd_link	jesd_tx_link;
 	struct ad9081_jesd_link	jesd_rx_link[2];
 	uint32_t	multidevice_instance_count;
@@ -140,6 +141,8 @@ struct ad9081_init_param {
 	bool		jesd_sync_pins_01_swap_enable;
 	uint32_t	lmfc_delay_dac_clk_cycles;
 	uint32_t	nco_sync_ms_extra_lmfc_num;
+	/* Shadow the device registers to save SPI reads */
+	bool		reg_cache_enable;
 	/* TX */
 	uint64_t	dac_frequency_hz;
 	/* The 4 DAC Main Datapaths */
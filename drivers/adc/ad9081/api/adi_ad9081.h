@@ -570,6 +570,19 @@ typedef struct {
 	uint8_t virtual_converterf_index; /*! Index for JTX virtual converter15 */
 } adi_ad9081_jtx_conv_sel_t;
 
+/*!
+ * @brief Shadow of the 8-bit registers, see adi_ad9081_hal_reg_cache_enable()
+ */
+typedef struct {
+	uint8_t value[0x4000]; /*!< Last value written to each register */
+	uint8_t valid[0x4000 / 8]; /*!< Bitmap of the registers whose value is known */
+	uint8_t write_back; /*!< Merge consecutive bitfield writes to a register */
+	uint8_t bypass; /*!< Read the registers over SPI, used while polling */
+	int32_t pending_reg; /*!< Register whose write is deferred, -1 if none */
+	uint32_t hits; /*!< Number of register reads served from the shadow */
+	uint32_t merged; /*!< Number of register writes merged with the next one */
+} adi_ad9081_reg_cache_t;
+
 /*!
  * @brief Device Hardware Abstract Layer Structure
  */
@@ -596,6 +609,10 @@ typedef struct {
 		tx_en_pin_ctrl; /*!< Function pointer to hal tx_enable pin control function */
 	adi_reset_pin_ctrl_t
 		reset_pin_ctrl; /*!< Function pointer to hal reset# pin control function */
+
+	adi_ad9081_reg_cache_t
+		*reg_cache; /*!< Register shadow provided by the user, NULL if disabled */
+	uint32_t spi_xfer_cnt; /*!< Number of SPI transfers issued by the HAL */
 } adi_ad9081_hal_t;
 
 /*!
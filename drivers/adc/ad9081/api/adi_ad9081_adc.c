@@ -1163,8 +1163,7 @@ int32_t adi_ad9081_adc_ddc_coarse_nco_ftw_set(adi_ad9081_device_t *device,
 	in_data[6] = (uint8_t)((ftw >> 32) & 0xFF);
 	in_data[7] = (uint8_t)((ftw >> 40) & 0xFF);
 	if (API_CMS_ERROR_OK !=
-	    device->hal_info.spi_xfer(device->hal_info.user_data, in_data, NULL,
-				      0x8))
+	    adi_ad9081_hal_spi_burst_write(device, in_data, 0x8))
 		return API_CMS_ERROR_SPI_XFER;
 	in_data[0] = (REG_COARSE_DDC_PHASE_INC_FRAC_A0_ADDR >> 8) & 0x3F;
 	in_data[1] = (REG_COARSE_DDC_PHASE_INC_FRAC_A0_ADDR >> 0) & 0xFF;
@@ -1175,8 +1174,7 @@ int32_t adi_ad9081_adc_ddc_coarse_nco_ftw_set(adi_ad9081_device_t *device,
 	in_data[6] = (uint8_t)((modulus_a >> 32) & 0xFF);
 	in_data[7] = (uint8_t)((modulus_a >> 40) & 0xFF);
 	if (API_CMS_ERROR_OK !=
-	    device->hal_info.spi_xfer(device->hal_info.user_data, in_data, NULL,
-				      0x8))
+	    adi_ad9081_hal_spi_burst_write(device, in_data, 0x8))
 		return API_CMS_ERROR_SPI_XFER;
 	in_data[0] = (REG_COARSE_DDC_PHASE_INC_FRAC_B0_ADDR >> 8) & 0x3F;
 	in_data[1] = (REG_COARSE_DDC_PHASE_INC_FRAC_B0_ADDR >> 0) & 0xFF;
@@ -1187,8 +1185,7 @@ int32_t adi_ad9081_adc_ddc_coarse_nco_ftw_set(adi_ad9081_device_t *device,
 	in_data[6] = (uint8_t)((modulus_b >> 32) & 0xFF);
 	in_data[7] = (uint8_t)((modulus_b >> 40) & 0xFF);
 	if (API_CMS_ERROR_OK !=
-	    device->hal_info.spi_xfer(device->hal_info.user_data, in_data, NULL,
-				      0x8))
+	    adi_ad9081_hal_spi_burst_write(device, in_data, 0x8))
 		return API_CMS_ERROR_SPI_XFER;
 #else
 	err = adi_ad9081_hal_bf_set(device, REG_COARSE_DDC_PHASE_INC0_ADDR,
@@ -1275,8 +1272,7 @@ adi_ad9081_adc_ddc_coarse_nco_phase_offset_set(adi_ad9081_device_t *device,
 	in_data[6] = (uint8_t)((offset >> 32) & 0xFF);
 	in_data[7] = (uint8_t)((offset >> 40) & 0xFF);
 	if (API_CMS_ERROR_OK !=
-	    device->hal_info.spi_xfer(device->hal_info.user_data, in_data, NULL,
-				      0x8))
+	    adi_ad9081_hal_spi_burst_write(device, in_data, 0x8))
 		return API_CMS_ERROR_SPI_XFER;
 #else
 	err = adi_ad9081_hal_bf_set(device, REG_COARSE_DDC_PHASE_OFFSET0_ADDR,
@@ -1927,8 +1923,7 @@ int32_t adi_ad9081_adc_ddc_fine_nco_ftw_set(adi_ad9081_device_t *device,
 	in_data[6] = (uint8_t)((ftw >> 32) & 0xFF);
 	in_data[7] = (uint8_t)((ftw >> 40) & 0xFF);
 	if (API_CMS_ERROR_OK !=
-	    device->hal_info.spi_xfer(device->hal_info.user_data, in_data, NULL,
-				      0x8))
+	    adi_ad9081_hal_spi_burst_write(device, in_data, 0x8))
 		return API_CMS_ERROR_SPI_XFER;
 	in_data[0] = (REG_FINE_DDC_PHASE_INC_FRAC_A0_ADDR >> 8) & 0x3F;
 	in_data[1] = (REG_FINE_DDC_PHASE_INC_FRAC_A0_ADDR >> 0) & 0xFF;
@@ -1939,8 +1934,7 @@ int32_t adi_ad9081_adc_ddc_fine_nco_ftw_set(adi_ad9081_device_t *device,
 	in_data[6] = (uint8_t)((modulus_a >> 32) & 0xFF);
 	in_data[7] = (uint8_t)((modulus_a >> 40) & 0xFF);
 	if (API_CMS_ERROR_OK !=
-	    device->hal_info.spi_xfer(device->hal_info.user_data, in_data, NULL,
-				      0x8))
+	    adi_ad9081_hal_spi_burst_write(device, in_data, 0x8))
 		return API_CMS_ERROR_SPI_XFER;
 	in_data[0] = (REG_FINE_DDC_PHASE_INC_FRAC_B0_ADDR >> 8) & 0x3F;
 	in_data[1] = (REG_FINE_DDC_PHASE_INC_FRAC_B0_ADDR >> 0) & 0xFF;
@@ -1951,8 +1945,7 @@ int32_t adi_ad9081_adc_ddc_fine_nco_ftw_set(adi_ad9081_device_t *device,
 	in_data[6] = (uint8_t)((modulus_b >> 32) & 0xFF);
 	in_data[7] = (uint8_t)((modulus_b >> 40) & 0xFF);
 	if (API_CMS_ERROR_OK !=
-	    device->hal_info.spi_xfer(device->hal_info.user_data, in_data, NULL,
-				      0x8))
+	    adi_ad9081_hal_spi_burst_write(device, in_data, 0x8))
 		return API_CMS_ERROR_SPI_XFER;
 #else
 	err = adi_ad9081_hal_bf_set(device, REG_FINE_DDC_PHASE_INC0_ADDR,
@@ -2022,8 +2015,7 @@ adi_ad9081_adc_ddc_fine_nco_phase_offset_set(adi_ad9081_device_t *device,
 	in_data[6] = (uint8_t)((offset >> 32) & 0xFF);
 	in_data[7] = (uint8_t)((offset >> 40) & 0xFF);
 	if (API_CMS_ERROR_OK !=
-	    device->hal_info.spi_xfer(device->hal_info.user_data, in_data, NULL,
-				      0x8))
+	    adi_ad9081_hal_spi_burst_write(device, in_data, 0x8))
 		return API_CMS_ERROR_SPI_XFER;
 #else
 	err = adi_ad9081_hal_bf_set(device, REG_FINE_DDC_PHASE_OFFSET0_ADDR,
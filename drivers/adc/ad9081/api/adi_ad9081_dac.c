@@ -330,8 +330,8 @@ int32_t adi_ad9081_dac_duc_nco_ftw0_set(adi_ad9081_device_t *device,
 			in_data[6] = (uint8_t)((ftw >> 32) & 0xFF);
 			in_data[7] = (uint8_t)((ftw >> 40) & 0xFF);
 			if (API_CMS_ERROR_OK !=
-			    device->hal_info.spi_xfer(device->hal_info.user_data,
-						      in_data, NULL, 0x8))
+			    adi_ad9081_hal_spi_burst_write(
+				    device, in_data, 0x8))
 				return API_CMS_ERROR_SPI_XFER;
 #else
 			err = adi_ad9081_hal_bf_set(device, REG_DDSM_FTW0_ADDR,
@@ -375,8 +375,8 @@ int32_t adi_ad9081_dac_duc_nco_ftw0_set(adi_ad9081_device_t *device,
 			in_data[6] = (uint8_t)((ftw >> 32) & 0xFF);
 			in_data[7] = (uint8_t)((ftw >> 40) & 0xFF);
 			if (API_CMS_ERROR_OK !=
-			    device->hal_info.spi_xfer(device->hal_info.user_data,
-						      in_data, NULL, 0x8))
+			    adi_ad9081_hal_spi_burst_write(
+				    device, in_data, 0x8))
 				return API_CMS_ERROR_SPI_XFER;
 #else
 			err = adi_ad9081_hal_bf_set(device, REG_DDSC_FTW0_ADDR,
@@ -455,9 +455,8 @@ int32_t adi_ad9081_dac_duc_nco_ftw_set(adi_ad9081_device_t *device,
 				in_data[7] =
 					(uint8_t)((acc_modulus >> 40) & 0xFF);
 				if (API_CMS_ERROR_OK !=
-				    device->hal_info.spi_xfer(
-					    device->hal_info.user_data, in_data,
-					    NULL, 0x8))
+				    adi_ad9081_hal_spi_burst_write(
+					    device, in_data, 0x8))
 					return API_CMS_ERROR_SPI_XFER;
 				in_data[0] =
 					(BF_DDSM_ACC_DELTA_INFO >> 8) & 0x3F;
@@ -474,9 +473,8 @@ int32_t adi_ad9081_dac_duc_nco_ftw_set(adi_ad9081_device_t *device,
 				in_data[7] =
 					(uint8_t)((acc_delta >> 40) & 0xFF);
 				if (API_CMS_ERROR_OK !=
-				    device->hal_info.spi_xfer(
-					    device->hal_info.user_data, in_data,
-					    NULL, 0x8))
+				    adi_ad9081_hal_spi_burst_write(
+					    device, in_data, 0x8))
 					return API_CMS_ERROR_SPI_XFER;
 #else
 				err = adi_ad9081_hal_bf_set(
@@ -531,9 +529,8 @@ int32_t adi_ad9081_dac_duc_nco_ftw_set(adi_ad9081_device_t *device,
 				in_data[7] =
 					(uint8_t)((acc_modulus >> 40) & 0xFF);
 				if (API_CMS_ERROR_OK !=
-				    device->hal_info.spi_xfer(
-					    device->hal_info.user_data, in_data,
-					    NULL, 0x8))
+				    adi_ad9081_hal_spi_burst_write(
+					    device, in_data, 0x8))
 					return API_CMS_ERROR_SPI_XFER;
 				in_data[0] =
 					(REG_DDSC_ACC_DELTA0_ADDR >> 8) & 0x3F;
@@ -550,9 +547,8 @@ int32_t adi_ad9081_dac_duc_nco_ftw_set(adi_ad9081_device_t *device,
 				in_data[7] =
 					(uint8_t)((acc_delta >> 40) & 0xFF);
 				if (API_CMS_ERROR_OK !=
-				    device->hal_info.spi_xfer(
-					    device->hal_info.user_data, in_data,
-					    NULL, 0x8))
+				    adi_ad9081_hal_spi_burst_write(
+					    device, in_data, 0x8))
 					return API_CMS_ERROR_SPI_XFER;
 #else
 				err = adi_ad9081_hal_bf_set(
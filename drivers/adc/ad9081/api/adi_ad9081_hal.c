@@ -15,7 +15,197 @@
 /*============= I N C L U D E S ============*/
 #include "adi_ad9081_hal.h"
 
+/*============= D A T A ====================*/
+/* Registers always accessed over SPI: status, self-clearing and indirect
+ * access registers. */
+static const struct {
+	uint16_t start;
+	uint16_t end;
+} adi_ad9081_hal_volatile_regs[] = {
+	{ 0x0000, 0x0001 }, /* SPI config, soft reset */
+	{ 0x0010, 0x0013 }, /* chip id */
+	{ 0x0026, 0x0034 }, /* irq and gpio status */
+	{ 0x0063, 0x0063 }, { 0x00a5, 0x00a5 }, { 0x00b4, 0x00b4 },
+	{ 0x00bb, 0x00bc }, { 0x00e2, 0x00e2 }, { 0x00ec, 0x00f4 },
+	{ 0x0110, 0x0110 }, { 0x01a1, 0x01a1 }, { 0x01c7, 0x01c7 },
+	{ 0x01ca, 0x01ca }, { 0x01f6, 0x01f6 }, { 0x0201, 0x0201 },
+	{ 0x0210, 0x0215 }, { 0x02a4, 0x02a7 }, { 0x02ba, 0x02bd },
+	{ 0x02c2, 0x02c5 },
+	{ 0x0400, 0x047f }, /* deserializer, jrx cbus */
+	{ 0x05ad, 0x05bb }, /* jrx status */
+	{ 0x0700, 0x07ff }, /* serializer, lcpll, jtx cbus */
+	{ 0x0a00, 0x0a02 }, { 0x0a1d, 0x0a1d }, { 0x0a32, 0x0a38 },
+	{ 0x0a80, 0x0a82 }, { 0x0a9d, 0x0a9d }, { 0x0ab2, 0x0ab8 },
+	{ 0x0f2c, 0x0f2c }, { 0x0f34, 0x0f34 }, { 0x2008, 0x2008 },
+	{ 0x2061, 0x2066 },
+	{ 0x3d00, 0x3dff }, /* uP, mailbox, extended address */
+};
+
+/* Registers resetting other registers when written. */
+static const uint16_t adi_ad9081_hal_reset_regs[] = {
+	0x00e2, 0x0201, 0x0214, 0x0215, 0x070a, 0x0710, 0x0f34,
+};
+
 /*============= C O D E ====================*/
+static int32_t adi_ad9081_hal_spi_xfer(adi_ad9081_device_t *device,
+				       uint8_t *in_data, uint8_t *out_data,
+				       uint32_t size_bytes)
+{
+	/* a deferred register write goes out before any other access */
+	if ((device->hal_info.reg_cache != NULL) &&
+	    (device->hal_info.reg_cache->pending_reg >= 0) &&
+	    (API_CMS_ERROR_OK != adi_ad9081_hal_reg_cache_flush(device)))
+		return API_CMS_ERROR_SPI_XFER;
+
+	device->hal_info.spi_xfer_cnt++;
+	return device->hal_info.spi_xfer(device->hal_info.user_data, in_data,
+					 out_data, size_bytes);
+}
+
+static uint8_t adi_ad9081_hal_reg_is_volatile(uint32_t reg)
+{
+	uint8_t i;
+
+	for (i = 0; i < sizeof(adi_ad9081_hal_volatile_regs) /
+			 sizeof(adi_ad9081_hal_volatile_regs[0]); i++)
+		if ((reg >= adi_ad9081_hal_volatile_regs[i].start) &&
+		    (reg <= adi_ad9081_hal_volatile_regs[i].end))
+			return 1;
+
+	return 0;
+}
+
+static void adi_ad9081_hal_reg_cache_invalidate(adi_ad9081_reg_cache_t *cache,
+						uint32_t from)
+{
+	uint32_t i;
+
+	for (i = from >> 3; i < sizeof(cache->valid); i++)
+		cache->valid[i] = 0;
+}
+
+static uint8_t adi_ad9081_hal_reg_cache_get(adi_ad9081_device_t *device,
+					    uint32_t reg, uint8_t *data)
+{
+	adi_ad9081_reg_cache_t *cache = device->hal_info.reg_cache;
+
+	if ((cache == NULL) || cache->bypass || (reg >= 0x4000) ||
+	    !(cache->valid[reg >> 3] & (1 << (reg & 7))))
+		return 0;
+
+	*data = cache->value[reg];
+	cache->hits++;
+
+	return 1;
+}
+
+static void adi_ad9081_hal_reg_cache_update(adi_ad9081_device_t *device,
+					    uint32_t reg, uint8_t data)
+{
+	adi_ad9081_reg_cache_t *cache = device->hal_info.reg_cache;
+	uint8_t i;
+
+	if ((cache == NULL) || (reg >= 0x4000))
+		return;
+
+	if ((reg == 0x0000) && (data & 0x81)) { /* soft reset */
+		adi_ad9081_hal_reg_cache_invalidate(cache, 0);
+		return;
+	}
+	for (i = 0; i < sizeof(adi_ad9081_hal_reset_regs) /
+			 sizeof(adi_ad9081_hal_reset_regs[0]); i++) {
+		if (reg == adi_ad9081_hal_reset_regs[i]) {
+			adi_ad9081_hal_reg_cache_invalidate(cache, 0);
+			return;
+		}
+	}
+	/* the paged registers are not tracked per page */
+	if ((reg >= 0x0018) && (reg <= 0x001f) &&
+	    (!(cache->valid[reg >> 3] & (1 << (reg & 7))) ||
+	     (cache->value[reg] != data)))
+		adi_ad9081_hal_reg_cache_invalidate(cache, 0x100);
+
+	if (adi_ad9081_hal_reg_is_volatile(reg))
+		return;
+
+	cache->value[reg] = data;
+	cache->valid[reg >> 3] |= 1 << (reg & 7);
+}
+
+int32_t adi_ad9081_hal_reg_cache_flush(adi_ad9081_device_t *device)
+{
+	adi_ad9081_reg_cache_t *cache;
+	uint8_t in_data[3] = { 0 }, out_data[3] = { 0 };
+	uint32_t reg;
+	AD9081_NULL_POINTER_RETURN(device);
+
+	cache = device->hal_info.reg_cache;
+	if ((cache == NULL) || (cache->pending_reg < 0))
+		return API_CMS_ERROR_OK;
+
+	reg = cache->pending_reg;
+	cache->pending_reg = -1;
+	in_data[0] = (reg >> 8) & 0x3F;
+	in_data[1] = (reg >> 0) & 0xFF;
+	in_data[2] = cache->value[reg];
+	if (API_CMS_ERROR_OK !=
+	    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
+		return API_CMS_ERROR_SPI_XFER;
+	if (API_CMS_ERROR_OK != AD9081_LOG_SPIW(reg & 0x3fff, in_data[2]))
+		return API_CMS_ERROR_LOG_WRITE;
+
+	return API_CMS_ERROR_OK;
+}
+
+int32_t adi_ad9081_hal_reg_cache_enable(adi_ad9081_device_t *device,
+					adi_ad9081_reg_cache_t *cache,
+					uint8_t write_back)
+{
+	int32_t err;
+	AD9081_NULL_POINTER_RETURN(device);
+
+	err = adi_ad9081_hal_reg_cache_flush(device);
+	AD9081_ERROR_RETURN(err);
+
+	if ((cache != NULL) && (cache != device->hal_info.reg_cache)) {
+		adi_ad9081_hal_reg_cache_invalidate(cache, 0);
+		cache->bypass = 0;
+		cache->pending_reg = -1;
+		cache->hits = 0;
+		cache->merged = 0;
+	}
+	if (cache != NULL)
+		cache->write_back = write_back;
+	device->hal_info.reg_cache = cache;
+
+	return API_CMS_ERROR_OK;
+}
+
+/* Write a register updated by a bitfield set, the write may be merged with
+ * the next bitfield set of the same register. */
+static int32_t adi_ad9081_hal_reg_set_bf(adi_ad9081_device_t *device,
+					 uint32_t reg, uint8_t data)
+{
+	adi_ad9081_reg_cache_t *cache = device->hal_info.reg_cache;
+	int32_t err;
+
+	if ((cache == NULL) || !cache->write_back ||
+	    adi_ad9081_hal_reg_is_volatile(reg) ||
+	    ((reg >= 0x0018) && (reg <= 0x001f)))
+		return adi_ad9081_hal_reg_set(device, reg, data);
+
+	if (cache->pending_reg == (int32_t)reg) {
+		cache->merged++;
+	} else {
+		err = adi_ad9081_hal_reg_cache_flush(device);
+		AD9081_ERROR_RETURN(err);
+	}
+	adi_ad9081_hal_reg_cache_update(device, reg, data);
+	cache->pending_reg = reg;
+
+	return API_CMS_ERROR_OK;
+}
+
 int32_t adi_ad9081_hal_hw_open(adi_ad9081_device_t *device)
 {
 	AD9081_NULL_POINTER_RETURN(device);
@@ -31,6 +221,8 @@ int32_t adi_ad9081_hal_hw_open(adi_ad9081_device_t *device)
 int32_t adi_ad9081_hal_hw_close(adi_ad9081_device_t *device)
 {
 	AD9081_NULL_POINTER_RETURN(device);
+	if (API_CMS_ERROR_OK != adi_ad9081_hal_reg_cache_flush(device))
+		return API_CMS_ERROR_SPI_XFER;
 	if (device->hal_info.hw_close != NULL) {
 		if (API_CMS_ERROR_OK !=
 		    device->hal_info.hw_close(device->hal_info.user_data))
@@ -44,6 +236,8 @@ int32_t adi_ad9081_hal_delay_us(adi_ad9081_device_t *device, uint32_t us)
 {
 	AD9081_NULL_POINTER_RETURN(device);
 	AD9081_NULL_POINTER_RETURN(device->hal_info.delay_us);
+	if (API_CMS_ERROR_OK != adi_ad9081_hal_reg_cache_flush(device))
+		return API_CMS_ERROR_SPI_XFER;
 	if (API_CMS_ERROR_OK !=
 	    device->hal_info.delay_us(device->hal_info.user_data, us)) {
 		return API_CMS_ERROR_DELAY_US;
@@ -57,6 +251,11 @@ int32_t adi_ad9081_hal_reset_pin_ctrl(adi_ad9081_device_t *device,
 {
 	AD9081_NULL_POINTER_RETURN(device);
 	AD9081_NULL_POINTER_RETURN(device->hal_info.reset_pin_ctrl);
+	if (API_CMS_ERROR_OK != adi_ad9081_hal_reg_cache_flush(device))
+		return API_CMS_ERROR_SPI_XFER;
+	if (device->hal_info.reg_cache != NULL)
+		adi_ad9081_hal_reg_cache_invalidate(device->hal_info.reg_cache,
+						    0);
 	if (API_CMS_ERROR_OK != device->hal_info.reset_pin_ctrl(
 					device->hal_info.user_data, enable)) {
 		return API_CMS_ERROR_RESET_PIN_CTRL;
@@ -197,8 +396,8 @@ int32_t adi_ad9081_hal_bf_set(adi_ad9081_device_t *device, uint32_t reg,
 				width = offset + width - 8;
 				offset = 0;
 			}
-			err = adi_ad9081_hal_reg_set(device, reg + reg_offset,
-						     data8);
+			err = adi_ad9081_hal_reg_set_bf(device,
+							reg + reg_offset, data8);
 			AD9081_ERROR_RETURN(err);
 		}
 	} else { /* access extended space */
@@ -244,12 +443,14 @@ int32_t adi_ad9081_hal_reg_get(adi_ad9081_device_t *device, uint32_t reg,
 	AD9081_NULL_POINTER_RETURN(device->hal_info.spi_xfer);
 	AD9081_NULL_POINTER_RETURN(data);
 
+	if (adi_ad9081_hal_reg_cache_get(device, reg, data))
+		return API_CMS_ERROR_OK;
+
 	if (reg < 0x4000) {
 		in_data[0] = ((reg >> 8) & 0x3F) | 0x80;
 		in_data[1] = ((reg >> 0) & 0xFF);
 		if (API_CMS_ERROR_OK !=
-		    device->hal_info.spi_xfer(device->hal_info.user_data,
-					      in_data, out_data, 0x3))
+		    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
 			return API_CMS_ERROR_SPI_XFER;
 		*data = out_data[2];
 		if (API_CMS_ERROR_OK !=
@@ -261,8 +462,7 @@ int32_t adi_ad9081_hal_reg_get(adi_ad9081_device_t *device, uint32_t reg,
 		in_data[1] = 0x21;
 		in_data[2] = (reg >> 8) & 0xC0;
 		if (API_CMS_ERROR_OK !=
-		    device->hal_info.spi_xfer(device->hal_info.user_data,
-					      in_data, out_data, 0x3))
+		    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
 			return API_CMS_ERROR_SPI_XFER;
 		if (API_CMS_ERROR_OK != AD9081_LOG_SPIW(0x3d21, in_data[2]))
 			return API_CMS_ERROR_LOG_WRITE;
@@ -270,8 +470,7 @@ int32_t adi_ad9081_hal_reg_get(adi_ad9081_device_t *device, uint32_t reg,
 		in_data[1] = 0x22;
 		in_data[2] = (reg >> 16) & 0xFF;
 		if (API_CMS_ERROR_OK !=
-		    device->hal_info.spi_xfer(device->hal_info.user_data,
-					      in_data, out_data, 0x3))
+		    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
 			return API_CMS_ERROR_SPI_XFER;
 		if (API_CMS_ERROR_OK != AD9081_LOG_SPIW(0x3d22, in_data[2]))
 			return API_CMS_ERROR_LOG_WRITE;
@@ -279,8 +478,7 @@ int32_t adi_ad9081_hal_reg_get(adi_ad9081_device_t *device, uint32_t reg,
 		in_data[1] = 0x23;
 		in_data[2] = (reg >> 24) & 0xFF;
 		if (API_CMS_ERROR_OK !=
-		    device->hal_info.spi_xfer(device->hal_info.user_data,
-					      in_data, out_data, 0x3))
+		    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
 			return API_CMS_ERROR_SPI_XFER;
 		if (API_CMS_ERROR_OK != AD9081_LOG_SPIW(0x3d23, in_data[2]))
 			return API_CMS_ERROR_LOG_WRITE;
@@ -290,8 +488,7 @@ int32_t adi_ad9081_hal_reg_get(adi_ad9081_device_t *device, uint32_t reg,
 			in_data[0] = ((reg >> 8) & 0x3F) | 0xC0;
 			in_data[1] = ((reg >> 0) & 0xFF);
 			if (API_CMS_ERROR_OK !=
-			    device->hal_info.spi_xfer(device->hal_info.user_data,
-						      in_data, out_data, 0x3))
+			    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
 				return API_CMS_ERROR_SPI_XFER;
 			*data = out_data[2];
 			if (API_CMS_ERROR_OK !=
@@ -307,9 +504,8 @@ int32_t adi_ad9081_hal_reg_get(adi_ad9081_device_t *device, uint32_t reg,
 			in_data[0] = ((reg >> 8) & 0x3F) | 0xC0;
 			in_data[1] = ((reg >> 0) & 0xFF);
 			if (API_CMS_ERROR_OK !=
-			    device->hal_info.spi_xfer(
-				    device->hal_info.user_data, in_data,
-				    out_data, 0x20000006))
+			    adi_ad9081_hal_spi_xfer(device, in_data, out_data,
+						    0x20000006))
 				return API_CMS_ERROR_SPI_XFER;
 			if (device->hal_info.addr_inc == SPI_ADDR_INC_AUTO) {
 				*(uint32_t *)data = (out_data[2]) +
@@ -332,6 +528,30 @@ int32_t adi_ad9081_hal_reg_get(adi_ad9081_device_t *device, uint32_t reg,
 	return API_CMS_ERROR_OK;
 }
 
+/* Write consecutive registers in one SPI burst. in_data holds the address of
+ * the first register, then the data, as sent over SPI. */
+int32_t adi_ad9081_hal_spi_burst_write(adi_ad9081_device_t *device,
+				       uint8_t *in_data, uint32_t size_bytes)
+{
+	uint32_t reg, i;
+	AD9081_NULL_POINTER_RETURN(device);
+	AD9081_NULL_POINTER_RETURN(device->hal_info.spi_xfer);
+	AD9081_NULL_POINTER_RETURN(in_data);
+	AD9081_INVALID_PARAM_RETURN(size_bytes < 3);
+
+	/* a deferred write of the range is flushed first, then overwritten */
+	if (API_CMS_ERROR_OK !=
+	    adi_ad9081_hal_spi_xfer(device, in_data, NULL, size_bytes))
+		return API_CMS_ERROR_SPI_XFER;
+
+	reg = ((in_data[0] & 0x3F) << 8) | in_data[1];
+	for (i = 2; i < size_bytes; i++)
+		adi_ad9081_hal_reg_cache_update(device, reg + i - 2,
+						in_data[i]);
+
+	return API_CMS_ERROR_OK;
+}
+
 int32_t adi_ad9081_hal_reg_set(adi_ad9081_device_t *device, uint32_t reg,
 			       uint32_t data)
 {
@@ -339,24 +559,27 @@ int32_t adi_ad9081_hal_reg_set(adi_ad9081_device_t *device, uint32_t reg,
 	AD9081_NULL_POINTER_RETURN(device);
 	AD9081_NULL_POINTER_RETURN(device->hal_info.spi_xfer);
 
+	if ((device->hal_info.reg_cache != NULL) &&
+	    (device->hal_info.reg_cache->pending_reg == (int32_t)reg))
+		device->hal_info.reg_cache->pending_reg = -1;
+
 	if (reg < 0x4000) {
 		in_data[0] = (reg >> 8) & 0x3F;
 		in_data[1] = (reg >> 0) & 0xFF;
 		in_data[2] = (uint8_t)(data & 0xFF);
 		if (API_CMS_ERROR_OK !=
-		    device->hal_info.spi_xfer(device->hal_info.user_data,
-					      in_data, out_data, 0x3))
+		    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
 			return API_CMS_ERROR_SPI_XFER;
 		if (API_CMS_ERROR_OK !=
 		    AD9081_LOG_SPIW(reg & 0x3fff, in_data[2]))
 			return API_CMS_ERROR_LOG_WRITE;
+		adi_ad9081_hal_reg_cache_update(device, reg, in_data[2]);
 	} else { /* access extended 32-bit data space */
 		in_data[0] = 0x3D;
 		in_data[1] = 0x21;
 		in_data[2] = (reg >> 8) & 0xC0;
 		if (API_CMS_ERROR_OK !=
-		    device->hal_info.spi_xfer(device->hal_info.user_data,
-					      in_data, out_data, 0x3))
+		    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
 			return API_CMS_ERROR_SPI_XFER;
 		if (API_CMS_ERROR_OK != AD9081_LOG_SPIW(0x3d21, in_data[2]))
 			return API_CMS_ERROR_LOG_WRITE;
@@ -364,8 +587,7 @@ int32_t adi_ad9081_hal_reg_set(adi_ad9081_device_t *device, uint32_t reg,
 		in_data[1] = 0x22;
 		in_data[2] = (reg >> 16) & 0xFF;
 		if (API_CMS_ERROR_OK !=
-		    device->hal_info.spi_xfer(device->hal_info.user_data,
-					      in_data, out_data, 0x3))
+		    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
 			return API_CMS_ERROR_SPI_XFER;
 		if (API_CMS_ERROR_OK != AD9081_LOG_SPIW(0x3d22, in_data[2]))
 			return API_CMS_ERROR_LOG_WRITE;
@@ -373,8 +595,7 @@ int32_t adi_ad9081_hal_reg_set(adi_ad9081_device_t *device, uint32_t reg,
 		in_data[1] = 0x23;
 		in_data[2] = (reg >> 24) & 0xFF;
 		if (API_CMS_ERROR_OK !=
-		    device->hal_info.spi_xfer(device->hal_info.user_data,
-					      in_data, out_data, 0x3))
+		    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
 			return API_CMS_ERROR_SPI_XFER;
 		if (API_CMS_ERROR_OK != AD9081_LOG_SPIW(0x3d23, in_data[2]))
 			return API_CMS_ERROR_LOG_WRITE;
@@ -385,8 +606,7 @@ int32_t adi_ad9081_hal_reg_set(adi_ad9081_device_t *device, uint32_t reg,
 			in_data[1] = ((reg >> 0) & 0xFF);
 			in_data[2] = (uint8_t)(data & 0xFF);
 			if (API_CMS_ERROR_OK !=
-			    device->hal_info.spi_xfer(device->hal_info.user_data,
-						      in_data, out_data, 0x3))
+			    adi_ad9081_hal_spi_xfer(device, in_data, out_data, 0x3))
 				return API_CMS_ERROR_SPI_XFER;
 			if (API_CMS_ERROR_OK !=
 			    AD9081_LOG_SPIW((in_data[0] << 8) + in_data[1],
@@ -410,9 +630,8 @@ int32_t adi_ad9081_hal_reg_set(adi_ad9081_device_t *device, uint32_t reg,
 				in_data[5] = (uint8_t)((data >> 0) & 0xFF);
 			}
 			if (API_CMS_ERROR_OK !=
-			    device->hal_info.spi_xfer(
-				    device->hal_info.user_data, in_data,
-				    out_data, 0x20000006))
+			    adi_ad9081_hal_spi_xfer(device, in_data, out_data,
+						    0x20000006))
 				return API_CMS_ERROR_SPI_XFER;
 			if (API_CMS_ERROR_OK !=
 			    AD9081_LOG_SPIW32((in_data[0] << 8) + in_data[1],
@@ -562,7 +781,11 @@ int32_t adi_ad9081_hal_bf_wait_to_clear(adi_ad9081_device_t *device,
 	for (i = 0; i < 200; i++) {
 		err = adi_ad9081_hal_delay_us(device, 20);
 		AD9081_ERROR_RETURN(err);
+		if (device->hal_info.reg_cache != NULL)
+			device->hal_info.reg_cache->bypass = 1;
 		err = adi_ad9081_hal_bf_get(device, reg, info, &bf_value, 1);
+		if (device->hal_info.reg_cache != NULL)
+			device->hal_info.reg_cache->bypass = 0;
 		AD9081_ERROR_RETURN(err);
 		if (bf_value == 0) {
 			break;
@@ -584,7 +807,11 @@ int32_t adi_ad9081_hal_bf_wait_to_set(adi_ad9081_device_t *device, uint32_t reg,
 	for (i = 0; i < 200; i++) {
 		err = adi_ad9081_hal_delay_us(device, 20);
 		AD9081_ERROR_RETURN(err);
+		if (device->hal_info.reg_cache != NULL)
+			device->hal_info.reg_cache->bypass = 1;
 		err = adi_ad9081_hal_bf_get(device, reg, info, &bf_value, 1);
+		if (device->hal_info.reg_cache != NULL)
+			device->hal_info.reg_cache->bypass = 0;
 		AD9081_ERROR_RETURN(err);
 		if (bf_value == 1) {
 			break;
@@ -1085,7 +1312,7 @@ int32_t adi_ad9081_hal_multi_bf_set(adi_ad9081_device_t *device, uint32_t reg,
 	int32_t err;
 	uint32_t mask = 0;
 	uint8_t data8 = 0, offset = 0, width = 0;
-	uint8_t i = 0, reg_bytes = 0, reg_read_reqd = 1;
+	uint8_t i = 0, reg_bytes = 0, reg_read_reqd = 1, reg_write_reqd = 0;
 	AD9081_NULL_POINTER_RETURN(device);
 	AD9081_NULL_POINTER_RETURN(info);
 	AD9081_NULL_POINTER_RETURN(value);
@@ -1114,6 +1341,7 @@ int32_t adi_ad9081_hal_multi_bf_set(adi_ad9081_device_t *device, uint32_t reg,
 			mask = (1 << width) - 1;
 			data8 = data8 & (~(mask << offset));
 			data8 = data8 | ((*(value + i) & mask) << offset);
+			reg_write_reqd = 1;
 		} else {
 			/* Use non-multi bf set */
 			AD9081_LOG_WARN(
@@ -1124,8 +1352,8 @@ int32_t adi_ad9081_hal_multi_bf_set(adi_ad9081_device_t *device, uint32_t reg,
 		}
 	}
 
-	if (reg_read_reqd == 0) {
-		err = adi_ad9081_hal_reg_set(device, reg, data8);
+	if (reg_write_reqd == 1) {
+		err = adi_ad9081_hal_reg_set_bf(device, reg, data8);
 		AD9081_ERROR_RETURN(err);
 	}
 
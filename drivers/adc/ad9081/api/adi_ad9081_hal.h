@@ -150,6 +150,13 @@ int32_t adi_ad9081_hal_bf_wait_to_clear(adi_ad9081_device_t *device,
 int32_t adi_ad9081_hal_bf_wait_to_set(adi_ad9081_device_t *device, uint32_t reg,
 				      uint32_t info);
 
+int32_t adi_ad9081_hal_reg_cache_enable(adi_ad9081_device_t *device,
+					adi_ad9081_reg_cache_t *cache,
+					uint8_t write_back);
+int32_t adi_ad9081_hal_reg_cache_flush(adi_ad9081_device_t *device);
+int32_t adi_ad9081_hal_spi_burst_write(adi_ad9081_device_t *device,
+				       uint8_t *in_data, uint32_t size_bytes);
+
 int32_t adi_ad9081_hal_error_report(adi_ad9081_device_t *device,
 				    adi_cms_log_type_e log_type, int32_t error,
 				    const char *file_name,
@@ -49,6 +49,16 @@
 #include "axi_adc_core.h"
 #include "axi_io.h"
 
+#define BINLOG_MODULE axi_adc
+#include "print_log.h"
+
+/******************************************************************************/
+/************************ Variable Definitions ********************************/
+/******************************************************************************/
+#ifdef ENABLE_BINLOG
+BINLOG_MODULE_DEFINE(axi_adc, LOG_LEVEL);
+#endif
+
 /***************************************************************************//**
  * @brief axi_adc_read
  *******************************************************************************/
@@ -164,16 +174,19 @@ int32_t axi_adc_delay_set(struct axi_adc *adc,
 	axi_adc_read(adc, 0x0, &pcore_version);
 	pcore_version >>= 16;
 	if (pcore_version < 9) {
-		printf(" pcore_version is : %d\n\r", pcore_version);
-		printf(" DRIVER DOES NOT SUPPORT PCORE VERSIONS OLDER THAN 10 !");
+		pr_print(LOG_ERR, " pcore_version is : %"PRIu32"\n\r",
+			 pcore_version);
+		pr_print(LOG_ERR,
+			 " DRIVER DOES NOT SUPPORT PCORE VERSIONS OLDER THAN 10 !");
 		return FAILURE;
 	} else {
 		for (i = 0; i < no_of_lanes; i++) {
 			axi_adc_idelay_set(adc, i, delay);
 			axi_adc_read(adc, AXI_ADC_REG_DELAY(i), &rdata);
 			if (rdata != delay) {
-				printf("adc_delay_1: sel(%2d), rcv(%04x), exp(%04x)\n\r",
-				       i, rdata, delay);
+				pr_print(LOG_WARNING,
+					 "adc_delay_1: sel(%2"PRIu32"), rcv(%04"PRIx32"), exp(%04"PRIx32")\n\r",
+					 i, rdata, delay);
 			}
 		}
 	}
@@ -214,7 +227,7 @@ int32_t axi_adc_delay_calibrate(struct axi_adc *adc,
 		}
 	}
 	if (start_valid_delay > 31) {
-		printf("%s FAILED.\n", __func__);
+		pr_print(LOG_ERR, "%s FAILED.\n", __func__);
 		axi_adc_delay_set(adc, no_of_lanes, 0);
 		return FAILURE;
 	}
@@ -256,7 +269,8 @@ int32_t axi_adc_delay_calibrate(struct axi_adc *adc,
 
 	delay = (valid_range[max_interval] + invalid_range[max_interval] - 1) / 2;
 
-	printf("adc_delay: setting zero error delay (%d)\n\r", delay);
+	pr_print(LOG_INFO, "adc_delay: setting zero error delay (%d)\n\r",
+		 delay);
 	axi_adc_delay_set(adc, no_of_lanes, delay);
 
 	return SUCCESS;
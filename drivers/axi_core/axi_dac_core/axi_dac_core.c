@@ -52,6 +52,9 @@
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
+/* Number of words formatted on the stack before a block write to the buffer */
+#define AXI_DAC_BUFF_CHUNK				128
+
 #define AXI_DAC_REG_RSTN				0x40
 #define AXI_DAC_MMCM_RSTN				BIT(1)
 #define AXI_DAC_RSTN					BIT(0)
@@ -683,64 +686,79 @@ int32_t axi_dac_dds_get_calib_phase(struct axi_dac *dac,
 	return axi_dac_dds_get_calib_phase_scale(dac, 1, chan, val, val2);
 }
 
+/***************************************************************************//**
+ * @brief Append a word to the chunk being formatted, replicated for each
+ *        channel, and write the chunk to the buffer when full.
+*******************************************************************************/
+static int32_t axi_dac_buff_push(uint32_t address, uint32_t *offset,
+				 uint32_t *chunk, uint32_t *used,
+				 uint32_t data, uint32_t copies)
+{
+	int32_t ret;
+
+	while (copies--) {
+		chunk[(*used)++] = data;
+		if (*used < AXI_DAC_BUFF_CHUNK)
+			continue;
+
+		ret = axi_io_write_block(address, *offset, chunk, *used);
+		if (ret != SUCCESS)
+			return ret;
+		*offset += *used * sizeof(*chunk);
+		*used = 0;
+	}
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Write the last, partial, chunk to the buffer.
+*******************************************************************************/
+static int32_t axi_dac_buff_flush(uint32_t address, uint32_t offset,
+				  const uint32_t *chunk, uint32_t used)
+{
+	if (!used)
+		return SUCCESS;
+
+	return axi_io_write_block(address, offset, chunk, used);
+}
+
 /***************************************************************************//**
  * @brief axi_dac_set_sine_lut
+ * @return The length of the waveform in bytes, or a negative error code if
+ *         the buffer could not be written.
 *******************************************************************************/
-uint32_t axi_dac_set_sine_lut(struct axi_dac *dac,
-			      uint32_t address)
+int32_t axi_dac_set_sine_lut(struct axi_dac *dac,
+			     uint32_t address)
 {
-	uint32_t length;
+	uint32_t chunk[AXI_DAC_BUFF_CHUNK];
+	uint32_t offset = 0, used = 0;
 	uint32_t tx_count;
-	uint32_t index_mem;
 	uint32_t index;
-	uint32_t index_i1;
-	uint32_t index_q1;
-	uint32_t index_i2;
-	uint32_t index_q2;
-	uint32_t data_i1;
-	uint32_t data_q1;
-	uint32_t data_i2;
-	uint32_t data_q2;
+	uint32_t index_q;
+	uint32_t data;
+	int32_t ret;
 	tx_count = sizeof(sine_lut) / sizeof(uint16_t);
-	if(dac->num_channels == 4) {
-		for(index = 0, index_mem = 0; index < (tx_count * 2);
-		    index += 2, index_mem += 2) {
-			index_i1 = index;
-			index_q1 = index + (tx_count / 2);
-			if(index_q1 >= (tx_count * 2))
-				index_q1 -= (tx_count * 2);
-			data_i1 = (sine_lut[index_i1 / 2] << 20);
-			data_q1 = (sine_lut[index_q1 / 2] << 4);
-
-			axi_io_write(address, index_mem * 4, data_i1 | data_q1);
-
-			index_i2 = index_i1;
-			index_q2 = index_q1;
-			if(index_i2 >= (tx_count * 2))
-				index_i2 -= (tx_count * 2);
-			if(index_q2 >= (tx_count * 2))
-				index_q2 -= (tx_count * 2);
-			data_i2 = (sine_lut[index_i2 / 2] << 20);
-			data_q2 = (sine_lut[index_q2 / 2] << 4);
-
-			axi_io_write(address, (index_mem + 1) * 4, data_i2 | data_q2);
-
-		}
-	} else {
-		for(index = 0; index < tx_count; index += 1) {
-			index_i1 = index;
-			index_q1 = index + (tx_count / 4);
-			if(index_q1 >= tx_count)
-				index_q1 -= tx_count;
-			data_i1 = (sine_lut[index_i1] << 20);
-			data_q1 = (sine_lut[index_q1] << 4);
-
-			axi_io_write(address, index * 4, data_i1 | data_q1);
-		}
+	for(index = 0; index < tx_count; index++) {
+		/* Q lags I by a quarter of a period */
+		index_q = index + (tx_count / 4);
+		if(index_q >= tx_count)
+			index_q -= tx_count;
+		data = ((uint32_t)sine_lut[index] << 20) |
+		       ((uint32_t)sine_lut[index_q] << 4);
+
+		/* Both I/Q pairs get the same samples on 4 channel cores */
+		ret = axi_dac_buff_push(address, &offset, chunk, &used, data,
+					dac->num_channels == 4 ? 2 : 1);
+		if (ret != SUCCESS)
+			return ret;
 	}
 
-	length = tx_count * dac->num_channels * 2;
-	return length;
+	ret = axi_dac_buff_flush(address, offset, chunk, used);
+	if (ret != SUCCESS)
+		return ret;
+
+	return tx_count * dac->num_channels * 2;
 }
 
 /***************************************************************************//**
@@ -751,18 +769,24 @@ int32_t axi_dac_set_buff(struct axi_dac *dac,
 			 uint16_t *buff,
 			 uint32_t buff_size)
 {
+	uint32_t chunk[AXI_DAC_BUFF_CHUNK];
+	uint32_t offset = 0, used = 0;
 	uint32_t index;
 	uint32_t data_i;
 	uint32_t data_q;
+	int32_t ret;
 
 	for(index = 0; index < buff_size; index += 2) {
 		data_i = (buff[index]);
-		data_q = (buff[index + 1] << 16);
+		data_q = ((uint32_t)buff[index + 1] << 16);
 
-		axi_io_write(address, index * 2, data_i | data_q);
+		ret = axi_dac_buff_push(address, &offset, chunk, &used,
+					data_i | data_q, 1);
+		if (ret != SUCCESS)
+			return ret;
 	}
 
-	return SUCCESS;
+	return axi_dac_buff_flush(address, offset, chunk, used);
 }
 
 /***************************************************************************//**
@@ -773,21 +797,25 @@ int32_t axi_dac_load_custom_data(struct axi_dac *dac,
 				 uint32_t custom_tx_count,
 				 uint32_t address)
 {
-	uint32_t index, index_mem = 0;
+	uint32_t chunk[AXI_DAC_BUFF_CHUNK];
+	uint32_t offset = 0, used = 0;
+	uint32_t index;
 	uint8_t chan;
 	uint8_t num_tx_channels = dac->num_channels / 2;
+	int32_t ret;
 
 	for(index = 0; index < custom_tx_count; index++) {
 		/* Send the same data on all the channels */
-		for (chan = 0; chan < num_tx_channels; chan++) {
-
-			axi_io_write(address, index_mem * sizeof(uint32_t),
-				     custom_data_iq[index]);
-
-			index_mem++;
-		}
+		ret = axi_dac_buff_push(address, &offset, chunk, &used,
+					custom_data_iq[index], num_tx_channels);
+		if (ret != SUCCESS)
+			return ret;
 	}
 
+	ret = axi_dac_buff_flush(address, offset, chunk, used);
+	if (ret != SUCCESS)
+		return ret;
+
 	for (chan = 0; chan < dac->num_channels; chan++) {
 		axi_dac_write(dac, AXI_DAC_REG_DATA_SELECT((chan*2)+0), 0x2);
 		axi_dac_write(dac, AXI_DAC_REG_DATA_SELECT((chan*2)+1), 0x2);
@@ -0,0 +1,764 @@
+/***************************************************************************//**
+ *   @file   axi_dac_waveform.c
+ *   @brief  Waveform generator and cache for the AXI-DAC-CORE DMA path.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "error.h"
+#include "util.h"
+#include "axi_io.h"
+#include "axi_dac_waveform.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/* Number of words formatted on the stack before a block write to DDR */
+#define AXI_DAC_WFM_CHUNK		128
+
+#define AXI_DAC_WFM_FNV_OFFSET		2166136261u
+#define AXI_DAC_WFM_FNV_PRIME		16777619u
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/* Chirp phase, advanced one sample at a time so that no product of the
+ * sample index overflows. phase(n) = lin(n) + quad(n) / (2 * len) */
+struct axi_dac_wfm_chirp {
+	/* c0 * n modulo len and its step */
+	uint32_t lin;
+	uint32_t lin_step;
+	/* (c1 - c0) * n^2 modulo 2 * len^2, its increment (c1 - c0) * (2n + 1)
+	 * and the step of the increment 2 * (c1 - c0), all modulo mod */
+	uint64_t quad;
+	uint64_t quad_inc;
+	uint64_t quad_step;
+	uint64_t mod;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/***************************************************************************//**
+ * @brief Build the quarter wave sine table for a buffer of len samples.
+ *        The table holds len / 4 + 1 entries so that both ends of the
+ *        quarter are exact.
+*******************************************************************************/
+static int32_t axi_dac_wfm_build_table(struct axi_dac_wfm *wfm, uint32_t len)
+{
+	uint32_t quarter = len / 4;
+	int16_t *table;
+	uint32_t i;
+
+	if (wfm->sin_table && wfm->table_len == len)
+		return SUCCESS;
+
+	table = (int16_t *)calloc(quarter + 1, sizeof(*table));
+	if (!table)
+		return -ENOMEM;
+
+	for (i = 0; i <= quarter; i++)
+		table[i] = (int16_t)lround(32767.0 *
+					   sin(2.0 * M_PI * i / len));
+
+	free(wfm->sin_table);
+	wfm->sin_table = table;
+	wfm->table_len = len;
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Look up sin(2 * pi * idx / len) in Q15 from the quarter wave table.
+*******************************************************************************/
+static inline int32_t axi_dac_wfm_sin(const struct axi_dac_wfm *wfm,
+				      uint32_t idx)
+{
+	uint32_t quarter = wfm->table_len / 4;
+	uint32_t r = idx % quarter;
+
+	switch (idx / quarter) {
+	case 0:
+		return wfm->sin_table[r];
+	case 1:
+		return wfm->sin_table[quarter - r];
+	case 2:
+		return -wfm->sin_table[r];
+	default:
+		return -wfm->sin_table[quarter - r];
+	}
+}
+
+/***************************************************************************//**
+ * @brief Look up cos(2 * pi * idx / len) in Q15 from the quarter wave table.
+*******************************************************************************/
+static inline int32_t axi_dac_wfm_cos(const struct axi_dac_wfm *wfm,
+				      uint32_t idx)
+{
+	idx += wfm->table_len / 4;
+	if (idx >= wfm->table_len)
+		idx -= wfm->table_len;
+
+	return axi_dac_wfm_sin(wfm, idx);
+}
+
+/***************************************************************************//**
+ * @brief Reduce a signed number of cycles to a table step in [0, len).
+*******************************************************************************/
+static uint64_t axi_dac_wfm_step(int64_t cycles, uint64_t len)
+{
+	int64_t step = cycles % (int64_t)len;
+
+	return (uint64_t)(step < 0 ? step + (int64_t)len : step);
+}
+
+/***************************************************************************//**
+ * @brief Convert an amplitude in micro units to Q15.
+*******************************************************************************/
+static int32_t axi_dac_wfm_q15(int32_t scale)
+{
+	return (int32_t)(((int64_t)scale * 32767) / AXI_DAC_WFM_FULL_SCALE);
+}
+
+/***************************************************************************//**
+ * @brief Saturate a Q15 accumulator to a DAC sample.
+*******************************************************************************/
+static int16_t axi_dac_wfm_sat(int64_t val)
+{
+	if (val > INT16_MAX)
+		return INT16_MAX;
+	if (val < INT16_MIN)
+		return INT16_MIN;
+
+	return (int16_t)val;
+}
+
+/***************************************************************************//**
+ * @brief Hash the content of a waveform description (FNV-1a).
+*******************************************************************************/
+static uint32_t axi_dac_wfm_hash_word(uint32_t hash, uint32_t word)
+{
+	uint8_t i;
+
+	for (i = 0; i < 4; i++) {
+		hash ^= (word >> (8 * i)) & 0xFF;
+		hash *= AXI_DAC_WFM_FNV_PRIME;
+	}
+
+	return hash;
+}
+
+static uint32_t axi_dac_wfm_hash(const struct axi_dac_wfm_param *param)
+{
+	uint32_t hash = AXI_DAC_WFM_FNV_OFFSET;
+	uint32_t i;
+
+	hash = axi_dac_wfm_hash_word(hash, param->type);
+	hash = axi_dac_wfm_hash_word(hash, param->samples);
+
+	switch (param->type) {
+	case AXI_DAC_WFM_TONES:
+		hash = axi_dac_wfm_hash_word(hash, param->num_tones);
+		for (i = 0; i < param->num_tones; i++) {
+			hash = axi_dac_wfm_hash_word(hash,
+						     param->tones[i].cycles);
+			hash = axi_dac_wfm_hash_word(hash,
+						     param->tones[i].scale);
+			hash = axi_dac_wfm_hash_word(hash,
+						     param->tones[i].phase);
+		}
+		break;
+	case AXI_DAC_WFM_CHIRP:
+		hash = axi_dac_wfm_hash_word(hash, param->scale);
+		hash = axi_dac_wfm_hash_word(hash, param->chirp_start);
+		hash = axi_dac_wfm_hash_word(hash, param->chirp_stop);
+		break;
+	case AXI_DAC_WFM_PN:
+		hash = axi_dac_wfm_hash_word(hash, param->scale);
+		hash = axi_dac_wfm_hash_word(hash, param->pn_order);
+		hash = axi_dac_wfm_hash_word(hash, param->pn_seed);
+		break;
+	}
+
+	/* 0 marks a free cache entry */
+	return hash ? hash : 1;
+}
+
+/***************************************************************************//**
+ * @brief Compare a waveform description with the one stored in a cache entry.
+ *        Only the fields used by the waveform type are compared, as in
+ *        axi_dac_wfm_hash().
+*******************************************************************************/
+static bool axi_dac_wfm_match(const struct axi_dac_wfm_entry *entry,
+			      const struct axi_dac_wfm_param *param)
+{
+	const struct axi_dac_wfm_param *key = &entry->param;
+	uint32_t i;
+
+	if (key->type != param->type || key->samples != param->samples)
+		return false;
+
+	switch (param->type) {
+	case AXI_DAC_WFM_TONES:
+		if (key->num_tones != param->num_tones)
+			return false;
+		for (i = 0; i < param->num_tones; i++)
+			if (entry->tones[i].cycles != param->tones[i].cycles ||
+			    entry->tones[i].scale != param->tones[i].scale ||
+			    entry->tones[i].phase != param->tones[i].phase)
+				return false;
+		return true;
+	case AXI_DAC_WFM_CHIRP:
+		return key->scale == param->scale &&
+		       key->chirp_start == param->chirp_start &&
+		       key->chirp_stop == param->chirp_stop;
+	case AXI_DAC_WFM_PN:
+		return key->scale == param->scale &&
+		       key->pn_order == param->pn_order &&
+		       key->pn_seed == param->pn_seed;
+	default:
+		return false;
+	}
+}
+
+/***************************************************************************//**
+ * @brief Check a waveform description.
+*******************************************************************************/
+static int32_t axi_dac_wfm_check(const struct axi_dac_wfm_param *param)
+{
+	if (!param->samples || (param->samples % 4) ||
+	    param->samples > AXI_DAC_WFM_MAX_SAMPLES)
+		return -EINVAL;
+
+	switch (param->type) {
+	case AXI_DAC_WFM_TONES:
+		if (!param->tones || !param->num_tones ||
+		    param->num_tones > AXI_DAC_WFM_MAX_TONES)
+			return -EINVAL;
+		break;
+	case AXI_DAC_WFM_CHIRP:
+		/* The sweep wraps cleanly only if it covers an integer
+		 * number of cycles */
+		if (((int64_t)param->chirp_start + param->chirp_stop) % 2)
+			return -EINVAL;
+		break;
+	case AXI_DAC_WFM_PN:
+		if (param->pn_order != 7 && param->pn_order != 15 &&
+		    param->pn_order != 23 && param->pn_order != 31)
+			return -EINVAL;
+		break;
+	default:
+		return -EINVAL;
+	}
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Advance a Fibonacci LFSR using the PN polynomials of the DAC core:
+ *        x^7 + x^6 + 1, x^15 + x^14 + 1, x^23 + x^18 + 1, x^31 + x^28 + 1.
+*******************************************************************************/
+static uint8_t axi_dac_wfm_pn_bit(uint32_t *state, uint8_t order)
+{
+	uint8_t tap;
+	uint8_t bit;
+
+	switch (order) {
+	case 7:
+		tap = 6;
+		break;
+	case 15:
+		tap = 14;
+		break;
+	case 23:
+		tap = 18;
+		break;
+	default:
+		tap = 28;
+		break;
+	}
+
+	bit = ((*state >> (order - 1)) ^ (*state >> (tap - 1))) & 1;
+	*state = ((*state << 1) | bit) & (uint32_t)((1ull << order) - 1);
+
+	return bit;
+}
+
+/***************************************************************************//**
+ * @brief Start a chirp at sample 0.
+*******************************************************************************/
+static void axi_dac_wfm_chirp_init(struct axi_dac_wfm_chirp *chirp,
+				   const struct axi_dac_wfm_param *param)
+{
+	int64_t delta = (int64_t)param->chirp_stop - param->chirp_start;
+	uint64_t len = param->samples;
+
+	chirp->lin = 0;
+	chirp->lin_step = axi_dac_wfm_step(param->chirp_start, len);
+	chirp->mod = 2 * len * len;
+	chirp->quad = 0;
+	chirp->quad_inc = axi_dac_wfm_step(delta, chirp->mod);
+	chirp->quad_step = axi_dac_wfm_step(2 * delta, chirp->mod);
+}
+
+/***************************************************************************//**
+ * @brief Get the table index of the current chirp sample and advance the
+ *        chirp to the next one.
+*******************************************************************************/
+static uint32_t axi_dac_wfm_chirp_next(struct axi_dac_wfm_chirp *chirp,
+				       uint32_t len)
+{
+	uint32_t idx = chirp->lin + (uint32_t)(chirp->quad / (2 * (uint64_t)len));
+
+	if (idx >= len)
+		idx -= len;
+
+	chirp->lin += chirp->lin_step;
+	if (chirp->lin >= len)
+		chirp->lin -= len;
+	chirp->quad += chirp->quad_inc;
+	if (chirp->quad >= chirp->mod)
+		chirp->quad -= chirp->mod;
+	chirp->quad_inc += chirp->quad_step;
+	if (chirp->quad_inc >= chirp->mod)
+		chirp->quad_inc -= chirp->mod;
+
+	return idx;
+}
+
+/***************************************************************************//**
+ * @brief Compute one I/Q sample of the waveform. Returns (Q << 16) | I.
+ *        state carries the per-tone phase indexes or the LFSR between calls,
+ *        chirp the phase of a chirp.
+*******************************************************************************/
+static uint32_t axi_dac_wfm_sample(const struct axi_dac_wfm *wfm,
+				   const struct axi_dac_wfm_param *param,
+				   struct axi_dac_wfm_chirp *chirp,
+				   uint32_t *state, const uint32_t *step,
+				   const int32_t *amp)
+{
+	uint32_t len = param->samples;
+	int64_t acc_i = 0;
+	int64_t acc_q = 0;
+	uint32_t idx;
+	uint32_t i;
+
+	switch (param->type) {
+	case AXI_DAC_WFM_TONES:
+		for (i = 0; i < param->num_tones; i++) {
+			acc_i += (int64_t)amp[i] * axi_dac_wfm_cos(wfm, state[i]);
+			acc_q += (int64_t)amp[i] * axi_dac_wfm_sin(wfm, state[i]);
+			state[i] += step[i];
+			if (state[i] >= len)
+				state[i] -= len;
+		}
+		break;
+	case AXI_DAC_WFM_CHIRP:
+		/* phase(n) = c0 * n + (c1 - c0) * n^2 / (2 * len) table steps */
+		idx = axi_dac_wfm_chirp_next(chirp, len);
+		acc_i = (int64_t)amp[0] * axi_dac_wfm_cos(wfm, idx);
+		acc_q = (int64_t)amp[0] * axi_dac_wfm_sin(wfm, idx);
+		break;
+	case AXI_DAC_WFM_PN:
+		acc_i = axi_dac_wfm_pn_bit(state, param->pn_order) ?
+			(int64_t)amp[0] << 15 : -((int64_t)amp[0] << 15);
+		acc_q = axi_dac_wfm_pn_bit(state, param->pn_order) ?
+			(int64_t)amp[0] << 15 : -((int64_t)amp[0] << 15);
+		break;
+	}
+
+	return ((uint32_t)(uint16_t)axi_dac_wfm_sat(acc_q >> 15) << 16) |
+	       (uint16_t)axi_dac_wfm_sat(acc_i >> 15);
+}
+
+/***************************************************************************//**
+ * @brief Synthesize a waveform at the given DDR address. Each I/Q sample is
+ *        replicated for every I/Q pair of the DAC core.
+*******************************************************************************/
+static int32_t axi_dac_wfm_generate(struct axi_dac_wfm *wfm,
+				    const struct axi_dac_wfm_param *param,
+				    uint32_t address)
+{
+	uint32_t chunk[AXI_DAC_WFM_CHUNK];
+	struct axi_dac_wfm_chirp chirp;
+	uint32_t state[AXI_DAC_WFM_MAX_TONES] = {0};
+	uint32_t step[AXI_DAC_WFM_MAX_TONES] = {0};
+	int32_t amp[AXI_DAC_WFM_MAX_TONES] = {0};
+	uint32_t pairs = max(wfm->dac->num_channels / 2, 1);
+	uint32_t len = param->samples;
+	uint32_t offset = 0;
+	uint32_t used = 0;
+	uint32_t data;
+	uint32_t n;
+	uint32_t i;
+	int32_t ret;
+
+	if (param->type != AXI_DAC_WFM_PN) {
+		ret = axi_dac_wfm_build_table(wfm, len);
+		if (ret != SUCCESS)
+			return ret;
+	}
+
+	switch (param->type) {
+	case AXI_DAC_WFM_TONES:
+		for (i = 0; i < param->num_tones; i++) {
+			step[i] = axi_dac_wfm_step(param->tones[i].cycles, len);
+			state[i] = (uint32_t)(((uint64_t)param->tones[i].phase *
+					       len) / 360000) % len;
+			amp[i] = axi_dac_wfm_q15(param->tones[i].scale);
+		}
+		break;
+	case AXI_DAC_WFM_CHIRP:
+		axi_dac_wfm_chirp_init(&chirp, param);
+		amp[0] = axi_dac_wfm_q15(param->scale);
+		break;
+	case AXI_DAC_WFM_PN:
+		state[0] = param->pn_seed & (uint32_t)((1ull << param->pn_order) - 1);
+		/* An all zero LFSR never leaves that state */
+		if (!state[0])
+			state[0] = 1;
+	/* fallthrough */
+	default:
+		amp[0] = axi_dac_wfm_q15(param->scale);
+		break;
+	}
+
+	for (n = 0; n < len; n++) {
+		data = axi_dac_wfm_sample(wfm, param, &chirp, state, step, amp);
+		for (i = 0; i < pairs; i++) {
+			chunk[used++] = data;
+			if (used == AXI_DAC_WFM_CHUNK) {
+				ret = axi_io_write_block(address, offset,
+							 chunk, used);
+				if (ret != SUCCESS)
+					return ret;
+				offset += used * sizeof(uint32_t);
+				used = 0;
+			}
+		}
+	}
+
+	if (used)
+		return axi_io_write_block(address, offset, chunk, used);
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Drop all cached waveforms but the one being played, which the DMA
+ *        still reads. The DDR area is reused from its start.
+*******************************************************************************/
+void axi_dac_wfm_cache_clear(struct axi_dac_wfm *wfm)
+{
+	uint32_t i;
+
+	for (i = 0; i < AXI_DAC_WFM_CACHE_ENTRIES; i++)
+		if (&wfm->cache[i] != wfm->active)
+			wfm->cache[i].hash = 0;
+	wfm->ddr_used = 0;
+}
+
+/***************************************************************************//**
+ * @brief Check if a byte range of the DDR area overlaps a cached waveform.
+*******************************************************************************/
+static bool axi_dac_wfm_overlap(const struct axi_dac_wfm *wfm,
+				const struct axi_dac_wfm_entry *entry,
+				uint32_t offset, uint32_t bytes)
+{
+	uint32_t start = entry->address - wfm->ddr_base;
+
+	return entry->hash && offset < start + entry->size &&
+	       start < (uint64_t)offset + bytes;
+}
+
+/***************************************************************************//**
+ * @brief Find room for a waveform in the DDR area.
+ *
+ * The area is used as a ring: waveforms are placed one after the other and
+ * the placement wraps to the start of the area when the end is reached. The
+ * active waveform is skipped, the other waveforms in the way are evicted.
+ *
+ * @param wfm    - The waveform generator descriptor.
+ * @param bytes  - The waveform size in bytes.
+ * @param offset - Set to the offset of the waveform in the DDR area.
+ * @return SUCCESS in case of success, -ENOMEM if the active waveform leaves
+ *         no room for the new one.
+*******************************************************************************/
+static int32_t axi_dac_wfm_alloc(struct axi_dac_wfm *wfm, uint32_t bytes,
+				 uint32_t *offset)
+{
+	uint32_t start[2] = {wfm->ddr_used, 0};
+	uint32_t i;
+
+	for (i = 0; i < 2; i++) {
+		*offset = start[i];
+		if (wfm->active &&
+		    axi_dac_wfm_overlap(wfm, wfm->active, *offset, bytes))
+			*offset = wfm->active->address - wfm->ddr_base +
+				  wfm->active->size;
+		if (*offset <= wfm->ddr_size && bytes <= wfm->ddr_size - *offset)
+			break;
+	}
+	if (i == 2)
+		return -ENOMEM;
+
+	for (i = 0; i < AXI_DAC_WFM_CACHE_ENTRIES; i++)
+		if (axi_dac_wfm_overlap(wfm, &wfm->cache[i], *offset, bytes))
+			wfm->cache[i].hash = 0;
+	wfm->ddr_used = *offset + bytes;
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Find the cache entry of a waveform, generating it on a miss.
+ *
+ * On a miss the waveform takes a free entry, or evicts the entries in round
+ * robin order when the table is full. The active waveform, which the cyclic
+ * DMA may be playing, is never evicted nor overwritten.
+*******************************************************************************/
+static int32_t axi_dac_wfm_lookup(struct axi_dac_wfm *wfm,
+				  const struct axi_dac_wfm_param *param,
+				  struct axi_dac_wfm_entry **found)
+{
+	struct axi_dac_wfm_entry *entry = NULL;
+	uint64_t bytes;
+	uint32_t offset;
+	uint32_t hash;
+	uint32_t i;
+	int32_t ret;
+
+	ret = axi_dac_wfm_check(param);
+	if (ret != SUCCESS)
+		return ret;
+
+	hash = axi_dac_wfm_hash(param);
+	for (i = 0; i < AXI_DAC_WFM_CACHE_ENTRIES; i++) {
+		if (wfm->cache[i].hash == hash &&
+		    axi_dac_wfm_match(&wfm->cache[i], param)) {
+			wfm->hits++;
+			*found = &wfm->cache[i];
+			return SUCCESS;
+		}
+		if (!entry && !wfm->cache[i].hash)
+			entry = &wfm->cache[i];
+	}
+
+	bytes = (uint64_t)param->samples * max(wfm->dac->num_channels / 2, 1) *
+		sizeof(uint32_t);
+	if (bytes > wfm->ddr_size)
+		return -ENOMEM;
+
+	ret = axi_dac_wfm_alloc(wfm, bytes, &offset);
+	if (ret != SUCCESS)
+		return ret;
+
+	/* The allocation may have freed an entry */
+	for (i = 0; !entry && i < AXI_DAC_WFM_CACHE_ENTRIES; i++)
+		if (!wfm->cache[i].hash)
+			entry = &wfm->cache[i];
+
+	for (i = 0; !entry && i < AXI_DAC_WFM_CACHE_ENTRIES; i++) {
+		if (&wfm->cache[wfm->victim] != wfm->active)
+			entry = &wfm->cache[wfm->victim];
+		wfm->victim = (wfm->victim + 1) % AXI_DAC_WFM_CACHE_ENTRIES;
+	}
+	if (!entry)
+		return -ENOMEM;
+
+	/* The entry is free until the waveform is complete */
+	entry->hash = 0;
+	ret = axi_dac_wfm_generate(wfm, param, wfm->ddr_base + offset);
+	if (ret != SUCCESS)
+		return ret;
+
+	if (wfm->dcache_flush_range)
+		wfm->dcache_flush_range(wfm->ddr_base + offset, bytes);
+
+	entry->hash = hash;
+	entry->param = *param;
+	entry->param.tones = NULL;
+	if (param->type == AXI_DAC_WFM_TONES)
+		memcpy(entry->tones, param->tones,
+		       param->num_tones * sizeof(*param->tones));
+	entry->address = wfm->ddr_base + offset;
+	entry->size = bytes;
+	wfm->misses++;
+
+	*found = entry;
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Get a waveform from the cache, generating it on a miss.
+ *
+ * Waveforms are placed one after the other in the DDR area, used as a ring.
+ * A hash match is only a hit if the description stored in the entry is the
+ * same, so colliding waveforms get their own entries. The waveform being
+ * played by axi_dac_wfm_play() is never evicted; a waveform played by the
+ * caller with its own DMA transfer is not protected.
+ *
+ * @param wfm     - The waveform generator descriptor.
+ * @param param   - The waveform description.
+ * @param address - Set to the DDR address of the waveform.
+ * @param size    - Set to the waveform size in bytes.
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+int32_t axi_dac_wfm_get(struct axi_dac_wfm *wfm,
+			const struct axi_dac_wfm_param *param,
+			uint32_t *address, uint32_t *size)
+{
+	struct axi_dac_wfm_entry *entry;
+	int32_t ret;
+
+	if (!wfm || !param || !address || !size)
+		return -EINVAL;
+
+	ret = axi_dac_wfm_lookup(wfm, param, &entry);
+	if (ret != SUCCESS)
+		return ret;
+
+	*address = entry->address;
+	*size = entry->size;
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Select DMA data on all DAC channels and play a waveform. The DMA
+ *        should be configured with the DMA_CYCLIC flag so that the buffer
+ *        repeats; starting a transfer stops the previous one.
+*******************************************************************************/
+int32_t axi_dac_wfm_play(struct axi_dac_wfm *wfm, struct axi_dmac *dmac,
+			 const struct axi_dac_wfm_param *param)
+{
+	struct axi_dac_wfm_entry *entry;
+	int32_t ret;
+
+	if (!wfm || !param || !dmac)
+		return -EINVAL;
+
+	ret = axi_dac_wfm_lookup(wfm, param, &entry);
+	if (ret != SUCCESS)
+		return ret;
+
+	ret = axi_dac_set_datasel(wfm->dac, -1, AXI_DAC_DATA_SEL_DMA);
+	if (ret != SUCCESS)
+		return ret;
+
+	ret = axi_dmac_transfer(dmac, entry->address, entry->size);
+	if (ret != SUCCESS)
+		return ret;
+
+	wfm->active = entry;
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Convert a frequency to the nearest integer number of cycles per
+ *        buffer. The tone actually played is
+ *        cycles * sample_rate_hz / samples.
+*******************************************************************************/
+int32_t axi_dac_wfm_cycles(int64_t freq_hz, uint64_t sample_rate_hz,
+			   uint32_t samples)
+{
+	int64_t num;
+
+	if (!sample_rate_hz)
+		return 0;
+
+	num = freq_hz * (int64_t)samples;
+	if (num >= 0)
+		return (int32_t)((num + (int64_t)(sample_rate_hz / 2)) /
+				 (int64_t)sample_rate_hz);
+
+	return -(int32_t)((-num + (int64_t)(sample_rate_hz / 2)) /
+			  (int64_t)sample_rate_hz);
+}
+
+/***************************************************************************//**
+ * @brief Initialize the waveform generator.
+ *
+ * @param wfm  - The waveform generator descriptor.
+ * @param init - The initialization parameters.
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+int32_t axi_dac_wfm_init(struct axi_dac_wfm **wfm,
+			 const struct axi_dac_wfm_init_param *init)
+{
+	struct axi_dac_wfm *desc;
+
+	if (!wfm || !init || !init->dac || !init->ddr_size)
+		return -EINVAL;
+
+	desc = (struct axi_dac_wfm *)calloc(1, sizeof(*desc));
+	if (!desc)
+		return -ENOMEM;
+
+	desc->dac = init->dac;
+	desc->ddr_base = init->ddr_base;
+	desc->ddr_size = init->ddr_size;
+	desc->dcache_flush_range = init->dcache_flush_range;
+
+	*wfm = desc;
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Free the resources allocated by axi_dac_wfm_init().
+ *
+ * @param wfm - The waveform generator descriptor.
+ * @return SUCCESS in case of success, negative error code otherwise.
+*******************************************************************************/
+int32_t axi_dac_wfm_remove(struct axi_dac_wfm *wfm)
+{
+	if (!wfm)
+		return -EINVAL;
+
+	free(wfm->sin_table);
+	free(wfm);
+
+	return SUCCESS;
+}
@@ -0,0 +1,188 @@
+/***************************************************************************//**
+ *   @file   axi_dac_waveform.h
+ *   @brief  Waveform generator and cache for the AXI-DAC-CORE DMA path.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef AXI_DAC_WAVEFORM_H_
+#define AXI_DAC_WAVEFORM_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+#include <stdint.h>
+#include "axi_dac_core.h"
+#include "axi_dmac.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+/** Maximum number of waveforms remembered by the cache */
+#define AXI_DAC_WFM_CACHE_ENTRIES	16
+/** Maximum number of samples per channel of a waveform */
+#define AXI_DAC_WFM_MAX_SAMPLES		(1u << 24)
+/** Maximum number of tones in a multi-tone waveform */
+#define AXI_DAC_WFM_MAX_TONES		8
+/** Full scale in micro units (1.0*1000*1000 is 1.0) */
+#define AXI_DAC_WFM_FULL_SCALE		1000000
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+/**
+ * @enum axi_dac_wfm_type
+ * @brief Waveform kinds supported by the generator.
+ */
+enum axi_dac_wfm_type {
+	/** Sum of complex tones */
+	AXI_DAC_WFM_TONES,
+	/** Linear complex chirp */
+	AXI_DAC_WFM_CHIRP,
+	/** PN sequence on I and Q */
+	AXI_DAC_WFM_PN,
+};
+
+/**
+ * @struct axi_dac_wfm_tone
+ * @brief Single complex tone. The frequency is given as an integer number of
+ * cycles per buffer so that the buffer repeats without a phase jump. Negative
+ * cycles produce a tone below the carrier.
+ */
+struct axi_dac_wfm_tone {
+	/** Cycles per buffer, see axi_dac_wfm_cycles() */
+	int32_t cycles;
+	/** Amplitude in micro units (1.0*1000*1000 is 1.0) */
+	int32_t scale;
+	/** Phase in millidegrees */
+	uint32_t phase;
+};
+
+/**
+ * @struct axi_dac_wfm_param
+ * @brief Description of one waveform. Two descriptions with the same content
+ * share the same cache entry.
+ */
+struct axi_dac_wfm_param {
+	enum axi_dac_wfm_type type;
+	/** Samples per channel, a multiple of 4 up to AXI_DAC_WFM_MAX_SAMPLES */
+	uint32_t samples;
+	/** Peak amplitude of chirp and PN waveforms in micro units */
+	int32_t scale;
+	/** AXI_DAC_WFM_TONES: tone list */
+	const struct axi_dac_wfm_tone *tones;
+	uint32_t num_tones;
+	/** AXI_DAC_WFM_CHIRP: cycles per buffer at the start and at the end of
+	 *  the sweep. Their sum must be even for the sweep to wrap cleanly. */
+	int32_t chirp_start;
+	int32_t chirp_stop;
+	/** AXI_DAC_WFM_PN: sequence order (7, 15, 23 or 31) and LFSR seed */
+	uint8_t pn_order;
+	uint32_t pn_seed;
+};
+
+/**
+ * @struct axi_dac_wfm_init_param
+ * @brief Waveform generator initialization parameters.
+ */
+struct axi_dac_wfm_init_param {
+	/** DAC core fed by the waveforms */
+	struct axi_dac *dac;
+	/** Start of the DDR area holding the generated waveforms */
+	uint32_t ddr_base;
+	/** Size in bytes of the DDR area */
+	uint32_t ddr_size;
+	/** Flush the Data cache for the given address range, may be NULL */
+	void (*dcache_flush_range)(uint32_t address, uint32_t bytes_count);
+};
+
+/**
+ * @struct axi_dac_wfm_entry
+ * @brief Cached waveform.
+ */
+struct axi_dac_wfm_entry {
+	/** Hash of the waveform parameters, 0 for a free entry */
+	uint32_t hash;
+	/** Copy of the waveform description, compared on a hash match. The
+	 *  tones pointer is not used, the tone list is kept in tones[]. */
+	struct axi_dac_wfm_param param;
+	struct axi_dac_wfm_tone tones[AXI_DAC_WFM_MAX_TONES];
+	uint32_t address;
+	uint32_t size;
+};
+
+/**
+ * @struct axi_dac_wfm
+ * @brief Waveform generator descriptor.
+ */
+struct axi_dac_wfm {
+	struct axi_dac *dac;
+	uint32_t ddr_base;
+	uint32_t ddr_size;
+	/** Offset of the next waveform in the DDR area */
+	uint32_t ddr_used;
+	/** Entry played by the cyclic DMA, never evicted, NULL if none */
+	struct axi_dac_wfm_entry *active;
+	/** Next entry evicted when the entry table is full */
+	uint32_t victim;
+	void (*dcache_flush_range)(uint32_t address, uint32_t bytes_count);
+	/** Quarter wave sine table, rebuilt when the buffer length changes */
+	int16_t *sin_table;
+	uint32_t table_len;
+	struct axi_dac_wfm_entry cache[AXI_DAC_WFM_CACHE_ENTRIES];
+	uint32_t hits;
+	uint32_t misses;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+/* Initialize the waveform generator. */
+int32_t axi_dac_wfm_init(struct axi_dac_wfm **wfm,
+			 const struct axi_dac_wfm_init_param *init);
+/* Free the resources allocated by axi_dac_wfm_init(). */
+int32_t axi_dac_wfm_remove(struct axi_dac_wfm *wfm);
+/* Get a waveform from the cache, generating it on a miss. */
+int32_t axi_dac_wfm_get(struct axi_dac_wfm *wfm,
+			const struct axi_dac_wfm_param *param,
+			uint32_t *address, uint32_t *size);
+/* Select DMA data on the DAC and play a waveform in a cyclic transfer. */
+int32_t axi_dac_wfm_play(struct axi_dac_wfm *wfm, struct axi_dmac *dmac,
+			 const struct axi_dac_wfm_param *param);
+/* Drop all cached waveforms but the one being played. */
+void axi_dac_wfm_cache_clear(struct axi_dac_wfm *wfm);
+/* Convert a frequency to the nearest integer number of cycles per buffer. */
+int32_t axi_dac_wfm_cycles(int64_t freq_hz, uint64_t sample_rate_hz,
+			   uint32_t samples);
+
+#endif
@@ -49,6 +49,79 @@
 #include "delay.h"
 #include "axi_dmac.h"
 
+/***************************************************************************//**
+ * @brief Hand the first pending descriptor to the hardware, if the queued
+ *        transfer slot is free.
+ *******************************************************************************/
+static void axi_dmac_queue_start(struct axi_dmac *dmac)
+{
+	struct axi_dmac_desc *desc = dmac->pending_head;
+	uint32_t reg_val;
+
+	if (!desc)
+		return;
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_START_TRANSFER, &reg_val);
+	if (reg_val & 1)
+		return; /* The queued transfer slot is still in use. */
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_ID, &desc->id);
+
+	switch (dmac->direction) {
+	case DMA_DEV_TO_MEM:
+		axi_dmac_write(dmac, AXI_DMAC_REG_DEST_ADDRESS, desc->address);
+		axi_dmac_write(dmac, AXI_DMAC_REG_DEST_STRIDE, desc->stride);
+		break;
+	case DMA_MEM_TO_DEV:
+		axi_dmac_write(dmac, AXI_DMAC_REG_SRC_ADDRESS, desc->address);
+		axi_dmac_write(dmac, AXI_DMAC_REG_SRC_STRIDE, desc->stride);
+		break;
+	default:
+		return; // Other directions are not supported yet
+	}
+	axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, desc->x_length - 1);
+	axi_dmac_write(dmac, AXI_DMAC_REG_Y_LENGTH,
+		       desc->y_length ? desc->y_length - 1 : 0);
+	axi_dmac_write(dmac, AXI_DMAC_REG_FLAGS, dmac->flags & ~DMA_CYCLIC);
+
+	/* Move the descriptor to the active list before it can complete. */
+	dmac->pending_head = desc->next;
+	if (!dmac->pending_head)
+		dmac->pending_tail = NULL;
+	desc->next = NULL;
+	if (dmac->active_tail)
+		dmac->active_tail->next = desc;
+	else
+		dmac->active_head = desc;
+	dmac->active_tail = desc;
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_START_TRANSFER, 0x1);
+}
+
+/***************************************************************************//**
+ * @brief Complete, in submission order, the active descriptors whose
+ *        TRANSFER_ID is flagged in TRANSFER_DONE.
+ *******************************************************************************/
+static void axi_dmac_queue_done(struct axi_dmac *dmac)
+{
+	struct axi_dmac_desc *desc;
+	uint32_t done;
+
+	if (!dmac->active_head)
+		return;
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_TRANSFER_DONE, &done);
+
+	while ((desc = dmac->active_head) && (done & (1u << desc->id))) {
+		dmac->active_head = desc->next;
+		if (!dmac->active_head)
+			dmac->active_tail = NULL;
+		desc->next = NULL;
+		if (desc->callback)
+			desc->callback(desc->ctx, desc);
+	}
+}
+
 /***************************************************************************//**
  * @brief dma_isr
 *******************************************************************************/
@@ -62,6 +135,10 @@ void axi_dmac_default_isr(void *instance)
 	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
 	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
 
+	/* The queued transfer slot is free again, refill it from the queue. */
+	if ((reg_val & AXI_DMAC_IRQ_SOT) && (dmac->big_transfer.size == 0))
+		axi_dmac_queue_start(dmac);
+
 	if ((reg_val & AXI_DMAC_IRQ_SOT) && (dmac->big_transfer.size != 0)) {
 		remaining_size = dmac->big_transfer.size -
 				 dmac->big_transfer.size_done;
@@ -96,6 +173,9 @@ void axi_dmac_default_isr(void *instance)
 		dmac->big_transfer.address = 0;
 		dmac->big_transfer.size = 0;
 		dmac->big_transfer.size_done = 0;
+
+		axi_dmac_queue_done(dmac);
+		axi_dmac_queue_start(dmac);
 	}
 }
 
@@ -193,6 +273,226 @@ int32_t axi_dmac_is_transfer_ready(struct axi_dmac *dmac, bool *rdy)
 	return SUCCESS;
 }
 
+/*
+ * The interrupt driven completion uses the irq and timer layers, define
+ * ENABLE_AXI_DMAC_IRQ in the projects that build them.
+ */
+#ifdef ENABLE_AXI_DMAC_IRQ
+/***************************************************************************//**
+ * @brief Interrupt handler used when the DMA interrupt is owned by the driver.
+ *******************************************************************************/
+static void axi_dmac_irq_handler(void *ctx, uint32_t event, void *extra)
+{
+	struct axi_dmac *dmac = ctx;
+	uint32_t counter;
+
+	if (dmac->timer && !timer_counter_get(dmac->timer, &counter))
+		dmac->irq_counter = counter;
+
+	axi_dmac_default_isr(dmac);
+}
+
+/***************************************************************************//**
+ * @brief Number of ticks between two samples of the timer counter.
+ *
+ * The timers count down and reload with load_value, at most one reload is
+ * expected between two samples.
+ *******************************************************************************/
+static uint32_t axi_dmac_timer_delta(struct axi_dmac *dmac, uint32_t prev,
+				     uint32_t now)
+{
+	if (now <= prev)
+		return prev - now;
+
+	return prev + dmac->timer->load_value - now;
+}
+
+/***************************************************************************//**
+ * @brief Sleep until an interrupt is pending.
+ *******************************************************************************/
+static inline void axi_dmac_wait_for_irq(void)
+{
+#if defined(__arm__) || defined(__aarch64__)
+	__asm__ volatile("wfi");
+#endif
+}
+
+/***************************************************************************//**
+ * @brief Abort the current transfer. The state of a split transfer is cleared
+ *        as on its EOT and the pending interrupts are acknowledged, so neither
+ *        a late SOT/EOT interrupt nor the next transfer continues it.
+ *******************************************************************************/
+static void axi_dmac_abort(struct axi_dmac *dmac)
+{
+	uint32_t reg_val;
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
+
+	dmac->big_transfer.address = 0;
+	dmac->big_transfer.size = 0;
+	dmac->big_transfer.size_done = 0;
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+}
+
+/***************************************************************************//**
+ * @brief axi_dmac_transfer_wait_completion
+ *
+ * Start a transfer and sleep until its EOT interrupt. Interrupts are masked
+ * while the completion is checked, a pending interrupt still wakes up the
+ * core, so the EOT can not be missed.
+ * A timeout_us of 0 waits forever. The timeout needs a timer and is only
+ * checked when the core wakes up, so the timer interrupt should be enabled
+ * to guarantee a wake-up.
+ *******************************************************************************/
+int32_t axi_dmac_transfer_wait_completion(struct axi_dmac *dmac,
+		uint32_t address, uint32_t size, uint32_t timeout_us)
+{
+	uint32_t prev = 0, now, freq_hz = 0;
+	uint64_t elapsed = 0;
+	uint32_t latency_us;
+	int32_t ret;
+
+	if (!dmac || !dmac->irq_ctrl || (dmac->flags & DMA_CYCLIC))
+		return FAILURE;
+
+	if (size == 0)
+		return SUCCESS; /* nothing to do */
+
+	if (dmac->timer) {
+		ret = timer_count_clk_get(dmac->timer, &freq_hz);
+		if (IS_ERR_VALUE(ret) || !freq_hz)
+			return FAILURE;
+		timer_counter_get(dmac->timer, &prev);
+	}
+
+	dmac->big_transfer.transfer_done = false;
+	ret = axi_dmac_transfer_nonblocking(dmac, address, size);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	irq_global_disable(dmac->irq_ctrl);
+	while (!dmac->big_transfer.transfer_done) {
+		if (dmac->timer && timeout_us) {
+			timer_counter_get(dmac->timer, &now);
+			elapsed += axi_dmac_timer_delta(dmac, prev, now);
+			prev = now;
+			if (elapsed * 1000000 / freq_hz >= timeout_us) {
+				axi_dmac_abort(dmac);
+				irq_global_enable(dmac->irq_ctrl);
+				dmac->stats.timeouts++;
+
+				return -ETIMEDOUT;
+			}
+		}
+		axi_dmac_wait_for_irq();
+		irq_global_enable(dmac->irq_ctrl);
+		irq_global_disable(dmac->irq_ctrl);
+	}
+	irq_global_enable(dmac->irq_ctrl);
+
+	dmac->stats.transfers++;
+	if (dmac->timer) {
+		elapsed += axi_dmac_timer_delta(dmac, prev, dmac->irq_counter);
+		latency_us = elapsed * 1000000 / freq_hz;
+		dmac->stats.last_latency_us = latency_us;
+		if (latency_us > dmac->stats.max_latency_us)
+			dmac->stats.max_latency_us = latency_us;
+	}
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief Take ownership of the DMA interrupt, if one is provided.
+ *******************************************************************************/
+static int32_t axi_dmac_irq_init(struct axi_dmac *dmac,
+				 const struct axi_dmac_init *init)
+{
+	int32_t ret;
+
+	dmac->timer = init->timer;
+	if (!init->irq_ctrl)
+		return SUCCESS;
+
+	dmac->irq_id = init->irq_id;
+	dmac->irq_cb.callback = axi_dmac_irq_handler;
+	dmac->irq_cb.ctx = dmac;
+	dmac->irq_cb.config = NULL;
+
+	ret = irq_register_callback(init->irq_ctrl, dmac->irq_id,
+				    &dmac->irq_cb);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	ret = irq_trigger_level_set(init->irq_ctrl, dmac->irq_id,
+				    IRQ_LEVEL_HIGH);
+	if (IS_ERR_VALUE(ret))
+		goto error;
+
+	ret = irq_enable(init->irq_ctrl, dmac->irq_id);
+	if (IS_ERR_VALUE(ret))
+		goto error;
+
+	dmac->irq_ctrl = init->irq_ctrl;
+
+	return SUCCESS;
+
+error:
+	irq_unregister(init->irq_ctrl, dmac->irq_id);
+
+	return ret;
+}
+
+/***************************************************************************//**
+ * @brief Release the DMA interrupt.
+ *******************************************************************************/
+static void axi_dmac_irq_remove(struct axi_dmac *dmac)
+{
+	if (!dmac->irq_ctrl)
+		return;
+
+	irq_disable(dmac->irq_ctrl, dmac->irq_id);
+	irq_unregister(dmac->irq_ctrl, dmac->irq_id);
+}
+#else
+/***************************************************************************//**
+ * @brief axi_dmac_transfer_wait_completion
+ *
+ * Not available without ENABLE_AXI_DMAC_IRQ.
+ *******************************************************************************/
+int32_t axi_dmac_transfer_wait_completion(struct axi_dmac *dmac,
+		uint32_t address, uint32_t size, uint32_t timeout_us)
+{
+	return FAILURE;
+}
+
+static int32_t axi_dmac_irq_init(struct axi_dmac *dmac,
+				 const struct axi_dmac_init *init)
+{
+	return SUCCESS;
+}
+
+static void axi_dmac_irq_remove(struct axi_dmac *dmac)
+{
+}
+#endif
+
+/***************************************************************************//**
+ * @brief axi_dmac_get_stats
+ *******************************************************************************/
+int32_t axi_dmac_get_stats(struct axi_dmac *dmac,
+			   struct axi_dmac_stats *stats)
+{
+	if (!dmac || !stats)
+		return FAILURE;
+
+	*stats = dmac->stats;
+
+	return SUCCESS;
+}
+
 /***************************************************************************//**
  * @brief axi_dmac_transfer
  *******************************************************************************/
@@ -206,6 +506,10 @@ int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 	if (size == 0)
 		return SUCCESS; /* nothing to do */
 
+	/* Sleep instead of polling when the DMA interrupt is available. */
+	if (dmac->irq_ctrl && !(dmac->flags & DMA_CYCLIC))
+		return axi_dmac_transfer_wait_completion(dmac, address, size, 0);
+
 	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
 	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_ENABLE);
 
@@ -286,6 +590,95 @@ int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 	return SUCCESS;
 }
 
+/***************************************************************************//**
+ * @brief axi_dmac_submit
+ *
+ * Queue a descriptor. Descriptors are handed to the hardware one by one from
+ * the DMA interrupt, as soon as the queued transfer slot becomes free, and
+ * are completed in order through their callback. The DMA interrupt must be
+ * registered with axi_dmac_default_isr() as handler. Only the DMA_DEV_TO_MEM
+ * and DMA_MEM_TO_DEV directions are supported, -ENOTSUP is returned
+ * otherwise.
+ *******************************************************************************/
+int32_t axi_dmac_submit(struct axi_dmac *dmac, struct axi_dmac_desc *desc)
+{
+	uint32_t reg_val;
+
+	if (!dmac || !desc || !desc->x_length)
+		return FAILURE;
+
+	if ((desc->x_length - 1) > dmac->transfer_max_size)
+		return FAILURE;
+
+	/* axi_dmac_queue_start() would never start it. */
+	if (dmac->direction != DMA_DEV_TO_MEM &&
+	    dmac->direction != DMA_MEM_TO_DEV)
+		return -ENOTSUP;
+
+	desc->next = NULL;
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_CTRL, &reg_val);
+	if (!(reg_val & AXI_DMAC_CTRL_ENABLE)) {
+		axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
+		axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, AXI_DMAC_CTRL_ENABLE);
+	}
+
+	/* Mask the DMA interrupts while the queue is updated. */
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK,
+		       AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+
+	if (dmac->pending_tail)
+		dmac->pending_tail->next = desc;
+	else
+		dmac->pending_head = desc;
+	dmac->pending_tail = desc;
+
+	axi_dmac_queue_start(dmac);
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, 0x0);
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief axi_dmac_queue_abort
+ *
+ * Stop the core and drop all queued descriptors without calling their
+ * callbacks.
+ *******************************************************************************/
+int32_t axi_dmac_queue_abort(struct axi_dmac *dmac)
+{
+	uint32_t reg_val;
+
+	if (!dmac)
+		return FAILURE;
+
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK,
+		       AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+	axi_dmac_write(dmac, AXI_DMAC_REG_CTRL, 0x0);
+
+	dmac->pending_head = NULL;
+	dmac->pending_tail = NULL;
+	dmac->active_head = NULL;
+	dmac->active_tail = NULL;
+
+	axi_dmac_read(dmac, AXI_DMAC_REG_IRQ_PENDING, &reg_val);
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_PENDING, reg_val);
+	axi_dmac_write(dmac, AXI_DMAC_REG_IRQ_MASK, 0x0);
+
+	return SUCCESS;
+}
+
+/***************************************************************************//**
+ * @brief axi_dmac_queue_is_idle
+ *******************************************************************************/
+int32_t axi_dmac_queue_is_idle(struct axi_dmac *dmac, bool *idle)
+{
+	*idle = !dmac->pending_head && !dmac->active_head;
+
+	return SUCCESS;
+}
+
 /***************************************************************************//**
  * @brief axi_dmac_init
  *******************************************************************************/
@@ -293,8 +686,9 @@ int32_t axi_dmac_init(struct axi_dmac **dmac_core,
 		      const struct axi_dmac_init *init)
 {
 	struct axi_dmac *dmac;
+	int32_t ret;
 
-	dmac = (struct axi_dmac *)malloc(sizeof(*dmac));
+	dmac = (struct axi_dmac *)calloc(1, sizeof(*dmac));
 	if (!dmac)
 		return FAILURE;
 
@@ -306,10 +700,20 @@ int32_t axi_dmac_init(struct axi_dmac **dmac_core,
 	dmac->big_transfer.address = 0;
 	dmac->big_transfer.size = 0;
 	dmac->big_transfer.size_done = 0;
+	dmac->pending_head = NULL;
+	dmac->pending_tail = NULL;
+	dmac->active_head = NULL;
+	dmac->active_tail = NULL;
 
 	axi_dmac_write(dmac, AXI_DMAC_REG_X_LENGTH, dmac->transfer_max_size);
 	axi_dmac_read(dmac, AXI_DMAC_REG_X_LENGTH, &dmac->transfer_max_size);
 
+	ret = axi_dmac_irq_init(dmac, init);
+	if (IS_ERR_VALUE(ret)) {
+		free(dmac);
+		return ret;
+	}
+
 	*dmac_core = dmac;
 
 	return SUCCESS;
@@ -323,6 +727,8 @@ int32_t axi_dmac_remove(struct axi_dmac *dmac)
 	if(!dmac)
 		return FAILURE;
 
+	axi_dmac_irq_remove(dmac);
+
 	free(dmac);
 
 	return SUCCESS;
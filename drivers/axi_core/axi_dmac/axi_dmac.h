@@ -44,6 +44,8 @@
 /******************************************************************************/
 #include <stdint.h>
 #include "util.h"
+#include "irq.h"
+#include "timer.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -88,6 +90,47 @@ struct axi_dma_transfer {
 	volatile bool transfer_done;
 };
 
+/**
+ * @struct axi_dmac_desc
+ * @brief Descriptor of a queued (optionally 2D) DMA transfer.
+ *
+ * The descriptor is owned by the caller and must stay valid until its
+ * callback was called.
+ */
+struct axi_dmac_desc {
+	/** Memory address of the first row */
+	uint32_t address;
+	/** Number of bytes in a row */
+	uint32_t x_length;
+	/** Number of rows, 0 or 1 for a 1D transfer */
+	uint32_t y_length;
+	/** Distance in bytes between the start of two consecutive rows */
+	uint32_t stride;
+	/** Called from the DMA interrupt when the transfer is completed */
+	void (*callback)(void *ctx, struct axi_dmac_desc *desc);
+	/** Parameter passed to the callback */
+	void *ctx;
+	/** Hardware TRANSFER_ID, filled when the descriptor is started */
+	uint32_t id;
+	/** Next descriptor in the queue, used internally */
+	struct axi_dmac_desc *next;
+};
+
+/**
+ * @struct axi_dmac_stats
+ * @brief Statistics of the transfers waited for by interrupt.
+ */
+struct axi_dmac_stats {
+	/** Number of completed transfers */
+	uint32_t transfers;
+	/** Number of transfers that timed out */
+	uint32_t timeouts;
+	/** Time from start to EOT of the last transfer (us) */
+	uint32_t last_latency_us;
+	/** Maximum time from start to EOT (us) */
+	uint32_t max_latency_us;
+};
+
 struct axi_dmac {
 	const char *name;
 	uint32_t base;
@@ -95,6 +138,21 @@ struct axi_dmac {
 	uint32_t flags;
 	uint32_t transfer_max_size;
 	volatile struct axi_dma_transfer big_transfer;
+	/** Descriptors not yet handed to the hardware */
+	struct axi_dmac_desc *volatile pending_head;
+	struct axi_dmac_desc *volatile pending_tail;
+	/** Descriptors handed to the hardware, in submission order */
+	struct axi_dmac_desc *volatile active_head;
+	struct axi_dmac_desc *volatile active_tail;
+	/** Controller of the DMA interrupt, NULL to poll for completion */
+	struct irq_ctrl_desc *irq_ctrl;
+	uint32_t irq_id;
+	struct callback_desc irq_cb;
+	/** Running timer used for timeouts and latency, may be NULL */
+	struct timer_desc *timer;
+	/** Timer counter value sampled on the last DMA interrupt */
+	volatile uint32_t irq_counter;
+	struct axi_dmac_stats stats;
 };
 
 struct axi_dmac_init {
@@ -102,6 +160,12 @@ struct axi_dmac_init {
 	uint32_t base;
 	enum dma_direction direction;
 	uint32_t flags;
+	/** Controller of the DMA interrupt (optional) */
+	struct irq_ctrl_desc *irq_ctrl;
+	/** DMA interrupt ID, used when irq_ctrl is set */
+	uint32_t irq_id;
+	/** Running timer used for timeouts and latency (optional) */
+	struct timer_desc *timer;
 };
 
 /******************************************************************************/
@@ -117,6 +181,13 @@ int32_t axi_dmac_transfer_nonblocking(struct axi_dmac *dmac,
 int32_t axi_dmac_is_transfer_ready(struct axi_dmac *dmac, bool *rdy);
 int32_t axi_dmac_transfer(struct axi_dmac *dmac,
 			  uint32_t address, uint32_t size);
+int32_t axi_dmac_transfer_wait_completion(struct axi_dmac *dmac,
+		uint32_t address, uint32_t size, uint32_t timeout_us);
+int32_t axi_dmac_get_stats(struct axi_dmac *dmac,
+			   struct axi_dmac_stats *stats);
+int32_t axi_dmac_submit(struct axi_dmac *dmac, struct axi_dmac_desc *desc);
+int32_t axi_dmac_queue_abort(struct axi_dmac *dmac);
+int32_t axi_dmac_queue_is_idle(struct axi_dmac *dmac, bool *idle);
 int32_t axi_dmac_init(struct axi_dmac **adc_core,
 		      const struct axi_dmac_init *init);
 int32_t axi_dmac_remove(struct axi_dmac *dmac);
@@ -46,6 +46,7 @@
 #include <inttypes.h>
 #include <stdlib.h>
 #include "error.h"
+#include "delay.h"
 #include "iio.h"
 #include "iio_axi_adc.h"
 
@@ -298,6 +299,41 @@ static ssize_t set_sampling_frequency(void *device, char *buf, size_t len,
 	return -ENOENT;
 }
 
+/**
+ * @brief get_overflows().
+ * @param device - Physical instance of a iio_axi_adc_desc device.
+ * @param buf - Where value is stored.
+ * @param len - Maximum length of value to be stored in buf.
+ * @param channel - Channel properties.
+ * @return Length of chars written in buf, or negative value on failure.
+ */
+static ssize_t get_overflows(void *device, char *buf, size_t len,
+			     const struct iio_ch_info *channel,
+			     intptr_t priv)
+{
+	struct iio_axi_adc_desc *iio_adc = (struct iio_axi_adc_desc *)device;
+
+	return snprintf(buf, len, "%"PRIu32"", iio_adc->overflows);
+}
+
+/**
+ * @brief set_overflows(), any write clears the counter.
+ * @param device - Physical instance of a iio_axi_adc_desc device.
+ * @param buf - Value to be written to attribute.
+ * @param len - Length of the data in "buf".
+ * @param channel - Channel properties.
+ * @return Number of bytes written to device, or negative value on failure.
+ */
+static ssize_t set_overflows(void *device, char *buf, size_t len,
+			     const struct iio_ch_info *channel,
+			     intptr_t priv)
+{
+	struct iio_axi_adc_desc *iio_adc = (struct iio_axi_adc_desc *)device;
+
+	iio_adc->overflows = 0;
+
+	return len;
+}
 
 /**
  * List containing attributes, corresponding to "voltage" channels.
@@ -331,6 +367,231 @@ static struct iio_attribute iio_voltage_attributes[] = {
 	END_ATTRIBUTES_ARRAY
 };
 
+/**
+ * List containing buffer attributes, used in streaming mode.
+ */
+static struct iio_attribute iio_buffer_attributes[] = {
+	{
+		.name = "overflows",
+		.show = get_overflows,
+		.store = set_overflows,
+	},
+	END_ATTRIBUTES_ARRAY
+};
+
+/** Time to wait for a filled ring buffer before giving up */
+#define IIO_AXI_ADC_RING_TIMEOUT_US	1000000
+
+/**
+ * @brief Mask the DMA interrupts while the ring state is updated.
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @return None.
+ */
+static inline void iio_axi_adc_ring_lock(struct iio_axi_adc_desc *iio_adc)
+{
+	axi_dmac_write(iio_adc->dmac, AXI_DMAC_REG_IRQ_MASK,
+		       AXI_DMAC_IRQ_SOT | AXI_DMAC_IRQ_EOT);
+}
+
+/**
+ * @brief Unmask the DMA interrupts.
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @return None.
+ */
+static inline void iio_axi_adc_ring_unlock(struct iio_axi_adc_desc *iio_adc)
+{
+	axi_dmac_write(iio_adc->dmac, AXI_DMAC_REG_IRQ_MASK, 0x0);
+}
+
+/**
+ * @brief DMA completion callback of a ring buffer, called from interrupt.
+ * The buffer is queued as filled. If no other buffer is handed to the DMA,
+ * the DMA would stop, so the oldest filled buffer is taken back from the
+ * queue and overwritten and an overflow is counted. The buffer being read
+ * is never in the queue, so it is never overwritten. A completion for a buffer
+ * that was not handed to the DMA is ignored, it can not be queued twice.
+ * @param ctx - Instance of the iio_axi_adc.
+ * @param desc - Completed DMA descriptor.
+ * @return None.
+ */
+static void iio_axi_adc_ring_done(void *ctx, struct axi_dmac_desc *desc)
+{
+	struct iio_axi_adc_desc *iio_adc = ctx;
+	uint32_t slot;
+
+	slot = desc - iio_adc->ring_desc;
+	if (slot >= iio_adc->ring_size ||
+	    iio_adc->ring_state[slot] != IIO_AXI_ADC_SLOT_INFLIGHT)
+		return;
+
+	iio_adc->ring_inflight--;
+	iio_adc->ring_state[slot] = IIO_AXI_ADC_SLOT_FILLED;
+	iio_adc->ring_fifo[(iio_adc->ring_head + iio_adc->ring_filled) %
+			   iio_adc->ring_size] = slot;
+	iio_adc->ring_filled++;
+
+	if (iio_adc->ring_inflight || !iio_adc->streaming)
+		return;
+
+	iio_adc->overflows++;
+
+	slot = iio_adc->ring_fifo[iio_adc->ring_head];
+	iio_adc->ring_head = (iio_adc->ring_head + 1) % iio_adc->ring_size;
+	iio_adc->ring_filled--;
+	iio_adc->ring_state[slot] = IIO_AXI_ADC_SLOT_INFLIGHT;
+	iio_adc->ring_inflight++;
+	axi_dmac_submit(iio_adc->dmac, &iio_adc->ring_desc[slot]);
+}
+
+/**
+ * @brief Stop streaming into the ring.
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_axi_adc_ring_stop(struct iio_axi_adc_desc *iio_adc)
+{
+	int32_t ret;
+	uint32_t i;
+
+	if (!iio_adc->streaming)
+		return SUCCESS;
+
+	iio_adc->streaming = false;
+
+	ret = axi_dmac_queue_abort(iio_adc->dmac);
+
+	for (i = 0; i < iio_adc->ring_size; i++)
+		iio_adc->ring_state[i] = IIO_AXI_ADC_SLOT_FREE;
+	iio_adc->ring_inflight = 0;
+	iio_adc->ring_filled = 0;
+	iio_adc->ring_head = 0;
+	iio_adc->ring_served = -1;
+
+	return ret;
+}
+
+/**
+ * @brief Start streaming into the ring, all buffers are queued to the DMA.
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @param bytes - Number of bytes to capture in each buffer.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_axi_adc_ring_start(struct iio_axi_adc_desc *iio_adc,
+				      uint32_t bytes)
+{
+	struct axi_dmac_desc *desc;
+	int32_t ret;
+	uint32_t i;
+
+	for (i = 0; i < iio_adc->ring_size; i++)
+		if (bytes > iio_adc->ring[i].size)
+			return -ENOMEM;
+
+	iio_adc->ring_bytes = bytes;
+	iio_adc->ring_inflight = iio_adc->ring_size;
+	iio_adc->ring_filled = 0;
+	iio_adc->ring_head = 0;
+	iio_adc->ring_served = -1;
+	iio_adc->streaming = true;
+
+	for (i = 0; i < iio_adc->ring_size; i++) {
+		iio_adc->ring_state[i] = IIO_AXI_ADC_SLOT_INFLIGHT;
+		desc = &iio_adc->ring_desc[i];
+		desc->address = (uint32_t)iio_adc->ring[i].buff;
+		desc->x_length = bytes;
+		desc->y_length = 0;
+		desc->stride = 0;
+		desc->callback = iio_axi_adc_ring_done;
+		desc->ctx = iio_adc;
+
+		ret = axi_dmac_submit(iio_adc->dmac, desc);
+		if (IS_ERR_VALUE(ret)) {
+			iio_axi_adc_ring_stop(iio_adc);
+			return ret;
+		}
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the next filled ring buffer.
+ * The buffer read before is handed back to the DMA, then the oldest filled
+ * buffer becomes the read buffer of the iio device, so it is served without
+ * copying while the DMA fills the other buffers.
+ * @param iio_adc - Instance of the iio_axi_adc.
+ * @param bytes - Number of bytes to read.
+ * @return SUCCESS in case of success, -ETIMEDOUT if no buffer was filled in
+ *         IIO_AXI_ADC_RING_TIMEOUT_US, -EFAULT if a buffer is not in the
+ *         expected state, the ring is then stopped, or negative value
+ *         otherwise.
+ */
+static int32_t iio_axi_adc_ring_read(struct iio_axi_adc_desc *iio_adc,
+				     uint32_t bytes)
+{
+	uint32_t timeout = IIO_AXI_ADC_RING_TIMEOUT_US;
+	uint32_t slot;
+	int32_t ret;
+
+	if (iio_adc->streaming && bytes != iio_adc->ring_bytes)
+		iio_axi_adc_ring_stop(iio_adc);
+
+	if (!iio_adc->streaming) {
+		ret = iio_axi_adc_ring_start(iio_adc, bytes);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+	} else if (iio_adc->ring_served >= 0) {
+		slot = iio_adc->ring_served;
+		if (iio_adc->ring_state[slot] != IIO_AXI_ADC_SLOT_SERVED) {
+			iio_axi_adc_ring_stop(iio_adc);
+			return -EFAULT;
+		}
+
+		iio_axi_adc_ring_lock(iio_adc);
+		iio_adc->ring_state[slot] = IIO_AXI_ADC_SLOT_INFLIGHT;
+		iio_adc->ring_inflight++;
+		iio_axi_adc_ring_unlock(iio_adc);
+
+		ret = axi_dmac_submit(iio_adc->dmac, &iio_adc->ring_desc[slot]);
+		if (IS_ERR_VALUE(ret)) {
+			iio_axi_adc_ring_lock(iio_adc);
+			iio_adc->ring_state[slot] = IIO_AXI_ADC_SLOT_FREE;
+			iio_adc->ring_inflight--;
+			iio_axi_adc_ring_unlock(iio_adc);
+			iio_adc->ring_served = -1;
+			return ret;
+		}
+	}
+	iio_adc->ring_served = -1;
+
+	while (!iio_adc->ring_filled) {
+		if (!timeout--)
+			return -ETIMEDOUT;
+		udelay(1);
+	}
+
+	iio_axi_adc_ring_lock(iio_adc);
+	slot = iio_adc->ring_fifo[iio_adc->ring_head];
+	if (iio_adc->ring_state[slot] != IIO_AXI_ADC_SLOT_FILLED) {
+		/* The DMA may still write this buffer, do not serve it */
+		iio_axi_adc_ring_unlock(iio_adc);
+		iio_axi_adc_ring_stop(iio_adc);
+		return -EFAULT;
+	}
+	iio_adc->ring_head = (iio_adc->ring_head + 1) % iio_adc->ring_size;
+	iio_adc->ring_filled--;
+	iio_adc->ring_state[slot] = IIO_AXI_ADC_SLOT_SERVED;
+	iio_axi_adc_ring_unlock(iio_adc);
+
+	iio_adc->ring_served = slot;
+	if (iio_adc->dcache_invalidate_range)
+		iio_adc->dcache_invalidate_range((uint32_t)iio_adc->ring[slot].buff,
+						 bytes);
+	iio_adc->read_buff->buff = iio_adc->ring[slot].buff;
+
+	return SUCCESS;
+}
+
 /**
  * @brief Update active channels
  * @param dev - Instance of the iio_axi_adc
@@ -341,6 +602,7 @@ int32_t iio_axi_adc_prepare_transfer(void *dev, uint32_t mask)
 {
 	struct iio_axi_adc_desc *iio_adc = dev;
 
+	iio_axi_adc_ring_stop(iio_adc);
 	iio_adc->mask = mask;
 
 	return axi_adc_update_active_channels(iio_adc->adc, mask);
@@ -365,6 +627,9 @@ int32_t	iio_axi_adc_read_dev(void *dev, void *buff, uint32_t nb_samples)
 	bytes = nb_samples * hweight8(iio_adc->mask) * (STORAGE_BITS / 8);
 
 	iio_adc->dmac->flags = 0;
+	if (iio_adc->ring)
+		return iio_axi_adc_ring_read(iio_adc, bytes);
+
 	ret = axi_dmac_transfer(iio_adc->dmac, (uint32_t)buff, bytes);
 	if (ret < 0)
 		return ret;
@@ -375,6 +640,16 @@ int32_t	iio_axi_adc_read_dev(void *dev, void *buff, uint32_t nb_samples)
 	return SUCCESS;
 }
 
+/**
+ * @brief Stop streaming at the end of a transfer.
+ * @param dev - Instance of the iio_axi_adc
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+int32_t iio_axi_adc_end_transfer(void *dev)
+{
+	return iio_axi_adc_ring_stop(dev);
+}
+
 /**
  * @brief Delete iio_device.
  * @param iio_device - Structure describing a device, channels and attributes.
@@ -425,6 +700,8 @@ static int32_t iio_axi_adc_create_device_descriptor(
 
 	iio_device->num_ch = desc->adc->num_channels;
 	iio_device->attributes = NULL; /* no device attribute */
+	if (desc->ring)
+		iio_device->buffer_attributes = iio_buffer_attributes;
 	iio_device->channels = calloc(iio_device->num_ch,
 				      sizeof(struct iio_channel));
 	if (!iio_device->channels)
@@ -445,6 +722,7 @@ static int32_t iio_axi_adc_create_device_descriptor(
 	}
 
 	iio_device->prepare_transfer = iio_axi_adc_prepare_transfer;
+	iio_device->end_transfer = iio_axi_adc_end_transfer;
 	iio_device->read_dev = iio_axi_adc_read_dev;
 
 	return SUCCESS;
@@ -477,7 +755,7 @@ int32_t iio_axi_adc_init(struct iio_axi_adc_desc **desc,
 			 struct iio_axi_adc_init_param *init)
 {
 	struct iio_axi_adc_desc *iio_axi_adc_inst;
-
+	uint32_t i;
 	int32_t status;
 
 	if (!init)
@@ -486,6 +764,15 @@ int32_t iio_axi_adc_init(struct iio_axi_adc_desc **desc,
 	if (!init->rx_adc || !init->rx_dmac)
 		return FAILURE;
 
+	if (init->ring && (init->ring_size < 2 || !init->read_buff))
+		return FAILURE;
+
+	/* Each ring buffer is filled by a single DMA descriptor */
+	for (i = 0; init->ring && i < init->ring_size; i++)
+		if (!init->ring[i].buff || !init->ring[i].size ||
+		    init->ring[i].size - 1 > init->rx_dmac->transfer_max_size)
+			return -EINVAL;
+
 	iio_axi_adc_inst = (struct iio_axi_adc_desc *)calloc(1,
 			   sizeof(struct iio_axi_adc_desc));
 	if (!iio_axi_adc_inst)
@@ -495,17 +782,40 @@ int32_t iio_axi_adc_init(struct iio_axi_adc_desc **desc,
 	iio_axi_adc_inst->dmac = init->rx_dmac;
 	iio_axi_adc_inst->dcache_invalidate_range = init->dcache_invalidate_range;
 	iio_axi_adc_inst->get_sampling_frequency = init->get_sampling_frequency;
+	iio_axi_adc_inst->ring_served = -1;
+	if (init->ring) {
+		iio_axi_adc_inst->ring_desc = calloc(init->ring_size,
+						     sizeof(struct axi_dmac_desc));
+		iio_axi_adc_inst->ring_state = calloc(init->ring_size,
+						      sizeof(*iio_axi_adc_inst->ring_state));
+		iio_axi_adc_inst->ring_fifo = calloc(init->ring_size,
+						     sizeof(*iio_axi_adc_inst->ring_fifo));
+		if (!iio_axi_adc_inst->ring_desc || !iio_axi_adc_inst->ring_state ||
+		    !iio_axi_adc_inst->ring_fifo) {
+			status = FAILURE;
+			goto error;
+		}
+		iio_axi_adc_inst->ring = init->ring;
+		iio_axi_adc_inst->ring_size = init->ring_size;
+		iio_axi_adc_inst->read_buff = init->read_buff;
+	}
 
 	status = iio_axi_adc_create_device_descriptor(iio_axi_adc_inst,
 			&iio_axi_adc_inst->dev_descriptor);
-	if (IS_ERR_VALUE(status)) {
-		free(iio_axi_adc_inst);
-		return status;
-	}
+	if (IS_ERR_VALUE(status))
+		goto error;
 
 	*desc = iio_axi_adc_inst;
 
 	return SUCCESS;
+
+error:
+	free((void *)iio_axi_adc_inst->ring_fifo);
+	free((void *)iio_axi_adc_inst->ring_state);
+	free(iio_axi_adc_inst->ring_desc);
+	free(iio_axi_adc_inst);
+
+	return status;
 }
 
 /**
@@ -520,10 +830,15 @@ int32_t iio_axi_adc_remove(struct iio_axi_adc_desc *desc)
 	if (!desc)
 		return FAILURE;
 
+	iio_axi_adc_ring_stop(desc);
+
 	status = iio_axi_adc_delete_device_descriptor(desc);
 	if (status < 0)
 		return status;
 
+	free((void *)desc->ring_fifo);
+	free((void *)desc->ring_state);
+	free(desc->ring_desc);
 	free(desc);
 
 	return SUCCESS;
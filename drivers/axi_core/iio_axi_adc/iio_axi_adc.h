@@ -52,6 +52,21 @@
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
+/**
+ * @enum iio_axi_adc_slot_state
+ * @brief State of a streaming ring buffer.
+ */
+enum iio_axi_adc_slot_state {
+	/** Not used */
+	IIO_AXI_ADC_SLOT_FREE,
+	/** Queued to the DMA */
+	IIO_AXI_ADC_SLOT_INFLIGHT,
+	/** Captured, waiting to be read */
+	IIO_AXI_ADC_SLOT_FILLED,
+	/** Being read by the client */
+	IIO_AXI_ADC_SLOT_SERVED
+};
+
 /**
  * @struct iio_axi_adc_desc
  * @brief iio_axi_adc_descriptor
@@ -72,6 +87,32 @@ struct iio_axi_adc_desc {
 	struct iio_device dev_descriptor;
 	/** Channel names */
 	char (*ch_names)[20];
+	/** Buffers of the streaming ring, NULL if streaming is not used */
+	struct iio_data_buffer *ring;
+	/** Number of buffers in the ring */
+	uint32_t ring_size;
+	/** DMA descriptors, one for each ring buffer */
+	struct axi_dmac_desc *ring_desc;
+	/** Read buffer of the iio device, pointed to the buffer being read */
+	struct iio_data_buffer *read_buff;
+	/** True while the DMA fills the ring */
+	bool streaming;
+	/** Number of bytes captured in each ring buffer */
+	uint32_t ring_bytes;
+	/** State of each ring buffer */
+	volatile enum iio_axi_adc_slot_state *ring_state;
+	/** Indexes of the filled ring buffers, in completion order */
+	volatile uint32_t *ring_fifo;
+	/** Ring buffers handed to the DMA */
+	volatile uint32_t ring_inflight;
+	/** Filled ring buffers not yet read */
+	volatile uint32_t ring_filled;
+	/** Position of the oldest filled ring buffer in ring_fifo */
+	volatile uint32_t ring_head;
+	/** Index of the ring buffer being read, -1 if none */
+	int32_t ring_served;
+	/** Number of times the DMA ran out of buffers */
+	volatile uint32_t overflows;
 };
 
 /**
@@ -88,6 +129,15 @@ struct iio_axi_adc_init_param {
 	/** Custom sampling frequency getter */
 	int (*get_sampling_frequency)(struct axi_adc *dev, uint32_t chan,
 				      uint64_t *sampling_freq_hz);
+	/** Buffers used for continuous streaming (optional, at least 2).
+	 *  The receive DMA interrupt must be handled by axi_dmac_default_isr.
+	 *  A buffer can not be larger than a single transfer of the DMA, see
+	 *  axi_dmac transfer_max_size, iio_axi_adc_init() fails otherwise. */
+	struct iio_data_buffer *ring;
+	/** Number of buffers in ring */
+	uint32_t ring_size;
+	/** Read buffer registered with iio_register(), required with ring */
+	struct iio_data_buffer *read_buff;
 };
 
 /******************************************************************************/
@@ -49,6 +49,7 @@ significant delays */
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <sleep.h>
 #include <inttypes.h>
 
@@ -57,13 +58,24 @@ significant delays */
 #include "error.h"
 #include "spi_engine.h"
 
+#define BINLOG_MODULE spi_engine
+#include "print_log.h"
+
+/******************************************************************************/
+/************************ Variable Definitions ********************************/
+/******************************************************************************/
+#ifdef ENABLE_BINLOG
+BINLOG_MODULE_DEFINE(spi_engine, LOG_LEVEL);
+#endif
+
 /**
  * @brief Spi engine platform specific SPI platform ops structure
  */
 const struct spi_platform_ops spi_eng_platform_ops = {
 	.init = &spi_engine_init,
 	.write_and_read = &spi_engine_write_and_read,
-	.remove = &spi_engine_remove
+	.remove = &spi_engine_remove,
+	.transfer = &spi_engine_transfer
 };
 
 /******************************************************************************/
@@ -226,189 +238,17 @@ static int32_t spi_get_sleep_div(struct spi_desc *desc,
 }
 
 /**
- * @brief Create a new commands queue used in a spi transfer
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command with wich the buffer will be initiated
- * @return int32_t Failure if the memory allocation failed
- */
-static int32_t spi_engine_queue_new_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *local_fifo;
-
-	local_fifo = (spi_engine_cmd_queue*)malloc(sizeof(*local_fifo));
-
-	if(!local_fifo)
-		return FAILURE;
-
-	local_fifo->cmd = cmd;
-	local_fifo->next = NULL;
-	*fifo = local_fifo;
-
-	return SUCCESS;
-}
-
-/**
- * @brief Add a command at the end of an existing queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command to be added
- */
-static void spi_engine_queue_add_cmd(struct spi_engine_cmd_queue **fifo,
-				     uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *to_add = NULL;
-	struct spi_engine_cmd_queue *local_fifo;
-
-	local_fifo = *fifo;
-	while (local_fifo->next != NULL) {
-		// Get the last element
-		local_fifo = local_fifo->next;
-	}
-
-	// Create a new element
-	spi_engine_queue_new_cmd(&to_add, cmd);
-	// Add as the next element
-	local_fifo->next = to_add;
-}
-
-/**
- * @brief Add a command at the beginning of an existing queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Command to be added
- */
-static void spi_engine_queue_append_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t cmd)
-{
-	struct spi_engine_cmd_queue *to_add = NULL;
-
-	// Create a new element
-	spi_engine_queue_new_cmd(&to_add, cmd);
-	// Interchange the addresses
-	to_add->next = *fifo;
-	*fifo = to_add;
-}
-
-
-/**
- * @brief Get the command from the beginning of the queue
- *
- * @param fifo Command buffer, usualy used in fifo mode
- * @param cmd Value of the command that was extracted
- * @return int32_t Return FAILURE if the queue is empty
- */
-static int32_t spi_engine_queue_get_cmd(struct spi_engine_cmd_queue **fifo,
-					uint32_t *cmd)
-{
-	struct spi_engine_cmd_queue *local_fifo;
-
-	if (!*fifo)
-		return FAILURE;
-
-	local_fifo = *fifo;
-	*cmd = local_fifo->cmd;
-	if ((*fifo)->next) {
-		*fifo = local_fifo->next;
-		free(local_fifo);
-	} else {
-		free(*fifo);
-		*fifo = NULL;
-	}
-
-	return SUCCESS;
-}
-
-/**
- * @brief Free the memory allocated by a queue
- *
- * @param fifo The queue that needs it's memory freed
- * @return int32_t This function allways return SUCCESS
- */
-static int32_t spi_engine_queue_free(struct spi_engine_cmd_queue **fifo)
-{
-	if(*fifo && (*fifo)->next)
-		spi_engine_queue_free(&(*fifo)->next);
-	if((*fifo) != NULL) {
-		free(*fifo);
-		*fifo = NULL;
-	}
-
-	return SUCCESS;
-}
-
-/**
- * @brief Write the SPI engine's command fifo
- *
- * @param desc Decriptor containing SPI Engine's parameters
- * @param cmd The command that will be written
- * @return int32_t Returns FAILURE if the the axi transfer failed
- */
-static int32_t spi_engine_write_cmd_reg(struct spi_engine_desc *desc,
-					uint32_t cmd)
-{
-	int32_t ret;
-
-	/* Check if offload is enabled */
-	if(desc->offload_config & (OFFLOAD_TX_EN | OFFLOAD_RX_EN)) {
-		ret = spi_engine_write(desc,
-				       SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
-				       cmd);
-
-	} else {
-		ret = spi_engine_write(desc,
-				       SPI_ENGINE_REG_CMD_FIFO,
-				       cmd);
-	}
-
-	return ret;
-}
-
-/**
- * @brief Write a transfer command to the SPI engine's command fifo
- *
- * @param desc Decriptor containing SPI Engine's parameters
- * @param read_write Read/Write operation flag
- * @param bytes_number Number of bytes to transfer
- * @return int32_t This function allways returns SUCCESS
- */
-static int32_t spi_engine_transfer(struct spi_engine_desc *desc,
-				   uint8_t read_write,
-				   uint8_t bytes_number)
-{
-	uint8_t words_number;
-
-	words_number = spi_get_words_number(desc, bytes_number);
-
-	desc->offload_tx_len += words_number;
-
-	/*
-	 * Engine Wiki:
-	 *
-	 * https://wiki.analog.com/resources/fpga/peripherals/spi_engine
-	 *
-	 * The words number is zero based
-	 */
-
-	spi_engine_write_cmd_reg(desc,
-				 SPI_ENGINE_CMD_TRANSFER(read_write,
-						 words_number  - 1));
-
-	return SUCCESS;
-}
-
-/**
- * @brief Change the state of the chip select port
+ * @brief Get the chip select command of the SPI engine
  *
  * @param desc Decriptor containing SPI interface parameters
  * @param assert Chip select state.
  * 		 The supported values are :
  * 			-true (HIGH)
  * 			-false (LOW)
+ * @return uint32_t The engine command
  */
-static void spi_engine_set_cs(struct spi_desc *desc,
-			      bool assert)
+static uint32_t spi_engine_cs_cmd(struct spi_desc *desc,
+				  bool assert)
 {
 	uint8_t			mask;
 	struct spi_engine_desc	*eng_desc;
@@ -420,44 +260,63 @@ static void spi_engine_set_cs(struct spi_desc *desc,
 	if (!assert)
 		mask ^= BIT(desc->chip_select);
 
-	spi_engine_write_cmd_reg(eng_desc,
-				 SPI_ENGINE_CMD_ASSERT(eng_desc->cs_delay,
-						 mask));
+	return SPI_ENGINE_CMD_ASSERT(eng_desc->cs_delay, mask);
 }
 
 /**
- * @brief Add a delay bewtheen the engine commands
+ * @brief Get the commands configuring the prescaler, the data width and the
+ * 	spi mode.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param sleep_time_ns Number of nanoseconds to sleep between commands
+ * @param cmds Buffer of SPI_ENGINE_CONFIG_CMDS engine commands
+ * @return uint32_t The number of commands
  */
-static void spi_gen_sleep_ns(struct spi_desc *desc,
-			     uint32_t sleep_time_ns)
+static uint32_t spi_engine_config_cmds(struct spi_desc *desc,
+				       uint32_t *cmds)
 {
-	uint32_t 		sleep_div;
-	struct spi_engine_desc	*eng_desc;
+	struct spi_engine_desc	*desc_extra;
 
-	eng_desc = desc->extra;
+	desc_extra = desc->extra;
 
-	spi_get_sleep_div(desc, sleep_time_ns, &sleep_div);
+	/* Configure the prescaler */
+	cmds[0] = SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_REG_CLK_DIV,
+					desc_extra->clk_div);
+	/* Set the data transfer length */
+	cmds[1] = SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_DATA_TRANSFER_LEN,
+					desc_extra->data_width);
+	/*
+	 * Configure the spi mode :
+	 *	- 3 wire
+	 *	- CPOL
+	 *	- CPHA
+	 */
+	cmds[2] = SPI_ENGINE_CMD_CONFIG(SPI_ENGINE_CMD_REG_CONFIG, desc->mode);
 
-	spi_engine_write_cmd_reg(eng_desc, SPI_ENGINE_CMD_SLEEP(sleep_div));
+	return SPI_ENGINE_CONFIG_CMDS;
 }
 
 /**
  * @brief Spi engine command interpreter
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param cmd Command to send to the engine
- * @return int32_t - SUCCESS if the command is transfered
+ * @param cmd Command of a message (WRITE, READ, CS_LOW, SLEEP, ...)
+ * @param eng_cmd The command in the format of the engine
+ * @param tx_words Incremented with the number of words written on SDO
+ * @param rx_words Incremented with the number of words read from SDI
+ * @return int32_t - SUCCESS if the command is valid
  *		   - FAILURE if the command format is invalid
  */
-static int32_t spi_engine_write_cmd(struct spi_desc *desc,
-				    uint32_t cmd)
+static int32_t spi_engine_compile_cmd(struct spi_desc *desc,
+				      uint32_t cmd,
+				      uint32_t *eng_cmd,
+				      uint32_t *tx_words,
+				      uint32_t *rx_words)
 {
 	uint8_t				engine_command;
 	uint8_t				parameter;
 	uint8_t				modifier;
+	uint8_t				words_number;
+	uint32_t			sleep_div;
 	struct spi_engine_desc		*desc_extra;
 
 	desc_extra = desc->extra;
@@ -468,146 +327,282 @@ static int32_t spi_engine_write_cmd(struct spi_desc *desc,
 
 	switch(engine_command) {
 	case SPI_ENGINE_INST_TRANSFER:
-		spi_engine_transfer(desc_extra, modifier, parameter);
+		words_number = spi_get_words_number(desc_extra, parameter);
+		if (modifier & SPI_ENGINE_INSTRUCTION_TRANSFER_W)
+			*tx_words += words_number;
+		if (modifier & SPI_ENGINE_INSTRUCTION_TRANSFER_R)
+			*rx_words += words_number;
+		/*
+		 * Engine Wiki:
+		 *
+		 * https://wiki.analog.com/resources/fpga/peripherals/spi_engine
+		 *
+		 * The words number is zero based
+		 */
+		*eng_cmd = SPI_ENGINE_CMD_TRANSFER(modifier, words_number - 1);
 		break;
 
 	case SPI_ENGINE_INST_ASSERT:
-		if(parameter == 0xFF) {
+		if(parameter == 0xFF)
 			/* Set the CS HIGH */
-			spi_engine_set_cs(desc, true);
-		} else if(parameter == 0x00) {
+			*eng_cmd = spi_engine_cs_cmd(desc, true);
+		else if(parameter == 0x00)
 			/* Set the CS LOW */
-			spi_engine_set_cs(desc, false);
-		}
+			*eng_cmd = spi_engine_cs_cmd(desc, false);
+		else
+			*eng_cmd = cmd;
 		break;
 
 	/* The SYNC and SLEEP commands got the same value but different
 	modifier */
 	case SPI_ENGINE_INST_SYNC_SLEEP:
-		/* SYNC instruction */
-		if(modifier == 0x00) {
-			spi_engine_write_cmd_reg(desc_extra, cmd);
-		} else if(modifier == 0x01) {
-			spi_gen_sleep_ns(desc, parameter);
+		if(modifier == SPI_ENGINE_MISC_SLEEP) {
+			spi_get_sleep_div(desc, parameter, &sleep_div);
+			*eng_cmd = SPI_ENGINE_CMD_SLEEP(sleep_div);
+		} else {
+			*eng_cmd = cmd;
 		}
 		break;
-	case SPI_ENGINE_INST_CONFIG:
-		spi_engine_write_cmd_reg(desc_extra, cmd);
 
+	case SPI_ENGINE_INST_CONFIG:
+		*eng_cmd = cmd;
 		break;
 
 	default:
 
 		return FAILURE;
-		break;
 	}
 
 	return SUCCESS;
 }
 
 /**
- * @brief Prepare the command queue before sending it to the engine
+ * @brief Feed the SPI engine's command and SDO fifos and drain its SDI fifo
+ *
+ * The words are written in bursts, the fifo room is read only when the words
+ * known to fit were written. The three streams progress together, so the
+ * engine never waits for data while the driver waits for room.
+ *
+ * @param desc Decriptor containing SPI Engine's parameters
+ * @param cmds Engine commands
+ * @param no_cmds Number of commands
+ * @param tx Words written on SDO
+ * @param tx_words Number of words in tx
+ * @param rx Words read from SDI, may be NULL if rx_words is 0
+ * @param rx_words Number of words read
+ */
+static void spi_engine_pump(struct spi_engine_desc *desc,
+			    const uint32_t *cmds,
+			    uint32_t no_cmds,
+			    const uint32_t *tx,
+			    uint32_t tx_words,
+			    uint32_t *rx,
+			    uint32_t rx_words)
+{
+	uint32_t n;
+
+	while (no_cmds || tx_words || rx_words) {
+		if (no_cmds) {
+			spi_engine_read(desc, SPI_ENGINE_REG_CMD_FIFO_ROOM, &n);
+			for (; n && no_cmds; n--, no_cmds--)
+				spi_engine_write(desc, SPI_ENGINE_REG_CMD_FIFO,
+						 *cmds++);
+		}
+		if (tx_words) {
+			spi_engine_read(desc, SPI_ENGINE_REG_SDO_FIFO_ROOM, &n);
+			for (; n && tx_words; n--, tx_words--)
+				spi_engine_write(desc,
+						 SPI_ENGINE_REG_SDO_DATA_FIFO,
+						 *tx++);
+		}
+		if (rx_words) {
+			spi_engine_read(desc, SPI_ENGINE_REG_SDI_FIFO_LEVEL, &n);
+			for (; n && rx_words; n--, rx_words--)
+				spi_engine_read(desc,
+						SPI_ENGINE_REG_SDI_DATA_FIFO,
+						rx++);
+		}
+	}
+}
+
+/**
+ * @brief End a spi transfer with a SYNC command and wait for it
+ *
+ * @param desc Decriptor containing SPI Engine's parameters
+ */
+static void spi_engine_sync(struct spi_engine_desc *desc)
+{
+	uint32_t sync_id;
+	uint32_t sync_cmd;
+
+	/* Add a sync command to signal that the transfer has finished */
+	sync_cmd = SPI_ENGINE_CMD_SYNC(_sync_id);
+	spi_engine_pump(desc, &sync_cmd, 1, NULL, 0, NULL, 0);
+
+	/* Wait for the end sync signal */
+	do {
+		spi_engine_read(desc, SPI_ENGINE_REG_SYNC_ID, &sync_id);
+	} while(sync_id != _sync_id);
+	_sync_id++;
+}
+
+/**
+ * @brief Initiate a spi transfer
+ *
+ * In offload mode, the commands and the data are stored in the offload
+ * memories. Otherwise they are run and the end of the transfer is waited.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Structure used to store the transfer messages
+ * @param cmds Engine commands, without the final SYNC
+ * @param no_cmds Number of commands
+ * @param tx Words written on SDO
+ * @param tx_words Number of words in tx
+ * @param rx Words read from SDI, may be NULL if rx_words is 0
+ * @param rx_words Number of words read
  * @return int32_t This function allways returns SUCCESS
  */
-static int32_t spi_engine_compile_message(struct spi_desc *desc,
-		struct spi_engine_msg *msg)
+static int32_t spi_engine_transfer_message(struct spi_desc *desc,
+		const uint32_t *cmds,
+		uint32_t no_cmds,
+		const uint32_t *tx,
+		uint32_t tx_words,
+		uint32_t *rx,
+		uint32_t rx_words)
 {
+	uint32_t		i;
 	struct spi_engine_desc	*desc_extra;
 
 	desc_extra = desc->extra;
 
-	/* Configure the prescaler */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_REG_CLK_DIV,
-					    desc_extra->clk_div));
+	if (desc_extra->offload_config & (OFFLOAD_TX_EN | OFFLOAD_RX_EN)) {
+		for (i = 0; i < no_cmds; i++)
+			spi_engine_write(desc_extra,
+					 SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+					 cmds[i]);
+		spi_engine_write(desc_extra, SPI_ENGINE_REG_OFFLOAD_CMD_MEM(0),
+				 SPI_ENGINE_CMD_SYNC(_sync_id));
+		for (i = 0; i < tx_words; i++)
+			spi_engine_write(desc_extra,
+					 SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0),
+					 tx[i]);
 
-	/* Set the data transfer length */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_DATA_TRANSFER_LEN,
-					    desc_extra->data_width));
-	/*
-	 * Configure the spi mode :
-	 *	- 3 wire
-	 *	- CPOL
-	 *	- CPHA
-	 */
-	spi_engine_queue_append_cmd(&msg->cmds,
-				    SPI_ENGINE_CMD_CONFIG(
-					    SPI_ENGINE_CMD_REG_CONFIG,
-					    desc->mode));
+		return SUCCESS;
+	}
 
-	/* Add a sync command to signal that the transfer has finished */
-	spi_engine_queue_add_cmd(&msg->cmds, SPI_ENGINE_CMD_SYNC(_sync_id));
+	spi_engine_pump(desc_extra, cmds, no_cmds, tx, tx_words, rx, rx_words);
+	spi_engine_sync(desc_extra);
 
 	return SUCCESS;
 }
 
 /**
- * @brief Initiate a spi transfer
+ * @brief Disable the offload module before a direct access
+ *
+ * @param desc Decriptor containing SPI Engine's parameters
+ */
+static void spi_engine_offload_disable(struct spi_engine_desc *desc)
+{
+	if (desc->offload_config == OFFLOAD_DISABLED)
+		return;
+
+	/* This is set in spi_engine_offload_init() */
+	desc->offload_config = OFFLOAD_DISABLED;
+	/* This is set in spi_engine_offload_transfer() */
+	spi_engine_write(desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
+}
+
+/**
+ * @brief Compile a message, to be transferred any number of times with
+ * 	spi_engine_msg_transfer()
+ *
+ * The prescaler, data width and mode are the ones set when compiling, so the
+ * message must be compiled again after changing them.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Structure used to store the transfer messages
- * @return int32_t - SUCCESS if the transfer finished
- *		   - FAILURE if the memory allocation failed
+ * @param commands Message commands (WRITE, READ, WRITE_READ, CS_LOW, ...)
+ * @param no_commands Number of commands
+ * @param msg The compiled message
+ * @return int32_t - SUCCESS if the message is compiled
+ *		   - FAILURE if the memory allocation failed or a command is
+ *		     invalid
  */
-static int32_t spi_engine_transfer_message(struct spi_desc *desc,
-		struct spi_engine_msg *msg)
+int32_t spi_engine_msg_compile(struct spi_desc *desc,
+			       const uint32_t *commands,
+			       uint32_t no_commands,
+			       struct spi_engine_compiled_msg **msg)
 {
-	uint32_t		i;
-	uint32_t		data;
-	uint32_t		sync_id;
-	bool 			offload_en;
-	struct spi_engine_desc	*desc_extra;
+	struct spi_engine_compiled_msg	*lmsg;
+	uint32_t			i;
+	int32_t				ret;
 
-	desc_extra = desc->extra;
+	if (!desc || !commands || !msg)
+		return FAILURE;
 
-	spi_engine_compile_message(desc, msg);
+	lmsg = calloc(1, sizeof(*lmsg));
+	if (!lmsg)
+		return FAILURE;
 
-	offload_en = (desc_extra->offload_config & OFFLOAD_TX_EN) |
-		     (desc_extra->offload_config & OFFLOAD_RX_EN);
+	lmsg->cmds = calloc(no_commands + SPI_ENGINE_CONFIG_CMDS,
+			    sizeof(*lmsg->cmds));
+	if (!lmsg->cmds) {
+		free(lmsg);
+		return FAILURE;
+	}
 
-	/* Write the command fifo buffer */
-	while(msg->cmds != NULL) {
-		spi_engine_queue_get_cmd(&msg->cmds, &data);
-		spi_engine_write_cmd(desc, data);
+	lmsg->no_cmds = spi_engine_config_cmds(desc, lmsg->cmds);
+	for (i = 0; i < no_commands; i++) {
+		ret = spi_engine_compile_cmd(desc, commands[i],
+					     &lmsg->cmds[lmsg->no_cmds++],
+					     &lmsg->tx_words, &lmsg->rx_words);
+		if (IS_ERR_VALUE(ret)) {
+			spi_engine_msg_remove(lmsg);
+			return ret;
+		}
 	}
 
-	/* Write a number of tx_length WORDS on the SDO line */
+	*msg = lmsg;
 
-	if(offload_en) {
-		for(i = 0; i < desc_extra->offload_tx_len; i++)
-			spi_engine_write(desc_extra,
-					 SPI_ENGINE_REG_OFFLOAD_SDO_MEM(0),
-					 msg->tx_buf[i]);
+	return SUCCESS;
+}
 
-	} else {
-		for(i = 0; i < msg->length; i++)
-			spi_engine_write(desc_extra,
-					 SPI_ENGINE_REG_SDO_DATA_FIFO,
-					 msg->tx_buf[i]);
-		do {
-			spi_engine_read(desc_extra,
-					SPI_ENGINE_REG_SYNC_ID,
-					&sync_id);
-		}
-		/* Wait for the end sync signal */
-		while(sync_id != _sync_id);
-		_sync_id++;
-
-		/* Read a number of rx_length WORDS from the SDI line and store
-		them */
-		for(i = 0; i < msg->length; i++) {
-			spi_engine_read(desc_extra,
-					SPI_ENGINE_REG_SDI_DATA_FIFO,
-					&data);
-			msg->rx_buf[i] = data;
-		}
-	}
+/**
+ * @brief Transfer a compiled message
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param msg Message compiled by spi_engine_msg_compile()
+ * @param tx msg->tx_words words written on SDO
+ * @param rx Buffer for the msg->rx_words words read from SDI
+ * @return int32_t - SUCCESS if the transfer finished
+ *		   - FAILURE if the parameters are invalid
+ */
+int32_t spi_engine_msg_transfer(struct spi_desc *desc,
+				const struct spi_engine_compiled_msg *msg,
+				const uint32_t *tx,
+				uint32_t *rx)
+{
+	if (!desc || !msg || (msg->tx_words && !tx) || (msg->rx_words && !rx))
+		return FAILURE;
+
+	spi_engine_offload_disable(desc->extra);
+
+	return spi_engine_transfer_message(desc, msg->cmds, msg->no_cmds,
+					   tx, msg->tx_words,
+					   rx, msg->rx_words);
+}
+
+/**
+ * @brief Free the resources allocated by spi_engine_msg_compile()
+ *
+ * @param msg The compiled message
+ * @return int32_t This function allways returns SUCCESS
+ */
+int32_t spi_engine_msg_remove(struct spi_engine_compiled_msg *msg)
+{
+	if (!msg)
+		return SUCCESS;
+
+	free(msg->cmds);
+	free(msg);
 
 	return SUCCESS;
 }
@@ -638,10 +633,21 @@ int32_t spi_engine_init(struct spi_desc **desc,
 		return FAILURE;
 	}
 
-	eng_desc = (struct spi_engine_desc*)malloc(sizeof(*eng_desc));
+	eng_desc = (struct spi_engine_desc*)calloc(1, sizeof(*eng_desc));
 
-	if (!eng_desc)
+	if (!eng_desc) {
+		free(*desc);
 		return FAILURE;
+	}
+
+	/* Allocated once, so the transfers don't use the heap */
+	eng_desc->xfer_words = calloc(SPI_ENGINE_MAX_WORDS,
+				      sizeof(*eng_desc->xfer_words));
+	if (!eng_desc->xfer_words) {
+		free(eng_desc);
+		free(*desc);
+		return FAILURE;
+	}
 
 	spi_engine_init = param->extra;
 
@@ -672,98 +678,173 @@ int32_t spi_engine_init(struct spi_desc **desc,
 	/* Get current data width */
 	spi_engine_read(eng_desc, SPI_ENGINE_REG_VERSION, &spi_engine_version);
 
-	printf("Spi engine v%"PRIu32".%"PRIu32".%"PRIu32" succesfully initialized.\n",
-	       (spi_engine_version >> 16),
-	       ((spi_engine_version >> 8) & 0xFF),
-	       (spi_engine_version & 0xFF));
+	pr_print(LOG_INFO,
+		 "Spi engine v%"PRIu32".%"PRIu32".%"PRIu32" succesfully initialized.\n",
+		 (spi_engine_version >> 16),
+		 ((spi_engine_version >> 8) & 0xFF),
+		 (spi_engine_version & 0xFF));
 
 	return SUCCESS;
 }
 
 /**
- * @brief Write/read on the spi interface
+ * @brief Transfer a list of messages in a single engine command stream
+ *
+ * The chip select is asserted before the first message and deasserted after
+ * the messages with cs_change set and after the last one. The end of the
+ * whole stream is waited only once.
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param data Pointer to data buffer
- * @param bytes_number Number of bytes to transfer
+ * @param msgs Array of messages
+ * @param len Number of messages
  * @return int32_t - SUCCESS if the transfer finished
- *		   - FAILURE if the memory allocation or transfer failed
+ *		   - -EINVAL if the parameters are invalid
  */
-int32_t spi_engine_write_and_read(struct spi_desc *desc,
-				  uint8_t *data,
-				  uint16_t bytes_number)
+int32_t spi_engine_transfer(struct spi_desc *desc,
+			    struct spi_msg *msgs,
+			    uint32_t len)
 {
-	uint8_t 		i;
+	uint32_t		cmds[SPI_ENGINE_CONFIG_CMDS + 3];
+	uint32_t		no_cmds;
+	uint32_t		*words;
+	uint32_t		words_number;
+	uint32_t		chunk;
+	uint32_t		off;
+	uint32_t		i;
+	uint32_t		j;
+	uint8_t			flags;
 	uint8_t 		word_len;
-	uint8_t 		words_number;
-	int32_t 		ret;
-	struct spi_engine_msg	msg;
+	bool			cs_active;
 	struct spi_engine_desc	*desc_extra;
 
+	if (!desc || (!msgs && len))
+		return -EINVAL;
+
 	desc_extra = desc->extra;
+	words = desc_extra->xfer_words;
+	word_len = spi_get_word_lenght(desc_extra);
 
 	/* If we want to access SPI interface and SPI engine offload module was
-	 * activated, we need to disable it
-	 * This is set in spi_engine_offload_init() */
-	desc_extra->offload_config = OFFLOAD_DISABLED;
-	/* This is set in spi_engine_offload_transfer() */
-	spi_engine_write(desc_extra, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
-
-	words_number = spi_get_words_number(desc_extra, bytes_number);
-
-	msg.cmds = (spi_engine_cmd_queue*)malloc(sizeof(*msg.cmds));
-	if (!msg.cmds)
-		return FAILURE;
-
-	msg.tx_buf =(uint32_t*)calloc(words_number, sizeof(msg.tx_buf[0]));
-	msg.rx_buf =(uint32_t*)calloc(words_number, sizeof(msg.rx_buf[0]));
-	msg.length = words_number;
-
-	/* Get the length of transfered word */
-	word_len = spi_get_word_lenght(desc_extra);
+	 * activated, we need to disable it */
+	spi_engine_offload_disable(desc_extra);
 
+	no_cmds = spi_engine_config_cmds(desc, cmds);
 	/* Make sure the CS is HIGH before starting a transaction */
-	msg.cmds->next = NULL;
-	msg.cmds->cmd = CS_HIGH;
-	spi_engine_queue_add_cmd(&msg.cmds, CS_LOW);
-	spi_engine_queue_add_cmd(&msg.cmds, WRITE_READ(bytes_number));
-	spi_engine_queue_add_cmd(&msg.cmds, CS_HIGH);
+	cmds[no_cmds++] = spi_engine_cs_cmd(desc, true);
+	spi_engine_pump(desc_extra, cmds, no_cmds, NULL, 0, NULL, 0);
+
+	cs_active = false;
+	for (i = 0; i < len; i++) {
+		no_cmds = 0;
+		if (!cs_active) {
+			cmds[no_cmds++] = spi_engine_cs_cmd(desc, false);
+			cs_active = true;
+		}
 
-	/* Pack the bytes into engine WORDS */
-	for (i = 0; i < bytes_number; i++)
-		msg.tx_buf[i / word_len] |= data[i] << (desc_extra->data_width-
-							(i % word_len + 1) * 8);
+		/* If there is no tx buffer, 0x00 is sent unless only reading */
+		flags = 0;
+		if (msgs[i].tx_buff || !msgs[i].rx_buff)
+			flags |= SPI_ENGINE_INSTRUCTION_TRANSFER_W;
+		if (msgs[i].rx_buff)
+			flags |= SPI_ENGINE_INSTRUCTION_TRANSFER_R;
+
+		/* A transfer command moves at most SPI_ENGINE_MAX_WORDS words */
+		for (off = 0; off < msgs[i].bytes_number; off += chunk) {
+			chunk = min(msgs[i].bytes_number - off,
+				    (uint32_t)SPI_ENGINE_MAX_WORDS * word_len);
+			words_number = (chunk + word_len - 1) / word_len;
+			cmds[no_cmds++] = SPI_ENGINE_CMD_TRANSFER(flags,
+					  words_number - 1);
+
+			/* Pack the bytes into engine WORDS */
+			memset(words, 0, words_number * sizeof(*words));
+			if (msgs[i].tx_buff)
+				for (j = 0; j < chunk; j++)
+					words[j / word_len] |=
+						msgs[i].tx_buff[off + j] <<
+						(desc_extra->data_width -
+						 (j % word_len + 1) * 8);
+
+			spi_engine_pump(desc_extra, cmds, no_cmds,
+					words,
+					(flags & SPI_ENGINE_INSTRUCTION_TRANSFER_W) ?
+					words_number : 0,
+					words,
+					msgs[i].rx_buff ? words_number : 0);
+			no_cmds = 0;
+
+			if (msgs[i].rx_buff)
+				for (j = 0; j < chunk; j++)
+					msgs[i].rx_buff[off + j] =
+						words[j / word_len] >>
+						(desc_extra->data_width -
+						 (j % word_len + 1) * 8);
+		}
 
-	ret = spi_engine_transfer_message(desc, &msg);
+		if (msgs[i].cs_change || i == len - 1) {
+			cmds[no_cmds++] = spi_engine_cs_cmd(desc, true);
+			cs_active = false;
+		}
+		spi_engine_pump(desc_extra, cmds, no_cmds, NULL, 0, NULL, 0);
+	}
 
-	for (i = 0; i < bytes_number; i++)
-		data[i] = msg.rx_buf[(i) / word_len] >>
-			  (desc_extra->data_width -
-			   ((i) % word_len + 1) * 8);
+	spi_engine_sync(desc_extra);
 
-	spi_engine_queue_free(&msg.cmds);
-	free(msg.tx_buf);
-	free(msg.rx_buf);
+	return SUCCESS;
+}
 
-	return ret;
+/**
+ * @brief Write/read on the spi interface
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param data Pointer to data buffer
+ * @param bytes_number Number of bytes to transfer
+ * @return int32_t - SUCCESS if the transfer finished
+ *		   - FAILURE if the transfer failed
+ */
+int32_t spi_engine_write_and_read(struct spi_desc *desc,
+				  uint8_t *data,
+				  uint16_t bytes_number)
+{
+	struct spi_msg msg = {
+		.tx_buff = data,
+		.rx_buff = data,
+		.bytes_number = bytes_number,
+		.cs_change = 1,
+	};
+
+	return spi_engine_transfer(desc, &msg, 1);
 }
 
 /**
  * @brief Initialize the SPI engine's offload module
  *
+ * The DMACs of a previous initialization are removed first, so the function
+ * can be called before each offload transfer.
+ *
  * @param desc Decriptor containing SPI interface parameters
  * @param param Structure containing the offload init parameters
- * @return int32_t This function allways returns SUCCESS
+ * @return int32_t - SUCCESS if the DMACs are initialized
+ *		   - FAILURE otherwise
  */
 int32_t spi_engine_offload_init(struct spi_desc *desc,
 				const struct spi_engine_offload_init_param *param)
 {
 	struct spi_engine_desc	*eng_desc;
-	struct axi_dmac_init	dmac_init;
+	struct axi_dmac_init	dmac_init = { 0 };
 	uint32_t dma_flags;
 
 	eng_desc = desc->extra;
 
+	if (eng_desc->offload_tx_dma) {
+		axi_dmac_remove(eng_desc->offload_tx_dma);
+		eng_desc->offload_tx_dma = NULL;
+	}
+	if (eng_desc->offload_rx_dma) {
+		axi_dmac_remove(eng_desc->offload_rx_dma);
+		eng_desc->offload_rx_dma = NULL;
+	}
+
 	eng_desc->offload_config = param->offload_config;
 
 	if(!(param->dma_flags))
@@ -773,6 +854,8 @@ int32_t spi_engine_offload_init(struct spi_desc *desc,
 
 	if(param->offload_config & OFFLOAD_TX_EN) {
 		dmac_init.name = "DAC DMAC";
+		dmac_init.irq_ctrl = NULL;
+		dmac_init.timer = NULL;
 		dmac_init.base = param->tx_dma_baseaddr;
 		dmac_init.direction = DMA_MEM_TO_DEV;
 		dmac_init.flags = dma_flags;
@@ -782,6 +865,9 @@ int32_t spi_engine_offload_init(struct spi_desc *desc,
 	}
 	if(param->offload_config & OFFLOAD_RX_EN) {
 		dmac_init.name = "ADC DMAC";
+		dmac_init.irq_ctrl = param->irq_ctrl;
+		dmac_init.irq_id = param->rx_dma_irq_id;
+		dmac_init.timer = NULL;
 		dmac_init.base = param->rx_dma_baseaddr;
 		dmac_init.direction = DMA_DEV_TO_MEM;
 		dmac_init.flags = dma_flags;
@@ -794,21 +880,21 @@ int32_t spi_engine_offload_init(struct spi_desc *desc,
 }
 
 /**
- * @brief Initiate a SPI transfer in offload mode
+ * @brief Load a message in the offload module, to be transferred on each
+ * 	offload trigger
  *
  * @param desc Decriptor containing SPI interface parameters
- * @param msg Offload message that get's to be transferred
- * @param no_samples Number of time the messages will be transferred
- * @return int32_t This function allways returns SUCCESS
+ * @param msg Offload message
+ * @return int32_t - SUCCESS if the message is loaded
+ *		   - FAILURE if the offload is disabled or the message is invalid
  */
-int32_t spi_engine_offload_transfer(struct spi_desc *desc,
-				    struct spi_engine_offload_message msg,
-				    uint32_t no_samples)
+static int32_t spi_engine_offload_load(struct spi_desc *desc,
+				       const struct spi_engine_offload_message *msg)
 {
-	struct spi_engine_msg	transfer;
-	struct spi_engine_desc	*eng_desc;
-	uint32_t 		i;
-	uint8_t 		word_length;
+	struct spi_engine_compiled_msg	*transfer;
+	struct spi_engine_desc		*eng_desc;
+	uint32_t 			i;
+	int32_t				ret;
 
 	eng_desc = desc->extra;
 
@@ -823,45 +909,278 @@ int32_t spi_engine_offload_transfer(struct spi_desc *desc,
 	eng_desc->offload_tx_len = 0;
 	eng_desc->offload_rx_len = 0;
 
-	transfer.cmds = (spi_engine_cmd_queue*)malloc(sizeof(*transfer.cmds));
+	ret = spi_engine_msg_compile(desc, msg->commands, msg->no_commands,
+				     &transfer);
+	if (IS_ERR_VALUE(ret))
+		return ret;
 
-	if (!transfer.cmds)
-		return FAILURE;
+	/* Number of words of all the transfers of a sample */
+	for (i = SPI_ENGINE_CONFIG_CMDS; i < transfer->no_cmds; i++)
+		if (((transfer->cmds[i] >> 12) & 0x0F) ==
+		    SPI_ENGINE_INST_TRANSFER)
+			eng_desc->offload_tx_len += (transfer->cmds[i] & 0xFF) + 1;
 
-	transfer.tx_buf = msg.commands_data;
+	spi_engine_transfer_message(desc, transfer->cmds, transfer->no_cmds,
+				    msg->commands_data,
+				    eng_desc->offload_tx_len, NULL, 0);
 
-	/* Load the commands into the message */
-	transfer.cmds->next = NULL;
-	transfer.cmds->cmd = msg.commands[0];
-	i = 1;
-	while(i < msg.no_commands) {
-		spi_engine_queue_add_cmd(&transfer.cmds, msg.commands[i++]);
+	spi_engine_msg_remove(transfer);
 
-	}
+	return SUCCESS;
+}
+
+/**
+ * @brief Initiate a SPI transfer in offload mode
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param msg Offload message that get's to be transferred
+ * @param no_samples Number of time the messages will be transferred
+ * @return int32_t - SUCCESS if the transfer was started
+ *		   - FAILURE if the offload is disabled or the message is invalid
+ *		   - the error of the DMA transfer otherwise
+ */
+int32_t spi_engine_offload_transfer(struct spi_desc *desc,
+				    struct spi_engine_offload_message msg,
+				    uint32_t no_samples)
+{
+	struct spi_engine_desc		*eng_desc;
+	uint8_t 			word_length;
+	int32_t				ret;
+
+	eng_desc = desc->extra;
 
-	spi_engine_transfer_message(desc, &transfer);
+	ret = spi_engine_offload_load(desc, &msg);
+	if (IS_ERR_VALUE(ret))
+		return ret;
 
 	/* Start transfer */
 	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x0001);
 
 	word_length = spi_get_word_lenght(eng_desc);
 	if(eng_desc->offload_config & OFFLOAD_TX_EN) {
-		axi_dmac_transfer(eng_desc->offload_tx_dma,
-				  msg.tx_addr,
-				  word_length * eng_desc->offload_tx_len *
-				  no_samples);
+		ret = axi_dmac_transfer(eng_desc->offload_tx_dma,
+					msg.tx_addr,
+					word_length * eng_desc->offload_tx_len *
+					no_samples);
+		if (IS_ERR_VALUE(ret))
+			return ret;
 	}
 
 	if(eng_desc->offload_config & OFFLOAD_RX_EN) {
-		axi_dmac_transfer(eng_desc->offload_rx_dma,
-				  msg.rx_addr,
-				  word_length * eng_desc->offload_tx_len *
-				  no_samples);
+		ret = axi_dmac_transfer(eng_desc->offload_rx_dma,
+					msg.rx_addr,
+					word_length * eng_desc->offload_tx_len *
+					no_samples);
+		if (IS_ERR_VALUE(ret))
+			return ret;
 	}
 
 	usleep(1000);
 
-	spi_engine_queue_free(&transfer.cmds);
+	return SUCCESS;
+}
+
+/**
+ * @brief Completion callback of a stream buffer, called from the DMA interrupt
+ *
+ * @param ctx The stream buffer
+ * @param dma The DMA descriptor of the buffer
+ */
+static void spi_engine_stream_done(void *ctx, struct axi_dmac_desc *dma)
+{
+	struct spi_engine_stream_buff	*buff = ctx;
+	struct spi_engine_stream	*stream = buff->stream;
+	bool				idle;
+
+	buff->no_samples = stream->buff_samples;
+	buff->seq = stream->produced;
+	buff->overrun = stream->starved;
+	stream->starved = false;
+
+	/*
+	 * No buffer left in the DMA: the offload keeps being triggered and
+	 * the samples are lost until a buffer is given back.
+	 */
+	axi_dmac_queue_is_idle(stream->dma, &idle);
+	if (idle) {
+		stream->starved = true;
+		stream->overruns++;
+	}
+
+	if (stream->dcache_invalidate_range)
+		stream->dcache_invalidate_range(dma->address, dma->x_length);
+
+	stream->produced++;
+
+	if (stream->callback) {
+		stream->callback(stream->ctx, buff);
+		buff->no_samples = 0;
+		stream->consumed++;
+		axi_dmac_submit(stream->dma, dma);
+	}
+}
+
+/**
+ * @brief Start streaming offload transfers into a ring of buffers
+ *
+ * The offload module must be initialized with OFFLOAD_RX_EN. The buffers are
+ * queued to the RX DMA and filled in order. A filled buffer is handed to the
+ * callback or, without callback, taken with spi_engine_stream_get() and given
+ * back with spi_engine_stream_release().
+ *
+ * @param desc Decriptor containing SPI interface parameters
+ * @param param Stream parameters
+ * @param stream The stream
+ * @return int32_t - SUCCESS if the stream is started
+ *		   - FAILURE otherwise
+ */
+int32_t spi_engine_stream_start(struct spi_desc *desc,
+				const struct spi_engine_stream_init_param *param,
+				struct spi_engine_stream **stream)
+{
+	struct spi_engine_stream	*lstream;
+	struct spi_engine_desc		*eng_desc;
+	struct spi_engine_stream_buff	*buff;
+	uint32_t			buff_bytes;
+	uint32_t			i;
+	int32_t				ret;
+
+	if (!desc || !param || !param->msg || !stream ||
+	    param->no_buffs < 2 || !param->buff_samples)
+		return FAILURE;
+
+	eng_desc = desc->extra;
+	if (!(eng_desc->offload_config & OFFLOAD_RX_EN) ||
+	    !eng_desc->offload_rx_dma)
+		return FAILURE;
+
+	lstream = calloc(1, sizeof(*lstream));
+	if (!lstream)
+		return FAILURE;
+
+	lstream->buffs = calloc(param->no_buffs, sizeof(*lstream->buffs));
+	if (!lstream->buffs) {
+		ret = FAILURE;
+		goto error;
+	}
+
+	ret = spi_engine_offload_load(desc, param->msg);
+	if (IS_ERR_VALUE(ret))
+		goto error;
+
+	lstream->spi = desc;
+	lstream->dma = eng_desc->offload_rx_dma;
+	lstream->no_buffs = param->no_buffs;
+	lstream->buff_samples = param->buff_samples;
+	lstream->sample_bytes = spi_get_word_lenght(eng_desc) *
+				eng_desc->offload_tx_len;
+	lstream->callback = param->callback;
+	lstream->ctx = param->ctx;
+	lstream->dcache_invalidate_range = param->dcache_invalidate_range;
+
+	buff_bytes = lstream->sample_bytes * lstream->buff_samples;
+	for (i = 0; i < lstream->no_buffs; i++) {
+		buff = &lstream->buffs[i];
+		buff->addr = param->addr + i * buff_bytes;
+		buff->stream = lstream;
+		buff->dma.address = buff->addr;
+		buff->dma.x_length = buff_bytes;
+		buff->dma.callback = spi_engine_stream_done;
+		buff->dma.ctx = buff;
+		ret = axi_dmac_submit(lstream->dma, &buff->dma);
+		if (IS_ERR_VALUE(ret)) {
+			axi_dmac_queue_abort(lstream->dma);
+			goto error;
+		}
+	}
+
+	/* Start transfer */
+	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0x0001);
+
+	*stream = lstream;
+
+	return SUCCESS;
+
+error:
+	free(lstream->buffs);
+	free(lstream);
+
+	return ret;
+}
+
+/**
+ * @brief Get the oldest filled buffer of a stream
+ *
+ * Only valid for streams without callback. Without DMA interrupt, the DMA is
+ * polled for completed buffers.
+ *
+ * @param stream The stream
+ * @param buff The buffer, to be given back with spi_engine_stream_release()
+ * @return int32_t - SUCCESS if a buffer is returned
+ *		   - -EAGAIN if no buffer is filled yet
+ *		   - FAILURE if the stream uses a callback
+ */
+int32_t spi_engine_stream_get(struct spi_engine_stream *stream,
+			      struct spi_engine_stream_buff **buff)
+{
+	if (!stream || !buff || stream->callback)
+		return FAILURE;
+
+	if (!stream->dma->irq_ctrl)
+		axi_dmac_default_isr(stream->dma);
+
+	if (stream->produced == stream->consumed)
+		return -EAGAIN;
+
+	*buff = &stream->buffs[stream->consumed % stream->no_buffs];
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Give the buffer returned by spi_engine_stream_get() back to the DMA
+ *
+ * @param stream The stream
+ * @return int32_t - SUCCESS if the buffer was queued again
+ *		   - FAILURE if no buffer is taken
+ */
+int32_t spi_engine_stream_release(struct spi_engine_stream *stream)
+{
+	struct spi_engine_stream_buff	*buff;
+
+	if (!stream || stream->callback || stream->produced == stream->consumed)
+		return FAILURE;
+
+	buff = &stream->buffs[stream->consumed % stream->no_buffs];
+	buff->no_samples = 0;
+	stream->consumed++;
+
+	return axi_dmac_submit(stream->dma, &buff->dma);
+}
+
+/**
+ * @brief Stop a stream and free its resources
+ *
+ * The buffers not handed out yet are dropped.
+ *
+ * @param stream The stream
+ * @return int32_t - SUCCESS if the stream is stopped
+ *		   - FAILURE if the stream is NULL
+ */
+int32_t spi_engine_stream_stop(struct spi_engine_stream *stream)
+{
+	struct spi_engine_desc	*eng_desc;
+
+	if (!stream)
+		return FAILURE;
+
+	eng_desc = stream->spi->extra;
+
+	spi_engine_write(eng_desc, SPI_ENGINE_REG_OFFLOAD_CTRL(0), 0);
+	axi_dmac_queue_abort(stream->dma);
+
+	free(stream->buffs);
+	free(stream);
 
 	return SUCCESS;
 }
@@ -878,10 +1197,11 @@ int32_t spi_engine_remove(struct spi_desc *desc)
 
 	eng_desc = desc->extra;
 
-	if(eng_desc->offload_config & OFFLOAD_TX_EN)
+	if (eng_desc->offload_tx_dma)
 		axi_dmac_remove(eng_desc->offload_tx_dma);
-	if(eng_desc->offload_config & OFFLOAD_RX_EN)
+	if (eng_desc->offload_rx_dma)
 		axi_dmac_remove(eng_desc->offload_rx_dma);
+	free(eng_desc->xfer_words);
 	free(desc->extra);
 	free(desc);
 
@@ -48,6 +48,7 @@
 
 #include "spi_extra.h"
 #include "spi_engine_private.h"
+#include "axi_dmac.h"
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -60,6 +61,11 @@
 
 #define SPI_ENGINE_MSG_QUEUE_END	0xFFFFFFFF
 
+/* Number of CONFIG commands starting each message */
+#define SPI_ENGINE_CONFIG_CMDS		3
+/* Maximum number of words of a transfer command */
+#define SPI_ENGINE_MAX_WORDS		256
+
 /* Spi engine commands */
 #define	WRITE(no_bytes)			((SPI_ENGINE_INST_TRANSFER << 12) |\
 	(SPI_ENGINE_INSTRUCTION_TRANSFER_W << 8) | no_bytes)
@@ -132,6 +138,8 @@ struct spi_engine_desc {
 	uint8_t			data_width;
 	/** The maximum data width supported by the engine */
 	uint8_t 		max_data_width;
+	/** Words of spi_engine_transfer(), allocated once */
+	uint32_t		*xfer_words;
 };
 
 
@@ -148,6 +156,11 @@ struct spi_engine_offload_init_param {
 	uint32_t	*dma_flags;
 	/** Offload's module transfer direction : TX, RX or both */
 	uint8_t		offload_config;
+	/** Controller of the RX DMAC interrupt, needed for streaming. If NULL,
+	 * the stream is polled by spi_engine_stream_get() */
+	struct irq_ctrl_desc	*irq_ctrl;
+	/** RX DMAC interrupt ID, used when irq_ctrl is set */
+	uint32_t	rx_dma_irq_id;
 };
 
 /**
@@ -170,6 +183,100 @@ struct spi_engine_offload_message {
 	uint32_t rx_addr;
 };
 
+/**
+ * @struct spi_engine_compiled_msg
+ * @brief  Message compiled once by spi_engine_msg_compile() and transferred
+ * any number of times
+ */
+struct spi_engine_compiled_msg {
+	/** Engine commands, configuration included, without the final SYNC */
+	uint32_t	*cmds;
+	/** Number of engine commands */
+	uint32_t	no_cmds;
+	/** Number of words written on SDO by the message */
+	uint32_t	tx_words;
+	/** Number of words read from SDI by the message */
+	uint32_t	rx_words;
+};
+
+struct spi_engine_stream;
+
+/**
+ * @struct spi_engine_stream_buff
+ * @brief  Buffer of an offload stream
+ */
+struct spi_engine_stream_buff {
+	/** Memory address of the buffer */
+	uint32_t	addr;
+	/** Number of samples in the buffer, 0 while it is being filled */
+	uint32_t	no_samples;
+	/** Index of the buffer in the stream, counting from 0 */
+	uint32_t	seq;
+	/** Samples were lost between the previous buffer and this one */
+	bool		overrun;
+	/** DMA descriptor of the buffer, used internally */
+	struct axi_dmac_desc	dma;
+	/** Stream the buffer belongs to, used internally */
+	struct spi_engine_stream	*stream;
+};
+
+/**
+ * @struct spi_engine_stream_init_param
+ * @brief  Structure containing the parameters of an offload stream
+ */
+struct spi_engine_stream_init_param {
+	/** Message transferred on each offload trigger. Only the commands and
+	 * commands_data fields are used */
+	struct spi_engine_offload_message	*msg;
+	/** Address of the ring memory, no_buffs * buff_samples samples */
+	uint32_t	addr;
+	/** Number of buffers of the ring, at least 2 */
+	uint32_t	no_buffs;
+	/** Number of samples of a buffer */
+	uint32_t	buff_samples;
+	/** Called from the DMA interrupt with each filled buffer, which is
+	 * given back to the DMA when the callback returns. If NULL, the
+	 * buffers are taken with spi_engine_stream_get() */
+	void		(*callback)(void *ctx, struct spi_engine_stream_buff *buff);
+	/** Parameter passed to the callback */
+	void		*ctx;
+	/** Invalidate a filled buffer before handing it out (optional) */
+	void		(*dcache_invalidate_range)(uint32_t address,
+			uint32_t bytes_count);
+};
+
+/**
+ * @struct spi_engine_stream
+ * @brief  Offload stream, chaining the offload triggered DMA transfers into a
+ * ring of buffers
+ */
+struct spi_engine_stream {
+	/** SPI descriptor the stream runs on */
+	struct spi_desc		*spi;
+	/** RX DMAC of the offload module */
+	struct axi_dmac		*dma;
+	/** Ring buffers */
+	struct spi_engine_stream_buff	*buffs;
+	/** Number of buffers of the ring */
+	uint32_t		no_buffs;
+	/** Number of samples of a buffer */
+	uint32_t		buff_samples;
+	/** Number of bytes of a sample */
+	uint32_t		sample_bytes;
+	/** Buffers filled, written from the DMA interrupt only */
+	volatile uint32_t	produced;
+	/** Buffers given back to the DMA, written by the consumer only */
+	volatile uint32_t	consumed;
+	/** Number of times the DMA ran out of buffers */
+	volatile uint32_t	overruns;
+	/** The DMA ran out of buffers, reported with the next buffer */
+	volatile bool		starved;
+	void		(*callback)(void *ctx, struct spi_engine_stream_buff *buff);
+	void		*ctx;
+	void		(*dcache_invalidate_range)(uint32_t address,
+			uint32_t bytes_count);
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -197,6 +304,26 @@ int32_t spi_engine_write_and_read(struct spi_desc *desc,
 				  uint8_t *data,
 				  uint16_t bytes_number);
 
+/* Transfer a list of messages in a single engine command stream */
+int32_t spi_engine_transfer(struct spi_desc *desc,
+			    struct spi_msg *msgs,
+			    uint32_t len);
+
+/* Compile a message, to be transferred any number of times */
+int32_t spi_engine_msg_compile(struct spi_desc *desc,
+			       const uint32_t *commands,
+			       uint32_t no_commands,
+			       struct spi_engine_compiled_msg **msg);
+
+/* Transfer a compiled message */
+int32_t spi_engine_msg_transfer(struct spi_desc *desc,
+				const struct spi_engine_compiled_msg *msg,
+				const uint32_t *tx,
+				uint32_t *rx);
+
+/* Free the resources allocated by spi_engine_msg_compile() */
+int32_t spi_engine_msg_remove(struct spi_engine_compiled_msg *msg);
+
 /* Free the resources used by the SPI engine device */
 int32_t spi_engine_remove(struct spi_desc *desc);
 
@@ -209,6 +336,21 @@ int32_t spi_engine_offload_transfer(struct spi_desc *desc,
 				    struct spi_engine_offload_message msg,
 				    uint32_t no_samples);
 
+/* Start streaming offload transfers into a ring of buffers */
+int32_t spi_engine_stream_start(struct spi_desc *desc,
+				const struct spi_engine_stream_init_param *param,
+				struct spi_engine_stream **stream);
+
+/* Get the oldest filled buffer of a stream */
+int32_t spi_engine_stream_get(struct spi_engine_stream *stream,
+			      struct spi_engine_stream_buff **buff);
+
+/* Give the buffer returned by spi_engine_stream_get() back to the DMA */
+int32_t spi_engine_stream_release(struct spi_engine_stream *stream);
+
+/* Stop a stream and free its resources */
+int32_t spi_engine_stream_stop(struct spi_engine_stream *stream);
+
 /* Set SPI transfer width */
 int32_t spi_engine_set_transfer_width(struct spi_desc *desc,
 				      uint8_t data_wdith);
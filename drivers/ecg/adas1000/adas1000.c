@@ -407,15 +407,23 @@ int32_t adas1000_read_data(struct adas1000_dev *device, uint8_t *data_buff,
 uint32_t adas1000_compute_frame_crc(struct adas1000_dev * device, uint8_t *buff)
 {
 	uint32_t crc = 0xFFFFFFFFul;
+	static bool crc16_ready, crc24_ready;
 
 	/** Select the CRC poly and word size based on the frame rate. */
 	if(device->frame_rate == ADAS1000_128KHZ_FRAME_RATE) {
-		DECLARE_CRC16_TABLE(adas1000_crc16);
-		crc16_populate_msb(adas1000_crc16, CRC_POLY_128KHZ);
-		return crc16(adas1000_crc16, buff, device->frame_size, (uint16_t)crc);
+		DECLARE_CRC16_SLICE_TABLE(adas1000_crc16);
+		if (!crc16_ready) {
+			crc16_populate_msb_slice(adas1000_crc16, CRC_POLY_128KHZ);
+			crc16_ready = true;
+		}
+		return crc16_slice(adas1000_crc16, buff, device->frame_size,
+				   (uint16_t)crc);
 	} else {
-		DECLARE_CRC24_TABLE(adas1000_crc24);
-		crc24_populate_msb(adas1000_crc24, CRC_POLY_2KHZ_16KHZ);
-		return crc24(adas1000_crc24, buff, device->frame_size, crc);
+		DECLARE_CRC24_SLICE_TABLE(adas1000_crc24);
+		if (!crc24_ready) {
+			crc24_populate_msb_slice(adas1000_crc24, CRC_POLY_2KHZ_16KHZ);
+			crc24_ready = true;
+		}
+		return crc24_slice(adas1000_crc24, buff, device->frame_size, crc);
 	}
 }
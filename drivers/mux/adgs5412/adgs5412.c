@@ -44,6 +44,7 @@
 #include <stdlib.h>
 #include "adgs5412.h"
 #include "error.h"
+#include "crc8.h"
 
 /******************************************************************************/
 /************************** Functions Implementation **************************/
@@ -57,22 +58,8 @@
 uint8_t adgs5412_compute_crc8(uint8_t *data,
 			      uint8_t data_size)
 {
-	uint8_t i;
-	uint8_t crc = 0;
-
-	while (data_size) {
-		for (i = 0x80; i != 0; i >>= 1) {
-			if (((crc & 0x80) != 0) != ((*data & i) != 0)) {
-				crc <<= 1;
-				crc ^= ADGS5412_CRC8_POLY;
-			} else
-				crc <<= 1;
-		}
-		data++;
-		data_size--;
-	}
-
-	return crc;
+	/* ADGS5412_CRC8_POLY */
+	return crc8_slice(crc8_poly07_table, data, data_size, 0);
 }
 
 /**
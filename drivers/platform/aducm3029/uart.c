@@ -47,6 +47,9 @@
 #include "irq.h"
 #include "uart_extra.h"
 #include "util.h"
+#ifdef ENABLE_UART_RX_RING
+#include "uart_rx.h"
+#endif
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
@@ -110,6 +113,8 @@ struct aducm_uart_desc {
 	struct op_desc	write_desc;
 	/** Status of a read operation */
 	struct op_desc	read_desc;
+	/** Receive ring, NULL if the application submits its own buffers */
+	struct uart_rx	*rx;
 };
 
 /******************************************************************************/
@@ -202,6 +207,25 @@ static void free_desc_mem(struct uart_desc *desc)
 	free(desc);
 }
 
+#ifdef ENABLE_UART_RX_RING
+/**
+ * @brief Submit the next byte of the receive ring to the UART driver.
+ *
+ * The ADI UART driver only reports full buffers, so the ring is filled one
+ * byte per interrupt.
+ * @param extra:	Platform specific UART descriptor
+ */
+static void uart_rx_arm(struct aducm_uart_desc *extra)
+{
+	uint8_t		*buff;
+	uint32_t	len;
+
+	uart_rx_fill_get(extra->rx, 1, &buff, &len);
+	adi_uart_SubmitRxBuffer((ADI_UART_HANDLE const)extra->uart_handler,
+				(void *const)buff, (uint32_t const)len, false);
+}
+#endif
+
 /**
  * @brief Call the user defined callback when a read/write operation completed
  * @param desc:		Descriptor of the UART device
@@ -217,6 +241,13 @@ static void uart_callback(void *ctx, uint32_t event, void *buff)
 	switch(event) {
 	/* Read done */
 	case ADI_UART_EVENT_RX_BUFFER_PROCESSED:
+#ifdef ENABLE_UART_RX_RING
+		if (extra->rx) {
+			uart_rx_fill_done(extra->rx, 1);
+			uart_rx_arm(extra);
+			break;
+		}
+#endif
 		if (extra->read_desc.pending) {
 			len = min(extra->read_desc.pending, MAX_BYTES);
 			extra->read_desc.pending -= len;
@@ -253,6 +284,10 @@ static void uart_callback(void *ctx, uint32_t event, void *buff)
 		break;
 	default:
 		extra->errors |= (uint32_t)buff;
+#ifdef ENABLE_UART_RX_RING
+		if (extra->rx)
+			uart_rx_error(extra->rx);
+#endif
 		extra->read_desc.is_nonblocking = false;
 		extra->write_desc.is_nonblocking = false;
 		if (desc->callback)
@@ -285,6 +320,15 @@ int32_t uart_read(struct uart_desc *desc, uint8_t *data,
 		goto failure;
 	}
 
+#ifdef ENABLE_UART_RX_RING
+	if (extra->rx) {
+		if (uart_rx_read(extra->rx, data, bytes_number) != SUCCESS)
+			return FAILURE;
+
+		return bytes_number;
+	}
+#endif
+
 	/* Wait until a previously uart_read_nonblocking ends */
 	while (extra->read_desc.is_nonblocking)
 		;
@@ -373,7 +417,7 @@ int32_t uart_read_nonblocking(struct uart_desc *desc, uint8_t *data,
 	extra = desc->extra;
 
 	/* Driver can not submit an other buffer when there is already one */
-	if (extra->read_desc.is_nonblocking)
+	if (extra->read_desc.is_nonblocking || extra->rx)
 		return FAILURE;
 	extra->read_desc.is_nonblocking = true;
 
@@ -494,6 +538,15 @@ int32_t uart_init(struct uart_desc **desc, struct uart_init_param *param)
 	adi_uart_RegisterCallback(aducm_desc->uart_handler, uart_callback,
 				  *desc);
 
+#ifdef ENABLE_UART_RX_RING
+	if (aducm_init_param->rx_ring_size) {
+		if (uart_rx_init(&aducm_desc->rx,
+				 aducm_init_param->rx_ring_size) != SUCCESS)
+			goto failure;
+		uart_rx_arm(aducm_desc);
+	}
+#endif
+
 	return SUCCESS;
 failure:
 	free_desc_mem(*desc);
@@ -517,6 +570,9 @@ int32_t uart_remove(struct uart_desc *desc)
 
 	aducm_desc = desc->extra;
 	adi_uart_Close(aducm_desc->uart_handler);
+#ifdef ENABLE_UART_RX_RING
+	uart_rx_remove(aducm_desc->rx);
+#endif
 	free_desc_mem(desc);
 
 	return SUCCESS;
@@ -540,3 +596,72 @@ uint32_t uart_get_errors(struct uart_desc *desc)
 	return ret;
 }
 
+/**
+ * @brief Get received data without copying it.
+ *
+ * Only available when the receive ring is enabled, see
+ * \ref aducm_uart_init_param. The data stays in the ring until
+ * \ref uart_read_release() is called.
+ * @param desc:	Descriptor of the UART device
+ * @param data:	Where to store the address of the received data
+ * @param bytes_number:	Where to store the number of bytes, 0 if nothing was
+ *			received
+ * @return \ref SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_read_peek(struct uart_desc *desc, const uint8_t **data,
+		       uint32_t *bytes_number)
+{
+#ifdef ENABLE_UART_RX_RING
+	struct aducm_uart_desc *extra;
+
+	if (!desc)
+		return -EINVAL;
+	extra = desc->extra;
+	if (extra->rx)
+		return uart_rx_peek(extra->rx, data, bytes_number);
+#endif
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Release data returned by \ref uart_read_peek()
+ * @param desc:	Descriptor of the UART device
+ * @param bytes_number:	Number of bytes consumed
+ * @return \ref SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_read_release(struct uart_desc *desc, uint32_t bytes_number)
+{
+#ifdef ENABLE_UART_RX_RING
+	struct aducm_uart_desc *extra;
+
+	if (!desc)
+		return -EINVAL;
+	extra = desc->extra;
+	if (extra->rx)
+		return uart_rx_release(extra->rx, bytes_number);
+#endif
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Get the statistics of the receive ring
+ * @param desc:	Descriptor of the UART device
+ * @param stats:	Where to store the statistics
+ * @return \ref SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_get_rx_stats(struct uart_desc *desc, struct uart_rx_stats *stats)
+{
+#ifdef ENABLE_UART_RX_RING
+	struct aducm_uart_desc *extra;
+
+	if (!desc)
+		return -EINVAL;
+	extra = desc->extra;
+	if (extra->rx)
+		return uart_rx_get_stats(extra->rx, stats);
+#endif
+
+	return -ENOTSUP;
+}
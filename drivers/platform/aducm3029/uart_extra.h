@@ -176,6 +176,11 @@ struct aducm_uart_init_param {
 	enum UART_STOPBITS	stop_bits;
 	/** Set the word length */
 	enum UART_WORDLEN	word_length;
+	/**
+	 * Size of the receive ring filled from the interrupt, 0 to read in the
+	 * application buffers. Needs ENABLE_UART_RX_RING.
+	 */
+	uint32_t		rx_ring_size;
 };
 
 #endif /* UART_H_ */
@@ -44,6 +44,7 @@
 #include <io.h>
 #include "error.h"
 #include "axi_io.h"
+#include "util.h"
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
@@ -77,3 +78,33 @@ int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 	return SUCCESS;
 }
 
+/**
+ * @brief AXI IO Altera specific block write function.
+ * @param base - Base address
+ * @param offset - Address offset of the first word
+ * @param data - words to be written.
+ * @param count - number of words.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_write_block(uint32_t base, uint32_t offset,
+			   const uint32_t *data, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++, offset += sizeof(*data))
+		IOWR_32DIRECT(base, offset, data[i]);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief AXI IO Altera specific remove function.
+ * @param base - Base address
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_remove(uint32_t base)
+{
+	UNUSED_PARAM(base);
+
+	return SUCCESS;
+}
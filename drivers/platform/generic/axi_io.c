@@ -80,3 +80,34 @@ int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 
 	return SUCCESS;
 }
+
+/**
+ * @brief AXI IO generic block write function.
+ * @param base - Base address
+ * @param offset - Address offset of the first word
+ * @param data - words to be written.
+ * @param count - number of words.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_write_block(uint32_t base, uint32_t offset,
+			   const uint32_t *data, uint32_t count)
+{
+	UNUSED_PARAM(base);
+	UNUSED_PARAM(offset);
+	UNUSED_PARAM(data);
+	UNUSED_PARAM(count);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief AXI IO generic specific remove function.
+ * @param base - Base address
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_remove(uint32_t base)
+{
+	UNUSED_PARAM(base);
+
+	return SUCCESS;
+}
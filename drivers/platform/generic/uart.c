@@ -197,3 +197,50 @@ uint32_t uart_get_errors(struct uart_desc *desc)
 
 	return SUCCESS;
 }
+
+/**
+ * @brief Get received data without copying it.
+ * @param desc - The UART descriptor.
+ * @param data - Where to store the address of the received data.
+ * @param bytes_number - Where to store the number of bytes.
+ * @return -ENOTSUP, the generic platform has no receive ring.
+ */
+int32_t uart_read_peek(struct uart_desc *desc, const uint8_t **data,
+		       uint32_t *bytes_number)
+{
+	if (desc || data || bytes_number) {
+		// Unused variable - fix compiler warning
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Release data returned by uart_read_peek().
+ * @param desc - The UART descriptor.
+ * @param bytes_number - Number of bytes consumed.
+ * @return -ENOTSUP, the generic platform has no receive ring.
+ */
+int32_t uart_read_release(struct uart_desc *desc, uint32_t bytes_number)
+{
+	if (desc || bytes_number) {
+		// Unused variable - fix compiler warning
+	}
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Get the statistics of the receive ring.
+ * @param desc - The UART descriptor.
+ * @param stats - Where to store the statistics.
+ * @return -ENOTSUP, the generic platform has no receive ring.
+ */
+int32_t uart_get_rx_stats(struct uart_desc *desc, struct uart_rx_stats *stats)
+{
+	if (desc || stats) {
+		// Unused variable - fix compiler warning
+	}
+
+	return -ENOTSUP;
+}
@@ -49,66 +49,182 @@
 #include "error.h"
 #include "axi_io.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define UIO_MAX_DEVICES		64
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct uio_map
+ * @brief Cached mapping of a UIO register window.
+ */
+struct uio_map {
+	/** Start of the mapped region, NULL if not mapped */
+	volatile void *addr;
+	/** Size of the mapped region in bytes */
+	size_t size;
+};
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+static struct uio_map uio_maps[UIO_MAX_DEVICES];
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
 /**
- * @brief AXI IO through UIO read/write function.
+ * @brief Get the size of the first memory region of a UIO device.
  * @param base - UIO index (/dev/uioX).
- * @param offset - Address offset.
- * @param read - Location where read data will be stored.
- * @param write - Data to be written.
+ * @param size - Location where the region size will be stored.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t uio_read_write(uint32_t base, uint32_t offset, uint32_t *read,
-			      uint32_t *write)
+static int32_t uio_get_map_size(uint32_t base, size_t *size)
 {
-	char buf[32];
+	char buf[64];
+	FILE *f;
+	unsigned long long val;
 	int ret;
+
+	sprintf(buf, "/sys/class/uio/uio%"PRIu32"/maps/map0/size", base);
+
+	f = fopen(buf, "r");
+	if (!f) {
+		printf("%s: Can't open %s\n\r", __func__, buf);
+		return FAILURE;
+	}
+
+	ret = fscanf(f, "%llx", &val);
+	fclose(f);
+	if (ret != 1 || !val)
+		return FAILURE;
+
+	*size = val;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Map the register window of a UIO device, once.
+ *
+ * The mapping is kept until axi_io_remove() is called, so that register
+ * accesses do not need any system call.
+ * @param base - UIO index (/dev/uioX).
+ * @return Pointer to the cached mapping, NULL in case of error.
+ */
+static struct uio_map *uio_get_map(uint32_t base)
+{
+	struct uio_map *map;
+	char buf[32];
+	size_t size;
+	void *addr;
 	int uio_fd;
-	int32_t status = SUCCESS;
-	void *uio_addr;
+	int32_t ret;
+
+	if (base >= UIO_MAX_DEVICES) {
+		printf("%s: Invalid UIO index %"PRIu32"\n\r", __func__, base);
+		return NULL;
+	}
+
+	map = &uio_maps[base];
+	if (map->addr)
+		return map;
+
+	ret = uio_get_map_size(base, &size);
+	if (ret != SUCCESS)
+		return NULL;
 
 	sprintf(buf, "/dev/uio%"PRIu32"", base);
 
-	uio_fd = open(buf, O_RDWR);
+	uio_fd = open(buf, O_RDWR | O_SYNC);
 	if (uio_fd < 0) {
 		printf("%s: Can't open %s\n\r", __func__, buf);
-		return FAILURE;
+		return NULL;
 	}
 
-	uio_addr = mmap(NULL,
-			offset + sizeof(*read),
-			PROT_READ|PROT_WRITE,
-			MAP_SHARED,
-			uio_fd,
-			0);
-	if (uio_addr == MAP_FAILED) {
+	addr = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, uio_fd, 0);
+	/* The mapping stays valid after the file descriptor is closed. */
+	close(uio_fd);
+	if (addr == MAP_FAILED) {
 		printf("%s: mmap() failed\n\r", __func__);
-		status = FAILURE;
-		goto close;
+		return NULL;
 	}
 
-	if (read)
-		*read = *(uint32_t *)((uintptr_t)uio_addr + offset);
-	if (write)
-		*(uint32_t *)((uintptr_t)uio_addr + offset) = *write;
+	map->addr = addr;
+	map->size = size;
 
-	ret = munmap(uio_addr, offset + sizeof(*read));
-	if (ret < 0) {
-		printf("%s: munmap() failed\n\r", __func__);
-		status = FAILURE;
+	return map;
+}
+
+/**
+ * @brief AXI IO through UIO read/write function.
+ * @param base - UIO index (/dev/uioX).
+ * @param offset - Address offset.
+ * @param read - Location where read data will be stored.
+ * @param write - Data to be written.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static inline int32_t uio_read_write(uint32_t base, uint32_t offset,
+				     uint32_t *read, uint32_t *write)
+{
+	struct uio_map *map;
+	volatile uint32_t *reg;
+
+	map = uio_get_map(base);
+	if (!map)
+		return FAILURE;
+
+	if ((size_t)offset + sizeof(*reg) > map->size) {
+		printf("%s: Offset 0x%"PRIx32" out of range\n\r", __func__,
+		       offset);
+		return FAILURE;
 	}
 
-close:
-	ret = close(uio_fd);
+	reg = (volatile uint32_t *)((uintptr_t)map->addr + offset);
+
+	if (read) {
+		*read = *reg;
+		__sync_synchronize();
+	}
+	if (write) {
+		__sync_synchronize();
+		*reg = *write;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Unmap the register window of a UIO device.
+ * @param base - UIO index (/dev/uioX).
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t uio_remove(uint32_t base)
+{
+	struct uio_map *map;
+	int ret;
+
+	if (base >= UIO_MAX_DEVICES)
+		return FAILURE;
+
+	map = &uio_maps[base];
+	if (!map->addr)
+		return SUCCESS;
+
+	ret = munmap((void *)map->addr, map->size);
+	map->addr = NULL;
+	map->size = 0;
 	if (ret < 0) {
-		printf("%s: Can't close %s\n\r", __func__, buf);
-		status = FAILURE;
+		printf("%s: munmap() failed\n\r", __func__);
+		return FAILURE;
 	}
 
-	return status;
+	return SUCCESS;
 }
 
 #ifdef DEVMEM
@@ -190,3 +306,66 @@ int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data)
 	return uio_read_write(base, offset, NULL, &data);
 #endif
 }
+
+/**
+ * @brief AXI IO through UIO specific block write function.
+ *
+ * The UIO mapping and its bounds are checked once for the whole block.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @param offset - Address offset of the first word.
+ * @param data - Words to be written.
+ * @param count - Number of words.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_write_block(uint32_t base, uint32_t offset,
+			   const uint32_t *data, uint32_t count)
+{
+#ifdef DEVMEM
+	uint32_t i;
+	int32_t ret;
+
+	for (i = 0; i < count; i++) {
+		ret = axi_io_write(base, offset + i * sizeof(*data), data[i]);
+		if (ret != SUCCESS)
+			return ret;
+	}
+
+	return SUCCESS;
+#else
+	struct uio_map *map;
+	volatile uint32_t *reg;
+	uint32_t i;
+
+	map = uio_get_map(base);
+	if (!map)
+		return FAILURE;
+
+	if ((size_t)offset + (size_t)count * sizeof(*reg) > map->size) {
+		printf("%s: Offset 0x%"PRIx32" out of range\n\r", __func__,
+		       offset);
+		return FAILURE;
+	}
+
+	reg = (volatile uint32_t *)((uintptr_t)map->addr + offset);
+
+	__sync_synchronize();
+	for (i = 0; i < count; i++)
+		reg[i] = data[i];
+
+	return SUCCESS;
+#endif
+}
+
+/**
+ * @brief Release the resources used for AXI IO through UIO.
+ * @param base - UIO index (/dev/uioX)/base address.
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t axi_io_remove(uint32_t base)
+{
+#ifdef DEVMEM
+	return SUCCESS;
+#else
+	return uio_remove(base);
+#endif
+}
@@ -41,6 +41,69 @@
 #include "uart.h"
 #include "stm32_uart.h"
 #include "stm32_hal.h"
+#ifdef ENABLE_UART_RX_RING
+#include "uart_rx.h"
+
+/** Highest USART number handled by the driver */
+#define STM32_UART_MAX_DEVICES	8
+
+/** UARTs receiving in a ring, looked up from the HAL receive callback */
+static struct stm32_uart_desc *rx_ring_uarts[STM32_UART_MAX_DEVICES + 1];
+
+/**
+ * @brief Let the receiver store the next byte directly in the receive ring.
+ *
+ * The HAL only reports full buffers, so the ring is filled one byte per
+ * interrupt.
+ * @param sud - The stm32 specific UART descriptor.
+ */
+static void stm32_uart_rx_arm(struct stm32_uart_desc *sud)
+{
+	uint8_t *buff;
+	uint32_t len;
+
+	uart_rx_fill_get(sud->rx, 1, &buff, &len);
+	HAL_UART_Receive_IT(&sud->huart, buff, len);
+}
+
+/**
+ * @brief HAL receive complete callback, stores the byte in the ring.
+ * @param huart - The HAL UART handle.
+ */
+void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
+{
+	uint32_t i;
+
+	for (i = 0; i <= STM32_UART_MAX_DEVICES; i++) {
+		if (rx_ring_uarts[i] && &rx_ring_uarts[i]->huart == huart) {
+			uart_rx_fill_done(rx_ring_uarts[i]->rx, 1);
+			stm32_uart_rx_arm(rx_ring_uarts[i]);
+			return;
+		}
+	}
+}
+
+/**
+ * @brief HAL error callback, counts the error and restarts the reception.
+ *
+ * The HAL keeps receiving after parity, framing and noise errors, but stops
+ * after an overrun, which would leave the ring without a receiver.
+ * @param huart - The HAL UART handle.
+ */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+	uint32_t i;
+
+	for (i = 0; i <= STM32_UART_MAX_DEVICES; i++) {
+		if (rx_ring_uarts[i] && &rx_ring_uarts[i]->huart == huart) {
+			uart_rx_error(rx_ring_uarts[i]->rx);
+			if (huart->RxState == HAL_UART_STATE_READY)
+				stm32_uart_rx_arm(rx_ring_uarts[i]);
+			return;
+		}
+	}
+}
+#endif
 
 /**
  * @brief Initialize the UART communication peripheral.
@@ -156,6 +219,19 @@ int32_t uart_init(struct uart_desc **desc, struct uart_init_param *param)
 		goto error;
 	}
 
+	descriptor->device_id = param->device_id;
+#ifdef ENABLE_UART_RX_RING
+	if (suip->rx_ring_size) {
+		ret = uart_rx_init(&sud->rx, suip->rx_ring_size);
+		if (ret) {
+			HAL_UART_DeInit(&sud->huart);
+			goto error;
+		}
+		rx_ring_uarts[param->device_id] = sud;
+		stm32_uart_rx_arm(sud);
+	}
+#endif
+
 	*desc = descriptor;
 
 	return 0;
@@ -180,6 +256,12 @@ int32_t uart_remove(struct uart_desc *desc)
 
 	sud = desc->extra;
 	HAL_UART_DeInit(&sud->huart);
+#ifdef ENABLE_UART_RX_RING
+	if (sud->rx) {
+		rx_ring_uarts[desc->device_id] = NULL;
+		uart_rx_remove(sud->rx);
+	}
+#endif
 	free(desc->extra);
 	free(desc);
 
@@ -235,10 +317,93 @@ int32_t uart_read(struct uart_desc *desc, uint8_t *data,
 
 	sud = desc->extra;
 
+#ifdef ENABLE_UART_RX_RING
+	if (sud->rx) {
+		ret = uart_rx_read(sud->rx, data, bytes_number);
+		if (ret)
+			return ret;
+
+		return bytes_number;
+	}
+#endif
+
 	ret = HAL_UART_Receive(&sud->huart, (uint8_t *)data, bytes_number,
 			       HAL_MAX_DELAY);
 	if (ret != HAL_OK)
 		return -EIO;
 
 	return bytes_number;
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Get received data without copying it.
+ *
+ * Only available when the receive ring is enabled, see rx_ring_size in
+ * stm32_uart_init_param. The data stays in the ring until
+ * uart_read_release() is called.
+ * @param desc - Instance of UART.
+ * @param data - Where to store the address of the received data.
+ * @param bytes_number - Where to store the number of bytes, 0 if nothing was
+ *                       received.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_read_peek(struct uart_desc *desc, const uint8_t **data,
+		       uint32_t *bytes_number)
+{
+#ifdef ENABLE_UART_RX_RING
+	struct stm32_uart_desc *sud;
+
+	if (!desc || !desc->extra)
+		return -EINVAL;
+
+	sud = desc->extra;
+	if (sud->rx)
+		return uart_rx_peek(sud->rx, data, bytes_number);
+#endif
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Release data returned by uart_read_peek().
+ * @param desc - Instance of UART.
+ * @param bytes_number - Number of bytes consumed.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_read_release(struct uart_desc *desc, uint32_t bytes_number)
+{
+#ifdef ENABLE_UART_RX_RING
+	struct stm32_uart_desc *sud;
+
+	if (!desc || !desc->extra)
+		return -EINVAL;
+
+	sud = desc->extra;
+	if (sud->rx)
+		return uart_rx_release(sud->rx, bytes_number);
+#endif
+
+	return -ENOTSUP;
+}
+
+/**
+ * @brief Get the statistics of the receive ring.
+ * @param desc - Instance of UART.
+ * @param stats - Where to store the statistics.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_get_rx_stats(struct uart_desc *desc, struct uart_rx_stats *stats)
+{
+#ifdef ENABLE_UART_RX_RING
+	struct stm32_uart_desc *sud;
+
+	if (!desc || !desc->extra)
+		return -EINVAL;
+
+	sud = desc->extra;
+	if (sud->rx)
+		return uart_rx_get_stats(sud->rx, stats);
+#endif
+
+	return -ENOTSUP;
+}
@@ -55,6 +55,13 @@ struct stm32_uart_init_param {
 	uint32_t hw_flow_ctl;
 	/** Specifies oversampling mode. */
 	uint32_t over_sampling;
+	/**
+	 * Size of the receive ring filled from the interrupt, 0 to read with
+	 * polling. Needs ENABLE_UART_RX_RING, the USART interrupt handler of
+	 * the project calling HAL_UART_IRQHandler() on this UART and no other
+	 * definition of HAL_UART_RxCpltCallback().
+	 */
+	uint32_t rx_ring_size;
 };
 
 /**
@@ -64,6 +71,8 @@ struct stm32_uart_init_param {
 struct stm32_uart_desc {
 	/** SPI instance */
 	UART_HandleTypeDef huart;
+	/** Receive ring, NULL when reading with polling */
+	struct uart_rx *rx;
 };
 
 #endif
\ No newline at end of file
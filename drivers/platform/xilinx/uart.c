@@ -38,9 +38,9 @@
 #include "error.h"
 #include "uart.h"
 #include "uart_extra.h"
+#include "uart_rx.h"
 #ifdef XPAR_XUARTPS_NUM_INSTANCES
 #include "irq.h"
-#include "fifo.h"
 #include <xil_exception.h>
 #include <xuartps.h>
 #endif
@@ -59,51 +59,9 @@
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
-#ifdef XUARTPS_H
-/**
- * @brief Save received data into fifo.
- * @param desc - Instance descriptor containing a fifo element.
- * @return SUCCESS in case of success, FAILURE otherwise.
- */
-static int32_t uart_fifo_insert(struct uart_desc *desc)
-{
-	int32_t ret;
-	struct xil_uart_desc *xil_uart_desc = desc->extra;
-	struct irq_ctrl_desc *irq_desc = xil_uart_desc->irq_desc;
-
-	if (xil_uart_desc->bytes_received > 0) {
-		ret = irq_disable(irq_desc, xil_uart_desc->irq_id);
-		if (ret < 0)
-			return ret;
-		ret = fifo_insert(&xil_uart_desc->fifo, xil_uart_desc->buff,
-				  xil_uart_desc->bytes_received);
-		if (ret < 0)
-			return ret;
-		xil_uart_desc->bytes_received = 0;
-		switch(xil_uart_desc->type) {
-		case UART_PS:
-			XUartPs_Recv(xil_uart_desc->instance, (u8*)(xil_uart_desc->buff),
-				     UART_BUFF_LENGTH);
-			break;
-		case UART_PL:
-
-			break;
-		default:
-			return FAILURE;
-			break;
-		}
-		ret = irq_enable(irq_desc, xil_uart_desc->irq_id);
-		if (ret < 0)
-			return ret;
-	}
-
-	return SUCCESS;
-}
-#endif // XUARTPS_H
-
 /**
- * @brief Read byte from fifo.
- * @param desc - Instance descriptor containing a fifo element
+ * @brief Read byte from the UART.
+ * @param desc - Instance descriptor.
  * @param data - read value.
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
@@ -113,29 +71,8 @@ static int32_t uart_read_byte(struct uart_desc *desc, uint8_t *data)
 #ifdef XUARTLITE_H
 	XUartLite *instance = xil_uart_desc->instance;
 #endif
-#ifdef XUARTPS_H
-	int32_t ret;
-#endif
 
 	switch(xil_uart_desc->type) {
-	case UART_PS:
-#ifdef XUARTPS_H
-		while (xil_uart_desc->fifo == NULL) {
-			/* nothing in fifo, wait until something is received */
-			ret = uart_fifo_insert(desc);
-			if (ret < 0)
-				return ret;
-		}
-
-		*data = xil_uart_desc->fifo->data[xil_uart_desc->fifo_read_offset];
-		xil_uart_desc->fifo_read_offset++;
-
-		if (xil_uart_desc->fifo->len - xil_uart_desc->fifo_read_offset <= 0) {
-			xil_uart_desc->fifo_read_offset = 0;
-			xil_uart_desc->fifo = fifo_remove(xil_uart_desc->fifo);
-		}
-#endif // XUARTPS_H
-		break;
 	case UART_PL:
 #ifdef XUARTLITE_H
 		while (!(Xil_In32(instance->RegBaseAddress + XUL_STATUS_REG_OFFSET) &
@@ -159,7 +96,18 @@ static int32_t uart_read_byte(struct uart_desc *desc, uint8_t *data)
  */
 int32_t uart_read(struct uart_desc *desc, uint8_t *data, uint32_t bytes_number)
 {
+	struct xil_uart_desc *xil_uart_desc = desc->extra;
 	ssize_t ret;
+
+	/* The PS receive interrupt fills the ring, wait for it */
+	if (xil_uart_desc->rx) {
+		ret = uart_rx_read(xil_uart_desc->rx, data, bytes_number);
+		if (ret < 0)
+			return ret;
+
+		return bytes_number;
+	}
+
 	for (uint32_t i = 0; i < bytes_number; i++) {
 		ret = uart_read_byte(desc, &data[i]);
 		if (ret < 0)
@@ -169,6 +117,61 @@ int32_t uart_read(struct uart_desc *desc, uint8_t *data, uint32_t bytes_number)
 	return bytes_number;
 }
 
+/**
+ * @brief Get received data without copying it.
+ *
+ * Only available on the PS UART, which receives in a ring from its interrupt.
+ * The data stays in the ring until uart_read_release() is called.
+ *
+ * @param desc - Instance of UART.
+ * @param data - Where to store the address of the received data.
+ * @param bytes_number - Where to store the number of bytes, 0 if nothing was
+ *                       received.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_read_peek(struct uart_desc *desc, const uint8_t **data,
+		       uint32_t *bytes_number)
+{
+	struct xil_uart_desc *xil_uart_desc = desc->extra;
+
+	if (!xil_uart_desc->rx)
+		return -ENOTSUP;
+
+	return uart_rx_peek(xil_uart_desc->rx, data, bytes_number);
+}
+
+/**
+ * @brief Release data returned by uart_read_peek().
+ * @param desc - Instance of UART.
+ * @param bytes_number - Number of bytes consumed.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_read_release(struct uart_desc *desc, uint32_t bytes_number)
+{
+	struct xil_uart_desc *xil_uart_desc = desc->extra;
+
+	if (!xil_uart_desc->rx)
+		return -ENOTSUP;
+
+	return uart_rx_release(xil_uart_desc->rx, bytes_number);
+}
+
+/**
+ * @brief Get the statistics of the receive ring.
+ * @param desc - Instance of UART.
+ * @param stats - Where to store the statistics.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_get_rx_stats(struct uart_desc *desc, struct uart_rx_stats *stats)
+{
+	struct xil_uart_desc *xil_uart_desc = desc->extra;
+
+	if (!xil_uart_desc->rx)
+		return -ENOTSUP;
+
+	return uart_rx_get_stats(xil_uart_desc->rx, stats);
+}
+
 /**
  * @brief Write data to UART device.
  * @param desc - Instance of UART.
@@ -221,6 +224,19 @@ int32_t uart_write(struct uart_desc *desc, const uint8_t *data,
 }
 
 #ifdef XUARTPS_H
+/**
+ * @brief Let the receiver store the next bytes directly in the receive ring.
+ * @param xil_uart_desc - Xilinx specific UART descriptor.
+ */
+static void uart_rx_arm(struct xil_uart_desc *xil_uart_desc)
+{
+	uint8_t *buff;
+	uint32_t len;
+
+	uart_rx_fill_get(xil_uart_desc->rx, UART_BUFF_LENGTH, &buff, &len);
+	XUartPs_Recv(xil_uart_desc->instance, buff, len);
+}
+
 /**
  * @brief UART interrupt handler.
  * @param call_back_ref - Instance of UART.
@@ -242,7 +258,8 @@ static void uart_irq_handler(void *call_back_ref, uint32_t event,
 		 * timeout just indicates the data stopped for configured character time
 		 */
 		case XUARTPS_EVENT_RECV_TOUT:
-			xil_uart_desc->bytes_received = data_len;
+			uart_rx_fill_done(xil_uart_desc->rx, data_len);
+			uart_rx_arm(xil_uart_desc);
 			break;
 		/*
 		 * Data was received with an error, keep the data but determine
@@ -261,6 +278,7 @@ static void uart_irq_handler(void *call_back_ref, uint32_t event,
 		 */
 		case XUARTPS_EVENT_RECV_ORERR:
 			xil_uart_desc->total_error_count++;
+			uart_rx_error(xil_uart_desc->rx);
 			break;
 		default:
 			break;
@@ -396,14 +414,20 @@ int32_t uart_init(struct uart_desc **desc, struct uart_init_param *param)
 		 */
 		XUartPs_SetRecvTimeout(xil_uart_desc->instance, 8);
 
+		status = uart_rx_init(&xil_uart_desc->rx,
+				      xil_uart_init_param->rx_ring_size ?
+				      xil_uart_init_param->rx_ring_size :
+				      UART_RX_RING_SIZE);
+		if (status != SUCCESS)
+			goto error_free_instance;
+
 		status = uart_irq_init(descriptor);
 		if (status != XST_SUCCESS)
-			goto error_free_instance;
+			goto error_free_rx;
 
 		*desc = descriptor;
 
-		XUartPs_Recv(xil_uart_desc->instance, (u8*)xil_uart_desc->buff,
-			     UART_BUFF_LENGTH);
+		uart_rx_arm(xil_uart_desc);
 
 		break;
 #endif // XUARTPS_H
@@ -435,6 +459,10 @@ int32_t uart_init(struct uart_desc **desc, struct uart_init_param *param)
 
 	return SUCCESS;
 
+#ifdef XUARTPS_H
+error_free_rx:
+	uart_rx_remove(xil_uart_desc->rx);
+#endif // XUARTPS_H
 error_free_instance:
 	free(xil_uart_desc->instance);
 error_free_xil_uart_desc:
@@ -453,6 +481,13 @@ error_free_descriptor:
 int32_t uart_remove(struct uart_desc *desc)
 {
 	struct xil_uart_desc *xil_uart_desc = desc->extra;
+
+#ifdef XUARTPS_H
+	if (xil_uart_desc->rx) {
+		irq_disable(xil_uart_desc->irq_desc, xil_uart_desc->irq_id);
+		uart_rx_remove(xil_uart_desc->rx);
+	}
+#endif // XUARTPS_H
 	free(xil_uart_desc->instance);
 	free(xil_uart_desc);
 	free(desc);
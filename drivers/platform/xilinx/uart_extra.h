@@ -48,6 +48,7 @@
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
 
+/* Maximum number of bytes received in the ring between two interrupts */
 #define UART_BUFF_LENGTH 256
 
 /******************************************************************************/
@@ -77,6 +78,8 @@ struct xil_uart_init_param {
 	uint32_t			irq_id;
 	/** Interrupt Request Descriptor */
 	struct irq_ctrl_desc *irq_desc;
+	/** Size of the PS receive ring, 0 for UART_RX_RING_SIZE */
+	uint32_t			rx_ring_size;
 };
 
 /**
@@ -90,14 +93,8 @@ struct xil_uart_desc {
 	uint32_t			irq_id;
 	/** Interrupt Request Descriptor */
 	struct irq_ctrl_desc *irq_desc;
-	/** FIFO */
-	struct fifo_element	*fifo;
-	/** FIFO read offset */
-	uint32_t 			fifo_read_offset;
-	/** UART Buffer */
-	char 				buff[UART_BUFF_LENGTH];
-	/** Number of bytes received */
-	uint32_t 			bytes_received;
+	/** Receive ring filled by the PS UART interrupt */
+	struct uart_rx		*rx;
 	/** Total number of errors */
 	uint32_t 			total_error_count;
 	/** UART Instance */
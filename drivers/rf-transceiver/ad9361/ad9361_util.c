@@ -49,6 +49,13 @@
 /******************************************************************************/
 #define BITS_PER_LONG		32
 
+/******************************************************************************/
+/************************ Variable Definitions ********************************/
+/******************************************************************************/
+#if defined(HAVE_DEBUG_MESSAGES) && defined(ENABLE_BINLOG)
+BINLOG_MODULE_DEFINE(ad9361, LOG_DEBUG);
+#endif
+
 /***************************************************************************//**
  * @brief clk_prepare_enable
 *******************************************************************************/
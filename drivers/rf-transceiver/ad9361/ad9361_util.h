@@ -49,6 +49,9 @@
 #include "ad9361.h"
 #include "common.h"
 #include "app_config.h"
+#ifdef ENABLE_BINLOG
+#include "binlog.h"
+#endif
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
@@ -59,7 +62,9 @@
 #if defined(HAVE_VERBOSE_MESSAGES)
 #define dev_err(dev, format, ...)		({printf(format, ## __VA_ARGS__);printf("\n"); })
 #define dev_warn(dev, format, ...)		({printf(format, ## __VA_ARGS__);printf("\n"); })
-#if defined(HAVE_DEBUG_MESSAGES)
+#if defined(HAVE_DEBUG_MESSAGES) && defined(ENABLE_BINLOG)
+#define dev_dbg(dev, format, ...)		binlog_print(ad9361, LOG_DEBUG, format "\n", ## __VA_ARGS__)
+#elif defined(HAVE_DEBUG_MESSAGES)
 #define dev_dbg(dev, format, ...)		({printf(format, ## __VA_ARGS__);printf("\n"); })
 #else
 #define dev_dbg(dev, format, ...)	({ if (0) printf(format, ## __VA_ARGS__); })
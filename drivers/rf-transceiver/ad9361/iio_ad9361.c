@@ -2262,6 +2262,69 @@ static struct iio_channel iio_ad9361_channels[] = {
 	AD9361_OUT(),
 };
 
+/**
+ * @brief Write several attributes in one call.
+ * The sampling frequency and the RF bandwidths of the batch are applied
+ * together, so the bandwidth update and its calibrations run only once.
+ * The other attributes are written in order, before them.
+ * @param device - Physical instance of a ad9361 device.
+ * @param writes - Attribute writes.
+ * @param nb_writes - Number of writes.
+ * @return SUCCESS, the status of each write is stored in it.
+ */
+static int32_t iio_ad9361_write_attrs(void *device,
+				      struct iio_attr_write *writes,
+				      uint32_t nb_writes)
+{
+	struct ad9361_rf_phy *ad9361_phy = (struct ad9361_rf_phy *)device;
+	uint32_t rx_bw = ad9361_phy->current_rx_bw_Hz;
+	uint32_t tx_bw = ad9361_phy->current_tx_bw_Hz;
+	uint32_t sampling_freq_hz = 0;
+	uint32_t rx[6], tx[6];
+	bool update_bw = false;
+	ssize_t ret = 0;
+	uint32_t i;
+
+	for (i = 0; i < nb_writes; i++) {
+		if (writes[i].attr->store == set_sampling_frequency) {
+			sampling_freq_hz = srt_to_uint32(writes[i].buf);
+			update_bw = true;
+		} else if (writes[i].attr->store == set_rf_bandwidth) {
+			if (writes[i].channel->ch_out)
+				tx_bw = ad9361_validate_rf_bw(ad9361_phy,
+							      srt_to_uint32(writes[i].buf));
+			else
+				rx_bw = ad9361_validate_rf_bw(ad9361_phy,
+							      srt_to_uint32(writes[i].buf));
+			update_bw = true;
+		} else {
+			writes[i].ret = writes[i].attr->store(device,
+							      writes[i].buf,
+							      writes[i].len,
+							      writes[i].channel,
+							      writes[i].attr->priv);
+		}
+	}
+
+	if (sampling_freq_hz) {
+		ret = ad9361_calculate_rf_clock_chain(ad9361_phy,
+						      sampling_freq_hz,
+						      ad9361_phy->rate_governor,
+						      rx, tx);
+		if (ret >= 0)
+			ret = ad9361_set_trx_clock_chain(ad9361_phy, rx, tx);
+	}
+	if (update_bw && ret >= 0)
+		ret = ad9361_update_rf_bandwidth(ad9361_phy, rx_bw, tx_bw);
+
+	for (i = 0; i < nb_writes; i++)
+		if (writes[i].attr->store == set_sampling_frequency ||
+		    writes[i].attr->store == set_rf_bandwidth)
+			writes[i].ret = ret < 0 ? ret : (ssize_t)writes[i].len;
+
+	return SUCCESS;
+}
+
 /**
  * @brief Get iio device descriptor.
  * @param desc - Descriptor.
@@ -2296,6 +2359,7 @@ int32_t iio_ad9361_init(struct iio_ad9361_desc **desc,
 	iio_ad9361_inst->dev_descriptor.attributes = global_attributes;
 	iio_ad9361_inst->dev_descriptor.debug_attributes = NULL;
 	iio_ad9361_inst->dev_descriptor.buffer_attributes = NULL;
+	iio_ad9361_inst->dev_descriptor.write_attrs = iio_ad9361_write_attrs;
 	*desc = iio_ad9361_inst;
 
 	return SUCCESS;
@@ -59,6 +59,7 @@
 
 #define CMD0_RETRY_NUMBER		(5u)
 #define WAIT_RESP_TIMEOUT		(1000u) //1000ms
+#define SD_FAST_POLLS			(1000u)
 
 #define R1_READY_STATE			(0x00u)
 #define R1_IDLE_STATE			(0x01u)
@@ -71,14 +72,17 @@
 #define CSD_LEN				(18u)
 #define CRC_LEN				(2u)
 #define CMD_LEN				(8u)
+#define BUSY_POLL_LEN			(8u)
+/* Start token, data block, CRC and data response token */
+#define XFER_LEN			(1u + DATA_BLOCK_LEN + CRC_LEN + 1u)
 
 #define STUFF_ARG			(0x00000000u)
 #define CMD8_ARG			(0x000001AAu)
 #define ACMD41_ARG			(0x40000000u)
+#define ACMD23_ARG_MASK			(0x007FFFFFu)
 
 #define DATA_BLOCK_BITS			(9u)
 #define MASK_ADDR_IN_BLOCK		(DATA_BLOCK_LEN - 1u)
-#define MASK_BLOCK_NUMBER		(~(uint64_t)MASK_ADDR_IN_BLOCK)
 
 #define START_1_BLOCK_TOKEN		(0xFEu)
 #define START_N_BLOCK_TOKEN		(0xFCu)
@@ -93,69 +97,73 @@
 
 /**
  * Read SD card bytes until one is different from 0xFF
+ *
+ * The first SD_FAST_POLLS bytes are read back to back, the card usually
+ * answers within them. The following polls are 1ms apart.
  * @param sd_desc	- Instance of the SD card
  * @param data_out	- The read bytes is wrote here
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
 static int32_t wait_for_response(struct sd_desc *sd_desc, uint8_t *data_out)
 {
-	uint32_t	not_timeout;
-	int32_t		ret;
+	uint32_t	i;
 
-	ret = FAILURE;
-	not_timeout = WAIT_RESP_TIMEOUT;
-	do {
+	for (i = 0; i < SD_FAST_POLLS + WAIT_RESP_TIMEOUT; i++) {
+		*data_out = 0xFF;
 		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc,
 						  data_out, 1))
-			break;
-		if (*data_out != 0xFF) {
-			ret = SUCCESS;
-			break;
-		}
-		mdelay(1);
-	} while (not_timeout--);
+			return FAILURE;
+		if (*data_out != 0xFF)
+			return SUCCESS;
+		if (i >= SD_FAST_POLLS)
+			mdelay(1);
+	}
 
-	return ret;
+	return FAILURE;
 }
 
 /**
  * Read SD card bytes until one is different from 0x00
+ *
+ * The card holds its output low while busy, so the bytes are read
+ * BUSY_POLL_LEN at a time, back to back for the first SD_FAST_POLLS and
+ * then 1ms apart.
  * @param sd_desc - Instance of the SD card
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
 static int32_t wait_until_not_busy(struct sd_desc *sd_desc)
 {
-	uint32_t	not_timeout;
-	int32_t		ret;
-	uint8_t		data;
-
-	ret = FAILURE;
-	not_timeout = WAIT_RESP_TIMEOUT;
-	do {
-		data = 0xFF;
-		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, &data, 1))
-			break;
-		if (data != 0x00) {
-			ret = SUCCESS;
-			break;
-		}
-		mdelay(1);
-	} while (not_timeout--);
+	uint32_t	i;
 
-	return ret;
+	for (i = 0; i < SD_FAST_POLLS + WAIT_RESP_TIMEOUT; i++) {
+		memset(sd_desc->buff, 0xFF, BUSY_POLL_LEN);
+		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc,
+						  sd_desc->buff, BUSY_POLL_LEN))
+			return FAILURE;
+		if (sd_desc->buff[BUSY_POLL_LEN - 1] != 0x00)
+			return SUCCESS;
+		if (i >= SD_FAST_POLLS)
+			mdelay(1);
+	}
+
+	return FAILURE;
 }
 
 /**
- * Calculate the number of blocks to be read/written from the address
- * and the length
- * @param address - Address in memory
- * @param len - Length of data
- * @return Number of blocks
+ * Wait for the card to finish programming if a write left it busy
+ * @param sd_desc	- Instance of the SD card
+ * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static inline uint32_t get_nb_of_blocks(uint64_t address, uint64_t len)
+static int32_t wait_if_busy(struct sd_desc *sd_desc)
 {
-	return ((address + len - 1) >> DATA_BLOCK_BITS) -
-	       (address >> DATA_BLOCK_BITS) + 1;
+	if (!sd_desc->busy)
+		return SUCCESS;
+
+	if (SUCCESS != wait_until_not_busy(sd_desc))
+		return FAILURE;
+	sd_desc->busy = false;
+
+	return SUCCESS;
 }
 
 /**
@@ -167,6 +175,10 @@ static inline uint32_t get_nb_of_blocks(uint64_t address, uint64_t len)
  */
 static int32_t send_command(struct sd_desc *sd_desc, struct cmd_desc *cmd_desc)
 {
+	/* Wait for the end of the previous write */
+	if (SUCCESS != wait_if_busy(sd_desc))
+		return FAILURE;
+
 	/* Send CMD55 if it is an application command */
 	if (cmd_desc->cmd & BIT_APPLICATION_CMD) {
 		struct cmd_desc	cmd_desc_local;
@@ -175,7 +187,8 @@ static int32_t send_command(struct sd_desc *sd_desc, struct cmd_desc *cmd_desc)
 		cmd_desc_local.response_len = R1_LEN;
 		if (SUCCESS != send_command(sd_desc, &cmd_desc_local))
 			return FAILURE;
-		if (cmd_desc_local.response[0] != R1_IDLE_STATE) {
+		/* Idle during the initialization, ready afterwards */
+		if (cmd_desc_local.response[0] & ~R1_IDLE_STATE) {
 			DEBUG_MSG("Not the expected response for CMD55\n");
 			return FAILURE;
 		}
@@ -212,31 +225,40 @@ static int32_t send_command(struct sd_desc *sd_desc, struct cmd_desc *cmd_desc)
 
 /**
  * Send one block of data to the SD card
+ *
+ * The start token, the data, the CRC and the data response token are sent
+ * in a single transfer. The busy time of the card is not waited here but
+ * before the next block or command, so that the next block can be prepared
+ * while the card is programming.
  * @param sd_desc	- Instance of the SD card
  * @param data		- Data to be written
- * @param nb_of_blocks	- Number of blocks written in the executing command
+ * @param token		- Start block token
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t write_block(struct sd_desc *sd_desc, uint8_t *data,
-			   uint32_t nb_of_blocks)
+static int32_t write_block(struct sd_desc *sd_desc, const uint8_t *data,
+			   uint8_t token)
 {
-	/* Send start block token */
-	sd_desc->buff[0] = START_N_BLOCK_TOKEN;
-	if (nb_of_blocks == 1)
-		sd_desc->buff[0] = START_1_BLOCK_TOKEN;
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, 1))
-		return FAILURE;
+	struct spi_msg	msg;
+	uint8_t		response;
+
+	sd_desc->xfer[0] = token;
+	memcpy(sd_desc->xfer + 1, data, DATA_BLOCK_LEN);
+	memset(sd_desc->xfer + 1 + DATA_BLOCK_LEN, 0xFF, CRC_LEN + 1);
 
-	/* Send data with CRC */
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, data, DATA_BLOCK_LEN))
+	if (SUCCESS != wait_if_busy(sd_desc))
 		return FAILURE;
-	*((uint16_t *)sd_desc->buff) = 0xFFFF;
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, CRC_LEN))
+
+	msg.tx_buff = sd_desc->xfer;
+	msg.rx_buff = sd_desc->xfer;
+	msg.bytes_number = XFER_LEN;
+	msg.cs_change = 0;
+	if (IS_ERR_VALUE(spi_transfer(sd_desc->spi_desc, &msg, 1)))
 		return FAILURE;
 
 	/* Read response and check if write was ok */
-	uint8_t		response;
-	if (SUCCESS != wait_for_response(sd_desc, &response))
+	response = sd_desc->xfer[XFER_LEN - 1];
+	if (response == 0xFF &&
+	    SUCCESS != wait_for_response(sd_desc, &response))
 		return FAILURE;
 	switch (response & MASK_RESPONSE_TOKEN) {
 	case 0x4:
@@ -251,8 +273,7 @@ static int32_t write_block(struct sd_desc *sd_desc, uint8_t *data,
 		DEBUG_MSG("Other problem\n");
 		return FAILURE;
 	}
-	if (SUCCESS != wait_until_not_busy(sd_desc))
-		return FAILURE;
+	sd_desc->busy = true;
 
 	return SUCCESS;
 }
@@ -265,8 +286,10 @@ static int32_t write_block(struct sd_desc *sd_desc, uint8_t *data,
  */
 static int32_t read_block(struct sd_desc *sd_desc, uint8_t *data)
 {
+	struct spi_msg	msgs[2];
+	uint8_t		response;
+
 	/* Reading Start block token */
-	uint8_t	response;
 	if (SUCCESS != wait_for_response(sd_desc, &response))
 		return FAILURE;
 	if ((response & MASK_ERROR_TOKEN) == 0) {
@@ -295,116 +318,257 @@ static int32_t read_block(struct sd_desc *sd_desc, uint8_t *data)
 		return FAILURE;
 	}
 
-	/* Read data block */
+	/* Read data block and crc */
 	memset(data, 0xff, DATA_BLOCK_LEN);
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, data, DATA_BLOCK_LEN))
-		return FAILURE;
-
-	/* Read crc*/
-	*((uint16_t *)sd_desc->buff) = 0xFFFF;
-	if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, CRC_LEN))
+	memset(sd_desc->xfer, 0xff, CRC_LEN);
+	msgs[0].tx_buff = data;
+	msgs[0].rx_buff = data;
+	msgs[0].bytes_number = DATA_BLOCK_LEN;
+	msgs[0].cs_change = 0;
+	msgs[1].tx_buff = sd_desc->xfer;
+	msgs[1].rx_buff = sd_desc->xfer;
+	msgs[1].bytes_number = CRC_LEN;
+	msgs[1].cs_change = 0;
+	if (IS_ERR_VALUE(spi_transfer(sd_desc->spi_desc, msgs, 2)))
 		return FAILURE;
 
 	return SUCCESS;
 }
 
 /**
- * Prepare and write data block by block
+ * Write consecutive blocks with CMD24 or CMD25
  * @param sd_desc	- Instance of the SD card
  * @param data		- Data to be written
- * @param addr		- Address in memory where data will be written
- * @param len		- Length of data to be written
- * @param nb_of_blocks	- Number of block to be written
- * @param first_block	- First block where data will be written with unmodified
- * 						  data
- * @param last_block	- Last block where data will be written with unmodified
- * 						  data
+ * @param block		- First block
+ * @param count		- Number of blocks
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t write_multiple_blocks(struct sd_desc *sd_desc,
-				     uint8_t *data, uint64_t addr, uint64_t len,
-				     uint8_t *first_block, uint8_t *last_block)
+static int32_t stream_write(struct sd_desc *sd_desc, const uint8_t *data,
+			    uint32_t block, uint32_t count)
 {
-	uint16_t	buff_first_idx;
-	uint16_t	buff_copy_len;
+	struct cmd_desc	cmd_desc;
 	uint32_t	i;
-	uint64_t	data_idx;
-	uint32_t	nb_of_blocks = get_nb_of_blocks(addr, len);
 
-	data_idx = 0;
-	i = 0;
-	while (i < nb_of_blocks) {
-		buff_first_idx = 0x0000u;
-		if (i == 0)
-			buff_first_idx = addr & MASK_ADDR_IN_BLOCK;
-		buff_copy_len = DATA_BLOCK_LEN - buff_first_idx;
-		if (i == nb_of_blocks - 1)
-			buff_copy_len = ((addr + len - 1) & MASK_ADDR_IN_BLOCK) - buff_first_idx + 1;
-		if (buff_first_idx == 0x0000u && buff_copy_len == DATA_BLOCK_LEN) {
-			/* Write every block beside the first and last if the write is not the entire block */
-			if (SUCCESS != write_block(sd_desc, data + data_idx, nb_of_blocks))
-				return FAILURE;
-		} else {			/* If we are not writing a full block */
-			if (i == 0) {		/* If is the first block */
-				memcpy(first_block + buff_first_idx, data + data_idx, buff_copy_len);
-				if (SUCCESS != write_block(sd_desc, first_block, nb_of_blocks))
-					return FAILURE;
-			} else {		/* Is the last block */
-				memcpy(last_block, data + data_idx, buff_copy_len);
-				if (SUCCESS != write_block(sd_desc, last_block, nb_of_blocks))
-					return FAILURE;
-			}
+	/* Let the card pre-erase the blocks of a multiple block write */
+	if (count > 1) {
+		cmd_desc.cmd = ACMD(23);
+		cmd_desc.arg = count & ACMD23_ARG_MASK;
+		cmd_desc.response_len = R1_LEN;
+		if (SUCCESS != send_command(sd_desc, &cmd_desc))
+			return FAILURE;
+		if (cmd_desc.response[0] != R1_READY_STATE) {
+			DEBUG_MSG("Pre-erase not supported\n");
 		}
-		data_idx += buff_copy_len;
-		i++;
+	}
+
+	cmd_desc.cmd = (count == 1) ? CMD(24) : CMD(25);
+	cmd_desc.arg = block;
+	cmd_desc.response_len = R1_LEN;
+	if (SUCCESS != send_command(sd_desc, &cmd_desc))
+		return FAILURE;
+	if (cmd_desc.response[0] != R1_READY_STATE) {
+		DEBUG_MSG("Failed to write Data command\n");
+		return FAILURE;
+	}
+
+	for (i = 0; i < count; i++)
+		if (SUCCESS != write_block(sd_desc, data + i * DATA_BLOCK_LEN,
+					   (count == 1) ? START_1_BLOCK_TOKEN :
+					   START_N_BLOCK_TOKEN))
+			return FAILURE;
+
+	/* Send stop transmission token */
+	if (count != 1) {
+		if (SUCCESS != wait_if_busy(sd_desc))
+			return FAILURE;
+		sd_desc->buff[0] = STOP_TRANSMISSION_TOKEN;
+		sd_desc->buff[1] = 0xFF;
+		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, 2))
+			return FAILURE;
+		sd_desc->busy = true;
 	}
 
 	return SUCCESS;
 }
 
 /**
- * Prepare and read data block by block
+ * Read consecutive blocks with CMD17 or CMD18
  * @param sd_desc	- Instance of the SD card
- * @param data		- Data to be read
- * @param addr		- Address in memory from where data will be read
- * @param len		- Length of data to be read
- * @param nb_of_blocks	- Number of block to be read
+ * @param data		- Where data will be read
+ * @param block		- First block
+ * @param count		- Number of blocks
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
-static int32_t read_multiple_blocks(struct sd_desc *sd_desc,
-				    uint8_t *data, uint64_t addr, uint64_t len)
+static int32_t stream_read(struct sd_desc *sd_desc, uint8_t *data,
+			   uint32_t block, uint32_t count)
 {
-	uint8_t		buff[DATA_BLOCK_LEN] __attribute__ ((aligned));
+	struct cmd_desc	cmd_desc;
 	uint32_t	i;
-	uint64_t	data_idx;
 
-	data_idx = 0;
-	i = 0;
-	while (i < get_nb_of_blocks(addr, len)) {
-		uint16_t		buff_first_idx;
-		uint16_t		buff_copy_len;
-
-		buff_first_idx = 0x0000u;
-		if (i == 0)
-			buff_first_idx = addr & MASK_ADDR_IN_BLOCK;
-		buff_copy_len = DATA_BLOCK_LEN - buff_first_idx;
-		if (i == get_nb_of_blocks(addr, len) - 1)
-			buff_copy_len = ((addr + len - 1) & MASK_ADDR_IN_BLOCK) - buff_first_idx + 1;
-		if (buff_first_idx == 0x0000u && buff_copy_len == DATA_BLOCK_LEN) {
-			if (SUCCESS != read_block(sd_desc, data + data_idx))
-				return FAILURE;
-		} else {
-			if (SUCCESS != read_block(sd_desc, buff))
-				return FAILURE;
-			memcpy(data + data_idx, buff + buff_first_idx, buff_copy_len);
+	cmd_desc.cmd = (count == 1) ? CMD(17) : CMD(18);
+	cmd_desc.arg = block;
+	cmd_desc.response_len = R1_LEN;
+	if (SUCCESS != send_command(sd_desc, &cmd_desc))
+		return FAILURE;
+	if (cmd_desc.response[0] != R1_READY_STATE) {
+		DEBUG_MSG("Failed to write Data command\n");
+		return FAILURE;
+	}
+
+	for (i = 0; i < count; i++)
+		if (SUCCESS != read_block(sd_desc, data + i * DATA_BLOCK_LEN))
+			return FAILURE;
+
+	/* Send stop transmission command */
+	if (count != 1) {
+		cmd_desc.cmd = CMD(12);
+		cmd_desc.arg = STUFF_ARG;
+		cmd_desc.response_len = R1_LEN;
+		if (SUCCESS != send_command(sd_desc, &cmd_desc))
+			return FAILURE;
+		if(cmd_desc.response[0] != R1_READY_STATE) {
+			DEBUG_MSG("Failed to send stop transmission command\n");
+			return FAILURE;
+		}
+		sd_desc->busy = true;
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * Write the blocks of the write-behind cache to the card
+ * @param sd_desc	- Instance of the SD card
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+static int32_t cache_flush(struct sd_desc *sd_desc)
+{
+	int32_t ret;
+
+	if (!sd_desc->cache_count)
+		return SUCCESS;
+
+	ret = stream_write(sd_desc, sd_desc->cache, sd_desc->cache_start,
+			   sd_desc->cache_count);
+	/* On failure the blocks are dropped, the error is reported once */
+	sd_desc->cache_count = 0;
+
+	return ret;
+}
+
+/**
+ * Read consecutive blocks, the blocks waiting in the write-behind cache are
+ * taken from the cache
+ * @param sd_desc	- Instance of the SD card
+ * @param data		- Where data will be read
+ * @param block		- First block
+ * @param count		- Number of blocks
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sd_read_blocks(struct sd_desc *sd_desc, uint8_t *data, uint32_t block,
+		       uint32_t count)
+{
+	uint32_t	first;
+	uint32_t	last;
+
+	if (!sd_desc || !data || !count ||
+	    (uint64_t)block + count > sd_desc->memory_size >> DATA_BLOCK_BITS)
+		return FAILURE;
+
+	if (SUCCESS != stream_read(sd_desc, data, block, count))
+		return FAILURE;
+
+	if (!sd_desc->cache_count)
+		return SUCCESS;
+
+	first = block > sd_desc->cache_start ? block : sd_desc->cache_start;
+	last = block + count;
+	if (last > sd_desc->cache_start + sd_desc->cache_count)
+		last = sd_desc->cache_start + sd_desc->cache_count;
+	if (first < last)
+		memcpy(data + (first - block) * DATA_BLOCK_LEN,
+		       sd_desc->cache + (first - sd_desc->cache_start) *
+		       DATA_BLOCK_LEN, (last - first) * DATA_BLOCK_LEN);
+
+	return SUCCESS;
+}
+
+/**
+ * Write consecutive blocks
+ *
+ * With the write-behind cache enabled, consecutive small writes are merged
+ * in the cache and written with a single CMD25 when the cache is full, when
+ * a write is not consecutive or when sd_sync() is called. Writes larger
+ * than the cache are streamed directly.
+ * @param sd_desc	- Instance of the SD card
+ * @param data		- Data to write
+ * @param block		- First block
+ * @param count		- Number of blocks
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sd_write_blocks(struct sd_desc *sd_desc, const uint8_t *data,
+			uint32_t block, uint32_t count)
+{
+	uint32_t	idx;
+	uint32_t	n;
+
+	if (!sd_desc || !data || !count ||
+	    (uint64_t)block + count > sd_desc->memory_size >> DATA_BLOCK_BITS)
+		return FAILURE;
+
+	if (!sd_desc->cache_blocks)
+		return stream_write(sd_desc, data, block, count);
+
+	while (count) {
+		/* Update or extend the cached run */
+		if (sd_desc->cache_count && block >= sd_desc->cache_start &&
+		    block <= sd_desc->cache_start + sd_desc->cache_count &&
+		    block - sd_desc->cache_start < sd_desc->cache_blocks) {
+			idx = block - sd_desc->cache_start;
+			n = sd_desc->cache_blocks - idx;
+			if (n > count)
+				n = count;
+			memcpy(sd_desc->cache + idx * DATA_BLOCK_LEN, data,
+			       n * DATA_BLOCK_LEN);
+			if (idx + n > sd_desc->cache_count)
+				sd_desc->cache_count = idx + n;
+			data += n * DATA_BLOCK_LEN;
+			block += n;
+			count -= n;
+			continue;
 		}
-		data_idx += buff_copy_len;
-		i++;
+
+		if (SUCCESS != cache_flush(sd_desc))
+			return FAILURE;
+
+		if (count >= sd_desc->cache_blocks)
+			return stream_write(sd_desc, data, block, count);
+
+		sd_desc->cache_start = block;
+		memcpy(sd_desc->cache, data, count * DATA_BLOCK_LEN);
+		sd_desc->cache_count = count;
+		count = 0;
 	}
 
 	return SUCCESS;
 }
 
+/**
+ * Write the cached blocks and wait for the card to finish programming
+ * @param sd_desc	- Instance of the SD card
+ * @return SUCCESS in case of success, FAILURE otherwise.
+ */
+int32_t sd_sync(struct sd_desc *sd_desc)
+{
+	if (!sd_desc)
+		return FAILURE;
+
+	if (SUCCESS != cache_flush(sd_desc))
+		return FAILURE;
+
+	return wait_if_busy(sd_desc);
+}
+
 /**
  * Read data of size len from the specified address and store it in data.
  * This operation returns only when the read is complete
@@ -417,7 +581,9 @@ static int32_t read_multiple_blocks(struct sd_desc *sd_desc,
 int32_t sd_read(struct sd_desc *sd_desc,
 		uint8_t *data, uint64_t address, uint64_t len)
 {
-	struct cmd_desc	cmd_desc;
+	uint32_t	block;
+	uint32_t	offset;
+	uint64_t	n;
 
 	/* Initial checks */
 	if (data == NULL || address > sd_desc->memory_size ||
@@ -425,32 +591,37 @@ int32_t sd_read(struct sd_desc *sd_desc,
 	    address + len > sd_desc->memory_size)
 		return FAILURE;
 
-	/* Send read command */
-	cmd_desc.cmd = (get_nb_of_blocks(address, len) == 1) ? CMD(17): CMD(18);
-	cmd_desc.arg = address >> DATA_BLOCK_BITS;;
-	cmd_desc.response_len = R1_LEN;
-	if (SUCCESS != send_command(sd_desc, &cmd_desc))
-		return FAILURE;
-	if (cmd_desc.response[0] != R1_READY_STATE) {
-		DEBUG_MSG("Failed to write Data command\n");
-		return FAILURE;
-	}
+	block = address >> DATA_BLOCK_BITS;
+	offset = address & MASK_ADDR_IN_BLOCK;
 
-	/* Read blocks */
-	if (SUCCESS != read_multiple_blocks(sd_desc, data, address, len))
-		return FAILURE;
+	/* Partial first block */
+	if (offset && len) {
+		n = DATA_BLOCK_LEN - offset;
+		if (n > len)
+			n = len;
+		if (SUCCESS != sd_read_blocks(sd_desc, sd_desc->bounce, block, 1))
+			return FAILURE;
+		memcpy(data, sd_desc->bounce + offset, n);
+		data += n;
+		len -= n;
+		block++;
+	}
 
-	/* Send stop transmission command */
-	if (get_nb_of_blocks(address, len) != 1) {
-		cmd_desc.cmd = CMD(12);
-		cmd_desc.arg = STUFF_ARG;
-		cmd_desc.response_len = R1_LEN;
-		if (SUCCESS != send_command(sd_desc, &cmd_desc))
+	/* Full blocks */
+	n = len >> DATA_BLOCK_BITS;
+	if (n) {
+		if (SUCCESS != sd_read_blocks(sd_desc, data, block, n))
 			return FAILURE;
-		if(cmd_desc.response[0] != R1_READY_STATE) {
-			DEBUG_MSG("Failed to send stop transmission command\n");
+		data += n << DATA_BLOCK_BITS;
+		len -= n << DATA_BLOCK_BITS;
+		block += n;
+	}
+
+	/* Partial last block */
+	if (len) {
+		if (SUCCESS != sd_read_blocks(sd_desc, sd_desc->bounce, block, 1))
 			return FAILURE;
-		}
+		memcpy(data, sd_desc->bounce, len);
 	}
 
 	return SUCCESS;
@@ -458,7 +629,9 @@ int32_t sd_read(struct sd_desc *sd_desc,
 
 /**
  * Write data of size len to the specified address
- * This operation returns only when the write is complete
+ * This operation returns when the card accepted the data, it may still be
+ * in the write-behind cache or being programmed. Call sd_sync() to wait
+ * for the data to be stored.
  * @param sd_desc	- Instance of the SD card
  * @param data		- Data to write
  * @param address	- Address in memory where data will be written
@@ -468,51 +641,53 @@ int32_t sd_read(struct sd_desc *sd_desc,
 int32_t sd_write(struct sd_desc *sd_desc, uint8_t *data, uint64_t address,
 		 uint64_t len)
 {
-	struct cmd_desc	cmd_desc;
-	uint8_t		first_block[DATA_BLOCK_LEN] __attribute__ ((aligned));
-	uint8_t		last_block[DATA_BLOCK_LEN] __attribute__ ((aligned));
+	uint32_t	block;
+	uint32_t	offset;
+	uint64_t	n;
 
 	/* Initial checks */
 	if (data == NULL || address > sd_desc->memory_size ||
 	    len > sd_desc->memory_size || address + len > sd_desc->memory_size)
 		return FAILURE;
 
-	/* Read first and last block in memory if needed to be updated with user data and then written back                                                                        */
-	/* If not writing from the beginning of a block or */
-	if ((address & MASK_ADDR_IN_BLOCK) != 0 ||
-	    /* If writing from the beginning but not the full block */
-	    ((address & MASK_ADDR_IN_BLOCK) == 0 && len < DATA_BLOCK_LEN))
-		sd_read(sd_desc, first_block, address & MASK_BLOCK_NUMBER, DATA_BLOCK_LEN);
-	/* If the last block is different from the first and */
-	if (((address + len - 1) & MASK_BLOCK_NUMBER) != (address & MASK_BLOCK_NUMBER)
-	    /* If reading less than the full block */
-	    && ((address + len - 1) & MASK_ADDR_IN_BLOCK) != MASK_ADDR_IN_BLOCK)
-		sd_read(sd_desc, last_block, (address + len - 1) & MASK_BLOCK_NUMBER,
-			DATA_BLOCK_LEN);
-
-	/* Send write command to SD */
-	cmd_desc.cmd = (get_nb_of_blocks(address, len) == 1) ? CMD(24): CMD(25);
-	cmd_desc.arg = address >> DATA_BLOCK_BITS; //Address of first block
-	cmd_desc.response_len = R1_LEN;
-	if (SUCCESS != send_command(sd_desc, &cmd_desc))
-		return FAILURE;
-	if (cmd_desc.response[0] != R1_READY_STATE) {
-		DEBUG_MSG("Failed to write Data command\n");
-		return FAILURE;
+	block = address >> DATA_BLOCK_BITS;
+	offset = address & MASK_ADDR_IN_BLOCK;
+
+	/* Read, update and write back a partial first block */
+	if (offset || len < DATA_BLOCK_LEN) {
+		n = DATA_BLOCK_LEN - offset;
+		if (n > len)
+			n = len;
+		if (n) {
+			if (SUCCESS != sd_read_blocks(sd_desc, sd_desc->bounce,
+						      block, 1))
+				return FAILURE;
+			memcpy(sd_desc->bounce + offset, data, n);
+			if (SUCCESS != sd_write_blocks(sd_desc, sd_desc->bounce,
+						       block, 1))
+				return FAILURE;
+		}
+		data += n;
+		len -= n;
+		block++;
 	}
 
-	/* Write blocks */
-	if (SUCCESS != write_multiple_blocks(sd_desc, data, address, len,
-					     first_block, last_block))
-		return FAILURE;
+	/* Full blocks */
+	n = len >> DATA_BLOCK_BITS;
+	if (n) {
+		if (SUCCESS != sd_write_blocks(sd_desc, data, block, n))
+			return FAILURE;
+		data += n << DATA_BLOCK_BITS;
+		len -= n << DATA_BLOCK_BITS;
+		block += n;
+	}
 
-	/* Send stop transmission token */
-	if (get_nb_of_blocks(address, len) != 1) {
-		sd_desc->buff[0] = STOP_TRANSMISSION_TOKEN;
-		sd_desc->buff[1] = 0xFF;
-		if (SUCCESS != spi_write_and_read(sd_desc->spi_desc, sd_desc->buff, 2))
+	/* Read, update and write back a partial last block */
+	if (len) {
+		if (SUCCESS != sd_read_blocks(sd_desc, sd_desc->bounce, block, 1))
 			return FAILURE;
-		if (SUCCESS != wait_until_not_busy(sd_desc))
+		memcpy(sd_desc->bounce, data, len);
+		if (SUCCESS != sd_write_blocks(sd_desc, sd_desc->bounce, block, 1))
 			return FAILURE;
 	}
 
@@ -539,6 +714,12 @@ int32_t sd_init(struct sd_desc **sd_desc, const struct sd_init_param *param)
 	if (!local_desc)
 		return FAILURE;
 	local_desc->spi_desc = param->spi_desc;
+	if (param->cache_blocks) {
+		local_desc->cache = calloc(param->cache_blocks, DATA_BLOCK_LEN);
+		if (!local_desc->cache)
+			goto failure;
+		local_desc->cache_blocks = param->cache_blocks;
+	}
 
 	/* Synchronize SD card frequency: Send 10 dummy bytes*/
 	memset(local_desc->buff, 0xFF, 10);
@@ -552,7 +733,7 @@ int32_t sd_init(struct sd_desc **sd_desc, const struct sd_init_param *param)
 	i = 0;
 	while (true) {
 		if (SUCCESS != send_command(local_desc, &cmd_desc))
-			return FAILURE;
+			goto failure;
 		if (cmd_desc.response[0] == R1_IDLE_STATE)
 			break;
 		if (++i == CMD0_RETRY_NUMBER) {
@@ -581,7 +762,7 @@ int32_t sd_init(struct sd_desc **sd_desc, const struct sd_init_param *param)
 	cmd_desc.response_len = R1_LEN;
 	while (true) {
 		if (SUCCESS != send_command(local_desc, &cmd_desc))
-			return FAILURE;
+			goto failure;
 		if (cmd_desc.response[0] == R1_READY_STATE)
 			break;
 		cmd_desc.arg = 0x00000000u;
@@ -627,20 +808,27 @@ int32_t sd_init(struct sd_desc **sd_desc, const struct sd_init_param *param)
 
 	return SUCCESS;
 failure:
+	free(local_desc->cache);
 	free(local_desc);
 	return FAILURE;
 }
 
 /**
  * Remove the initialize instance of SD card.
+ * The cached blocks are written to the card first.
  * @param desc	- Instance of the SD card
  * @return SUCCESS in case of success, FAILURE otherwise.
  */
 int32_t sd_remove(struct sd_desc *desc)
 {
+	int32_t ret;
+
 	if (desc == NULL)
 		return FAILURE;
 
+	ret = sd_sync(desc);
+	free(desc->cache);
 	free(desc);
-	return SUCCESS;
+
+	return ret;
 }
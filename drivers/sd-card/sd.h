@@ -85,6 +85,8 @@
 struct sd_init_param {
 	/** Descriptor of an initialized SPI channel */
 	struct spi_desc *spi_desc;
+	/** Size of the write-behind cache in blocks, 0 to disable it */
+	uint32_t	cache_blocks;
 };
 
 /**
@@ -100,6 +102,20 @@ struct sd_desc {
 	uint8_t		high_capacity;
 	/** Buffer used for the driver implementation */
 	uint8_t		buff[18];
+	/** The card is programming, wait before the next command */
+	bool		busy;
+	/** Write-behind cache, holds consecutive blocks */
+	uint8_t		*cache;
+	/** Size of the cache in blocks */
+	uint32_t	cache_blocks;
+	/** First block in the cache */
+	uint32_t	cache_start;
+	/** Number of blocks in the cache */
+	uint32_t	cache_count;
+	/** Block transfer: start token, data, CRC and data response token */
+	uint8_t		xfer[DATA_BLOCK_LEN + 4] __attribute__ ((aligned));
+	/** Partial blocks of sd_read() and sd_write() */
+	uint8_t		bounce[DATA_BLOCK_LEN] __attribute__ ((aligned));
 };
 
 /**
@@ -132,6 +148,15 @@ int32_t sd_write(struct sd_desc *desc,
 		 uint8_t *data,
 		 uint64_t address,
 		 uint64_t len);
+int32_t sd_read_blocks(struct sd_desc *desc,
+		       uint8_t *data,
+		       uint32_t block,
+		       uint32_t count);
+int32_t sd_write_blocks(struct sd_desc *desc,
+			const uint8_t *data,
+			uint32_t block,
+			uint32_t count);
+int32_t sd_sync(struct sd_desc *desc);
 
 #endif /* __SD_H__ */
 
@@ -55,9 +55,7 @@
 #include <inttypes.h>
 
 #ifdef ENABLE_IIO_NETWORK
-#include "delay.h"
 #include "tcp_socket.h"
-#include "circular_buffer.h"
 #endif
 
 /******************************************************************************/
@@ -66,12 +64,58 @@
 
 #define IIOD_PORT		30431
 #define MAX_SOCKET_TO_HANDLE	4
+#define IIO_CLIENT_BUFF_SIZE	256
+#define IIO_CLIENT_MAX_CMD_SIZE	8192
+#define IIO_CLIENT_CHUNK_SIZE	4096
+#define IIO_BIN_TEXT_SIZE	64
+#define IIO_BIN_MAX_FRAME	256
+#define IIO_BIN_MAX_WRITES	((IIO_BIN_MAX_FRAME - IIO_BIN_HEADER_SIZE) / \
+				 IIO_BIN_WRITE_SIZE)
+/* Compression of the XML */
+#define IIO_LZ_WINDOW		4096
+#define IIO_LZ_MIN_MATCH	3
+#define IIO_LZ_MAX_MATCH	18
+#define IIO_LZ_MAX_CHAIN	32
+#define IIO_LZ_HASH_SIZE	1024
+#define IIO_LZ_HASH(p)		((((uint8_t)(p)[0] << 6) ^ \
+				  ((uint8_t)(p)[1] << 3) ^ \
+				  (uint8_t)(p)[2]) % IIO_LZ_HASH_SIZE)
+#define IIO_XML_Z_MAX_SIZE(len)	((len) + (len) / 8 + 1)
 #define REG_ACCESS_ATTRIBUTE	"direct_reg_access"
+#define CH_ID_MAX_LEN		64
 
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
 
+#ifdef ENABLE_IIO_NETWORK
+/* State of a network client */
+struct iio_client {
+	/* Client socket, NULL if the slot is free */
+	struct tcp_socket_desc		*sock;
+	/* Received bytes not yet consumed */
+	char				*buff;
+	/* Size of buff, grown up to IIO_CLIENT_MAX_CMD_SIZE for the data of
+	 * WRITE commands */
+	uint32_t			size;
+	/* Number of bytes in buff */
+	uint32_t			len;
+	/* Bytes of a refused command still to be received and dropped */
+	uint32_t			skip;
+	/* Device of the READBUF or WRITEBUF being served, NULL if none */
+	struct iio_interface		*xfer_iface;
+	bool				xfer_write;
+	uint32_t			xfer_offset;
+	uint32_t			xfer_left;
+	uint32_t			xfer_mask;
+	/* True while the client waits to be served, since ready_us */
+	bool				waiting;
+	uint32_t			ready_us;
+	/* Fairness and latency metrics */
+	struct iio_net_client_stats	stats;
+};
+#endif
+
 static char header[] =
 	"<?xml version=\"1.0\" encoding=\"utf-8\"?>"
 	"<!DOCTYPE context ["
@@ -118,6 +162,29 @@ struct attr_fun_params {
 	struct iio_ch_info	*ch_info;
 };
 
+/* Kind of item stored in the lookup table of an interface */
+enum iio_lookup_type {
+	IIO_LOOKUP_CH_IN,
+	IIO_LOOKUP_CH_OUT,
+	IIO_LOOKUP_ATTR_DEVICE,
+	IIO_LOOKUP_ATTR_DEBUG,
+	IIO_LOOKUP_ATTR_BUFFER,
+	/* Attribute of the channel with index (scope - IIO_LOOKUP_ATTR_CH) */
+	IIO_LOOKUP_ATTR_CH
+};
+
+/* Entry of the lookup table, built once at iio_register() */
+struct iio_lookup_entry {
+	/* Hash of name and scope */
+	uint32_t		hash;
+	/* enum iio_lookup_type, plus the channel index for channel attributes */
+	uint32_t		scope;
+	/* Channel ID or attribute name, NULL for an empty entry */
+	const char		*name;
+	/* struct iio_channel or struct iio_attribute */
+	void			*item;
+};
+
 /**
  * @struct iio_interface
  * @brief Links a physical device instance "void *dev_instance"
@@ -138,6 +205,17 @@ struct iio_interface {
 	struct iio_device	*dev_descriptor;
 	struct iio_data_buffer	*write_buffer;
 	struct iio_data_buffer	*read_buffer;
+	/** Channel IDs, as used by the clients */
+	char			(*ch_ids)[CH_ID_MAX_LEN];
+	/** Hash table of the channels and attributes */
+	struct iio_lookup_entry	*lookup;
+	/** Number of entries in lookup, power of 2 */
+	uint32_t		lookup_size;
+	/** Number of attributes of each binary protocol group */
+	uint16_t		*nb_attrs;
+	/** XML fragment describing the device */
+	char			*xml;
+	uint32_t		xml_len;
 };
 
 struct iio_desc {
@@ -146,16 +224,30 @@ struct iio_desc {
 	enum pysical_link_type	phy_type;
 	void			*phy_desc;
 	struct list_desc	*interfaces_list;
+	/* Registered interfaces, indexed by the number in their dev_id */
+	struct iio_interface	**interfaces;
+	/* XML of the context, built from the device fragments when needed */
 	char			*xml_desc;
 	uint32_t		xml_size;
-	uint32_t		xml_size_to_last_dev;
+	bool			xml_outdated;
+	/* Compressed XML, built when first requested */
+	uint8_t			*xml_z;
+	uint32_t		xml_z_size;
 	uint32_t		dev_count;
 	struct uart_desc	*uart_desc;
+	/* First byte of a text command, read to check for binary requests */
+	int16_t			uart_peek;
 #ifdef ENABLE_IIO_NETWORK
-	/* FIFO for socket descriptors */
-	struct circular_buffer	*sockets;
-	/* Client socket active during an iio_step */
-	struct tcp_socket_desc	*current_sock;
+	/* Network clients */
+	struct iio_client	*clients;
+	/* Number of entries in clients */
+	uint32_t		max_clients;
+	/* Client served during an iio_step */
+	struct iio_client	*current_client;
+	/* Index of the last served client, the next one is served first */
+	uint32_t		last_client;
+	/* Microsecond counter for the client metrics, may be NULL */
+	uint32_t		(*get_time_us)(void);
 	/* Instance of server socket */
 	struct tcp_socket_desc	*server;
 #endif
@@ -169,108 +261,253 @@ static struct iio_desc			*g_desc;
 
 #ifdef ENABLE_IIO_NETWORK
 
-static inline int32_t _pop_sock(struct iio_desc *desc,
-				struct tcp_socket_desc **sock)
+/* Release a client slot */
+static void _client_remove(struct iio_client *client)
 {
-	return cb_read(desc->sockets, sock, sizeof(*sock));
+	socket_remove(client->sock);
+	free(client->buff);
+	client->sock = NULL;
+	client->buff = NULL;
+	client->len = 0;
+	client->xfer_iface = NULL;
+	client->waiting = false;
+	client->stats.connected = false;
+}
+
+/* Accept all waiting connections, as long as there are free client slots */
+static int32_t _accept_clients(struct iio_desc *desc)
+{
+	struct tcp_socket_desc	*sock;
+	char			*buff;
+	uint32_t		i;
+	int32_t			ret;
+
+	while (true) {
+		ret = socket_accept(desc->server, &sock);
+		if (ret == -EAGAIN)
+			return SUCCESS;
+		if (IS_ERR_VALUE(ret))
+			return ret;
+
+		for (i = 0; i < desc->max_clients; i++)
+			if (!desc->clients[i].sock)
+				break;
+		buff = i < desc->max_clients ?
+		       malloc(IIO_CLIENT_BUFF_SIZE) : NULL;
+		if (!buff) {
+			/* No free slot, refuse the connection */
+			socket_remove(sock);
+			continue;
+		}
+
+		memset(&desc->clients[i], 0, sizeof(desc->clients[i]));
+		desc->clients[i].sock = sock;
+		desc->clients[i].buff = buff;
+		desc->clients[i].size = IIO_CLIENT_BUFF_SIZE;
+		desc->clients[i].stats.connected = true;
+	}
 }
 
-static inline int32_t _push_sock(struct iio_desc *desc,
-				 struct tcp_socket_desc *sock)
+/* Drop the first bytes of the client buffer */
+static void _client_consume(struct iio_client *client, uint32_t len)
 {
-	return cb_write(desc->sockets, &sock, sizeof(sock));
+	client->len -= len;
+	memmove(client->buff, client->buff + len, client->len);
 }
 
-static inline int32_t _nb_active_sockets(struct iio_desc *desc)
+static uint32_t iio_bin_frame_size(const uint8_t *buff, uint32_t len);
+
+/* Size of the text command starting buff, with the data of a WRITE command,
+ * 0 if the command line is not complete yet. The data of WRITEBUF is not
+ * part of the command, it is received in chunks. */
+static uint32_t _text_frame_size(const char *buff, uint32_t len)
 {
-	uint32_t size;
+	const char	*end;
+	const char	*p;
+	uint32_t	size;
+	unsigned long	data;
+
+	end = memchr(buff, '\n', len);
+	if (!end)
+		return 0;
+	size = end - buff + 1;
+
+	if (strncmp(buff, "WRITE ", 6))
+		return size;
 
-	cb_size(desc->sockets, &size);
+	/* The data size is the last argument */
+	for (p = end; p > buff && p[-1] != ' '; p--)
+		;
 
-	return size / sizeof(struct tcp_socket_desc *);
+	data = strtoul(p, NULL, 10);
+
+	/* The sum doesn't overflow */
+	return size + min(data, (unsigned long)(UINT32_MAX - size));
 }
 
-/* Blocking until new socket available.
- * Will iterate through a list of sockets */
-static int32_t _get_next_socket(struct iio_desc *desc)
+/* Receive, without blocking, the bytes available for a client. */
+static void _poll_client(struct iio_client *client)
 {
-	struct tcp_socket_desc	*sock;
-	int32_t			ret;
-	uint32_t		nb_active_sockets;
+	uint32_t	size;
+	char		*buff;
+	int32_t		ret;
 
-	/* Get all new waiting sockets.
-	 * If none is available, wait until first connection */
-	do {
-		ret = socket_accept(desc->server, &sock);
-		if (ret == -EAGAIN) {
-			nb_active_sockets = _nb_active_sockets(desc);
-			if (nb_active_sockets == 0) {
-				/* Wait until a connection exists */
-				mdelay(1);
-				continue;
-			} else {
-				break;
-			}
-		} else if (IS_ERR_VALUE(ret)) {
-			return ret;
+	if (client->len < client->size) {
+		ret = socket_recv(client->sock, client->buff + client->len,
+				  client->size - client->len);
+		if (ret == -ENOTCONN) {
+			/* The resources of a disconnected client are
+			 * released */
+			_client_remove(client);
+			return;
 		}
-		/* Add socket to queue */
-		ret = _push_sock(desc, sock);
-		if (IS_ERR_VALUE(ret))
-			return ret;
-	} while (true);
+		if (ret > 0)
+			client->len += ret;
+	}
 
-	ret = _pop_sock(desc, &desc->current_sock);
-	if (IS_ERR_VALUE(ret)) {
-		desc->current_sock = NULL;
-		return ret;
+	if (client->skip) {
+		size = min(client->skip, client->len);
+		client->skip -= size;
+		_client_consume(client, size);
 	}
 
-	return SUCCESS;
+	/* Make room for the data of a WRITE command */
+	if (!client->len || (client->buff[0] & 0x80) || client->xfer_iface)
+		return;
+	size = _text_frame_size(client->buff, client->len);
+	if (size <= client->size || size > IIO_CLIENT_MAX_CMD_SIZE)
+		return;
+	buff = realloc(client->buff, size);
+	if (!buff)
+		return;
+	client->buff = buff;
+	client->size = size;
 }
 
-static int32_t network_read(const void *data, uint32_t len)
+/* A client is ready when a full command, with its data, or binary request
+ * has been received, or while a READBUF or WRITEBUF is served. Commands that
+ * can not be received in the client buffer are refused when it is full. */
+static inline bool _client_ready(struct iio_client *client)
 {
-	uint32_t	i;
-	int32_t		ret;
+	uint32_t size;
 
-	if ((int32_t)g_desc->current_sock == -1)
-		return -1;
+	if (!client->sock)
+		return false;
+	if (client->xfer_iface)
+		return !client->xfer_write || client->len;
+	if (!client->len)
+		return false;
+	if (client->len == client->size)
+		return true;
+
+	if (client->buff[0] & 0x80)
+		size = iio_bin_frame_size((uint8_t *)client->buff, client->len);
+	else
+		size = _text_frame_size(client->buff, client->len);
 
-	if (g_desc->current_sock == NULL) {
-		ret = _get_next_socket(g_desc);
-		if (IS_ERR_VALUE(ret))
-			return ret;
-	}
+	return size && (size <= client->len || size > IIO_CLIENT_MAX_CMD_SIZE);
+}
 
-	i = 0;
-	do {
-		ret = socket_recv(g_desc->current_sock,
-				  (void *)((uint8_t *)data + i), len - i);
-		if (IS_ERR_VALUE(ret)) {
-			*(int8_t *)data = '*';
-			break;
+/* Get the next ready client, round robin after the last served one. The
+ * time a ready client waits for its turn is recorded in its metrics. */
+static struct iio_client *_get_next_client(struct iio_desc *desc)
+{
+	struct iio_client	*client;
+	struct iio_client	*next = NULL;
+	uint32_t		last = desc->last_client;
+	uint32_t		now;
+	uint32_t		i;
+	uint32_t		idx;
+
+	for (i = 0; i < desc->max_clients; i++)
+		if (desc->clients[i].sock)
+			_poll_client(&desc->clients[i]);
+
+	now = desc->get_time_us ? desc->get_time_us() : 0;
+	for (i = 1; i <= desc->max_clients; i++) {
+		idx = (last + i) % desc->max_clients;
+		client = &desc->clients[idx];
+		if (!_client_ready(client))
+			continue;
+
+		if (!client->waiting) {
+			client->waiting = true;
+			client->ready_us = now;
 		}
+		if (!next) {
+			next = client;
+			desc->last_client = idx;
+		}
+	}
 
-		i += ret;
-	} while (i < len);
-
-	if (ret == -ENOTCONN) {
-		/* A socket connection is disconnected, so we release
-		 * the resources and don't add it again in the list */
-		socket_remove(g_desc->current_sock);
-		g_desc->current_sock = (void *)-1;
+	if (next) {
+		next->waiting = false;
+		next->stats.max_wait_us = max(next->stats.max_wait_us,
+					      now - next->ready_us);
 	}
 
+	return next;
+}
+
+/*
+ * Commands are executed once fully received, so the data is always served
+ * from the client buffer and the read never waits for the network.
+ */
+static int32_t network_read(const void *data, uint32_t len)
+{
+	struct iio_client	*client = g_desc->current_client;
+	uint32_t		i;
+
+	if (!client || !client->sock)
+		return -1;
+
+	i = min(len, client->len);
+	if (!i)
+		return -EAGAIN;
+	memcpy((uint8_t *)data, client->buff, i);
+	_client_consume(client, i);
+
 	return i;
 }
+
+/**
+ * @brief Get the fairness and latency metrics of a network client.
+ * @param desc - iio descriptor.
+ * @param client - Index of the client slot.
+ * @param stats - Where the metrics are stored.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+int32_t iio_get_net_client_stats(struct iio_desc *desc, uint32_t client,
+				 struct iio_net_client_stats *stats)
+{
+	if (!desc || !stats || desc->phy_type != USE_NETWORK ||
+	    client >= desc->max_clients)
+		return -EINVAL;
+
+	*stats = desc->clients[client].stats;
+
+	return SUCCESS;
+}
 #endif
 
 static ssize_t iio_phy_read(char *buf, size_t len)
 {
-	if (g_desc->phy_type == USE_UART)
-		return (ssize_t)uart_read(g_desc->uart_desc, (uint8_t *)buf,
-					  (size_t)len);
+	ssize_t ret;
+
+	if (g_desc->phy_type == USE_UART) {
+		if (g_desc->uart_peek < 0 || !len)
+			return (ssize_t)uart_read(g_desc->uart_desc,
+						  (uint8_t *)buf, (size_t)len);
+
+		/* Serve the byte read by iio_step() first */
+		buf[0] = g_desc->uart_peek;
+		g_desc->uart_peek = -1;
+		if (len == 1)
+			return 1;
+		ret = uart_read(g_desc->uart_desc, (uint8_t *)buf + 1, len - 1);
+
+		return IS_ERR_VALUE(ret) ? ret : ret + 1;
+	}
 #ifdef ENABLE_IIO_NETWORK
 	else
 		return network_read((void *)buf, (uint32_t)len);
@@ -287,7 +524,9 @@ static ssize_t iio_phy_write(const char *buf, size_t len)
 					   (uint8_t *)buf, (size_t)len);
 #ifdef ENABLE_IIO_NETWORK
 	else
-		return socket_send(g_desc->current_sock, buf, len);
+		return g_desc->current_client && g_desc->current_client->sock ?
+		       socket_send(g_desc->current_client->sock, buf, len) :
+		       -ENOTCONN;
 #endif
 
 	return -EINVAL;
@@ -313,50 +552,230 @@ static inline void _print_ch_id(char *buff, struct iio_channel *ch)
 	}
 }
 
+/* FNV-1a hash of a string, mixed with the scope of the name */
+static inline uint32_t iio_lookup_hash(const char *name, uint32_t scope)
+{
+	uint32_t hash = 2166136261u;
+
+	while (*name) {
+		hash ^= (uint8_t)*name++;
+		hash *= 16777619u;
+	}
+
+	return hash ^ (scope * 2654435761u);
+}
+
 /**
- * @brief Get channel ID from a list of channels.
- * @param channel - Channel name.
- * @param desc - Device descriptor
- * @param ch_out - If "true" is output channel, if "false" is input channel.
- * @return Channel ID, or negative value if attribute is not found.
+ * @brief Find a channel or an attribute in the lookup table of an interface.
+ * @param intf - Interface.
+ * @param scope - Kind of the item, see enum iio_lookup_type.
+ * @param name - Channel ID or attribute name.
+ * @return Pointer to the item, NULL if it is not found.
  */
-static inline struct iio_channel *iio_get_channel(const char *channel,
-		struct iio_device *desc, bool ch_out)
+static void *iio_lookup(struct iio_interface *intf, uint32_t scope,
+			const char *name)
 {
-	int16_t i = 0;
-	char	ch_id[64];
+	struct iio_lookup_entry	*entry;
+	uint32_t		hash;
+	uint32_t		i;
 
-	while (i < desc->num_ch) {
-		_print_ch_id(ch_id, &desc->channels[i]);
-		if (!strcmp(channel, ch_id) &&
-		    (desc->channels[i].ch_out == ch_out))
-			return &desc->channels[i];
-		i++;
-	}
+	if (!intf->lookup)
+		return NULL;
+
+	hash = iio_lookup_hash(name, scope);
+	i = hash & (intf->lookup_size - 1);
+	for (entry = &intf->lookup[i]; entry->name;
+	     i = (i + 1) & (intf->lookup_size - 1), entry = &intf->lookup[i])
+		if (entry->hash == hash && entry->scope == scope &&
+		    !strcmp(entry->name, name))
+			return entry->item;
 
 	return NULL;
 }
 
+/* Add an item in the lookup table. The table is never full. */
+static void iio_lookup_add(struct iio_interface *intf, uint32_t scope,
+			   const char *name, void *item)
+{
+	struct iio_lookup_entry	*entry;
+	uint32_t		hash;
+	uint32_t		i;
+
+	hash = iio_lookup_hash(name, scope);
+	i = hash & (intf->lookup_size - 1);
+	while (intf->lookup[i].name) {
+		/* Keep the first definition, as the linear search did */
+		if (intf->lookup[i].hash == hash &&
+		    intf->lookup[i].scope == scope &&
+		    !strcmp(intf->lookup[i].name, name))
+			return;
+		i = (i + 1) & (intf->lookup_size - 1);
+	}
+
+	entry = &intf->lookup[i];
+	entry->hash = hash;
+	entry->scope = scope;
+	entry->name = name;
+	entry->item = item;
+}
+
+/* Number of attributes in an array */
+static uint32_t iio_nb_attributes(struct iio_attribute *attributes)
+{
+	uint32_t i = 0;
+
+	if (attributes)
+		while (attributes[i].name)
+			i++;
+
+	return i;
+}
+
+/* Add all attributes of an array in the lookup table */
+static void iio_lookup_add_attributes(struct iio_interface *intf,
+				      uint32_t scope,
+				      struct iio_attribute *attributes)
+{
+	uint32_t count = iio_nb_attributes(attributes);
+	uint32_t i;
+
+	for (i = 0; i < count; i++)
+		iio_lookup_add(intf, scope, attributes[i].name, &attributes[i]);
+}
+
+/**
+ * @brief Build the lookup table of the channels and attributes of an
+ * interface, so commands are dispatched without searching.
+ * @param intf - Interface.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_build_lookup(struct iio_interface *intf)
+{
+	struct iio_device	*dev = intf->dev_descriptor;
+	struct iio_channel	*ch;
+	uint32_t		count;
+	uint32_t		i;
+
+	count = iio_nb_attributes(dev->attributes) +
+		iio_nb_attributes(dev->debug_attributes) +
+		iio_nb_attributes(dev->buffer_attributes);
+	if (dev->channels) {
+		count += dev->num_ch;
+		for (i = 0; i < dev->num_ch; i++)
+			count += iio_nb_attributes(dev->channels[i].attributes);
+
+		intf->ch_ids = calloc(dev->num_ch, sizeof(*intf->ch_ids));
+		if (!intf->ch_ids)
+			return -ENOMEM;
+	}
+
+	intf->nb_attrs = calloc(IIO_BIN_GROUP_CH(dev->num_ch),
+				sizeof(*intf->nb_attrs));
+	if (!intf->nb_attrs) {
+		free(intf->ch_ids);
+		intf->ch_ids = NULL;
+		return -ENOMEM;
+	}
+
+	/* Keep the load factor under 1/2 */
+	intf->lookup_size = 1;
+	while (intf->lookup_size < 2 * count + 1)
+		intf->lookup_size <<= 1;
+
+	intf->lookup = calloc(intf->lookup_size, sizeof(*intf->lookup));
+	if (!intf->lookup) {
+		free(intf->nb_attrs);
+		free(intf->ch_ids);
+		intf->nb_attrs = NULL;
+		intf->ch_ids = NULL;
+		return -ENOMEM;
+	}
+
+	intf->nb_attrs[IIO_BIN_GROUP_DEVICE] =
+		iio_nb_attributes(dev->attributes);
+	intf->nb_attrs[IIO_BIN_GROUP_DEBUG] =
+		iio_nb_attributes(dev->debug_attributes);
+	intf->nb_attrs[IIO_BIN_GROUP_BUFFER] =
+		iio_nb_attributes(dev->buffer_attributes);
+	if (dev->channels)
+		for (i = 0; i < dev->num_ch; i++) {
+			ch = &dev->channels[i];
+			intf->nb_attrs[IIO_BIN_GROUP_CH(i)] =
+				iio_nb_attributes(ch->attributes);
+			_print_ch_id(intf->ch_ids[i], ch);
+			iio_lookup_add(intf, ch->ch_out ? IIO_LOOKUP_CH_OUT :
+				       IIO_LOOKUP_CH_IN, intf->ch_ids[i], ch);
+			iio_lookup_add_attributes(intf, IIO_LOOKUP_ATTR_CH + i,
+						  ch->attributes);
+		}
+	iio_lookup_add_attributes(intf, IIO_LOOKUP_ATTR_DEVICE,
+				  dev->attributes);
+	iio_lookup_add_attributes(intf, IIO_LOOKUP_ATTR_DEBUG,
+				  dev->debug_attributes);
+	iio_lookup_add_attributes(intf, IIO_LOOKUP_ATTR_BUFFER,
+				  dev->buffer_attributes);
+
+	return SUCCESS;
+}
+
+/* Free an interface and its lookup table */
+static void iio_free_interface(struct iio_interface *intf)
+{
+	free(intf->lookup);
+	free(intf->ch_ids);
+	free(intf->nb_attrs);
+	free(intf->xml);
+	free(intf);
+}
+
+/**
+ * @brief Get channel from a device.
+ * @param intf - Interface of the device.
+ * @param channel - Channel ID.
+ * @param ch_out - If "true" is output channel, if "false" is input channel.
+ * @return Channel, or NULL if the channel is not found.
+ */
+static inline struct iio_channel *iio_get_channel(struct iio_interface *intf,
+		const char *channel, bool ch_out)
+{
+	return iio_lookup(intf, ch_out ? IIO_LOOKUP_CH_OUT : IIO_LOOKUP_CH_IN,
+			  channel);
+}
+
+/* Fill the channel properties passed to show and store functions */
+static inline void iio_get_ch_info(struct iio_ch_info *ch_info,
+				   struct iio_channel *ch)
+{
+	ch_info->ch_out = ch->ch_out;
+	ch_info->ch_num = ch->channel;
+	ch_info->type = ch->ch_type;
+	ch_info->differential = ch->diferential;
+	ch_info->address = ch->address;
+}
+
 /**
  * @brief Find interface with "device_name".
- * @param device_name - Device name.
- * @param iio_interfaces - List of interfaces.
+ * @param device_name - Device ID, "device" followed by the device number.
  * @return Interface pointer if interface is found, NULL otherwise.
  */
 static struct iio_interface *iio_get_interface(const char *device_name)
 {
-	struct iio_interface	*interface;
-	struct iio_interface	cmp_val;
-	int32_t					ret;
+	const char	*p;
+	uint32_t	id;
 
-	strcpy(cmp_val.dev_id, device_name);
+	if (strncmp(device_name, "device", 6))
+		return NULL;
 
-	ret = list_read_find(g_desc->interfaces_list,
-			     (void **)&interface, &cmp_val);
-	if (IS_ERR_VALUE(ret))
+	p = device_name + 6;
+	if (!isdigit((unsigned char)*p))
+		return NULL;
+
+	for (id = 0; isdigit((unsigned char)*p); p++)
+		id = id * 10 + (*p - '0');
+	if (*p || id >= g_desc->dev_count)
 		return NULL;
 
-	return interface;
+	return g_desc->interfaces[id];
 }
 
 /**
@@ -429,42 +848,36 @@ static ssize_t iio_write_all_attr(struct attr_fun_params *params,
 /**
  * @brief Read/write attribute.
  * @param params - Structure describing parameters for store and show functions
- * @param attributes - Array of attributes.
+ * @param intf - Interface of the device.
+ * @param scope - Kind of attribute, see enum iio_lookup_type.
  * @param attr_name - Attribute name to be modified
  * @param is_write -If it has value "1", writes attribute, otherwise reads
  * 		attribute.
  * @return Length of chars written/read or negative value in case of error.
  */
 static ssize_t iio_rd_wr_attribute(struct attr_fun_params *params,
-				   struct iio_attribute *attributes,
-				   char *attr_name,
-				   bool is_write)
+				   struct iio_interface *intf, uint32_t scope,
+				   const char *attr_name, bool is_write)
 {
-	int16_t i = 0;
+	struct iio_attribute *attribute;
 
-	/* Search attribute */
-	while (attributes[i].name) {
-		if (!strcmp(attr_name, attributes[i].name))
-			break;
-		i++;
-	}
-
-	if (!attributes[i].name)
+	attribute = iio_lookup(intf, scope, attr_name);
+	if (!attribute)
 		return -ENOENT;
 
 	if (is_write) {
-		if (!attributes[i].store)
+		if (!attribute->store)
 			return -ENOENT;
 
-		return attributes[i].store(params->dev_instance, params->buf,
-					   params->len, params->ch_info,
-					   attributes[i].priv);
+		return attribute->store(params->dev_instance, params->buf,
+					params->len, params->ch_info,
+					attribute->priv);
 	} else {
-		if (!attributes[i].show)
+		if (!attribute->show)
 			return -ENOENT;
-		return attributes[i].show(params->dev_instance, params->buf,
-					  params->len, params->ch_info,
-					  attributes[i].priv);
+		return attribute->show(params->dev_instance, params->buf,
+				       params->len, params->ch_info,
+				       attribute->priv);
 	}
 }
 
@@ -660,6 +1073,7 @@ static ssize_t iio_read_attr(const char *device_id, const char *attr, char *buf,
 	struct iio_interface	*dev;
 	struct attr_fun_params	params;
 	struct iio_attribute	*attributes;
+	uint32_t		scope;
 
 	dev = iio_get_interface(device_id);
 	if (!dev)
@@ -670,6 +1084,7 @@ static ssize_t iio_read_attr(const char *device_id, const char *attr, char *buf,
 	params.dev_instance = dev->dev_instance;
 	params.ch_info = NULL;
 	attributes = NULL;
+	scope = IIO_LOOKUP_ATTR_DEVICE;
 	switch (type) {
 	case IIO_ATTR_TYPE_DEBUG:
 		if (strcmp(attr, REG_ACCESS_ATTRIBUTE) == 0) {
@@ -679,19 +1094,22 @@ static ssize_t iio_read_attr(const char *device_id, const char *attr, char *buf,
 				return -ENOENT;
 		}
 		attributes = dev->dev_descriptor->debug_attributes;
+		scope = IIO_LOOKUP_ATTR_DEBUG;
 		break;
 	case IIO_ATTR_TYPE_DEVICE:
 		attributes = dev->dev_descriptor->attributes;
+		scope = IIO_LOOKUP_ATTR_DEVICE;
 		break;
 	case IIO_ATTR_TYPE_BUFFER:
 		attributes = dev->dev_descriptor->buffer_attributes;
+		scope = IIO_LOOKUP_ATTR_BUFFER;
 		break;
 	}
 
 	if (!strcmp(attr, ""))
 		return iio_read_all_attr(&params, attributes);
 	else
-		return iio_rd_wr_attribute(&params,attributes, (char *)attr, 0);
+		return iio_rd_wr_attribute(&params, dev, scope, attr, 0);
 }
 
 /**
@@ -710,6 +1128,7 @@ static ssize_t iio_write_attr(const char *device_id, const char *attr,
 	struct iio_interface	*dev;
 	struct attr_fun_params	params;
 	struct iio_attribute	*attributes;
+	uint32_t		scope;
 
 	dev = iio_get_interface(device_id);
 	if (!dev)
@@ -720,6 +1139,7 @@ static ssize_t iio_write_attr(const char *device_id, const char *attr,
 	params.dev_instance = dev->dev_instance;
 	params.ch_info = NULL;
 	attributes = NULL;
+	scope = IIO_LOOKUP_ATTR_DEVICE;
 	switch (type) {
 	case IIO_ATTR_TYPE_DEBUG:
 		if (strcmp(attr, REG_ACCESS_ATTRIBUTE) == 0) {
@@ -729,19 +1149,22 @@ static ssize_t iio_write_attr(const char *device_id, const char *attr,
 				return -ENOENT;
 		}
 		attributes = dev->dev_descriptor->debug_attributes;
+		scope = IIO_LOOKUP_ATTR_DEBUG;
 		break;
 	case IIO_ATTR_TYPE_DEVICE:
 		attributes = dev->dev_descriptor->attributes;
+		scope = IIO_LOOKUP_ATTR_DEVICE;
 		break;
 	case IIO_ATTR_TYPE_BUFFER:
 		attributes = dev->dev_descriptor->buffer_attributes;
+		scope = IIO_LOOKUP_ATTR_BUFFER;
 		break;
 	}
 
 	if (!strcmp(attr, ""))
 		return iio_write_all_attr(&params, attributes);
 	else
-		return iio_rd_wr_attribute(&params, attributes, (char *)attr, 1);
+		return iio_rd_wr_attribute(&params, dev, scope, attr, 1);
 }
 
 /**
@@ -766,15 +1189,11 @@ static ssize_t iio_ch_read_attr(const char *device_id, const char *channel,
 	if (!dev)
 		return FAILURE;
 
-	ch = iio_get_channel(channel, dev->dev_descriptor, ch_out);
+	ch = iio_get_channel(dev, channel, ch_out);
 	if (!ch)
 		return -ENOENT;
 
-	ch_info.ch_out = ch_out;
-	ch_info.ch_num = ch->channel;
-	ch_info.type = ch->ch_type;
-	ch_info.differential = ch->diferential;
-	ch_info.address = ch->address;
+	iio_get_ch_info(&ch_info, ch);
 	params.buf = buf;
 	params.len = len;
 	params.dev_instance = dev->dev_instance;
@@ -782,7 +1201,9 @@ static ssize_t iio_ch_read_attr(const char *device_id, const char *channel,
 	if (!strcmp(attr, ""))
 		return iio_read_all_attr(&params, ch->attributes);
 	else
-		return iio_rd_wr_attribute(&params, ch->attributes, (char *)attr, 0);
+		return iio_rd_wr_attribute(&params, dev, IIO_LOOKUP_ATTR_CH +
+					   (ch - dev->dev_descriptor->channels),
+					   attr, 0);
 }
 
 /**
@@ -807,15 +1228,11 @@ static ssize_t iio_ch_write_attr(const char *device_id, const char *channel,
 	if (!dev)
 		return -ENOENT;
 
-	ch = iio_get_channel(channel, dev->dev_descriptor, ch_out);
+	ch = iio_get_channel(dev, channel, ch_out);
 	if (!ch)
 		return -ENOENT;
 
-	ch_info.ch_out = ch_out;
-	ch_info.ch_num = ch->channel;
-	ch_info.type = ch->ch_type;
-	ch_info.differential = ch->diferential;
-	ch_info.address = ch->address;
+	iio_get_ch_info(&ch_info, ch);
 	params.buf = (char *)buf;
 	params.len = len;
 	params.dev_instance = dev->dev_instance;
@@ -823,7 +1240,584 @@ static ssize_t iio_ch_write_attr(const char *device_id, const char *channel,
 	if (!strcmp(attr, ""))
 		return iio_write_all_attr(&params, ch->attributes);
 	else
-		return iio_rd_wr_attribute(&params, ch->attributes, (char *)attr, 1);
+		return iio_rd_wr_attribute(&params, dev, IIO_LOOKUP_ATTR_CH +
+					   (ch - dev->dev_descriptor->channels),
+					   attr, 1);
+}
+
+static inline uint32_t iio_bin_get_le32(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void iio_bin_put_le32(uint8_t *p, uint32_t val)
+{
+	p[0] = val;
+	p[1] = val >> 8;
+	p[2] = val >> 16;
+	p[3] = val >> 24;
+}
+
+/* Size of the binary request starting buff, 0 if not known yet */
+static uint32_t iio_bin_frame_size(const uint8_t *buff, uint32_t len)
+{
+	uint32_t count;
+
+	if (len < IIO_BIN_HEADER_SIZE)
+		return 0;
+
+	count = buff[2] | (buff[3] << 8);
+	switch (buff[0]) {
+	case IIO_BIN_OP_READ:
+		return IIO_BIN_HEADER_SIZE + count * IIO_BIN_READ_SIZE;
+	case IIO_BIN_OP_WRITE:
+		return IIO_BIN_HEADER_SIZE + count * IIO_BIN_WRITE_SIZE;
+	case IIO_BIN_OP_XML:
+	default:
+		return IIO_BIN_HEADER_SIZE;
+	}
+}
+
+/**
+ * @brief Get an attribute from its binary protocol ID.
+ * @param id - Attribute ID, see IIO_BIN_ATTR_ID.
+ * @param intf - Interface of the attribute.
+ * @param ch_info - Channel properties, filled for a channel attribute.
+ * @param is_ch - Set if the attribute is a channel attribute.
+ * @return The attribute, or NULL if the ID is invalid.
+ */
+static struct iio_attribute *iio_bin_get_attr(uint32_t id,
+		struct iio_interface **intf, struct iio_ch_info *ch_info,
+		bool *is_ch)
+{
+	struct iio_device	*dev;
+	struct iio_attribute	*attributes;
+	uint32_t		dev_idx = id >> 24;
+	uint32_t		group = (id >> 16) & 0xFF;
+	uint32_t		idx = id & 0xFFFF;
+
+	if (dev_idx >= g_desc->dev_count || !g_desc->interfaces[dev_idx])
+		return NULL;
+
+	*intf = g_desc->interfaces[dev_idx];
+	dev = (*intf)->dev_descriptor;
+	if (group >= IIO_BIN_GROUP_CH(dev->channels ? dev->num_ch : 0) ||
+	    idx >= (*intf)->nb_attrs[group])
+		return NULL;
+
+	*is_ch = false;
+	switch (group) {
+	case IIO_BIN_GROUP_DEVICE:
+		attributes = dev->attributes;
+		break;
+	case IIO_BIN_GROUP_DEBUG:
+		attributes = dev->debug_attributes;
+		break;
+	case IIO_BIN_GROUP_BUFFER:
+		attributes = dev->buffer_attributes;
+		break;
+	default:
+		*is_ch = true;
+		iio_get_ch_info(ch_info,
+				&dev->channels[group - IIO_BIN_GROUP_CH(0)]);
+		attributes = dev->channels[group - IIO_BIN_GROUP_CH(0)].attributes;
+		break;
+	}
+
+	return &attributes[idx];
+}
+
+/* Convert the text of an attribute to IIO_VAL_INT or IIO_VAL_INT_PLUS_MICRO */
+static int32_t iio_bin_parse_text(const char *buf, int32_t *val,
+				  int32_t *val2)
+{
+	const char	*p = buf;
+	char		*end;
+	bool		negative;
+	int32_t		scale = 100000;
+
+	while (isspace((unsigned char)*p))
+		p++;
+	negative = (*p == '-');
+	/* Decimal only, a leading 0 is not an octal prefix */
+	*val = strtol(p, &end, 10);
+	*val2 = 0;
+	if (end == p)
+		return -EINVAL;
+	if (*end != '.') {
+		/* Not a decimal number, like 0x1f */
+		if (*end && !isspace((unsigned char)*end))
+			return -EINVAL;
+		return IIO_VAL_INT;
+	}
+
+	for (p = end + 1; isdigit((unsigned char)*p); p++) {
+		*val2 += (*p - '0') * scale;
+		scale /= 10;
+	}
+	/* Same convention as Linux, val2 carries the sign when val is 0 */
+	if (negative && *val == 0)
+		*val2 = -*val2;
+
+	return IIO_VAL_INT_PLUS_MICRO;
+}
+
+/* Read an attribute, directly from the driver if it supports it. */
+static int32_t iio_bin_read(uint32_t id, int32_t *val, int32_t *val2)
+{
+	struct iio_interface	*intf;
+	struct iio_attribute	*attr;
+	struct iio_ch_info	ch_info;
+	char			buf[IIO_BIN_TEXT_SIZE];
+	bool			is_ch;
+	ssize_t			ret;
+
+	attr = iio_bin_get_attr(id, &intf, &ch_info, &is_ch);
+	if (!attr)
+		return -ENOENT;
+
+	if (attr->read_raw)
+		return attr->read_raw(intf->dev_instance, val, val2,
+				      is_ch ? &ch_info : NULL, attr->priv);
+	if (!attr->show)
+		return -ENOENT;
+
+	ret = attr->show(intf->dev_instance, buf, sizeof(buf) - 1,
+			 is_ch ? &ch_info : NULL, attr->priv);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+	buf[min((size_t)ret, sizeof(buf) - 1)] = '\0';
+
+	return iio_bin_parse_text(buf, val, val2);
+}
+
+/* Format the value of a binary write entry as text, for store */
+static int32_t iio_bin_format_entry(const uint8_t *entry, char *buf)
+{
+	int32_t vals[2];
+	int32_t ret;
+
+	vals[0] = iio_bin_get_le32(entry + 8);
+	vals[1] = iio_bin_get_le32(entry + 12);
+	ret = iio_format_value(buf, IIO_BIN_TEXT_SIZE,
+			       iio_bin_get_le32(entry + 4), 2, vals);
+
+	return (ret <= 0 || ret >= IIO_BIN_TEXT_SIZE) ? -EINVAL : ret;
+}
+
+/* Write an attribute, directly to the driver if it supports it. */
+static int32_t iio_bin_write(const uint8_t *entry)
+{
+	struct iio_interface	*intf;
+	struct iio_attribute	*attr;
+	struct iio_ch_info	ch_info;
+	char			buf[IIO_BIN_TEXT_SIZE];
+	bool			is_ch;
+	ssize_t			ret;
+
+	attr = iio_bin_get_attr(iio_bin_get_le32(entry), &intf, &ch_info,
+				&is_ch);
+	if (!attr)
+		return -ENOENT;
+
+	if (attr->write_raw)
+		return attr->write_raw(intf->dev_instance,
+				       iio_bin_get_le32(entry + 8),
+				       iio_bin_get_le32(entry + 12),
+				       is_ch ? &ch_info : NULL, attr->priv);
+	if (!attr->store)
+		return -ENOENT;
+
+	ret = iio_bin_format_entry(entry, buf);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	ret = attr->store(intf->dev_instance, buf, ret,
+			  is_ch ? &ch_info : NULL, attr->priv);
+
+	return IS_ERR_VALUE(ret) ? ret : SUCCESS;
+}
+
+/**
+ * @brief Write the consecutive entries of a binary write request that target
+ * the same device. They are delivered in one call to drivers implementing
+ * write_attrs, and written one by one otherwise.
+ * @param entries - First entry.
+ * @param count - Number of entries, starting with the first one.
+ * @param status - Where the status of each written entry is stored.
+ * @return Number of entries written.
+ */
+static uint32_t iio_bin_write_batch(const uint8_t *entries, uint32_t count,
+				    int32_t *status)
+{
+	struct iio_interface	*intf;
+	struct iio_attribute	*attr;
+	struct iio_attr_write	*writes;
+	struct iio_ch_info	*ch_info;
+	char			(*bufs)[IIO_BIN_TEXT_SIZE];
+	uint8_t			map[IIO_BIN_MAX_WRITES];
+	uint32_t		dev_idx = iio_bin_get_le32(entries) >> 24;
+	uint32_t		nb;
+	uint32_t		i;
+	bool			is_ch;
+	int32_t			ret;
+
+	if (dev_idx >= g_desc->dev_count || !g_desc->interfaces[dev_idx] ||
+	    !g_desc->interfaces[dev_idx]->dev_descriptor->write_attrs) {
+		status[0] = iio_bin_write(entries);
+		return 1;
+	}
+
+	for (nb = 1; nb < min(count, (uint32_t)IIO_BIN_MAX_WRITES); nb++)
+		if (iio_bin_get_le32(entries + nb * IIO_BIN_WRITE_SIZE) >> 24 !=
+		    dev_idx)
+			break;
+	count = nb;
+
+	writes = calloc(count, sizeof(*writes));
+	ch_info = calloc(count, sizeof(*ch_info));
+	bufs = calloc(count, sizeof(*bufs));
+	if (!writes || !ch_info || !bufs) {
+		for (i = 0; i < count; i++)
+			status[i] = -ENOMEM;
+		goto free_batch;
+	}
+
+	for (i = 0, nb = 0; i < count; i++) {
+		attr = iio_bin_get_attr(iio_bin_get_le32(entries),
+					&intf, &ch_info[nb], &is_ch);
+		status[i] = (!attr || !attr->store) ? -ENOENT :
+			    iio_bin_format_entry(entries, bufs[nb]);
+		entries += IIO_BIN_WRITE_SIZE;
+		if (IS_ERR_VALUE(status[i]))
+			continue;
+
+		writes[nb].attr = attr;
+		writes[nb].channel = is_ch ? &ch_info[nb] : NULL;
+		writes[nb].buf = bufs[nb];
+		writes[nb].len = status[i];
+		map[nb++] = i;
+	}
+
+	intf = g_desc->interfaces[dev_idx];
+	ret = nb ? intf->dev_descriptor->write_attrs(intf->dev_instance,
+			writes, nb) : SUCCESS;
+	for (i = 0; i < nb; i++) {
+		if (IS_ERR_VALUE(ret))
+			status[map[i]] = ret;
+		else
+			status[map[i]] = IS_ERR_VALUE(writes[i].ret) ?
+					 writes[i].ret : SUCCESS;
+	}
+
+free_batch:
+	free(writes);
+	free(ch_info);
+	free(bufs);
+
+	return count;
+}
+
+/* Compress the XML, see IIO_BIN_OP_XML for the format. dst must hold
+ * IIO_XML_Z_MAX_SIZE(len) bytes. Returns the compressed size. */
+static int32_t iio_xml_compress(const char *src, uint32_t len, uint8_t *dst)
+{
+	int32_t		*head;
+	uint16_t	*prev;
+	uint32_t	pos = 0;
+	uint32_t	out = 0;
+	uint32_t	flags = 0;
+	uint32_t	items = 0;
+	uint32_t	cand;
+	uint32_t	best_len;
+	uint32_t	best_off;
+	uint32_t	max_len;
+	uint32_t	chain;
+	uint32_t	l;
+	uint32_t	h;
+
+	head = malloc(sizeof(*head) * IIO_LZ_HASH_SIZE);
+	prev = calloc(IIO_LZ_WINDOW, sizeof(*prev));
+	if (!head || !prev) {
+		free(head);
+		free(prev);
+		return -ENOMEM;
+	}
+	for (h = 0; h < IIO_LZ_HASH_SIZE; h++)
+		head[h] = -1;
+
+	while (pos < len) {
+		if (!(items % 8)) {
+			flags = out++;
+			dst[flags] = 0;
+		}
+
+		/* Longest match in the window, following the hash chain */
+		best_len = 0;
+		best_off = 0;
+		max_len = min(len - pos, (uint32_t)IIO_LZ_MAX_MATCH);
+		if (max_len >= IIO_LZ_MIN_MATCH) {
+			h = IIO_LZ_HASH(src + pos);
+			cand = head[h];
+			for (chain = 0; head[h] >= 0 && chain < IIO_LZ_MAX_CHAIN &&
+			     pos - cand <= IIO_LZ_WINDOW; chain++) {
+				for (l = 0; l < max_len && src[cand + l] == src[pos + l];
+				     l++)
+					;
+				if (l > best_len) {
+					best_len = l;
+					best_off = pos - cand;
+					if (l == max_len)
+						break;
+				}
+				if (!prev[cand % IIO_LZ_WINDOW] ||
+				    prev[cand % IIO_LZ_WINDOW] > cand)
+					break;
+				cand -= prev[cand % IIO_LZ_WINDOW];
+			}
+		}
+
+		if (best_len >= IIO_LZ_MIN_MATCH) {
+			dst[flags] |= 1 << (items % 8);
+			dst[out++] = ((best_off - 1) << 4) | (best_len - IIO_LZ_MIN_MATCH);
+			dst[out++] = (best_off - 1) >> 4;
+		} else {
+			best_len = 1;
+			dst[out++] = src[pos];
+		}
+		items++;
+
+		/* Add the consumed positions to the hash chains */
+		for (; best_len; best_len--, pos++) {
+			if (pos + IIO_LZ_MIN_MATCH > len)
+				continue;
+			h = IIO_LZ_HASH(src + pos);
+			prev[pos % IIO_LZ_WINDOW] = (head[h] >= 0 &&
+						     pos - head[h] <= IIO_LZ_WINDOW) ?
+						    pos - head[h] : 0;
+			head[h] = pos;
+		}
+	}
+
+	free(head);
+	free(prev);
+
+	return out;
+}
+
+/* Build the XML of the context from the device fragments, if outdated */
+static int32_t iio_update_xml(struct iio_desc *desc)
+{
+	struct iio_interface	*intf;
+	uint32_t		size;
+	uint32_t		i;
+	char			*xml;
+	char			*p;
+
+	if (!desc->xml_outdated)
+		return SUCCESS;
+
+	size = sizeof(header) - 1 + sizeof(header_end);
+	for (i = 0; i < desc->dev_count; i++)
+		if (desc->interfaces[i])
+			size += desc->interfaces[i]->xml_len;
+
+	xml = realloc(desc->xml_desc, size);
+	if (!xml)
+		return -ENOMEM;
+	desc->xml_desc = xml;
+
+	p = xml;
+	memcpy(p, header, sizeof(header) - 1);
+	p += sizeof(header) - 1;
+	for (i = 0; i < desc->dev_count; i++) {
+		intf = desc->interfaces[i];
+		if (!intf)
+			continue;
+		memcpy(p, intf->xml, intf->xml_len);
+		p += intf->xml_len;
+	}
+	memcpy(p, header_end, sizeof(header_end));
+	desc->xml_size = size;
+
+	/* The compressed form is built again on demand */
+	free(desc->xml_z);
+	desc->xml_z = NULL;
+	desc->xml_outdated = false;
+
+	return SUCCESS;
+}
+
+/* Send the compressed XML, built once per XML change */
+static int32_t iio_bin_send_xml(void)
+{
+	uint8_t		out[IIO_BIN_HEADER_SIZE + 8];
+	int32_t		ret;
+
+	ret = iio_update_xml(g_desc);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	if (!g_desc->xml_z) {
+		g_desc->xml_z = malloc(IIO_XML_Z_MAX_SIZE(g_desc->xml_size));
+		if (!g_desc->xml_z)
+			return -ENOMEM;
+		ret = iio_xml_compress(g_desc->xml_desc, g_desc->xml_size,
+				       g_desc->xml_z);
+		if (IS_ERR_VALUE(ret)) {
+			free(g_desc->xml_z);
+			g_desc->xml_z = NULL;
+			return ret;
+		}
+		g_desc->xml_z_size = ret;
+	}
+
+	out[0] = IIO_BIN_OP_XML;
+	out[1] = 0;
+	out[2] = 0;
+	out[3] = 0;
+	iio_bin_put_le32(out + IIO_BIN_HEADER_SIZE, g_desc->xml_size);
+	iio_bin_put_le32(out + IIO_BIN_HEADER_SIZE + 4, g_desc->xml_z_size);
+	ret = iio_phy_write((char *)out, sizeof(out));
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	return iio_phy_write((char *)g_desc->xml_z, g_desc->xml_z_size);
+}
+
+/**
+ * @brief Execute a binary request and send the response.
+ * @param in - Request.
+ * @param len - Number of bytes of the request available in "in". If it is
+ * smaller than the request size, the request is refused.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_bin_process(const uint8_t *in, uint32_t len)
+{
+	const uint8_t	*entry;
+	uint8_t		out[IIO_BIN_MAX_FRAME];
+	int32_t		status[IIO_BIN_MAX_WRITES];
+	uint32_t	frame_size;
+	uint32_t	count;
+	uint32_t	i;
+	uint32_t	j;
+	int32_t		val;
+	int32_t		val2;
+	int32_t		ret = SUCCESS;
+
+	frame_size = iio_bin_frame_size(in, len);
+	count = in[2] | (in[3] << 8);
+	if (!frame_size || frame_size > len ||
+	    (in[0] != IIO_BIN_OP_READ && in[0] != IIO_BIN_OP_WRITE) ||
+	    (in[0] == IIO_BIN_OP_WRITE && count > IIO_BIN_MAX_WRITES))
+		count = 0;
+
+	if (in[0] == IIO_BIN_OP_XML && frame_size && frame_size <= len)
+		return iio_bin_send_xml();
+
+	out[0] = in[0];
+	out[1] = 0;
+	out[2] = count;
+	out[3] = count >> 8;
+	j = IIO_BIN_HEADER_SIZE;
+	if (in[0] == IIO_BIN_OP_WRITE) {
+		/* The writes to a device are delivered together */
+		for (i = 0; i < count; i += j)
+			j = iio_bin_write_batch(in + IIO_BIN_HEADER_SIZE +
+						i * IIO_BIN_WRITE_SIZE,
+						count - i, status + i);
+		j = IIO_BIN_HEADER_SIZE;
+		for (i = 0; i < count; i++, j += 4)
+			iio_bin_put_le32(out + j, status[i]);
+
+		ret = iio_phy_write((char *)out, j);
+
+		return IS_ERR_VALUE(ret) ? ret : SUCCESS;
+	}
+
+	for (i = 0; i < count; i++) {
+		entry = in + IIO_BIN_HEADER_SIZE + i * IIO_BIN_READ_SIZE;
+		ret = iio_bin_read(iio_bin_get_le32(entry), &val, &val2);
+		if (IS_ERR_VALUE(ret))
+			val = val2 = 0;
+		iio_bin_put_le32(out + j, ret);
+		iio_bin_put_le32(out + j + 4, val);
+		iio_bin_put_le32(out + j + 8, val2);
+		j += 12;
+
+		/* Flush when the next entry may not fit */
+		if (j + 12 > sizeof(out)) {
+			ret = iio_phy_write((char *)out, j);
+			if (IS_ERR_VALUE(ret))
+				return ret;
+			j = 0;
+		}
+	}
+
+	if (j)
+		ret = iio_phy_write((char *)out, j);
+
+	return IS_ERR_VALUE(ret) ? ret : SUCCESS;
+}
+
+#ifdef ENABLE_IIO_NETWORK
+/* Execute the binary request at the start of the buffer of a client */
+static int32_t iio_bin_process_client(struct iio_client *client)
+{
+	uint32_t	frame_size;
+	int32_t		ret;
+
+	frame_size = iio_bin_frame_size((uint8_t *)client->buff, client->len);
+	ret = iio_bin_process((uint8_t *)client->buff, client->len);
+
+	/* A request larger than the client buffer is dropped */
+	if (!frame_size || frame_size > client->len)
+		frame_size = client->len;
+	client->len -= frame_size;
+	memmove(client->buff, client->buff + frame_size, client->len);
+
+	return ret;
+}
+#endif
+
+/**
+ * @brief Receive and execute a binary request over UART.
+ * @param op - Opcode, already received.
+ * @return SUCCESS in case of success or negative value otherwise.
+ */
+static int32_t iio_bin_process_uart(uint8_t op)
+{
+	uint8_t		in[IIO_BIN_MAX_FRAME];
+	uint8_t		drop[16];
+	uint32_t	frame_size;
+	uint32_t	len;
+	uint32_t	left;
+	uint32_t	n;
+	int32_t		ret;
+
+	in[0] = op;
+	ret = uart_read(g_desc->uart_desc, in + 1, IIO_BIN_HEADER_SIZE - 1);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	frame_size = iio_bin_frame_size(in, IIO_BIN_HEADER_SIZE);
+	len = min(frame_size, (uint32_t)sizeof(in));
+	if (len > IIO_BIN_HEADER_SIZE) {
+		ret = uart_read(g_desc->uart_desc, in + IIO_BIN_HEADER_SIZE,
+				len - IIO_BIN_HEADER_SIZE);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	/* Consume the rest of a request larger than the buffer */
+	for (left = frame_size - len; left; left -= n) {
+		n = min(left, (uint32_t)sizeof(drop));
+		ret = uart_read(g_desc->uart_desc, drop, n);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	return iio_bin_process(in, len);
 }
 
 /**
@@ -1036,6 +2030,184 @@ static ssize_t iio_write_dev(const char *device, const char *buf,
 	return -ENOENT;
 }
 
+#ifdef ENABLE_IIO_NETWORK
+/* Send an integer answer, as libtinyiiod does */
+static int32_t _client_write_value(struct iio_client *client, int32_t value)
+{
+	char	buf[16];
+	int32_t	len;
+
+	len = sprintf(buf, "%"PRIi32"\n", value);
+
+	return socket_send(client->sock, buf, len);
+}
+
+/*
+ * Start a READBUF or WRITEBUF command of a network client. The buffer data is
+ * then sent or received in chunks of IIO_CLIENT_CHUNK_SIZE, one chunk per
+ * iio_step(), so a large buffer does not delay the other clients. The answers
+ * are the ones of libtinyiiod.
+ */
+static int32_t _client_xfer_start(struct iio_desc *desc,
+				  struct iio_client *client,
+				  char *line, bool write)
+{
+	struct iio_interface	*iface;
+	char			*dev;
+	char			*p;
+	uint32_t		bytes;
+	uint32_t		i;
+	int32_t			ret;
+
+	dev = strchr(line, ' ') + 1;
+	p = strchr(dev, ' ');
+	if (!p)
+		return _client_write_value(client, -EINVAL);
+	*p = '\0';
+	bytes = strtoul(p + 1, NULL, 10);
+
+	iface = iio_get_interface(dev);
+	ret = iface ? SUCCESS : -ENODEV;
+
+	/* The device buffer is used by one transfer at a time */
+	for (i = 0; iface && i < desc->max_clients; i++)
+		if (desc->clients[i].xfer_iface == iface &&
+		    desc->clients[i].xfer_write == write)
+			ret = -EBUSY;
+
+	if (write) {
+		if (!IS_ERR_VALUE(ret) && (!iface->write_buffer ||
+					   bytes > iface->write_buffer->size))
+			ret = -ENOMEM;
+		if (IS_ERR_VALUE(ret)) {
+			/* The data of a refused WRITEBUF is dropped */
+			client->skip = bytes;
+			return _client_write_value(client, ret);
+		}
+		ret = _client_write_value(client, bytes);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+	} else {
+		if (!IS_ERR_VALUE(ret))
+			ret = iio_transfer_dev_to_mem(dev, bytes);
+		if (IS_ERR_VALUE(ret))
+			return _client_write_value(client, ret);
+		client->xfer_mask = iface->ch_mask;
+	}
+
+	if (!bytes)
+		return write ? _client_write_value(client, 0) : SUCCESS;
+
+	client->xfer_iface = iface;
+	client->xfer_write = write;
+	client->xfer_offset = 0;
+	client->xfer_left = bytes;
+
+	return SUCCESS;
+}
+
+/* Send the next chunk of the READBUF being served */
+static int32_t _client_readbuf_step(struct iio_client *client)
+{
+	struct iio_data_buffer	*r_buff = client->xfer_iface->read_buffer;
+	char			buf[32];
+	uint32_t		len;
+	uint32_t		n;
+	int32_t			ret;
+
+	n = min(client->xfer_left, (uint32_t)IIO_CLIENT_CHUNK_SIZE);
+	len = sprintf(buf, "%"PRIu32"\n", n);
+	if (!client->xfer_offset)
+		len += sprintf(buf + len, "%08"PRIx32"\n", client->xfer_mask);
+
+	ret = socket_send(client->sock, buf, len);
+	if (!IS_ERR_VALUE(ret))
+		/* Sent from the device buffer, no copy is needed */
+		ret = socket_send(client->sock,
+				  (char *)r_buff->buff + client->xfer_offset,
+				  n);
+	if (IS_ERR_VALUE(ret)) {
+		client->xfer_iface = NULL;
+		return ret;
+	}
+
+	client->xfer_offset += n;
+	client->xfer_left -= n;
+	if (!client->xfer_left)
+		client->xfer_iface = NULL;
+
+	return SUCCESS;
+}
+
+/* Store the received data of the WRITEBUF being served, at most a chunk, and
+ * start the transfer to the device once all data is received */
+static int32_t _client_writebuf_step(struct iio_client *client)
+{
+	struct iio_interface	*iface = client->xfer_iface;
+	uint32_t		n;
+	int32_t			ret;
+
+	n = min(client->xfer_left, client->len);
+	n = min(n, (uint32_t)IIO_CLIENT_CHUNK_SIZE);
+	ret = iio_write_dev(iface->dev_id, client->buff, client->xfer_offset,
+			    n);
+	_client_consume(client, n);
+	client->xfer_offset += n;
+	client->xfer_left -= n;
+	if (IS_ERR_VALUE(ret)) {
+		/* Drop the rest of the data */
+		client->skip = client->xfer_left;
+		client->xfer_iface = NULL;
+		return _client_write_value(client, ret);
+	}
+	if (client->xfer_left)
+		return SUCCESS;
+
+	client->xfer_iface = NULL;
+	ret = iio_transfer_mem_to_dev(iface->dev_id, client->xfer_offset);
+
+	return _client_write_value(client, IS_ERR_VALUE(ret) ? ret :
+				   (int32_t)client->xfer_offset);
+}
+
+/* Execute the text command at the start of the buffer of a client */
+static int32_t _client_process_text(struct iio_desc *desc,
+				    struct iio_client *client)
+{
+	char		line[IIO_CLIENT_BUFF_SIZE];
+	uint32_t	size;
+	uint32_t	n;
+	bool		write;
+
+	size = _text_frame_size(client->buff, client->len);
+	if (!size) {
+		/* A command line longer than the client buffer */
+		_client_remove(client);
+		return -EINVAL;
+	}
+	if (size > client->len) {
+		/* The data does not fit in the client buffer, drop it */
+		client->skip = size - client->len;
+		client->len = 0;
+		return _client_write_value(client, -ENOMEM);
+	}
+
+	write = !strncmp(client->buff, "WRITEBUF ", 9);
+	if (!write && strncmp(client->buff, "READBUF ", 8))
+		return tinyiiod_read_command(desc->iiod);
+
+	/* Without the new line, truncated if longer than any valid command */
+	n = min(size - 1, (uint32_t)sizeof(line) - 1);
+	memcpy(line, client->buff, n);
+	line[n] = '\0';
+	_client_consume(client, size);
+	if (n && line[n - 1] == '\r')
+		line[n - 1] = '\0';
+
+	return _client_xfer_start(desc, client, line, write);
+}
+#endif
+
 /**
  * @brief Get a merged xml containing all devices.
  * @param outxml - Generated xml.
@@ -1043,7 +2215,7 @@ static ssize_t iio_write_dev(const char *device, const char *buf,
  */
 static ssize_t iio_get_xml(char **outxml)
 {
-	if (!outxml)
+	if (!outxml || IS_ERR_VALUE(iio_update_xml(g_desc)))
 		return FAILURE;
 
 	*outxml = g_desc->xml_desc;
@@ -1059,18 +2231,49 @@ static ssize_t iio_get_xml(char **outxml)
 ssize_t iio_step(struct iio_desc *desc)
 {
 #ifdef ENABLE_IIO_NETWORK
-	int32_t ret;
+	struct iio_client	*client;
+#endif
+	uint8_t			c;
+	int32_t			ret;
 
+#ifdef ENABLE_IIO_NETWORK
 	if (desc->phy_type == USE_NETWORK) {
-		if (desc->current_sock != NULL &&
-		    (int32_t)desc->current_sock != -1) {
-			ret = _push_sock(desc, desc->current_sock);
-			if (IS_ERR_VALUE(ret))
-				return ret;
+		ret = _accept_clients(desc);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+
+		/* Commands are executed only once they are fully received, so
+		 * an idle or slow client does not block the others. */
+		client = _get_next_client(desc);
+		if (!client)
+			return SUCCESS;
+
+		desc->current_client = client;
+		if (client->xfer_iface) {
+			/* One chunk of the READBUF or WRITEBUF in progress */
+			ret = client->xfer_write ?
+			      _client_writebuf_step(client) :
+			      _client_readbuf_step(client);
+		} else {
+			client->stats.commands++;
+			if (client->buff[0] & 0x80)
+				ret = iio_bin_process_client(client);
+			else
+				ret = _client_process_text(desc, client);
 		}
-		desc->current_sock = NULL;
+		desc->current_client = NULL;
+
+		return ret;
 	}
 #endif
+	/* Binary requests are recognized by their first byte */
+	ret = uart_read(desc->uart_desc, &c, 1);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+	if (c & 0x80)
+		return iio_bin_process_uart(c);
+	desc->uart_peek = c;
+
 	return tinyiiod_read_command(desc->iiod);
 }
 
@@ -1260,10 +2463,9 @@ ssize_t iio_register(struct iio_desc *desc, struct iio_device *dev_descriptor,
 		     struct iio_data_buffer *write_buff)
 {
 	struct iio_interface	*iio_interface;
-	int32_t ret;
-	int32_t	n;
-	int32_t	new_size;
-	char	*aux;
+	struct iio_interface	**interfaces;
+	int32_t			ret;
+	int32_t			n;
 
 	iio_interface = (struct iio_interface *)calloc(1,
 			sizeof(*iio_interface));
@@ -1275,37 +2477,50 @@ ssize_t iio_register(struct iio_desc *desc, struct iio_device *dev_descriptor,
 	iio_interface->read_buffer = read_buff;
 	iio_interface->write_buffer = write_buff;
 
+	ret = iio_build_lookup(iio_interface);
+	if (IS_ERR_VALUE(ret)) {
+		free(iio_interface);
+		return ret;
+	}
+
+	interfaces = realloc(desc->interfaces,
+			     (desc->dev_count + 1) * sizeof(*interfaces));
+	if (!interfaces) {
+		iio_free_interface(iio_interface);
+		return -ENOMEM;
+	}
+	desc->interfaces = interfaces;
+
 	/* Get number of bytes needed for the xml of the new device */
 	n = iio_generate_device_xml(iio_interface->dev_descriptor,
 				    (char *)iio_interface->name,
 				    desc->dev_count, NULL, -1);
+	if (n < 0) {
+		iio_free_interface(iio_interface);
+		return n;
+	}
 
-	new_size = desc->xml_size + n;
-	aux = realloc(desc->xml_desc, new_size);
-	if (!aux) {
-		free(iio_interface);
+	iio_interface->xml = malloc(n + 1);
+	if (!iio_interface->xml) {
+		iio_free_interface(iio_interface);
 		return -ENOMEM;
 	}
 
 	ret = desc->interfaces_list->push(desc->interfaces_list, iio_interface);
 	if (IS_ERR_VALUE(ret)) {
-		free(iio_interface);
-		free(aux);
+		iio_free_interface(iio_interface);
 		return ret;
 	}
 
-	desc->xml_desc = aux;
-	/* Print the new device xml at the end of the xml */
-	iio_generate_device_xml(iio_interface->dev_descriptor,
-				(char *)iio_interface->name,
-				desc->dev_count,
-				desc->xml_desc + desc->xml_size_to_last_dev,
-				new_size - desc->xml_size_to_last_dev);
+	iio_interface->xml_len = iio_generate_device_xml(
+					 iio_interface->dev_descriptor,
+					 (char *)iio_interface->name,
+					 desc->dev_count, iio_interface->xml,
+					 n + 1);
 	sprintf((char *)iio_interface->dev_id, "device%d", (int)desc->dev_count);
-	desc->xml_size_to_last_dev += n;
-	desc->xml_size += n;
-	/* Copy end header at the end */
-	strcat(desc->xml_desc, header_end);
+	desc->interfaces[desc->dev_count] = iio_interface;
+	/* The XML of the context is rebuilt when next requested */
+	desc->xml_outdated = true;
 
 	desc->dev_count++;
 
@@ -1321,31 +2536,25 @@ ssize_t iio_register(struct iio_desc *desc, struct iio_device *dev_descriptor,
 ssize_t iio_unregister(struct iio_desc *desc, char *name)
 {
 	struct iio_interface	*to_remove_interface;
-	struct iio_interface	search_interface;
 	int32_t			ret;
-	int32_t			n;
-	char			*aux;
+	uint32_t		i;
+
+	for (i = 0; i < desc->dev_count; i++)
+		if (desc->interfaces[i] &&
+		    !strcmp(desc->interfaces[i]->name, name))
+			break;
+	if (i == desc->dev_count)
+		return -ENODEV;
 
-	/* Get if the item is found, get will remove it from the list */
-	search_interface.name = name;
+	/* The list is sorted by dev_id, get will remove it from the list */
 	ret = list_get_find(desc->interfaces_list,
-			    (void **)&to_remove_interface, &search_interface);
+			    (void **)&to_remove_interface, desc->interfaces[i]);
 	if (IS_ERR_VALUE(ret))
 		return ret;
-	free(to_remove_interface);
-
-	/* Get number of bytes needed for the xml of the device */
-	n = iio_generate_device_xml(to_remove_interface->dev_descriptor,
-				    (char *)to_remove_interface->name,
-				    desc->dev_count, NULL, -1);
-
-	/* Overwritte the deleted device */
-	aux = desc->xml_desc + desc->xml_size_to_last_dev - n;
-	memmove(aux, aux + n, strlen(aux + n));
 
-	/* Decrease the xml size */
-	desc->xml_size -= n;
-	desc->xml_size_to_last_dev -= n;
+	desc->interfaces[i] = NULL;
+	iio_free_interface(to_remove_interface);
+	desc->xml_outdated = true;
 
 	return SUCCESS;
 }
@@ -1398,14 +2607,8 @@ ssize_t iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 	ops->read = iio_phy_read;
 	ops->write = iio_phy_write;
 
-	ldesc->xml_size = sizeof(header) + sizeof(header_end);
-	ldesc->xml_desc = (char *)malloc(ldesc->xml_size);
-	if (!ldesc->xml_desc)
-		goto free_desc;
-
-	strcpy(ldesc->xml_desc, header);
-	strcat(ldesc->xml_desc, header_end);
-	ldesc->xml_size_to_last_dev = sizeof(header) - 1;
+	ldesc->xml_outdated = true;
+	ldesc->uart_peek = -1;
 
 	ldesc->phy_type = init_param->phy_type;
 	if (init_param->phy_type == USE_UART) {
@@ -1423,10 +2626,14 @@ ssize_t iio_init(struct iio_desc **desc, struct iio_init_param *init_param)
 		ret = socket_listen(ldesc->server, MAX_BACKLOG);
 		if (IS_ERR_VALUE(ret))
 			goto free_pylink;
-		ret = cb_init(&ldesc->sockets, sizeof(struct tcp_socket_desc *)
-			      * MAX_SOCKET_TO_HANDLE);
-		if (IS_ERR_VALUE(ret))
+		ldesc->max_clients = init_param->max_net_clients ?
+				     init_param->max_net_clients :
+				     MAX_SOCKET_TO_HANDLE;
+		ldesc->clients = calloc(ldesc->max_clients,
+					sizeof(*ldesc->clients));
+		if (!ldesc->clients)
 			goto free_pylink;
+		ldesc->get_time_us = init_param->get_time_us;
 	}
 #endif
 	else {
@@ -1458,8 +2665,7 @@ free_pylink:
 #ifdef ENABLE_IIO_NETWORK
 	if (ldesc->phy_type == USE_NETWORK) {
 		socket_remove(ldesc->server);
-		if (ldesc->sockets)
-			cb_remove(ldesc->sockets);
+		free(ldesc->clients);
 	}
 #endif
 free_desc:
@@ -1478,24 +2684,32 @@ free_ops:
 ssize_t iio_remove(struct iio_desc *desc)
 {
 	struct iio_interface	*iio_interface;
+#ifdef ENABLE_IIO_NETWORK
+	uint32_t		i;
+#endif
 
 	while (SUCCESS == list_get_first(desc->interfaces_list,
 					 (void **)&iio_interface))
-		free(iio_interface);
+		iio_free_interface(iio_interface);
 	list_remove(desc->interfaces_list);
+	free(desc->interfaces);
 
 	free(desc->iiod_ops);
 	tinyiiod_destroy(desc->iiod);
 
 	free(desc->xml_desc);
+	free(desc->xml_z);
 
 	if (desc->phy_type == USE_UART) {
 		uart_remove(desc->phy_desc);
 	}
 #ifdef ENABLE_IIO_NETWORK
 	else {
+		for (i = 0; i < desc->max_clients; i++)
+			if (desc->clients[i].sock)
+				_client_remove(&desc->clients[i]);
+		free(desc->clients);
 		socket_remove(desc->server);
-		cb_remove(desc->sockets);
 	}
 #endif
 
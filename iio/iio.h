@@ -72,8 +72,70 @@ struct iio_init_param {
 		struct tcp_socket_init_param *tcp_socket_init_param;
 #endif
 	};
+#ifdef ENABLE_IIO_NETWORK
+	/* Maximum number of simultaneous network clients, 0 for default */
+	uint32_t		max_net_clients;
+	/* Free running microsecond counter, used for the client metrics,
+	 * optional */
+	uint32_t		(*get_time_us)(void);
+#endif
 };
 
+/*
+ * Binary protocol, served next to the text protocol.
+ * All fields are little endian.
+ * Request: uint8_t opcode, uint8_t reserved, uint16_t count, then count
+ * entries:
+ *	IIO_BIN_OP_READ:  uint32_t id
+ *	IIO_BIN_OP_WRITE: uint32_t id, int32_t fmt, int32_t val, int32_t val2
+ *	IIO_BIN_OP_XML:   none, count is 0
+ * Response: uint8_t opcode, uint8_t reserved, uint16_t count, then count
+ * entries:
+ *	IIO_BIN_OP_READ:  int32_t fmt (or negative error), int32_t val,
+ *			  int32_t val2
+ *	IIO_BIN_OP_WRITE: int32_t status
+ * or for IIO_BIN_OP_XML: uint32_t xml size, uint32_t compressed size, then
+ * the compressed XML of the context. It is a sequence of groups made of a
+ * flags byte followed by up to 8 items. Item n is a literal byte if bit n of
+ * flags is clear, otherwise a 2 bytes little endian match
+ * ((offset - 1) << 4) | (length - 3): copy length bytes starting offset
+ * bytes back in the output.
+ * fmt is an enum iio_val, a request with an invalid count gets a response
+ * with count set to 0.
+ */
+/* Opcodes have their MSB set, so they don't start a text command */
+#define IIO_BIN_OP_READ		0x81
+#define IIO_BIN_OP_WRITE	0x82
+#define IIO_BIN_OP_XML		0x83
+#define IIO_BIN_HEADER_SIZE	4
+#define IIO_BIN_READ_SIZE	4
+#define IIO_BIN_WRITE_SIZE	16
+/* Attribute groups of a device, in the order they are registered */
+#define IIO_BIN_GROUP_DEVICE	0
+#define IIO_BIN_GROUP_DEBUG	1
+#define IIO_BIN_GROUP_BUFFER	2
+#define IIO_BIN_GROUP_CH(n)	(3 + (n))
+/* Numeric ID of the attribute with index attr in the attributes array of a
+ * group, for the device registered as device<dev> */
+#define IIO_BIN_ATTR_ID(dev, group, attr) \
+	(((uint32_t)(dev) << 24) | ((uint32_t)(group) << 16) | (attr))
+
+#ifdef ENABLE_IIO_NETWORK
+/**
+ * @struct iio_net_client_stats
+ * @brief Fairness and latency metrics of a network client.
+ */
+struct iio_net_client_stats {
+	/** True while a client uses the slot */
+	bool		connected;
+	/** Number of commands served */
+	uint32_t	commands;
+	/** Maximum time, in microseconds, a ready client waited to be served,
+	 *  0 if no get_time_us was given to iio_init() */
+	uint32_t	max_wait_us;
+};
+#endif
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -96,5 +158,10 @@ int32_t iio_parse_value(char *buf, enum iio_val fmt,
 			int32_t *val, int32_t *val2);
 ssize_t iio_format_value(char *buf, size_t len, enum iio_val fmt,
 			 int32_t size, int32_t *vals);
+#ifdef ENABLE_IIO_NETWORK
+/* Get the metrics of a network client. */
+int32_t iio_get_net_client_stats(struct iio_desc *desc, uint32_t client,
+				 struct iio_net_client_stats *stats);
+#endif
 
 #endif /* IIO_H_ */
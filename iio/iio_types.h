@@ -133,6 +133,13 @@ struct iio_attribute {
 	/** Store function pointer */
 	ssize_t (*store)(void *device, char *buf, size_t len,
 			 const struct iio_ch_info *channel, intptr_t priv);
+	/** Optional, used by the binary protocol instead of show. Returns
+	 * the IIO_VAL_* format of val and val2, or a negative error code. */
+	int32_t (*read_raw)(void *device, int32_t *val, int32_t *val2,
+			    const struct iio_ch_info *channel, intptr_t priv);
+	/** Optional, used by the binary protocol instead of store. */
+	int32_t (*write_raw)(void *device, int32_t val, int32_t val2,
+			     const struct iio_ch_info *channel, intptr_t priv);
 };
 
 /**
@@ -152,6 +159,23 @@ struct scan_type {
 	bool			is_big_endian;
 };
 
+/**
+ * @struct iio_attr_write
+ * @brief Attribute write, part of a batch delivered to write_attrs.
+ */
+struct iio_attr_write {
+	/** Attribute to be written */
+	struct iio_attribute		*attr;
+	/** Channel properties, NULL for a device attribute */
+	const struct iio_ch_info	*channel;
+	/** Value to be written */
+	char				*buf;
+	/** Length of buf */
+	size_t				len;
+	/** Set by the driver to what store would have returned */
+	ssize_t				ret;
+};
+
 /**
  * @struct iio_channel
  * @brief Structure holding attributes of a channel.
@@ -224,6 +248,10 @@ struct iio_device {
 	int32_t (*debug_reg_read)(void *dev, uint32_t reg, uint32_t *readval);
 	/* Write device register */
 	int32_t (*debug_reg_write)(void *dev, uint32_t reg, uint32_t writeval);
+	/** Optional. Write several attributes in one call, so the driver can
+	 * apply them together. Without it, store is called for each one. */
+	int32_t (*write_attrs)(void *dev, struct iio_attr_write *writes,
+			       uint32_t nb_writes);
 
 };
 
@@ -56,4 +56,11 @@ int32_t axi_io_read(uint32_t base, uint32_t offset, uint32_t *data);
 /* AXI IO Write data */
 int32_t axi_io_write(uint32_t base, uint32_t offset, uint32_t data);
 
+/* AXI IO Write consecutive 32-bit words */
+int32_t axi_io_write_block(uint32_t base, uint32_t offset,
+			   const uint32_t *data, uint32_t count);
+
+/* AXI IO Release the resources used for a base address */
+int32_t axi_io_remove(uint32_t base);
+
 #endif // AXI_IO_H_
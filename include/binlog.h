@@ -0,0 +1,248 @@
+/***************************************************************************//**
+ *   @file   binlog.h
+ *   @brief  Deferred binary logging header
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+#ifndef BINLOG_H_
+#define BINLOG_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <string.h>
+#include "print_log.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/*
+ * Call sites store the address of their format string and the raw bits of
+ * their arguments into a ring; the text is built later by binlog_drain() on
+ * the target, or on a host by tools/binlog/binlog_decode from the binary
+ * stream and the ELF file.
+ *
+ * Format strings and module names are placed in the binlog_fmt section and
+ * their ID is the offset in that section. Arguments are captured as 64-bit
+ * words, so 64-bit integers and doubles are kept, but:
+ *  - %s arguments are stored as pointers and must point to strings that are
+ *    still valid when the record is formatted (literals, __func__, ...);
+ *  - float arguments must be cast to double;
+ *  - at most BINLOG_MAX_ARGS arguments are supported.
+ */
+
+/** Maximum number of arguments of a message */
+#define BINLOG_MAX_ARGS		12
+
+/** First byte of every record of the binary stream */
+#define BINLOG_SYNC		0xA5
+
+/** Size of the record header in the binary stream */
+#define BINLOG_HDR_SIZE		16
+
+/** Format ID of the record reporting the number of dropped messages */
+#define BINLOG_ID_DROPPED	0xFFFFFFFF
+
+/** Name of the section holding the format strings and the module names */
+#define BINLOG_SECTION		"binlog_fmt"
+
+/** Place a constant string in the binlog_fmt section */
+#define BINLOG_STR_ATTR		__attribute__((section(BINLOG_SECTION)))
+
+/**
+ * @brief Define a logging module with its initial runtime level.
+ *
+ * Files logging to the module define BINLOG_MODULE to its name before
+ * including print_log.h, or pass it to binlog_print().
+ */
+#define BINLOG_MODULE_DEFINE(mod, lvl)					\
+	static const char binlog_module_name_##mod[] BINLOG_STR_ATTR = #mod; \
+	struct binlog_module binlog_module_##mod = {			\
+		.name = binlog_module_name_##mod,			\
+		.level = (lvl),						\
+	}
+
+/** Module of the call sites which don't select one */
+#ifndef BINLOG_MODULE
+#define BINLOG_MODULE		global
+#endif
+
+/** Capture the bits of an argument, zero-extended to 64 bits */
+#define BINLOG_ARG(x) ({						\
+	__typeof__((x) + 0) _binlog_v = (x);				\
+	uint32_t _binlog_w32;						\
+	uint64_t _binlog_w;						\
+	if (sizeof(_binlog_v) > sizeof(_binlog_w32)) {			\
+		memcpy(&_binlog_w, &_binlog_v, sizeof(_binlog_w));	\
+	} else {							\
+		memcpy(&_binlog_w32, &_binlog_v, sizeof(_binlog_w32));	\
+		_binlog_w = _binlog_w32;				\
+	}								\
+	_binlog_w;							\
+})
+
+#define BINLOG_ARGS_0()
+#define BINLOG_ARGS_1(a) BINLOG_ARG(a)
+#define BINLOG_ARGS_2(a, ...) BINLOG_ARG(a), BINLOG_ARGS_1(__VA_ARGS__)
+#define BINLOG_ARGS_3(a, ...) BINLOG_ARG(a), BINLOG_ARGS_2(__VA_ARGS__)
+#define BINLOG_ARGS_4(a, ...) BINLOG_ARG(a), BINLOG_ARGS_3(__VA_ARGS__)
+#define BINLOG_ARGS_5(a, ...) BINLOG_ARG(a), BINLOG_ARGS_4(__VA_ARGS__)
+#define BINLOG_ARGS_6(a, ...) BINLOG_ARG(a), BINLOG_ARGS_5(__VA_ARGS__)
+#define BINLOG_ARGS_7(a, ...) BINLOG_ARG(a), BINLOG_ARGS_6(__VA_ARGS__)
+#define BINLOG_ARGS_8(a, ...) BINLOG_ARG(a), BINLOG_ARGS_7(__VA_ARGS__)
+#define BINLOG_ARGS_9(a, ...) BINLOG_ARG(a), BINLOG_ARGS_8(__VA_ARGS__)
+#define BINLOG_ARGS_10(a, ...) BINLOG_ARG(a), BINLOG_ARGS_9(__VA_ARGS__)
+#define BINLOG_ARGS_11(a, ...) BINLOG_ARG(a), BINLOG_ARGS_10(__VA_ARGS__)
+#define BINLOG_ARGS_12(a, ...) BINLOG_ARG(a), BINLOG_ARGS_11(__VA_ARGS__)
+
+#define BINLOG_SELECT(_0, _1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, \
+		      n, ...) n
+
+/** Number of arguments, 0 to BINLOG_MAX_ARGS */
+#define BINLOG_NARGS(...) BINLOG_SELECT(_0, ##__VA_ARGS__, 12, 11, 10, 9, 8, \
+					7, 6, 5, 4, 3, 2, 1, 0)
+
+/** Comma separated list of the captured arguments */
+#define BINLOG_ARGS(...) BINLOG_SELECT(_0, ##__VA_ARGS__, BINLOG_ARGS_12,	\
+				       BINLOG_ARGS_11, BINLOG_ARGS_10,	\
+				       BINLOG_ARGS_9, BINLOG_ARGS_8,	\
+				       BINLOG_ARGS_7, BINLOG_ARGS_6,	\
+				       BINLOG_ARGS_5, BINLOG_ARGS_4,	\
+				       BINLOG_ARGS_3, BINLOG_ARGS_2,	\
+				       BINLOG_ARGS_1, BINLOG_ARGS_0)(__VA_ARGS__)
+
+#define binlog_print_(mod, lvl, fmt, ...) do {				\
+	extern struct binlog_module binlog_module_##mod;		\
+	if ((lvl) <= binlog_module_##mod.level) {			\
+		static const char _binlog_fmt[] BINLOG_STR_ATTR = fmt;	\
+		const uint64_t _binlog_args[] = {			\
+			0, BINLOG_ARGS(__VA_ARGS__)			\
+		};							\
+		binlog_record(&binlog_module_##mod, (lvl), _binlog_fmt,	\
+			      &_binlog_args[1],				\
+			      BINLOG_NARGS(__VA_ARGS__));		\
+	}								\
+} while (0)
+
+/**
+ * @brief Record a message of a module. fmt must be a string literal.
+ *
+ * Only the runtime level of the module is checked, the compile time
+ * LOG_LEVEL is applied by the pr_* macros.
+ */
+#define binlog_print(mod, lvl, fmt, ...) \
+	binlog_print_(mod, lvl, fmt, ##__VA_ARGS__)
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct binlog_module
+ * @brief Logging module, defined with BINLOG_MODULE_DEFINE()
+ */
+struct binlog_module {
+	/** Name, stored in the binlog_fmt section */
+	const char	*name;
+	/** Runtime level, messages above it are not recorded */
+	volatile uint8_t level;
+};
+
+/**
+ * @enum binlog_output
+ * @brief Format of the drained messages
+ */
+enum binlog_output {
+	/** Messages formatted on the target */
+	BINLOG_OUTPUT_TEXT,
+	/** Binary records, formatted on a host by binlog_decode */
+	BINLOG_OUTPUT_BINARY
+};
+
+/**
+ * @struct binlog_init_param
+ * @brief Deferred logger initialization parameters
+ */
+struct binlog_init_param {
+	/** Number of messages the ring can hold, must be a power of 2 */
+	uint32_t		slots;
+	/** Format of the drained messages */
+	enum binlog_output	output;
+	/** Output function, NULL to use printf (text output only) */
+	int32_t			(*write)(void *ctx, const uint8_t *data,
+					 uint32_t len);
+	/** Parameter of the output function */
+	void			*write_ctx;
+	/** Timestamp of the records, may be NULL */
+	uint32_t		(*timestamp)(void);
+};
+
+/**
+ * @struct binlog_fmt_param
+ * @brief Describes the target of the records being formatted
+ */
+struct binlog_fmt_param {
+	/** Size of long on the target */
+	uint8_t		long_size;
+	/** Size of a pointer on the target */
+	uint8_t		ptr_size;
+	/** Get the string a %s argument points to, NULL if it is a local
+	 *  pointer */
+	const char	*(*str)(void *ctx, uint64_t addr);
+	/** Parameter of str */
+	void		*str_ctx;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+int32_t binlog_init(const struct binlog_init_param *param);
+int32_t binlog_remove(void);
+
+void binlog_record(const struct binlog_module *mod, uint8_t level,
+		   const char *fmt, const uint64_t *args, uint32_t nargs);
+int32_t binlog_drain(uint32_t max_records);
+
+int32_t binlog_set_level(struct binlog_module *mod, uint8_t level);
+
+int32_t binlog_format(char *buff, uint32_t size, const char *fmt,
+		      const uint64_t *args, uint32_t nargs,
+		      const struct binlog_fmt_param *param);
+
+#endif /* BINLOG_H_ */
@@ -58,6 +58,34 @@
  */
 struct circular_buffer;
 
+/**
+ * @struct cb_segment
+ * @brief Contiguous part of the circular buffer, see cb_read_peek() and
+ * cb_write_peek()
+ */
+struct cb_segment {
+	/** Start of the segment */
+	void		*buff;
+	/** Size of the segment in bytes */
+	uint32_t	size;
+};
+
+struct irq_ctrl_desc;
+struct timer_desc;
+
+/**
+ * @struct cb_wait_param
+ * @brief How the blocking functions wait for the other side of the buffer
+ */
+struct cb_wait_param {
+	/** Controller of the interrupt updating the buffer, NULL to poll */
+	struct irq_ctrl_desc	*irq_ctrl;
+	/** Running timer used for the timeout, may be NULL */
+	struct timer_desc	*timer;
+	/** Timeout in microseconds, 0 to wait forever */
+	uint32_t		timeout_us;
+};
+
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
@@ -70,6 +98,18 @@ int32_t cb_write(struct circular_buffer *desc, const void *data,
 		 uint32_t nb_elements);
 int32_t cb_read(struct circular_buffer *desc, void *data, uint32_t nb_elements);
 
+int32_t cb_set_wait(struct circular_buffer *desc,
+		    const struct cb_wait_param *param);
+int32_t cb_wait_data(struct circular_buffer *desc, uint32_t size);
+int32_t cb_wait_space(struct circular_buffer *desc, uint32_t size);
+
+int32_t cb_read_peek(struct circular_buffer *desc, struct cb_segment seg[2],
+		     uint32_t *size);
+int32_t cb_read_commit(struct circular_buffer *desc, uint32_t size);
+int32_t cb_write_peek(struct circular_buffer *desc, struct cb_segment seg[2],
+		      uint32_t *size);
+int32_t cb_write_commit(struct circular_buffer *desc, uint32_t size);
+
 int32_t cb_prepare_async_write(struct circular_buffer *desc,
 			       uint32_t raw_size_to_write,
 			       void **write_buff,
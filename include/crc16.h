@@ -43,12 +43,20 @@
 #include <stddef.h>
 
 #define CRC16_TABLE_SIZE 256
+#define CRC16_SLICE_SIZE 4
 
 #define DECLARE_CRC16_TABLE(_table) \
 	static uint16_t _table[CRC16_TABLE_SIZE]
 
+#define DECLARE_CRC16_SLICE_TABLE(_table) \
+	static uint16_t _table[CRC16_SLICE_SIZE][CRC16_TABLE_SIZE]
+
 void crc16_populate_msb(uint16_t * table, const uint16_t polynomial);
 uint16_t crc16(const uint16_t * table, const uint8_t *pdata, size_t nbytes,
 	       uint16_t crc);
+void crc16_populate_msb_slice(uint16_t (*table)[CRC16_TABLE_SIZE],
+			      const uint16_t polynomial);
+uint16_t crc16_slice(const uint16_t (*table)[CRC16_TABLE_SIZE],
+		     const uint8_t *pdata, size_t nbytes, uint16_t crc);
 
 #endif // __CRC16_H
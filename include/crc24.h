@@ -43,12 +43,20 @@
 #include <stddef.h>
 
 #define CRC24_TABLE_SIZE 256
+#define CRC24_SLICE_SIZE 4
 
 #define DECLARE_CRC24_TABLE(_table) \
 	static uint32_t _table[CRC24_TABLE_SIZE]
 
+#define DECLARE_CRC24_SLICE_TABLE(_table) \
+	static uint32_t _table[CRC24_SLICE_SIZE][CRC24_TABLE_SIZE]
+
 void crc24_populate_msb(uint32_t * table, const uint32_t polynomial);
 uint32_t crc24(const uint32_t * table, const uint8_t *pdata, size_t nbytes,
 	       uint32_t crc);
+void crc24_populate_msb_slice(uint32_t (*table)[CRC24_TABLE_SIZE],
+			      const uint32_t polynomial);
+uint32_t crc24_slice(const uint32_t (*table)[CRC24_TABLE_SIZE],
+		     const uint8_t *pdata, size_t nbytes, uint32_t crc);
 
 #endif // __CRC24_H
@@ -43,12 +43,22 @@
 #include <stddef.h>
 
 #define CRC8_TABLE_SIZE 256
+#define CRC8_SLICE_SIZE 4
 
 #define DECLARE_CRC8_TABLE(_table) \
 	static uint8_t _table[CRC8_TABLE_SIZE]
 
+#define DECLARE_CRC8_SLICE_TABLE(_table) \
+	static uint8_t _table[CRC8_SLICE_SIZE][CRC8_TABLE_SIZE]
+
+extern const uint8_t crc8_poly07_table[CRC8_SLICE_SIZE][CRC8_TABLE_SIZE];
+
 void crc8_populate_msb(uint8_t * table, const uint8_t polynomial);
 uint8_t crc8(const uint8_t * table, const uint8_t *pdata, size_t nbytes,
 	     uint8_t crc);
+void crc8_populate_msb_slice(uint8_t (*table)[CRC8_TABLE_SIZE],
+			     const uint8_t polynomial);
+uint8_t crc8_slice(const uint8_t (*table)[CRC8_TABLE_SIZE],
+		   const uint8_t *pdata, size_t nbytes, uint8_t crc);
 
 #endif // __CRC8_H
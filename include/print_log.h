@@ -55,54 +55,67 @@
 #define LOG_LEVEL LOG_INFO
 #endif
 
+/*
+ * With ENABLE_BINLOG the messages are recorded by the deferred logger and
+ * printed later by binlog_drain(), see binlog.h for the restrictions on the
+ * arguments.
+ */
+#ifdef ENABLE_BINLOG
+#include "binlog.h"
+#define pr_print(lvl, fmt, args...) \
+	binlog_print(BINLOG_MODULE, lvl, fmt, ##args)
+#else
+#define pr_print(lvl, fmt, args...) printf(fmt, ##args)
+#endif
+
 #if defined(LOG_LEVEL) && LOG_LEVEL >= LOG_EMERG && LOG_LEVEL <= LOG_DEBUG
-#define pr_emerg(fmt, args...) printf("EMERG: %s:%d:%s(): " \
+#define pr_emerg(fmt, args...) pr_print(LOG_EMERG, "EMERG: %s:%d:%s(): " \
 fmt, __FILE__, __LINE__, __func__, ##args)
 #else
 #define pr_emerg(fmt, args...)
 #endif
 
 #if defined(LOG_LEVEL) && LOG_LEVEL >= LOG_ALERT && LOG_LEVEL <= LOG_DEBUG
-#define pr_alert(fmt, args...) printf("ALERT: %s:%d:%s(): " \
+#define pr_alert(fmt, args...) pr_print(LOG_ALERT, "ALERT: %s:%d:%s(): " \
 fmt, __FILE__, __LINE__, __func__, ##args)
 #else
 #define pr_alert(fmt, args...)
 #endif
 
 #if defined(LOG_LEVEL) && LOG_LEVEL >= LOG_CRIT && LOG_LEVEL <= LOG_DEBUG
-#define pr_crit(fmt, args...) printf("CRIT: %s:%d:%s(): " \
+#define pr_crit(fmt, args...) pr_print(LOG_CRIT, "CRIT: %s:%d:%s(): " \
 fmt, __FILE__, __LINE__, __func__, ##args)
 #else
 #define pr_crit(fmt, args...)
 #endif
 
 #if defined(LOG_LEVEL) && LOG_LEVEL >= LOG_ERR && LOG_LEVEL <= LOG_DEBUG
-#define pr_err(fmt, args...) printf("ERR: %s:%d:%s(): " \
+#define pr_err(fmt, args...) pr_print(LOG_ERR, "ERR: %s:%d:%s(): " \
 fmt, __FILE__, __LINE__, __func__, ##args)
 #else
 #define pr_err(fmt, args...)
 #endif
 
 #if defined(LOG_LEVEL) && LOG_LEVEL >= LOG_WARNING && LOG_LEVEL <= LOG_DEBUG
-#define pr_warning(fmt, args...) printf("WARNING: " fmt, ##args)
+#define pr_warning(fmt, args...) pr_print(LOG_WARNING, "WARNING: " fmt, ##args)
 #else
 #define pr_warning(fmt, args...)
 #endif
 
 #if defined(LOG_LEVEL) && LOG_LEVEL >= LOG_NOTICE && LOG_LEVEL <= LOG_DEBUG
-#define pr_notice(fmt, args...) printf("NOTICE: " fmt, ##args)
+#define pr_notice(fmt, args...) pr_print(LOG_NOTICE, "NOTICE: " fmt, ##args)
 #else
 #define pr_notice(fmt, args...)
 #endif
 
 #if defined(LOG_LEVEL) && LOG_LEVEL >= LOG_INFO && LOG_LEVEL <= LOG_DEBUG
-#define pr_info(fmt, args...) printf(fmt, ##args)
+#define pr_info(fmt, args...) pr_print(LOG_INFO, fmt, ##args)
 #else
 #define pr_info(fmt, args...)
 #endif
 
 #if defined(LOG_LEVEL) && LOG_LEVEL == LOG_DEBUG
-#define pr_debug(fmt, args...) printf("DEBUG: " fmt, ##args)
+#define pr_debug(fmt, args...) pr_print(LOG_DEBUG, "DEBUG: " fmt, ##args)
 #else
 #define pr_debug(fmt, args...)
 #endif
@@ -0,0 +1,188 @@
+/***************************************************************************//**
+ *   @file   regmap.h
+ *   @brief  Register map with a write-back cache.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef REGMAP_H_
+#define REGMAP_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "spi.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Number of registers written with one spi_transfer() call by regmap_sync() */
+#define REGMAP_SYNC_BATCH	16
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct regmap_range
+ * @brief Inclusive range of register addresses.
+ */
+struct regmap_range {
+	/** First register of the range */
+	uint32_t start;
+	/** Last register of the range */
+	uint32_t end;
+};
+
+/**
+ * @struct regmap_init_param
+ * @brief Register map initialization parameters.
+ *
+ * The registers are 8 bits wide. They are accessed either over SPI, with the
+ * address followed by the data in a single transfer, or through the reg_read
+ * and reg_write callbacks when spi is NULL.
+ */
+struct regmap_init_param {
+	/** Highest register address */
+	uint32_t max_register;
+	/** Registers changed by the device, never cached */
+	const struct regmap_range *volatile_ranges;
+	/** Number of volatile ranges */
+	uint32_t no_volatile_ranges;
+	/** Registers with read side effects, never read by the register map */
+	const struct regmap_range *precious_ranges;
+	/** Number of precious ranges */
+	uint32_t no_precious_ranges;
+	/** Reset values, max_register + 1 bytes, NULL if unknown */
+	const uint8_t *reg_defaults;
+	/** SPI descriptor, NULL to use the callbacks */
+	struct spi_desc *spi;
+	/** Number of address bytes sent over SPI, 1 or 2 */
+	uint8_t addr_bytes;
+	/** Bits set in the SPI address for reads */
+	uint32_t read_flag_mask;
+	/** Bits set in the SPI address for writes */
+	uint32_t write_flag_mask;
+	/** SPI streaming address step: 1, -1, or 0 if not supported */
+	int8_t addr_step;
+	/** Read a register, used when spi is NULL */
+	int32_t (*reg_read)(void *ctx, uint32_t reg, uint8_t *val);
+	/** Write a register, used when spi is NULL */
+	int32_t (*reg_write)(void *ctx, uint32_t reg, uint8_t val);
+	/** Callbacks context */
+	void *ctx;
+};
+
+/**
+ * @struct regmap
+ * @brief Register map descriptor.
+ */
+struct regmap {
+	/** Highest register address */
+	uint32_t max_register;
+	/** Registers changed by the device, never cached */
+	const struct regmap_range *volatile_ranges;
+	/** Number of volatile ranges */
+	uint32_t no_volatile_ranges;
+	/** Registers with read side effects, never read by the register map */
+	const struct regmap_range *precious_ranges;
+	/** Number of precious ranges */
+	uint32_t no_precious_ranges;
+	/** Reset values, NULL if unknown */
+	const uint8_t *reg_defaults;
+	/** SPI descriptor, NULL to use the callbacks */
+	struct spi_desc *spi;
+	/** Number of address bytes sent over SPI */
+	uint8_t addr_bytes;
+	/** Bits set in the SPI address for reads */
+	uint32_t read_flag_mask;
+	/** Bits set in the SPI address for writes */
+	uint32_t write_flag_mask;
+	/** SPI streaming address step */
+	int8_t addr_step;
+	/** Read a register, used when spi is NULL */
+	int32_t (*reg_read)(void *ctx, uint32_t reg, uint8_t *val);
+	/** Write a register, used when spi is NULL */
+	int32_t (*reg_write)(void *ctx, uint32_t reg, uint8_t val);
+	/** Callbacks context */
+	void *ctx;
+	/** Cached register values */
+	uint8_t *cache;
+	/** Bitmap of the cached registers */
+	uint8_t *valid;
+	/** Bitmap of the cached registers not written to the device yet */
+	uint8_t *dirty;
+	/** If set, writes only update the cache until regmap_sync() */
+	bool cache_only;
+	/** Number of dirty registers */
+	uint32_t no_dirty;
+	/** Number of register accesses done on the bus */
+	uint32_t bus_reads;
+	/** Number of register writes done on the bus */
+	uint32_t bus_writes;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Initialize the register map. */
+int32_t regmap_init(struct regmap **map,
+		    const struct regmap_init_param *init_param);
+/* Free the resources allocated by regmap_init(). */
+int32_t regmap_remove(struct regmap *map);
+/* Read a register. */
+int32_t regmap_read(struct regmap *map, uint32_t reg, uint8_t *val);
+/* Write a register. */
+int32_t regmap_write(struct regmap *map, uint32_t reg, uint8_t val);
+/* Update the bits of a register selected by mask. */
+int32_t regmap_update_bits(struct regmap *map, uint32_t reg, uint8_t mask,
+			   uint8_t val);
+/* Read consecutive registers. */
+int32_t regmap_bulk_read(struct regmap *map, uint32_t reg, uint8_t *val,
+			 uint32_t count);
+/* Write consecutive registers. */
+int32_t regmap_bulk_write(struct regmap *map, uint32_t reg, const uint8_t *val,
+			  uint32_t count);
+/* Defer the register writes until regmap_sync(). */
+int32_t regmap_cache_only(struct regmap *map, bool enable);
+/* Write the dirty registers to the device. */
+int32_t regmap_sync(struct regmap *map);
+/* Drop the cache, to be called after a device reset. */
+void regmap_cache_reset(struct regmap *map);
+
+#endif /* REGMAP_H_ */
@@ -113,6 +113,23 @@ struct uart_init_param {
 	void		*extra;
 };
 
+/**
+ * @struct uart_rx_stats
+ * @brief Statistics of the receive ring, see uart_get_rx_stats().
+ */
+struct uart_rx_stats {
+	/** Bytes stored in the receive ring */
+	uint32_t	received;
+	/** Bytes dropped because the receive ring was full */
+	uint32_t	dropped;
+	/** Number of times the receive ring filled up */
+	uint32_t	overflows;
+	/** Highest number of bytes waiting in the receive ring */
+	uint32_t	max_used;
+	/** Receive errors reported by the UART (framing, parity, overrun...) */
+	uint32_t	errors;
+};
+
 /**
  * @struct uart_desc
  * @brief Stucture holding the UART descriptor.
@@ -159,4 +176,14 @@ int32_t uart_remove(struct uart_desc *desc);
 /* Check if UART errors occurred. */
 uint32_t uart_get_errors(struct uart_desc *desc);
 
+/* Get received data without copying it. */
+int32_t uart_read_peek(struct uart_desc *desc, const uint8_t **data,
+		       uint32_t *bytes_number);
+
+/* Release data returned by uart_read_peek(). */
+int32_t uart_read_release(struct uart_desc *desc, uint32_t bytes_number);
+
+/* Get the statistics of the receive ring. */
+int32_t uart_get_rx_stats(struct uart_desc *desc, struct uart_rx_stats *stats);
+
 #endif /* UART_H_ */
@@ -0,0 +1,111 @@
+/***************************************************************************//**
+ *   @file   uart_rx.h
+ *   @brief  Receive ring shared by the UART platform drivers.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+#ifndef UART_RX_H_
+#define UART_RX_H_
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "uart.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Receive ring size used when the platform parameters do not set one */
+#define UART_RX_RING_SIZE	4096
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct circular_buffer;
+
+/**
+ * @struct uart_rx
+ * @brief Receive ring filled from the UART interrupt, or by DMA, and read by
+ * the application. The ring is allocated once, the interrupt only moves
+ * indexes.
+ */
+struct uart_rx {
+	/** Ring holding the received bytes */
+	struct circular_buffer	*cb;
+	/** Set when the receiver was given the scratch byte, the ring was full */
+	bool			dropping;
+	/** Receives a byte when the ring is full */
+	uint8_t			scratch;
+	/** Statistics */
+	struct uart_rx_stats	stats;
+};
+
+/******************************************************************************/
+/************************ Functions Declarations ******************************/
+/******************************************************************************/
+
+/* Allocate the receive ring. */
+int32_t uart_rx_init(struct uart_rx **rx, uint32_t size);
+
+/* Free the resources allocated by uart_rx_init(). */
+int32_t uart_rx_remove(struct uart_rx *rx);
+
+/* Get the buffer where the receiver stores the next bytes. Interrupt side. */
+void uart_rx_fill_get(struct uart_rx *rx, uint32_t max_len, uint8_t **buff,
+		      uint32_t *len);
+
+/* Publish the bytes stored in the buffer from uart_rx_fill_get(). */
+void uart_rx_fill_done(struct uart_rx *rx, uint32_t len);
+
+/* Count a receive error reported by the UART. Interrupt side. */
+void uart_rx_error(struct uart_rx *rx);
+
+/* Get received data without copying it. Application side. */
+int32_t uart_rx_peek(struct uart_rx *rx, const uint8_t **data, uint32_t *len);
+
+/* Release data returned by uart_rx_peek(). */
+int32_t uart_rx_release(struct uart_rx *rx, uint32_t len);
+
+/* Copy received data, waiting until len bytes are available. */
+int32_t uart_rx_read(struct uart_rx *rx, uint8_t *data, uint32_t len);
+
+/* Get the statistics of the ring. */
+int32_t uart_rx_get_stats(struct uart_rx *rx, struct uart_rx_stats *stats);
+
+#endif /* UART_RX_H_ */
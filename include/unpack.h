@@ -1,9 +1,8 @@
 /***************************************************************************//**
- *   @file   fifo.c
- *   @brief  Implementation of fifo.
- *   @author Cristian Pop (cristian.pop@analog.com)
+ *   @file   unpack.h
+ *   @brief  Unpacking of big-endian packed sample words.
 ********************************************************************************
- * Copyright 2019(c) Analog Devices, Inc.
+ * Copyright 2021(c) Analog Devices, Inc.
  *
  * All rights reserved.
  *
@@ -36,101 +35,26 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************/
+#ifndef UNPACK_H_
+#define UNPACK_H_
 
 /******************************************************************************/
 /***************************** Include Files **********************************/
 /******************************************************************************/
 
-#include <string.h>
-#include <stdlib.h>
-#include "fifo.h"
-#include "error.h"
+#include <stdint.h>
+#include <stdbool.h>
 
 /******************************************************************************/
-/************************ Functions Definitions *******************************/
+/************************ Functions Declarations ******************************/
 /******************************************************************************/
 
-/**
- * @brief Create new fifo element
- * @param buff - Data to be saved in fifo.
- * @param len - Length of the data.
- * @return fifo element in case of success, NULL otherwise
- */
-static struct fifo_element * fifo_new_element(char *buff, uint32_t len)
-{
-	struct fifo_element *q = calloc(1, sizeof(struct fifo_element));
-	if (!q)
-		return NULL;
+/* Unpack big-endian words of stride bits into 32-bit samples. */
+int32_t unpack_be_u32(uint32_t *dst, const uint8_t *src, uint32_t count,
+		      uint8_t stride, uint8_t bits, bool sign_ext);
 
-	q->len = len;
-	q->data = calloc(1, len);
-	if (!(q->data)) {
-		free(q);
-		return NULL;
-	}
-	memcpy(q->data, buff, len);
+/* Unpack big-endian words of stride bits into 16-bit samples. */
+int32_t unpack_be_u16(uint16_t *dst, const uint8_t *src, uint32_t count,
+		      uint8_t stride, uint8_t bits, bool sign_ext);
 
-	return q;
-}
-
-/**
- * @brief Get last element in fifo
- * @param p_fifo - pointer to fifo
- * @return fifo last element if exists, NULL otherwise
- */
-static struct fifo_element *fifo_get_last(struct fifo_element *p_fifo)
-{
-	if(p_fifo == NULL)
-		return NULL;
-	while (p_fifo->next) {
-		p_fifo = p_fifo->next;
-	}
-
-	return p_fifo;
-}
-
-/**
- * @brief Insert element to fifo, in the last position.
- * @param p_fifo - Pointer to fifo.
- * @param buff - Data to be saved in fifo.
- * @param len - Length of the data.
- * @return SUCCESS in case of success, FAILURE otherwise
- */
-int32_t fifo_insert(struct fifo_element **p_fifo, char *buff, uint32_t len)
-{
-	struct fifo_element *p, *q;
-
-	if (len <= 0)
-		return FAILURE;
-
-	q = fifo_new_element(buff, len);
-	if (!q)
-		return FAILURE;
-
-	if (!(*p_fifo)) {
-		*p_fifo = q;
-	} else {
-		p = fifo_get_last(*p_fifo);
-		p->next = q;
-	}
-
-	return SUCCESS;
-}
-
-/**
- * @brief Remove fifo head
- * @param p_fifo - Pointer to fifo.
- * @return next element in fifo if exists, NULL otherwise.
- */
-struct fifo_element * fifo_remove(struct fifo_element *p_fifo)
-{
-	struct fifo_element *p = p_fifo;
-
-	if (p_fifo != NULL) {
-		p_fifo = p_fifo->next;
-		free(p->data);
-		free(p);
-	}
-
-	return p_fifo;
-}
+#endif /* UNPACK_H_ */
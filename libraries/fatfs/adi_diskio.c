@@ -44,22 +44,37 @@
 #include "ff.h"			/* Obtains integer types */
 #include "diskio.h"		/* Declarations of disk functions */
 
+#include "adi_diskio.h"
 #include "sd.h"
 #include "error.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef LINUX_PLATFORM
+#include <unistd.h>
+#include <sys/types.h>
+#endif
 
 /******************************************************************************/
 /********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
 
-#define DEV_SD		0	/* Example: Map MMC/SD card to physical drive 0 */
-#define DEV_RAM		1	/* Example: Map Ramdisk to physical drive 1 */
-#define DEV_USB		2	/* Example: Map USB MSD to physical drive 2 */
-
 #define ERASE_SECTOR_SIZE	1u
+#define DISK_SECTOR_SIZE	512u
 uint8_t			sd_init_var = false;
 extern struct sd_desc	*sd_desc;
 
+/* RAM disk */
+static uint8_t		*ram_disk;
+static uint32_t		ram_disk_sectors;
+static bool		ram_disk_allocated;
+
+#ifdef LINUX_PLATFORM
+/* Disk image in a file */
+static FILE		*file_disk;
+static uint32_t		file_disk_sectors;
+#endif
+
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
@@ -67,7 +82,15 @@ extern struct sd_desc	*sd_desc;
 DSTATUS SD_disk_status();
 DSTATUS SD_disk_initialize();
 DRESULT SD_disk_read(BYTE *buff, LBA_t sector, UINT count);
-DRESULT SD_disk_write(BYTE *buff, LBA_t sector, UINT count);
+DRESULT SD_disk_write(const BYTE *buff, LBA_t sector, UINT count);
+DSTATUS RAM_disk_status();
+DRESULT RAM_disk_read(BYTE *buff, LBA_t sector, UINT count);
+DRESULT RAM_disk_write(const BYTE *buff, LBA_t sector, UINT count);
+DRESULT RAM_disk_ioctl(BYTE cmd, void *buff);
+DSTATUS FILE_disk_status();
+DRESULT FILE_disk_read(BYTE *buff, LBA_t sector, UINT count);
+DRESULT FILE_disk_write(const BYTE *buff, LBA_t sector, UINT count);
+DRESULT FILE_disk_ioctl(BYTE cmd, void *buff);
 
 /*-----------------------------------------------------------------------*/
 /* Get Drive Status                                                      */
@@ -80,9 +103,11 @@ DSTATUS disk_status (
 	case DEV_SD :
 		return SD_disk_status();;
 	case DEV_RAM :
-		return STA_NODISK;
+		return RAM_disk_status();
 	case DEV_USB :
 		return STA_NODISK;
+	case DEV_FILE :
+		return FILE_disk_status();
 	default:
 		return STA_NODISK;
 	}
@@ -100,9 +125,11 @@ DSTATUS disk_initialize (
 	case DEV_SD :
 		return SD_disk_initialize();
 	case DEV_RAM :
-		return STA_NODISK;
+		return RAM_disk_status();
 	case DEV_USB :
 		return STA_NODISK;
+	case DEV_FILE :
+		return FILE_disk_status();
 	}
 	return STA_NOINIT;
 }
@@ -122,9 +149,11 @@ DRESULT disk_read (
 	case DEV_SD :
 		return SD_disk_read(buff, sector, count);
 	case DEV_RAM :
-		return RES_NOTRDY;
+		return RAM_disk_read(buff, sector, count);
 	case DEV_USB :
 		return RES_NOTRDY;
+	case DEV_FILE :
+		return FILE_disk_read(buff, sector, count);
 	}
 	return RES_PARERR;
 }
@@ -146,9 +175,11 @@ DRESULT disk_write (
 	case DEV_SD:
 		return SD_disk_write(buff, sector, count);
 	case DEV_RAM :
-		return RES_NOTRDY;
+		return RAM_disk_write(buff, sector, count);
 	case DEV_USB :
 		return RES_NOTRDY;
+	case DEV_FILE :
+		return FILE_disk_write(buff, sector, count);
 	}
 
 	return RES_PARERR;
@@ -168,7 +199,10 @@ DRESULT disk_ioctl (
 	switch(pdrv) {
 	case DEV_SD:
 		switch (cmd){
-		case CTRL_SYNC: return RES_OK;
+		case CTRL_SYNC:
+			if (SUCCESS != sd_sync(sd_desc))
+				return RES_ERROR;
+			return RES_OK;
 		case GET_SECTOR_COUNT:
 			*(LBA_t *)buff = sd_desc->memory_size / DATA_BLOCK_LEN;
 			return RES_OK;
@@ -186,9 +220,11 @@ DRESULT disk_ioctl (
 		}
 		return RES_PARERR;
 	case DEV_RAM:
-		return RES_NOTRDY;
+		return RAM_disk_ioctl(cmd, buff);
 	case DEV_USB:
 		return RES_NOTRDY;
+	case DEV_FILE:
+		return FILE_disk_ioctl(cmd, buff);
 	}
 	return RES_PARERR;
 }
@@ -214,20 +250,271 @@ DRESULT SD_disk_read(BYTE *buff, LBA_t sector, UINT count)
 {
 	if (!sd_init_var)
 		return RES_NOTRDY;
-	if (SUCCESS != sd_read(sd_desc, buff, (uint64_t)sector * 512, (uint64_t)count * 512))
+	if (SUCCESS != sd_read_blocks(sd_desc, buff, sector, count))
 		return RES_ERROR;
 
 	return RES_OK;
 }
 
-DRESULT SD_disk_write(BYTE *buff, LBA_t sector, UINT count)
+DRESULT SD_disk_write(const BYTE *buff, LBA_t sector, UINT count)
 {
 	if (!sd_init_var)
 		return RES_NOTRDY;
-	if (SUCCESS != sd_write(sd_desc, buff, (uint64_t)sector * 512, (uint64_t)count * 512))
+	if (SUCCESS != sd_write_blocks(sd_desc, buff, sector, count))
+		return RES_ERROR;
+
+	return RES_OK;
+}
+
+/**
+ * @brief Set up the RAM disk. The disk must be formatted with f_mkfs()
+ * before being mounted, unless buff already holds a file system.
+ * @param buff - Memory of the disk, NULL to allocate it.
+ * @param sectors - Size of the disk in 512 bytes sectors.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t ram_disk_init(uint8_t *buff, uint32_t sectors)
+{
+	if (!sectors)
+		return -EINVAL;
+
+	if (ram_disk)
+		return -EBUSY;
+
+	ram_disk_allocated = !buff;
+	if (!buff) {
+		buff = calloc(sectors, DISK_SECTOR_SIZE);
+		if (!buff)
+			return -ENOMEM;
+	}
+
+	ram_disk = buff;
+	ram_disk_sectors = sectors;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by ram_disk_init().
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t ram_disk_remove(void)
+{
+	if (!ram_disk)
+		return -EINVAL;
+
+	if (ram_disk_allocated)
+		free(ram_disk);
+	ram_disk = NULL;
+	ram_disk_sectors = 0;
+
+	return SUCCESS;
+}
+
+DSTATUS RAM_disk_status()
+{
+	if (ram_disk)
+		return 0;
+	return STA_NOINIT | STA_NODISK;
+}
+
+DRESULT RAM_disk_read(BYTE *buff, LBA_t sector, UINT count)
+{
+	if (!ram_disk)
+		return RES_NOTRDY;
+	if (sector >= ram_disk_sectors || count > ram_disk_sectors - sector)
+		return RES_PARERR;
+
+	memcpy(buff, ram_disk + (size_t)sector * DISK_SECTOR_SIZE,
+	       (size_t)count * DISK_SECTOR_SIZE);
+
+	return RES_OK;
+}
+
+DRESULT RAM_disk_write(const BYTE *buff, LBA_t sector, UINT count)
+{
+	if (!ram_disk)
+		return RES_NOTRDY;
+	if (sector >= ram_disk_sectors || count > ram_disk_sectors - sector)
+		return RES_PARERR;
+
+	memcpy(ram_disk + (size_t)sector * DISK_SECTOR_SIZE, buff,
+	       (size_t)count * DISK_SECTOR_SIZE);
+
+	return RES_OK;
+}
+
+DRESULT RAM_disk_ioctl(BYTE cmd, void *buff)
+{
+	if (!ram_disk)
+		return RES_NOTRDY;
+
+	switch (cmd) {
+	case CTRL_SYNC:
+		return RES_OK;
+	case GET_SECTOR_COUNT:
+		*(LBA_t *)buff = ram_disk_sectors;
+		return RES_OK;
+	case GET_SECTOR_SIZE:
+		*(WORD *)buff = DISK_SECTOR_SIZE;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		*(DWORD *)buff = ERASE_SECTOR_SIZE;
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+}
+
+#ifdef LINUX_PLATFORM
+
+/**
+ * @brief Use a file as disk, for example an image made with mkfs.vfat or a
+ * file formatted with f_mkfs().
+ * @param path - Path of the file.
+ * @param sectors - Size of the disk in 512 bytes sectors, 0 to use the size
+ *                  of the existing file. The file is created or extended
+ *                  when needed.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t file_disk_init(const char *path, uint32_t sectors)
+{
+	off_t size;
+
+	if (!path)
+		return -EINVAL;
+
+	if (file_disk)
+		return -EBUSY;
+
+	file_disk = fopen(path, "r+b");
+	if (!file_disk && sectors)
+		file_disk = fopen(path, "w+b");
+	if (!file_disk)
+		return -ENOENT;
+
+	if (fseeko(file_disk, 0, SEEK_END))
+		goto error;
+	size = ftello(file_disk);
+	if (size < 0)
+		goto error;
+
+	if (!sectors)
+		sectors = size / DISK_SECTOR_SIZE;
+	if (!sectors)
+		goto error;
+
+	if (size < (off_t)sectors * DISK_SECTOR_SIZE &&
+	    ftruncate(fileno(file_disk), (off_t)sectors * DISK_SECTOR_SIZE))
+		goto error;
+
+	file_disk_sectors = sectors;
+
+	return SUCCESS;
+error:
+	fclose(file_disk);
+	file_disk = NULL;
+
+	return FAILURE;
+}
+
+/**
+ * @brief Close the file opened by file_disk_init().
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t file_disk_remove(void)
+{
+	int32_t ret;
+
+	if (!file_disk)
+		return -EINVAL;
+
+	ret = fclose(file_disk) ? FAILURE : SUCCESS;
+	file_disk = NULL;
+	file_disk_sectors = 0;
+
+	return ret;
+}
+
+DSTATUS FILE_disk_status()
+{
+	if (file_disk)
+		return 0;
+	return STA_NOINIT | STA_NODISK;
+}
+
+DRESULT FILE_disk_read(BYTE *buff, LBA_t sector, UINT count)
+{
+	if (!file_disk)
+		return RES_NOTRDY;
+	if (sector >= file_disk_sectors || count > file_disk_sectors - sector)
+		return RES_PARERR;
+
+	if (fseeko(file_disk, (off_t)sector * DISK_SECTOR_SIZE, SEEK_SET) ||
+	    fread(buff, DISK_SECTOR_SIZE, count, file_disk) != count)
+		return RES_ERROR;
+
+	return RES_OK;
+}
+
+DRESULT FILE_disk_write(const BYTE *buff, LBA_t sector, UINT count)
+{
+	if (!file_disk)
+		return RES_NOTRDY;
+	if (sector >= file_disk_sectors || count > file_disk_sectors - sector)
+		return RES_PARERR;
+
+	if (fseeko(file_disk, (off_t)sector * DISK_SECTOR_SIZE, SEEK_SET) ||
+	    fwrite(buff, DISK_SECTOR_SIZE, count, file_disk) != count)
 		return RES_ERROR;
 
 	return RES_OK;
 }
 
+DRESULT FILE_disk_ioctl(BYTE cmd, void *buff)
+{
+	if (!file_disk)
+		return RES_NOTRDY;
+
+	switch (cmd) {
+	case CTRL_SYNC:
+		if (fflush(file_disk) || fsync(fileno(file_disk)))
+			return RES_ERROR;
+		return RES_OK;
+	case GET_SECTOR_COUNT:
+		*(LBA_t *)buff = file_disk_sectors;
+		return RES_OK;
+	case GET_SECTOR_SIZE:
+		*(WORD *)buff = DISK_SECTOR_SIZE;
+		return RES_OK;
+	case GET_BLOCK_SIZE:
+		*(DWORD *)buff = ERASE_SECTOR_SIZE;
+		return RES_OK;
+	default:
+		return RES_PARERR;
+	}
+}
+
+#else
+
+DSTATUS FILE_disk_status()
+{
+	return STA_NOINIT | STA_NODISK;
+}
+
+DRESULT FILE_disk_read(BYTE *buff, LBA_t sector, UINT count)
+{
+	return RES_NOTRDY;
+}
+
+DRESULT FILE_disk_write(const BYTE *buff, LBA_t sector, UINT count)
+{
+	return RES_NOTRDY;
+}
+
+DRESULT FILE_disk_ioctl(BYTE cmd, void *buff)
+{
+	return RES_NOTRDY;
+}
 
+#endif /* LINUX_PLATFORM */
@@ -1,9 +1,8 @@
 /***************************************************************************//**
- *   @file   fifo.h
- *   @brief  Implementation of fifo
- *   @author Cristian Pop (cristian.pop@analog.com)
+ *   @file   adi_diskio.h
+ *   @brief  Drives of the Low level disk I/O module for FatFs.
 ********************************************************************************
- * Copyright 2019(c) Analog Devices, Inc.
+ * Copyright 2021(c) Analog Devices, Inc.
  *
  * All rights reserved.
  *
@@ -36,8 +35,9 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 *******************************************************************************/
-#ifndef FIFO_H_
-#define FIFO_H_
+
+#ifndef ADI_DISKIO_H_
+#define ADI_DISKIO_H_
 
 /******************************************************************************/
 /***************************** Include Files **********************************/
@@ -46,30 +46,26 @@
 #include <stdint.h>
 
 /******************************************************************************/
-/*************************** Types Declarations *******************************/
+/********************** Macros and Constants Definitions **********************/
 /******************************************************************************/
 
-/**
- * @struct fifo_element
- * @brief Structure holding the fifo element parameters.
- */
-struct fifo_element {
-	/** next FIFO element */
-	struct fifo_element *next;
-	/** FIFO data pointer */
-	char *data;
-	/** FIFO length */
-	uint32_t len;
-};
+/* Physical drive numbers, used as "<drive>:" in the FatFs paths. FatFs only
+ * reaches the drives below FF_VOLUMES, 1 by default, see ffconf.h. */
+#define DEV_SD		0	/* SD card, see sd_desc */
+#define DEV_RAM		1	/* RAM disk, see ram_disk_init() */
+#define DEV_USB		2	/* Not implemented */
+#define DEV_FILE	3	/* Linux file, see file_disk_init() */
 
 /******************************************************************************/
 /************************ Functions Declarations ******************************/
 /******************************************************************************/
 
-/* Insert element to fifo tail. */
-int32_t fifo_insert(struct fifo_element **p_fifo, char *buff, uint32_t len);
+int32_t ram_disk_init(uint8_t *buff, uint32_t sectors);
+int32_t ram_disk_remove(void);
 
-/* Remove fifo head. */
-struct fifo_element *fifo_remove(struct fifo_element *p_fifo);
+#ifdef LINUX_PLATFORM
+int32_t file_disk_init(const char *path, uint32_t sectors);
+int32_t file_disk_remove(void);
+#endif
 
-#endif /* FIFO_H_ */
+#endif /* ADI_DISKIO_H_ */
@@ -38,8 +38,11 @@
 /  f_findnext(). (0:Disable, 1:Enable 2:Enable with matching altname[] too) */
 
 
+#ifndef FF_USE_MKFS
 #define FF_USE_MKFS		0
-/* This option switches f_mkfs() function. (0:Disable or 1:Enable) */
+#endif
+/* This option switches f_mkfs() function. (0:Disable or 1:Enable)
+/  It can be overridden from the build, e.g. -DFF_USE_MKFS=1. */
 
 
 #define FF_USE_FASTSEEK	0
@@ -163,8 +166,12 @@
 / Drive/Volume Configurations
 /---------------------------------------------------------------------------*/
 
+#ifndef FF_VOLUMES
 #define FF_VOLUMES		1
-/* Number of volumes (logical drives) to be used. (1-10) */
+#endif
+/* Number of volumes (logical drives) to be used. (1-10)
+/  It can be overridden from the build. The drives of adi_diskio.h above 0:
+/  need FF_VOLUMES greater than their number, e.g. -DFF_VOLUMES=4 for 3:. */
 
 
 #define FF_STR_VOLUME_ID	0
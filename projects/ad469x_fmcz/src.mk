@@ -17,6 +17,7 @@ SRCS += $(DRIVERS)/spi/spi.c						\
 	$(DRIVERS)/axi_core/clk_axi_clkgen/clk_axi_clkgen.c		\
 	$(DRIVERS)/axi_core/axi_pwmgen/axi_pwm.c			\
 	$(DRIVERS)/axi_core/spi_engine/spi_engine.c			\
+	$(NO-OS)/util/regmap.c						\
 	$(NO-OS)/util/util.c
 SRCS +=	$(PLATFORM_DRIVERS)/axi_io.c					\
 	$(PLATFORM_DRIVERS)/xilinx_gpio.c				\
@@ -27,7 +28,8 @@ LIBRARIES += iio
 SRCS += $(PLATFORM_DRIVERS)/uart.c					\
 	$(PLATFORM_DRIVERS)/$(PLATFORM)_irq.c				\
 	$(DRIVERS)/irq/irq.c						\
-	$(NO-OS)/util/fifo.c						\
+	$(NO-OS)/util/circular_buffer.c					\
+	$(NO-OS)/util/uart_rx.c						\
 	$(NO-OS)/util/list.c						
 endif
 INCS += $(PROJECT)/src/parameters.h
@@ -49,9 +51,11 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/delay.h						\
 	$(INCLUDE)/irq.h						\
 	$(INCLUDE)/uart.h						\
+	$(INCLUDE)/regmap.h						\
 	$(INCLUDE)/util.h
 ifeq (y,$(strip $(TINYIIOD)))
-INCS += $(INCLUDE)/fifo.h						\
+INCS += $(INCLUDE)/circular_buffer.h					\
+	$(INCLUDE)/uart_rx.h						\
 	$(INCLUDE)/irq.h						\
 	$(INCLUDE)/uart.h						\
 	$(INCLUDE)/list.h						\
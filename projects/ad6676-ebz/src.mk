@@ -31,7 +31,8 @@ SRCS +=	$(PLATFORM_DRIVERS)/axi_io.c					\
 	$(PLATFORM_DRIVERS)/delay.c
 ifeq (y,$(strip $(TINYIIOD)))
 LIBRARIES += iio
-SRCS += $(NO-OS)/util/fifo.c						\
+SRCS += $(NO-OS)/util/circular_buffer.c					\
+	$(NO-OS)/util/uart_rx.c						\
 	$(NO-OS)/util/list.c						\
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.c				\
 	$(PLATFORM_DRIVERS)/uart.c					\
@@ -61,7 +62,8 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/util.h						\
 	$(INCLUDE)/print_log.h
 ifeq (y,$(strip $(TINYIIOD)))
-INCS += $(INCLUDE)/fifo.h						\
+INCS += $(INCLUDE)/circular_buffer.h					\
+	$(INCLUDE)/uart_rx.h						\
 	$(INCLUDE)/irq.h						\
 	$(INCLUDE)/uart.h						\
 	$(INCLUDE)/list.h						\
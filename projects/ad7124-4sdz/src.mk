@@ -12,7 +12,8 @@
 SRCS += $(PROJECT)/src/ad7124-4sdz.c
 SRCS += $(DRIVERS)/spi/spi.c						\
 	$(DRIVERS)/adc/ad7124/ad7124.c					\
-	$(DRIVERS)/adc/ad7124/ad7124_regs.c				
+	$(DRIVERS)/adc/ad7124/ad7124_regs.c				\
+	$(NO-OS)/util/crc8.c
 SRCS +=	$(PLATFORM_DRIVERS)/axi_io.c					\
 	$(PLATFORM_DRIVERS)/xilinx_spi.c				\
 	$(PLATFORM_DRIVERS)/delay.c
@@ -30,4 +31,5 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/delay.h						\
 	$(INCLUDE)/irq.h						\
 	$(INCLUDE)/uart.h						\
+	$(INCLUDE)/crc8.h						\
 	$(INCLUDE)/util.h
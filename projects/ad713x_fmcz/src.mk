@@ -27,7 +27,8 @@ SRC_DIRS += $(NO-OS)/iio/iio_app
 SRCS += $(PLATFORM_DRIVERS)/uart.c					\
 	$(PLATFORM_DRIVERS)/$(PLATFORM)_irq.c				\
 	$(DRIVERS)/irq/irq.c						\
-	$(NO-OS)/util/fifo.c						\
+	$(NO-OS)/util/circular_buffer.c					\
+	$(NO-OS)/util/uart_rx.c						\
 	$(NO-OS)/util/list.c	
 endif
 INCS += $(DRIVERS)/axi_core/axi_dmac/axi_dmac.h				\
@@ -46,6 +47,7 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/uart.h						\
 	$(INCLUDE)/util.h
 ifeq (y,$(strip $(TINYIIOD)))
-INCS += $(INCLUDE)/fifo.h						\
+INCS += $(INCLUDE)/circular_buffer.h					\
+	$(INCLUDE)/uart_rx.h						\
 	$(INCLUDE)/list.h
 endif
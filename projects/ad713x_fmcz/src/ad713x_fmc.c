@@ -81,7 +81,7 @@ int main()
 	uint32_t *offload_data;
 	uint32_t i;
 	int32_t ret;
-	struct spi_engine_offload_init_param spi_engine_offload_init_param;
+	struct spi_engine_offload_init_param spi_engine_offload_init_param = { 0 };
 	struct spi_engine_offload_message spi_engine_offload_message;
 	uint32_t spi_eng_msg_cmds[2];
 	static struct xil_spi_init_param spi_engine_init_params = {
@@ -36,10 +36,12 @@ LIBRARIES += iio
 SRCS += $(DRIVERS)/cdc/ad7746/iio_ad7746.c \
 	$(NO-OS)/iio/iio_app/iio_app.c \
 	$(NO-OS)/util/list.c \
-	$(NO-OS)/util/fifo.c
+	$(NO-OS)/util/circular_buffer.c \
+	$(NO-OS)/util/uart_rx.c
 INCS += $(DRIVERS)/cdc/ad7746/iio_ad7746.h \
 	$(NO-OS)/iio/iio_app/iio_app.h \
-	$(INCLUDE)/fifo.h \
+	$(INCLUDE)/circular_buffer.h \
+	$(INCLUDE)/uart_rx.h \
 	$(INCLUDE)/list.h
 endif
 
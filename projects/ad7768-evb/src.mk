@@ -11,7 +11,8 @@
 
 # Add to SRCS source files to be build in the project
 SRCS += $(PROJECT)/src/ad7768_evb.c
-SRCS += $(NO-OS)/util/fifo.c
+SRCS += $(NO-OS)/util/circular_buffer.c
+SRCS += $(NO-OS)/util/uart_rx.c
 SRCS += $(NO-OS)/util/util.c
 SRCS += $(NO-OS)/util/list.c
 
@@ -27,7 +28,8 @@ INCS += $(INCLUDE)/i2c.h
 INCS += $(INCLUDE)/uart.h
 INCS +=	$(INCLUDE)/irq.h
 INCS += $(INCLUDE)/list.h
-INCS += $(INCLUDE)/fifo.h
+INCS += $(INCLUDE)/circular_buffer.h
+INCS += $(INCLUDE)/uart_rx.h
 INCS += $(PROJECT)/src/parameters.h
 
 # Add to SRC_DIRS directories to be used in the build. All .c and .h files from
@@ -51,13 +53,15 @@ ifeq (y,$(strip $(TINYIIOD)))
 LIBRARIES += iio
 SRC_DIRS += $(NO-OS)/iio/iio_app
 
-INCS +=	$(INCLUDE)/fifo.h						\
+INCS +=	$(INCLUDE)/circular_buffer.h					\
+	$(INCLUDE)/uart_rx.h						\
 	$(INCLUDE)/uart.h						\
 	$(INCLUDE)/list.h						\
 	$(PLATFORM_DRIVERS)/irq_extra.h					\
 	$(PLATFORM_DRIVERS)/uart_extra.h                                \
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.h
-SRCS += $(NO-OS)/util/fifo.c						\
+SRCS += $(NO-OS)/util/circular_buffer.c					\
+	$(NO-OS)/util/uart_rx.c						\
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.c			\
 	$(NO-OS)/util/list.c						\
 	$(PLATFORM_DRIVERS)/uart.c					\
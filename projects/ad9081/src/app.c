@@ -57,6 +57,9 @@
 #include "axi_dmac.h"
 #include "parameters.h"
 #include "app_config.h"
+#ifndef PLATFORM_MB
+#include "xtime_l.h"
+#endif
 
 #ifdef IIO_SUPPORT
 #include "iio_app.h"
@@ -150,6 +153,7 @@ int main(void)
 #endif
 		.lmfc_delay_dac_clk_cycles = 0,
 		.nco_sync_ms_extra_lmfc_num = 0,
+		.reg_cache_enable = true,
 		/* TX */
 		.dac_frequency_hz = AD9081_DAC_FREQUENCY,
 		/* The 4 DAC Main Datapaths */
@@ -206,6 +210,9 @@ int main(void)
 	struct ad9081_phy* phy[MULTIDEVICE_INSTANCE_COUNT];
 	int32_t status;
 	int32_t i;
+#ifndef PLATFORM_MB
+	XTime t_start, t_end;
+#endif
 
 	printf("Hello\n");
 
@@ -252,9 +259,17 @@ int main(void)
 		phy_param.dev_clk = &app_clk[i];
 		jesd_rx_link.device_id = i;
 
+#ifndef PLATFORM_MB
+		XTime_GetTime(&t_start);
+#endif
 		status = ad9081_init(&phy[i], &phy_param);
 		if (status != SUCCESS)
 			printf("ad9081_init() error: %" PRId32 "\n", status);
+#ifndef PLATFORM_MB
+		XTime_GetTime(&t_end);
+		printf("ad9081_init() took %" PRIu32 " ms\n",
+		       (uint32_t)((t_end - t_start) / (COUNTS_PER_SECOND / 1000)));
+#endif
 
 		rx_adc_init.num_channels += phy[i]->jesd_rx_link[0].jesd_param.jesd_m +
 					    phy[i]->jesd_rx_link[1].jesd_param.jesd_m;
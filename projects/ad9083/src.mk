@@ -65,7 +65,8 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/print_log.h						\
 	$(INCLUDE)/util.h
 ifeq (y,$(strip $(TINYIIOD)))
-SRCS += $(NO-OS)/util/fifo.c						\
+SRCS += $(NO-OS)/util/circular_buffer.c					\
+	$(NO-OS)/util/uart_rx.c						\
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.c			\
 	$(NO-OS)/iio/iio_app/iio_app.c					\
 	$(NO-OS)/util/list.c						\
@@ -73,7 +74,8 @@ SRCS += $(NO-OS)/util/fifo.c						\
 	$(PLATFORM_DRIVERS)/$(PLATFORM)_irq.c				\
 	$(DRIVERS)/irq/irq.c                        			\
 
-INCS += $(INCLUDE)/fifo.h						\
+INCS += $(INCLUDE)/circular_buffer.h					\
+	$(INCLUDE)/uart_rx.h						\
 	$(INCLUDE)/irq.h						\
 	$(INCLUDE)/uart.h						\
 	$(INCLUDE)/list.h						\
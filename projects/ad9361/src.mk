@@ -41,7 +41,8 @@ else
 SRCS += $(PLATFORM_DRIVERS)/uart.c
 endif
 
-SRCS += $(NO-OS)/util/fifo.c						\
+SRCS += $(NO-OS)/util/circular_buffer.c					\
+	$(NO-OS)/util/uart_rx.c						\
 	$(NO-OS)/util/list.c						\
 	$(DRIVERS)/rf-transceiver/ad9361/iio_ad9361.c				\
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.c				\
@@ -80,7 +81,8 @@ INCS += $(NO-OS)/network/tcp_socket.h	\
 	$(NO-OS)/network/noos_mbedtls_config.h
 endif
 
-INCS += $(INCLUDE)/fifo.h						\
+INCS += $(INCLUDE)/circular_buffer.h					\
+	$(INCLUDE)/uart_rx.h						\
 	$(INCLUDE)/uart.h						\
 	$(INCLUDE)/list.h										\
 	$(DRIVERS)/rf-transceiver/ad9361/iio_ad9361.h				\
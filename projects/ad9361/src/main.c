@@ -589,7 +589,11 @@ int main(void)
 #endif
 	axi_dac_init(&ad9361_phy->tx_dac, &tx_dac_init);
 	axi_dac_set_datasel(ad9361_phy->tx_dac, -1, AXI_DAC_DATA_SEL_DMA);
-	axi_dac_set_sine_lut(ad9361_phy->tx_dac, DAC_DDR_BASEADDR);
+	status = axi_dac_set_sine_lut(ad9361_phy->tx_dac, DAC_DDR_BASEADDR);
+	if (status < 0) {
+		printf("axi_dac_set_sine_lut error: %"PRIi32"\n", status);
+		return status;
+	}
 #else
 #ifdef FMCOMMS5
 	axi_dac_init(&ad9361_phy_b->tx_dac, &tx_dac_init);
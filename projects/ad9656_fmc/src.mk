@@ -28,7 +28,8 @@ SRCS += $(DRIVERS)/axi_core/axi_adc_core/axi_adc_core.c			\
         $(DRIVERS)/spi/spi.c						\
         $(NO-OS)/util/util.c
 ifeq (y,$(strip $(TINYIIOD)))
-SRCS += $(NO-OS)/util/fifo.c					\
+SRCS += $(NO-OS)/util/circular_buffer.c				\
+	$(NO-OS)/util/uart_rx.c					\
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.c		\
 	$(DRIVERS)/irq/irq.c					\
 	$(NO-OS)/util/list.c						\
@@ -59,7 +60,8 @@ INCS +=	$(INCLUDE)/axi_io.h						\
         $(INCLUDE)/delay.h						\
         $(INCLUDE)/util.h
 ifeq (y,$(strip $(TINYIIOD)))
-INCS +=	$(INCLUDE)/fifo.h					\
+INCS +=	$(INCLUDE)/circular_buffer.h				\
+	$(INCLUDE)/uart_rx.h					\
 	$(INCLUDE)/irq.h						\
 	$(INCLUDE)/uart.h						\
 	$(INCLUDE)/list.h						\
@@ -21,7 +21,8 @@ SRCS += $(DRIVERS)/dac/ad9739a/ad9739a.c				\
 	$(DRIVERS)/axi_core/axi_dmac/axi_dmac.c				\
 	$(NO-OS)/util/util.c
 ifeq (y,$(strip $(TINYIIOD)))
-SRCS += $(NO-OS)/util/fifo.c						\
+SRCS += $(NO-OS)/util/circular_buffer.c					\
+	$(NO-OS)/util/uart_rx.c						\
 	$(DRIVERS)/axi_core/iio_axi_dac/iio_axi_dac.c			\
 	$(DRIVERS)/irq/irq.c                                            \
 	$(NO-OS)/util/list.c						\
@@ -47,7 +48,8 @@ INCS +=	$(INCLUDE)/axi_io.h						\
 	$(INCLUDE)/print_log.h						\
 	$(INCLUDE)/util.h
 ifeq (y,$(strip $(TINYIIOD)))
-INCS +=	$(INCLUDE)/fifo.h						\
+INCS +=	$(INCLUDE)/circular_buffer.h					\
+	$(INCLUDE)/uart_rx.h						\
 	$(INCLUDE)/irq.h						\
 	$(INCLUDE)/uart.h						\
 	$(INCLUDE)/list.h						\
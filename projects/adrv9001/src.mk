@@ -59,7 +59,8 @@ SRCS += $(PROJECT)/src/app/app_iio.c \
 	$(PLATFORM_DRIVERS)/uart.c \
 	$(PLATFORM_DRIVERS)/$(PLATFORM)_irq.c \
 	$(NO-OS)/util/list.c \
-	$(NO-OS)/util/fifo.c \
+	$(NO-OS)/util/circular_buffer.c \
+	$(NO-OS)/util/uart_rx.c \
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.c \
 	$(DRIVERS)/axi_core/iio_axi_dac/iio_axi_dac.c \
 	$(DRIVERS)/irq/irq.c
@@ -68,7 +69,8 @@ INCS += $(PROJECT)/src/app/app_iio.h \
 	$(INCLUDE)/irq.h \
 	$(PLATFORM_DRIVERS)/irq_extra.h \
 	$(PLATFORM_DRIVERS)/uart_extra.h \
-	$(INCLUDE)/fifo.h \
+	$(INCLUDE)/circular_buffer.h \
+	$(INCLUDE)/uart_rx.h \
 	$(INCLUDE)/list.h \
 	$(DRIVERS)/axi_core/iio_axi_adc/iio_axi_adc.h \
 	$(DRIVERS)/axi_core/iio_axi_dac/iio_axi_dac.h
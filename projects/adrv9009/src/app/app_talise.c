@@ -46,6 +46,9 @@
 #include "error.h"
 #include "delay.h"
 #include "util.h"
+#if !defined(ALTERA_PLATFORM) && !defined(PLATFORM_MB)
+#include "xtime_l.h"
+#endif
 
 // talise
 #include "talise.h"
@@ -84,6 +87,22 @@ bool adrv9009_check_sysref_rate(uint32_t lmfc, uint32_t sysref)
 	return mod <= div || mod >= sysref - div;
 }
 
+/**
+ * @brief Time in microseconds, 0 if the platform has no global timer.
+ */
+static uint64_t talise_time_us(void)
+{
+#if !defined(ALTERA_PLATFORM) && !defined(PLATFORM_MB)
+	XTime t;
+
+	XTime_GetTime(&t);
+
+	return t / (COUNTS_PER_SECOND / 1000000);
+#else
+	return 0;
+#endif
+}
+
 adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 {
 	uint32_t talAction = TALACT_NO_ACTION;
@@ -118,6 +137,9 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 
 	uint32_t api_vers[4];
 	uint8_t rev;
+	struct adi_hal *hal = (struct adi_hal *)pd->devHalInfo;
+	uint64_t init_start_us;
+	uint32_t init_frames, init_bytes;
 
 	/*******************************/
 	/**** Talise Initialization ***/
@@ -145,6 +167,10 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 	 * gain tables, and configures the JESD204b serializers/framers/deserializers
 	 * and deframers.
 	 */
+	init_start_us = talise_time_us();
+	init_frames = hal->spi_frames;
+	init_bytes = hal->spi_bytes;
+
 	talAction = TALISE_initialize(pd, pi);
 	if (talAction != TALACT_NO_ACTION) {
 		/*** < User: decide what to do based on Talise recovery action returned > ***/
@@ -230,6 +256,11 @@ adiHalErr_t talise_setup(taliseDevice_t * const pd, taliseInit_t * const pi)
 			goto error_11;
 		}
 
+		printf("talise: initialize to ARM ready in %lu ms, %lu SPI frames, %lu bytes\n",
+		       (unsigned long)((talise_time_us() - init_start_us) / 1000),
+		       (unsigned long)(hal->spi_frames - init_frames),
+		       (unsigned long)(hal->spi_bytes - init_bytes));
+
 	} else {
 		/*< user code- check settings for proper CLKPLL lock  > ***/
 		printf("error: CLKPLL not locked\n");
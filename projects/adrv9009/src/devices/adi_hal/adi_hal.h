@@ -26,6 +26,12 @@ struct adi_hal {
 	uint8_t			spi_adrv_csn;
 	void 			*extra_gpio;
 	uint8_t			gpio_adrv_resetb_num;
+	/* SPI streaming state, tracked from the SPI_INTERFACE_CONFIG writes */
+	int8_t			spi_addr_step;
+	uint8_t			spi_streaming;
+	/* Number of SPI frames (chip select assertions) and bytes */
+	uint32_t		spi_frames;
+	uint32_t		spi_bytes;
 };
 
 /**
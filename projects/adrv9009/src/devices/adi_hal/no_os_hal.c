@@ -41,6 +41,8 @@
 /***************************** Include Files **********************************/
 /******************************************************************************/
 #include <stdio.h>
+#include <stdbool.h>
+#include <string.h>
 #include "adi_hal.h"
 #include "parameters.h"
 #include "spi.h"
@@ -50,6 +52,27 @@
 #include "error.h"
 #include "delay.h"
 
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+#define ADIHAL_SPI_CONFIG_A		0x0000
+#define ADIHAL_SPI_CONFIG_A_SOFT_RESET	0x81
+#define ADIHAL_SPI_CONFIG_A_ADDR_ASC	0x20
+#define ADIHAL_SPI_CONFIG_B		0x0001
+#define ADIHAL_SPI_CONFIG_B_SINGLE_INS	0x80
+
+/* Size of the SPI frames of one spi_transfer() batch */
+#define ADIHAL_SPI_BATCH_BYTES		1024
+/* Number of SPI frames of one spi_transfer() batch */
+#define ADIHAL_SPI_BATCH_FRAMES		64
+
+/******************************************************************************/
+/************************ Variables Definitions *******************************/
+/******************************************************************************/
+/* HAL calls never nest, the batch is shared by all the devices */
+static uint8_t adi_hal_spi_buff[ADIHAL_SPI_BATCH_BYTES];
+static struct spi_msg adi_hal_spi_msgs[ADIHAL_SPI_BATCH_FRAMES];
+
 /******************************************************************************/
 /************************** Functions Implementation **************************/
 /******************************************************************************/
@@ -101,6 +124,11 @@ adiHalErr_t ADIHAL_openHw(void *devHalInfo, uint32_t halTimeout_ms)
 
 	status |= spi_init(&dev_hal_data->spi_adrv_desc, &spi_param);
 
+	dev_hal_data->spi_addr_step = -1;
+	dev_hal_data->spi_streaming = 0;
+	dev_hal_data->spi_frames = 0;
+	dev_hal_data->spi_bytes = 0;
+
 	status |= gpio_get(&dev_hal_data->gpio_adrv_sysref_req,
 			   &gpio_adrv_sysref_req_param);
 
@@ -138,6 +166,10 @@ adiHalErr_t ADIHAL_resetHw(void *devHalInfo)
 	gpio_direction_output(devHalData->gpio_adrv_resetb, 1);
 	mdelay(10);
 
+	/* Back to the default descending, single instruction mode. */
+	devHalData->spi_addr_step = -1;
+	devHalData->spi_streaming = 0;
+
 	return ADIHAL_OK;
 }
 
@@ -160,73 +192,182 @@ adiHalErr_t ADIHAL_sysrefReq(void *devHalInfo, sysrefReqMode_t mode)
 
 }
 
-adiHalErr_t ADIHAL_spiWriteByte(void *devHalInfo,
-				uint16_t addr, uint8_t data)
+/**
+ * @brief Keep track of the address step and streaming mode of the device.
+ * @param hal - The HAL descriptor.
+ * @param addr - The written register.
+ * @param data - The written value.
+ */
+static void adi_hal_spi_track(struct adi_hal *hal, uint16_t addr, uint8_t data)
 {
-	struct adi_hal *devHalData = (struct adi_hal *)devHalInfo;
-	uint8_t buf[3];
+	if (addr == ADIHAL_SPI_CONFIG_A) {
+		if ((data & ADIHAL_SPI_CONFIG_A_SOFT_RESET) ||
+		    !(data & ADIHAL_SPI_CONFIG_A_ADDR_ASC))
+			hal->spi_addr_step = -1;
+		else
+			hal->spi_addr_step = 1;
+		if (data & ADIHAL_SPI_CONFIG_A_SOFT_RESET)
+			hal->spi_streaming = 0;
+	} else if (addr == ADIHAL_SPI_CONFIG_B) {
+		hal->spi_streaming = !(data & ADIHAL_SPI_CONFIG_B_SINGLE_INS);
+	}
+}
+
+/**
+ * @brief Number of accesses, starting with the first one, that can be done in
+ * 	  a single streamed SPI frame.
+ * @param hal - The HAL descriptor.
+ * @param addr - The register addresses.
+ * @param count - The number of accesses.
+ * @param max - The maximum number of accesses of the frame.
+ * @return The number of accesses of the frame, at least 1.
+ */
+static uint32_t adi_hal_spi_run(struct adi_hal *hal, const uint16_t *addr,
+				uint32_t count, uint32_t max)
+{
+	uint32_t n = 1;
+
+	if (!hal->spi_streaming)
+		return 1;
+
+	/* The SPI configuration registers are always written alone. */
+	while (n < count && n < max &&
+	       addr[n - 1] > ADIHAL_SPI_CONFIG_B &&
+	       addr[n] > ADIHAL_SPI_CONFIG_B &&
+	       addr[n] == (uint16_t)(addr[n - 1] + hal->spi_addr_step))
+		n++;
+
+	return n;
+}
+
+/**
+ * @brief Send the batched SPI frames in a single spi_transfer().
+ * @param hal - The HAL descriptor.
+ * @param no_msgs - The number of frames.
+ * @param bytes - The number of bytes of the frames.
+ * @param readdata - Where to store the read data, NULL for writes.
+ * @return ADIHAL_OK in case of success, ADIHAL_SPI_FAIL otherwise.
+ */
+static adiHalErr_t adi_hal_spi_flush(struct adi_hal *hal, uint32_t no_msgs,
+				     uint32_t bytes, uint8_t *readdata)
+{
+	struct spi_msg *msg;
 	int32_t status;
+	uint32_t i;
 
-	buf[0] = (addr >> 8) & 0x7F;
-	buf[1] = addr & 0xFF;
-	buf[2] = data;
-	status = spi_write_and_read(devHalData->spi_adrv_desc, buf, 3);
+	if (!no_msgs)
+		return ADIHAL_OK;
 
+	status = spi_transfer(hal->spi_adrv_desc, adi_hal_spi_msgs, no_msgs);
 	if (status != SUCCESS)
 		return ADIHAL_SPI_FAIL;
-	else
-		return ADIHAL_OK;
+
+	hal->spi_frames += no_msgs;
+	hal->spi_bytes += bytes;
+
+	if (readdata)
+		for (i = 0; i < no_msgs; i++) {
+			msg = &adi_hal_spi_msgs[i];
+			memcpy(readdata, &msg->rx_buff[2], msg->bytes_number - 2);
+			readdata += msg->bytes_number - 2;
+		}
+
+	return ADIHAL_OK;
 }
 
-adiHalErr_t ADIHAL_spiWriteBytes(void *devHalInfo,
-				 uint16_t *addr, uint8_t *data, uint32_t count)
+/**
+ * @brief Write or read a list of registers.
+ *
+ * Runs of consecutive addresses, in the direction set in SPI_INTERFACE_CONFIG_A,
+ * are coalesced in a single streamed frame when SPI streaming is enabled.
+ * The frames are sent in batches of a single spi_transfer().
+ * @param hal - The HAL descriptor.
+ * @param addr - The register addresses.
+ * @param data - The data to write or the read data.
+ * @param count - The number of registers.
+ * @param read - Read the registers if set, write them otherwise.
+ * @return ADIHAL_OK in case of success, ADIHAL_SPI_FAIL otherwise.
+ */
+static adiHalErr_t adi_hal_spi_xfer(struct adi_hal *hal, const uint16_t *addr,
+				    uint8_t *data, uint32_t count, bool read)
 {
+	struct spi_msg *msg;
 	adiHalErr_t errVal;
-	uint32_t i;
-
-	for (i = 0; i < count; i++) {
-		errVal = ADIHAL_spiWriteByte(devHalInfo, addr[i], data[i]);
-		if (errVal)
-			return errVal;
+	uint32_t no_msgs = 0;
+	uint32_t bytes = 0;
+	uint32_t first = 0;
+	uint32_t i, j, n;
+	uint8_t *buf;
+
+	i = 0;
+	while (i < count) {
+		/* Flush when the next frame might not fit. */
+		if (no_msgs == ADIHAL_SPI_BATCH_FRAMES ||
+		    bytes + 3 > ADIHAL_SPI_BATCH_BYTES) {
+			errVal = adi_hal_spi_flush(hal, no_msgs, bytes,
+						   read ? &data[first] : NULL);
+			if (errVal != ADIHAL_OK)
+				return errVal;
+			first = i;
+			no_msgs = 0;
+			bytes = 0;
+		}
+
+		n = adi_hal_spi_run(hal, &addr[i], count - i,
+				    ADIHAL_SPI_BATCH_BYTES - bytes - 2);
+
+		buf = &adi_hal_spi_buff[bytes];
+		buf[0] = (read ? 0x80 : 0x00) | ((addr[i] >> 8) & 0x7F);
+		buf[1] = addr[i] & 0xFF;
+		if (read) {
+			memset(&buf[2], 0, n);
+		} else {
+			memcpy(&buf[2], &data[i], n);
+			for (j = i; j < i + n; j++)
+				adi_hal_spi_track(hal, addr[j], data[j]);
+		}
+
+		msg = &adi_hal_spi_msgs[no_msgs++];
+		msg->tx_buff = buf;
+		msg->rx_buff = buf;
+		msg->bytes_number = n + 2;
+		msg->cs_change = 1;
+
+		bytes += n + 2;
+		i += n;
 	}
 
-	return ADIHAL_OK;
+	return adi_hal_spi_flush(hal, no_msgs, bytes, read ? &data[first] : NULL);
 }
 
-adiHalErr_t ADIHAL_spiReadByte(void *devHalInfo,
-			       uint16_t addr, uint8_t *readdata)
+adiHalErr_t ADIHAL_spiWriteByte(void *devHalInfo,
+				uint16_t addr, uint8_t data)
 {
-	struct adi_hal *devHalData = (struct adi_hal *)devHalInfo;
+	return adi_hal_spi_xfer((struct adi_hal *)devHalInfo, &addr, &data, 1,
+				false);
+}
 
-	uint8_t buf[3];
-	int32_t status;
+adiHalErr_t ADIHAL_spiWriteBytes(void *devHalInfo,
+				 uint16_t *addr, uint8_t *data, uint32_t count)
+{
+	return adi_hal_spi_xfer((struct adi_hal *)devHalInfo, addr, data, count,
+				false);
+}
 
+adiHalErr_t ADIHAL_spiReadByte(void *devHalInfo,
+			       uint16_t addr, uint8_t *readdata)
+{
 	*readdata = 0;
-	buf[0] = 0x80 | ((addr >> 8) & 0x7F);
-	buf[1] = addr & 0xFF;
-	buf[2] = 0x00;
-	status = spi_write_and_read(devHalData->spi_adrv_desc, buf, 3);
-	*readdata = buf[2];
 
-	if (status != SUCCESS)
-		return ADIHAL_SPI_FAIL;
-	else
-		return ADIHAL_OK;
+	return adi_hal_spi_xfer((struct adi_hal *)devHalInfo, &addr, readdata, 1,
+				true);
 }
 
 adiHalErr_t ADIHAL_spiReadBytes(void *devHalInfo,
 				uint16_t *addr, uint8_t *readdata, uint32_t count)
 {
-	adiHalErr_t errVal;
-	uint32_t i;
-
-	for (i = 0; i < count; i++) {
-		errVal = ADIHAL_spiReadByte(devHalInfo, addr[i], &readdata[i]);
-		if (errVal)
-			return errVal;
-	}
-
-	return ADIHAL_OK;
+	return adi_hal_spi_xfer((struct adi_hal *)devHalInfo, addr, readdata,
+				count, true);
 }
 
 adiHalErr_t ADIHAL_spiWriteField(void *devHalInfo,
@@ -27,6 +27,7 @@ SRC_DIRS += $(INCLUDE)
 SRCS +=	$(DRIVERS)/irq/irq.c						\
 	$(DRIVERS)/gpio/gpio.c						\
 	$(NO-OS)/util/list.c						\
-	$(NO-OS)/util/fifo.c						\
+	$(NO-OS)/util/circular_buffer.c					\
+	$(NO-OS)/util/uart_rx.c						\
 	$(NO-OS)/util/util.c						\
 	$(DRIVERS)/spi/spi.c
@@ -3,7 +3,8 @@ SRC_DIRS += $(PROJECT)/src/app
 SRC_DIRS += $(NO-OS)/iio/iio_app
 
 SRCS +=	$(NO-OS)/util/list.c					\
-	$(NO-OS)/util/fifo.c						\
+	$(NO-OS)/util/circular_buffer.c					\
+	$(NO-OS)/util/uart_rx.c						\
 	$(NO-OS)/util/util.c
 
 #drivers
@@ -13,7 +14,8 @@ SRCS += $(DRIVERS)/adc/adc_demo/adc_demo.c				\
 	$(DRIVERS)/dac/dac_demo/dac_demo.c                              \
 	$(DRIVERS)/irq/irq.c
 
-INCS += $(INCLUDE)/fifo.h					\
+INCS += $(INCLUDE)/circular_buffer.h				\
+	$(INCLUDE)/uart_rx.h					\
 	$(INCLUDE)/uart.h						\
 	$(INCLUDE)/list.h						\
 	$(INCLUDE)/util.h						\
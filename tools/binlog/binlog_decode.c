@@ -0,0 +1,408 @@
+/***************************************************************************//**
+ *   @file   binlog_decode.c
+ *   @brief  Host decoder of the deferred binary log
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Formats the binary stream written by binlog_drain() with
+ * BINLOG_OUTPUT_BINARY, using the format strings of the ELF file of the
+ * application. Build on Linux with:
+ *
+ *	gcc -I../../include -o binlog_decode binlog_decode.c ../../util/binlog.c
+ *
+ * Usage:
+ *
+ *	binlog_decode [-t] [-m] <elf file> [<log file>]
+ *
+ * The log is read from stdin when no log file is given, for example
+ * directly from the serial port. %s arguments are looked up at their link
+ * address, so the application must not be position independent.
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <elf.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include "binlog.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define DECODE_LINE_SIZE	1024
+#define DECODE_MAX_SECTIONS	256
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct decode_section {
+	uint64_t	addr;
+	uint64_t	size;
+	const uint8_t	*data;
+};
+
+struct decode_elf {
+	uint8_t			*file;
+	long			file_size;
+	/* The binlog_fmt section */
+	struct decode_section	fmt;
+	/* Loaded sections, used to resolve %s arguments */
+	struct decode_section	sections[DECODE_MAX_SECTIONS];
+	uint32_t		nb_sections;
+	struct binlog_fmt_param	target;
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static uint32_t get_le32(const uint8_t *buff)
+{
+	return buff[0] | (buff[1] << 8) | (buff[2] << 16) |
+	       ((uint32_t)buff[3] << 24);
+}
+
+static uint64_t get_le64(const uint8_t *buff)
+{
+	return get_le32(buff) | ((uint64_t)get_le32(buff + 4) << 32);
+}
+
+static const char *decode_section_str(const struct decode_section *sec,
+				      uint64_t offset)
+{
+	if (offset >= sec->size ||
+	    !memchr(sec->data + offset, '\0', sec->size - offset))
+		return NULL;
+
+	return (const char *)sec->data + offset;
+}
+
+static const char *decode_str(void *ctx, uint64_t addr)
+{
+	struct decode_elf *elf = ctx;
+	const char *str;
+	uint32_t i;
+
+	for (i = 0; i < elf->nb_sections; i++) {
+		if (addr < elf->sections[i].addr ||
+		    addr >= elf->sections[i].addr + elf->sections[i].size)
+			continue;
+		str = decode_section_str(&elf->sections[i],
+					 addr - elf->sections[i].addr);
+		if (str)
+			return str;
+	}
+
+	return "<?>";
+}
+
+static int decode_add_section(struct decode_elf *elf, const char *name,
+			      uint32_t type, uint64_t flags, uint64_t addr,
+			      uint64_t offset, uint64_t size)
+{
+	struct decode_section *sec;
+
+	if (type == SHT_NOBITS || !(flags & SHF_ALLOC))
+		return 0;
+
+	if (offset > (uint64_t)elf->file_size ||
+	    size > (uint64_t)elf->file_size - offset)
+		return -1;
+
+	if (name && !strcmp(name, BINLOG_SECTION)) {
+		elf->fmt.addr = addr;
+		elf->fmt.size = size;
+		elf->fmt.data = elf->file + offset;
+	}
+
+	if (elf->nb_sections == DECODE_MAX_SECTIONS)
+		return 0;
+
+	sec = &elf->sections[elf->nb_sections++];
+	sec->addr = addr;
+	sec->size = size;
+	sec->data = elf->file + offset;
+
+	return 0;
+}
+
+static int decode_elf_load(struct decode_elf *elf, const char *path)
+{
+	const char *shstr = NULL;
+	uint64_t shstr_size = 0;
+	uint64_t shoff, i;
+	uint32_t shnum, shentsize, shstrndx;
+	uint32_t name, type;
+	uint64_t flags, addr, offset, size;
+	const uint8_t *sh;
+	int is64;
+	FILE *fp;
+
+	fp = fopen(path, "rb");
+	if (!fp)
+		return -1;
+	fseek(fp, 0, SEEK_END);
+	elf->file_size = ftell(fp);
+	fseek(fp, 0, SEEK_SET);
+	elf->file = malloc(elf->file_size > 0 ? elf->file_size : 1);
+	if (!elf->file || elf->file_size < EI_NIDENT ||
+	    fread(elf->file, 1, elf->file_size, fp) != (size_t)elf->file_size) {
+		fclose(fp);
+		return -1;
+	}
+	fclose(fp);
+
+	if (memcmp(elf->file, ELFMAG, SELFMAG) ||
+	    elf->file[EI_DATA] != ELFDATA2LSB) {
+		fprintf(stderr, "%s: not a little endian ELF file\n", path);
+		return -1;
+	}
+
+	is64 = elf->file[EI_CLASS] == ELFCLASS64;
+	if (is64) {
+		Elf64_Ehdr *ehdr = (Elf64_Ehdr *)elf->file;
+
+		shoff = ehdr->e_shoff;
+		shnum = ehdr->e_shnum;
+		shentsize = ehdr->e_shentsize;
+		shstrndx = ehdr->e_shstrndx;
+		elf->target.long_size = 8;
+		elf->target.ptr_size = 8;
+	} else {
+		Elf32_Ehdr *ehdr = (Elf32_Ehdr *)elf->file;
+
+		shoff = ehdr->e_shoff;
+		shnum = ehdr->e_shnum;
+		shentsize = ehdr->e_shentsize;
+		shstrndx = ehdr->e_shstrndx;
+		elf->target.long_size = 4;
+		elf->target.ptr_size = 4;
+	}
+	elf->target.str = decode_str;
+	elf->target.str_ctx = elf;
+
+	if (shoff > (uint64_t)elf->file_size ||
+	    (uint64_t)shnum * shentsize > (uint64_t)elf->file_size - shoff ||
+	    shentsize < (is64 ? sizeof(Elf64_Shdr) : sizeof(Elf32_Shdr)))
+		return -1;
+
+	/* Two passes: first the section names, then the sections */
+	for (i = 0; i < shnum; i++) {
+		if (shstr == NULL && i != shstrndx)
+			continue;
+		sh = elf->file + shoff + i * shentsize;
+		if (is64) {
+			const Elf64_Shdr *shdr = (const Elf64_Shdr *)sh;
+
+			name = shdr->sh_name;
+			type = shdr->sh_type;
+			flags = shdr->sh_flags;
+			addr = shdr->sh_addr;
+			offset = shdr->sh_offset;
+			size = shdr->sh_size;
+		} else {
+			const Elf32_Shdr *shdr = (const Elf32_Shdr *)sh;
+
+			name = shdr->sh_name;
+			type = shdr->sh_type;
+			flags = shdr->sh_flags;
+			addr = shdr->sh_addr;
+			offset = shdr->sh_offset;
+			size = shdr->sh_size;
+		}
+
+		if (shstr == NULL) {
+			if (offset > (uint64_t)elf->file_size ||
+			    size > (uint64_t)elf->file_size - offset)
+				return -1;
+			shstr = (const char *)elf->file + offset;
+			shstr_size = size;
+			i = -1;
+			continue;
+		}
+
+		if (decode_add_section(elf, name < shstr_size ? shstr + name :
+				       NULL, type, flags, addr, offset,
+				       size))
+			return -1;
+	}
+
+	if (!elf->fmt.data) {
+		fprintf(stderr, "%s: no %s section\n", path, BINLOG_SECTION);
+		return -1;
+	}
+
+	return 0;
+}
+
+static size_t decode_fill(FILE *fp, uint8_t *rec, size_t have, size_t need)
+{
+	size_t n;
+
+	while (have < need) {
+		n = fread(rec + have, 1, need - have, fp);
+		if (!n)
+			break;
+		have += n;
+	}
+
+	return have;
+}
+
+static int decode_record_valid(const struct decode_elf *elf,
+			       const uint8_t *rec)
+{
+	uint32_t fmt_id = get_le32(rec + 4);
+	uint32_t mod_id = get_le32(rec + 8);
+
+	if (rec[0] != BINLOG_SYNC || rec[1] > LOG_DEBUG ||
+	    rec[2] > BINLOG_MAX_ARGS || rec[3])
+		return 0;
+
+	if (fmt_id == BINLOG_ID_DROPPED)
+		return rec[2] == 1;
+
+	return decode_section_str(&elf->fmt, fmt_id) &&
+	       decode_section_str(&elf->fmt, mod_id);
+}
+
+static void usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s [-t] [-m] <elf file> [<log file>]\n"
+		"\t-t\tprint the timestamps\n"
+		"\t-m\tprint the module names\n", name);
+}
+
+int main(int argc, char **argv)
+{
+	uint8_t rec[BINLOG_HDR_SIZE + 8 * BINLOG_MAX_ARGS];
+	uint64_t args[BINLOG_MAX_ARGS];
+	char line[DECODE_LINE_SIZE];
+	struct decode_elf elf;
+	int timestamps = 0;
+	int modules = 0;
+	uint32_t fmt_id, i;
+	size_t have = 0;
+	size_t len;
+	FILE *fp = stdin;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "tmh")) != -1) {
+		switch (opt) {
+		case 't':
+			timestamps = 1;
+			break;
+		case 'm':
+			modules = 1;
+			break;
+		default:
+			usage(argv[0]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	if (optind >= argc || argc - optind > 2) {
+		usage(argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	memset(&elf, 0, sizeof(elf));
+	if (decode_elf_load(&elf, argv[optind])) {
+		fprintf(stderr, "%s: cannot load the ELF file\n", argv[optind]);
+		return EXIT_FAILURE;
+	}
+
+	if (argc - optind == 2) {
+		fp = fopen(argv[optind + 1], "rb");
+		if (!fp) {
+			perror(argv[optind + 1]);
+			return EXIT_FAILURE;
+		}
+	}
+
+	while (1) {
+		have = decode_fill(fp, rec, have, BINLOG_HDR_SIZE);
+		if (have < BINLOG_HDR_SIZE)
+			break;
+
+		/* Resynchronize on the next sync byte */
+		if (!decode_record_valid(&elf, rec)) {
+			memmove(rec, rec + 1, --have);
+			continue;
+		}
+
+		len = BINLOG_HDR_SIZE + 8 * rec[2];
+		have = decode_fill(fp, rec, have, len);
+		if (have < len)
+			break;
+
+		for (i = 0; i < rec[2]; i++)
+			args[i] = get_le64(rec + BINLOG_HDR_SIZE + 8 * i);
+
+		if (timestamps)
+			printf("[%10"PRIu32"] ", get_le32(rec + 12));
+		if (modules)
+			printf("%s: ", decode_section_str(&elf.fmt,
+							  get_le32(rec + 8)));
+
+		fmt_id = get_le32(rec + 4);
+		if (fmt_id == BINLOG_ID_DROPPED)
+			snprintf(line, sizeof(line),
+				 "binlog: %"PRIu64" messages dropped\n", args[0]);
+		else
+			binlog_format(line, sizeof(line),
+				      decode_section_str(&elf.fmt, fmt_id),
+				      args, rec[2], &elf.target);
+		fputs(line, stdout);
+		fflush(stdout);
+
+		have -= len;
+		memmove(rec, rec + len, have);
+	}
+
+	if (fp != stdin)
+		fclose(fp);
+	free(elf.file);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,407 @@
+/***************************************************************************//**
+ *   @file   cb_stress.c
+ *   @brief  Multithreaded stress test and throughput of the circular buffer
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Runs a producer thread writing through cb_write_peek()/cb_write_commit()
+ * against a consumer thread reading with cb_read(), as done by the drivers
+ * filling the buffer from an interrupt. The stream is a known pattern, so the
+ * consumer checks every byte, and the producer never overwrites unread data,
+ * so cb_read() must never return -EOVERRUN. Both power of two sizes (masked
+ * indexes) and other sizes (modulo indexes and wrapped counts) are tested.
+ * Build on Linux with:
+ *
+ *	gcc -O2 -pthread -I../../include -o cb_stress cb_stress.c \
+ *		../../util/circular_buffer.c
+ *
+ * Usage:
+ *
+ *	cb_stress [<MB per size> [<size> ...]]
+ *
+ * Each size is run twice: with random chunk sizes on both sides, then with
+ * the producer filling all the free space and the consumer reading half of
+ * the buffer at a time, which gives the throughput. The consumer only blocks
+ * in cb_read() when more than one CPU is online, otherwise it reads what
+ * cb_size() reports and yields, since a busy wait would hold the only CPU
+ * until the end of its time slice.
+ *
+ * The program exits with an error if any byte differs or any call fails.
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "circular_buffer.h"
+#include "error.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Pattern period, prime so that it never lines up with the buffer size */
+#define CB_STRESS_PATTERN	65521
+#define CB_STRESS_DEF_MB	16
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct cb_stress_run {
+	struct circular_buffer	*cb;
+	uint32_t		size;
+	/** Bytes to transfer */
+	uint64_t		total;
+	/** Random chunk sizes if set, bulk transfers otherwise */
+	bool			random;
+	/** Consumer may block in cb_read() */
+	bool			block;
+	/** Set by the side that fails, the other one stops */
+	atomic_bool		stop;
+	/** Number of times the producer found the buffer full */
+	uint64_t		full;
+	/** First error, 0 if none */
+	int32_t			err;
+	/** Stream position of the first wrong byte, valid if err is -EBADMSG */
+	uint64_t		bad_pos;
+};
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+
+static uint8_t pattern[CB_STRESS_PATTERN];
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t xorshift32(uint32_t *state)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return x;
+}
+
+/* Copy the stream bytes starting at position pos */
+static void pattern_fill(uint8_t *dst, uint64_t pos, uint32_t len)
+{
+	uint32_t off = pos % CB_STRESS_PATTERN;
+	uint32_t n;
+
+	while (len) {
+		n = CB_STRESS_PATTERN - off;
+		if (n > len)
+			n = len;
+		memcpy(dst, pattern + off, n);
+		dst += n;
+		len -= n;
+		off = 0;
+	}
+}
+
+/* Return the offset of the first byte differing from the stream, or len */
+static uint32_t pattern_check(const uint8_t *src, uint64_t pos, uint32_t len)
+{
+	uint32_t off = pos % CB_STRESS_PATTERN;
+	uint32_t done = 0;
+	uint32_t n;
+	uint32_t i;
+
+	while (done < len) {
+		n = CB_STRESS_PATTERN - off;
+		if (n > len - done)
+			n = len - done;
+		if (memcmp(src + done, pattern + off, n))
+			for (i = 0; i < n; i++)
+				if (src[done + i] != pattern[off + i])
+					return done + i;
+		done += n;
+		off = 0;
+	}
+
+	return len;
+}
+
+static void run_fail(struct cb_stress_run *run, int32_t err)
+{
+	if (!atomic_exchange(&run->stop, true))
+		run->err = err;
+}
+
+static void *producer(void *arg)
+{
+	struct cb_stress_run *run = arg;
+	struct cb_segment seg[2];
+	uint32_t rnd = 0x12345678 ^ run->size;
+	uint64_t pos = 0;
+	uint32_t avail;
+	uint32_t n;
+	int32_t ret;
+
+	while (pos < run->total && !atomic_load(&run->stop)) {
+		ret = cb_write_peek(run->cb, seg, &avail);
+		if (ret != SUCCESS) {
+			run_fail(run, ret);
+			break;
+		}
+		if (seg[0].size + seg[1].size != avail || avail > run->size) {
+			run_fail(run, -EFAULT);
+			break;
+		}
+		if (!avail) {
+			run->full++;
+			sched_yield();
+			continue;
+		}
+
+		n = avail;
+		if (run->random)
+			n = xorshift32(&rnd) % avail + 1;
+		if (n > run->total - pos)
+			n = run->total - pos;
+
+		if (n <= seg[0].size) {
+			pattern_fill(seg[0].buff, pos, n);
+		} else {
+			pattern_fill(seg[0].buff, pos, seg[0].size);
+			pattern_fill(seg[1].buff, pos + seg[0].size,
+				     n - seg[0].size);
+		}
+
+		ret = cb_write_commit(run->cb, n);
+		if (ret != SUCCESS) {
+			run_fail(run, ret);
+			break;
+		}
+		pos += n;
+	}
+
+	return NULL;
+}
+
+static void *consumer(void *arg)
+{
+	struct cb_stress_run *run = arg;
+	uint32_t max_chunk = run->random ? 2 * run->size : run->size / 2;
+	uint32_t rnd = 0x9abcdef0 ^ run->size;
+	uint64_t pos = 0;
+	uint32_t avail;
+	uint32_t bad;
+	uint8_t *buff;
+	uint32_t n;
+	int32_t ret;
+
+	if (!max_chunk)
+		max_chunk = 1;
+	buff = malloc(max_chunk);
+	if (!buff) {
+		run_fail(run, -ENOMEM);
+		return NULL;
+	}
+
+	while (pos < run->total && !atomic_load(&run->stop)) {
+		n = max_chunk;
+		if (run->random)
+			n = xorshift32(&rnd) % max_chunk + 1;
+		if (n > run->total - pos)
+			n = run->total - pos;
+
+		if (!run->block) {
+			ret = cb_size(run->cb, &avail);
+			if (ret != SUCCESS) {
+				run_fail(run, ret);
+				break;
+			}
+			if (!avail) {
+				sched_yield();
+				continue;
+			}
+			if (n > avail)
+				n = avail;
+		}
+
+		ret = cb_read(run->cb, buff, n);
+		if (ret != SUCCESS) {
+			run_fail(run, ret);
+			break;
+		}
+
+		bad = pattern_check(buff, pos, n);
+		if (bad != n) {
+			run->bad_pos = pos + bad;
+			run_fail(run, -EBADMSG);
+			break;
+		}
+		pos += n;
+	}
+
+	free(buff);
+
+	return NULL;
+}
+
+/* Run one transfer, return the throughput in MB/s or a negative value */
+static double run_one(uint32_t size, uint64_t total, bool random, bool block,
+		      uint64_t *full)
+{
+	struct cb_stress_run run = {
+		.size = size,
+		.total = total,
+		.random = random,
+		.block = block,
+	};
+	pthread_t prod;
+	pthread_t cons;
+	double start;
+	double t;
+	int32_t ret;
+
+	atomic_init(&run.stop, false);
+	ret = cb_init(&run.cb, size);
+	if (ret != SUCCESS) {
+		fprintf(stderr, "size %" PRIu32 ": cb_init failed (%" PRId32
+			")\n", size, ret);
+		return -1;
+	}
+
+	start = now_s();
+	if (pthread_create(&cons, NULL, consumer, &run)) {
+		cb_remove(run.cb);
+		return -1;
+	}
+	if (pthread_create(&prod, NULL, producer, &run)) {
+		run_fail(&run, -EAGAIN);
+		pthread_join(cons, NULL);
+		cb_remove(run.cb);
+		return -1;
+	}
+	pthread_join(prod, NULL);
+	pthread_join(cons, NULL);
+	t = now_s() - start;
+
+	cb_remove(run.cb);
+
+	if (run.err == -EBADMSG) {
+		fprintf(stderr, "size %" PRIu32 " %s: wrong byte at stream "
+			"position %" PRIu64 "\n", size,
+			random ? "random" : "bulk", run.bad_pos);
+		return -1;
+	}
+	if (run.err) {
+		fprintf(stderr, "size %" PRIu32 " %s: error %" PRId32 "\n",
+			size, random ? "random" : "bulk", run.err);
+		return -1;
+	}
+
+	*full = run.full;
+
+	return total / t / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+	static const uint32_t def_sizes[] = {
+		16, 64, 4096, 65536, 3, 100, 4099, 65521
+	};
+	uint64_t total = CB_STRESS_DEF_MB;
+	bool block = sysconf(_SC_NPROCESSORS_ONLN) > 1;
+	uint64_t full_rnd;
+	uint64_t full_bulk;
+	uint32_t nb_sizes;
+	uint32_t size;
+	double rnd_mbs;
+	double bulk_mbs;
+	uint32_t i;
+	int ret = EXIT_SUCCESS;
+
+	if (argc > 1)
+		total = strtoull(argv[1], NULL, 0);
+	total *= 1000000;
+	nb_sizes = argc > 2 ? (uint32_t)argc - 2 :
+		   sizeof(def_sizes) / sizeof(def_sizes[0]);
+
+	for (i = 0; i < CB_STRESS_PATTERN; i++)
+		pattern[i] = (uint8_t)((i * 2654435761u) >> 24);
+
+	printf("consumer %s\n\n", block ? "blocks in cb_read()" :
+	       "polls cb_size(), single CPU");
+	printf("%8s %5s %12s %12s %12s %12s\n", "size", "pow2", "random MB/s",
+	       "full waits", "bulk MB/s", "full waits");
+	for (i = 0; i < nb_sizes; i++) {
+		size = argc > 2 ? strtoul(argv[i + 2], NULL, 0) : def_sizes[i];
+		rnd_mbs = run_one(size, total, true, block, &full_rnd);
+		bulk_mbs = rnd_mbs < 0 ? -1 :
+			   run_one(size, total, false, block, &full_bulk);
+		if (rnd_mbs < 0 || bulk_mbs < 0) {
+			ret = EXIT_FAILURE;
+			continue;
+		}
+		printf("%8" PRIu32 " %5s %12.1f %12" PRIu64 " %12.1f %12"
+		       PRIu64 "\n", size, (size & (size - 1)) ? "no" : "yes",
+		       rnd_mbs, full_rnd, bulk_mbs, full_bulk);
+	}
+
+	if (ret == EXIT_SUCCESS)
+		printf("\nall bytes received in order, no overrun\n");
+
+	return ret;
+}
@@ -0,0 +1,337 @@
+/***************************************************************************//**
+ *   @file   crc_bench.c
+ *   @brief  Equivalence check and throughput of the CRC helpers
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Checks that the table driven and slice-by-4 CRC functions of util/ return
+ * the same CRCs as the bit-serial loops the drivers used before, then
+ * prints the throughput of each implementation. The polynomials are the ones
+ * used by the drivers: CRC-8 0x07 (ad7124, ad77681, ad7779, adgs1408,
+ * adgs5412, ad7606 registers), CRC-16 0x755b (ad7606 data), CRC-16 0x1021
+ * and CRC-24 0x5d6dcb (adas1000). Build on Linux with:
+ *
+ *	gcc -O2 -I../../include -o crc_bench crc_bench.c ../../util/crc8.c \
+ *		../../util/crc16.c ../../util/crc24.c
+ *
+ * Usage:
+ *
+ *	crc_bench [<seconds per measurement>]
+ *
+ * The program exits with an error if any CRC differs.
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "crc8.h"
+#include "crc16.h"
+#include "crc24.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define CRC_BENCH_BUFF_SIZE	4096
+#define CRC_BENCH_CHECKS	100000
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* A CRC implementation, all of them take the initial CRC value */
+typedef uint32_t (*crc_fn)(const uint8_t *data, size_t len, uint32_t crc);
+
+struct crc_variant {
+	const char	*name;
+	/* CRC width in bits */
+	uint8_t		width;
+	uint32_t	poly;
+	/* Bit-serial reference, byte-wise table and slice-by-4 */
+	crc_fn		impl[3];
+};
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+
+static const char * const impl_names[] = {"bit-serial", "table", "slice-by-4"};
+
+static uint8_t crc8_07_table[CRC8_SLICE_SIZE][CRC8_TABLE_SIZE];
+static uint16_t crc16_755b_table[CRC16_SLICE_SIZE][CRC16_TABLE_SIZE];
+static uint16_t crc16_1021_table[CRC16_SLICE_SIZE][CRC16_TABLE_SIZE];
+static uint32_t crc24_table[CRC24_SLICE_SIZE][CRC24_TABLE_SIZE];
+
+/* Benchmark sink, so the CRCs are not optimized out */
+static volatile uint32_t crc_sink;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/* MSB first bit-serial CRC, as the drivers computed it */
+static uint32_t crc_bits(uint8_t width, uint32_t poly, const uint8_t *data,
+			 size_t len, uint32_t crc)
+{
+	uint32_t top = 1ul << (width - 1);
+	uint32_t mask = top | (top - 1);
+	uint8_t bit;
+
+	while (len--) {
+		for (bit = 0x80; bit; bit >>= 1) {
+			if (!(crc & top) != !(*data & bit))
+				crc = (crc << 1) ^ poly;
+			else
+				crc <<= 1;
+		}
+		data++;
+	}
+
+	return crc & mask;
+}
+
+static uint32_t crc8_07_bits(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc_bits(8, 0x07, data, len, crc);
+}
+
+static uint32_t crc8_07_byte(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc8(crc8_poly07_table[0], data, len, crc);
+}
+
+static uint32_t crc8_07_slice(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc8_slice(crc8_poly07_table, data, len, crc);
+}
+
+static uint32_t crc16_755b_bits(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc_bits(16, 0x755b, data, len, crc);
+}
+
+static uint32_t crc16_755b_byte(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc16(crc16_755b_table[0], data, len, crc);
+}
+
+static uint32_t crc16_755b_slice(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc16_slice((const uint16_t (*)[CRC16_TABLE_SIZE])crc16_755b_table,
+			   data, len, crc);
+}
+
+static uint32_t crc16_1021_bits(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc_bits(16, 0x1021, data, len, crc);
+}
+
+static uint32_t crc16_1021_byte(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc16(crc16_1021_table[0], data, len, crc);
+}
+
+static uint32_t crc16_1021_slice(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc16_slice((const uint16_t (*)[CRC16_TABLE_SIZE])crc16_1021_table,
+			   data, len, crc);
+}
+
+static uint32_t crc24_bits(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc_bits(24, 0x5d6dcb, data, len, crc);
+}
+
+static uint32_t crc24_byte(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc24(crc24_table[0], data, len, crc);
+}
+
+static uint32_t crc24_slice_fn(const uint8_t *data, size_t len, uint32_t crc)
+{
+	return crc24_slice((const uint32_t (*)[CRC24_TABLE_SIZE])crc24_table,
+			   data, len, crc);
+}
+
+static const struct crc_variant variants[] = {
+	{"CRC-8 0x07", 8, 0x07, {crc8_07_bits, crc8_07_byte, crc8_07_slice}},
+	{
+		"CRC-16 0x755b", 16, 0x755b,
+		{crc16_755b_bits, crc16_755b_byte, crc16_755b_slice}
+	},
+	{
+		"CRC-16 0x1021", 16, 0x1021,
+		{crc16_1021_bits, crc16_1021_byte, crc16_1021_slice}
+	},
+	{"CRC-24 0x5d6dcb", 24, 0x5d6dcb, {crc24_bits, crc24_byte, crc24_slice_fn}},
+};
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* The const CRC-8 tables must be the ones built at run time */
+static int check_const_tables(void)
+{
+	if (memcmp(crc8_07_table, crc8_poly07_table, sizeof(crc8_07_table))) {
+		printf("crc8_poly07_table differs from crc8_populate_msb_slice()\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/*
+ * Compare all implementations on random data, with random lengths, initial
+ * values and alignments, so the unaligned head and the tail of the slice
+ * loops are covered.
+ */
+static int check_variant(const struct crc_variant *v, uint8_t *buff)
+{
+	uint32_t mask = (v->width == 32) ? 0xffffffff : (1ul << v->width) - 1;
+	uint32_t expected;
+	uint32_t crc;
+	uint32_t init;
+	size_t offset;
+	size_t len;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < CRC_BENCH_CHECKS; i++) {
+		offset = rand() % 4;
+		len = (i % 4) ? rand() % 16 : rand() % (CRC_BENCH_BUFF_SIZE - 4);
+		init = rand() & mask;
+		expected = v->impl[0](buff + offset, len, init);
+		for (j = 1; j < 3; j++) {
+			crc = v->impl[j](buff + offset, len, init);
+			if (crc != expected) {
+				printf("%s: %s returns 0x%"PRIx32" instead of 0x%"
+				       PRIx32" for %zu bytes at offset %zu, "
+				       "initial value 0x%"PRIx32"\n", v->name,
+				       impl_names[j], crc, expected, len, offset,
+				       init);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/* Throughput of an implementation in MB/s, on buffers of len bytes */
+static double measure(crc_fn fn, const uint8_t *buff, size_t len,
+		      double seconds)
+{
+	uint64_t bytes = 0;
+	uint32_t crc = 0;
+	uint32_t i;
+	double start;
+	double t;
+
+	start = now_s();
+	do {
+		for (i = 0; i < 1024; i++) {
+			crc = fn(buff, len, crc);
+			bytes += len;
+		}
+		t = now_s() - start;
+	} while (t < seconds);
+	crc_sink = crc;
+
+	return bytes / t / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+	static const size_t lens[] = {3, 64, CRC_BENCH_BUFF_SIZE};
+	double seconds = argc > 1 ? strtod(argv[1], NULL) : 0.2;
+	uint8_t *buff;
+	uint32_t i;
+	uint32_t j;
+	uint32_t k;
+	int ret = EXIT_SUCCESS;
+
+	buff = malloc(CRC_BENCH_BUFF_SIZE);
+	if (!buff)
+		return EXIT_FAILURE;
+
+	srand(1);
+	for (i = 0; i < CRC_BENCH_BUFF_SIZE; i++)
+		buff[i] = rand();
+
+	crc8_populate_msb_slice(crc8_07_table, 0x07);
+	crc16_populate_msb_slice(crc16_755b_table, 0x755b);
+	crc16_populate_msb_slice(crc16_1021_table, 0x1021);
+	crc24_populate_msb_slice(crc24_table, 0x5d6dcb);
+
+	if (check_const_tables())
+		ret = EXIT_FAILURE;
+	for (i = 0; i < sizeof(variants) / sizeof(variants[0]); i++)
+		if (check_variant(&variants[i], buff))
+			ret = EXIT_FAILURE;
+	if (ret != EXIT_SUCCESS) {
+		free(buff);
+		return ret;
+	}
+	printf("all implementations return the same CRCs\n\n");
+
+	printf("%-16s %6s %12s %12s %12s  (MB/s)\n", "", "bytes",
+	       impl_names[0], impl_names[1], impl_names[2]);
+	for (i = 0; i < sizeof(variants) / sizeof(variants[0]); i++)
+		for (j = 0; j < sizeof(lens) / sizeof(lens[0]); j++) {
+			printf("%-16s %6zu", variants[i].name, lens[j]);
+			for (k = 0; k < 3; k++)
+				printf(" %12.1f", measure(variants[i].impl[k],
+							  buff, lens[j],
+							  seconds));
+			printf("\n");
+		}
+
+	free(buff);
+
+	return ret;
+}
@@ -0,0 +1,388 @@
+/***************************************************************************//**
+ *   @file   fatfs_bench.c
+ *   @brief  Capture to file throughput of FatFs on the RAM and file disks
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Formats drive 1: (RAM disk) and drive 3: (file disk) with several cluster
+ * sizes, then writes a capture file with the write patterns of the data
+ * loggers: small odd-sized records, sectors, 4 KB and 64 KB blocks, 4 KB
+ * blocks with an f_sync() every 64 KB, and 4 KB blocks into a preallocated
+ * file. Each capture is read back and checked. The disk accesses of FatFs
+ * are counted by wrapping disk_read(), disk_write() and disk_ioctl(), which
+ * shows the sectors written per payload sector (FAT and directory updates,
+ * partial sectors) next to the MB/s. Build on Linux with:
+ *
+ *	gcc -O2 -DLINUX_PLATFORM -DFF_USE_MKFS=1 -DFF_VOLUMES=4 \
+ *		-I../../include -I../../drivers/sd-card \
+ *		-I../../libraries/fatfs -I../../libraries/fatfs/source \
+ *		-Wl,--wrap=disk_read,--wrap=disk_write,--wrap=disk_ioctl \
+ *		-o fatfs_bench fatfs_bench.c ../../libraries/fatfs/adi_diskio.c \
+ *		../../libraries/fatfs/source/ff.c \
+ *		../../libraries/fatfs/source/ffsystem.c \
+ *		../../libraries/fatfs/source/ffunicode.c
+ *
+ * Usage:
+ *
+ *	fatfs_bench <image file> [<MB per capture>]
+ *
+ * The image file is created or truncated and used as drive 3:. The MB/s of
+ * drive 3: include the host page cache, and its f_sync() calls fsync().
+ * The program exits with an error if a FatFs call fails or a capture reads
+ * back wrong.
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "ff.h"
+#include "diskio.h"
+#include "adi_diskio.h"
+#include "error.h"
+#include "sd.h"
+
+#if !FF_USE_MKFS || FF_VOLUMES < 4
+#error "Build with -DFF_USE_MKFS=1 -DFF_VOLUMES=4, see the build line above"
+#endif
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define FATFS_BENCH_CHUNK	65536
+#define FATFS_BENCH_SECTOR	512
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+struct bench_pattern {
+	const char	*name;
+	/** Size of each f_write() */
+	uint32_t	record;
+	/** f_sync() after this many bytes, 0 for none */
+	uint32_t	sync_every;
+	/** Extend the file to its final size before writing */
+	bool		prealloc;
+};
+
+struct disk_stats {
+	uint64_t	reads;
+	uint64_t	read_sectors;
+	uint64_t	writes;
+	uint64_t	write_sectors;
+	uint64_t	syncs;
+};
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+
+/* Drive 0: is not used, adi_diskio.c still needs the SD card symbols */
+struct sd_desc *sd_desc;
+
+static struct disk_stats stats;
+
+static const struct bench_pattern patterns[] = {
+	{"100 B records", 100, 0, false},
+	{"512 B records", 512, 0, false},
+	{"4 KB blocks", 4096, 0, false},
+	{"64 KB blocks", 65536, 0, false},
+	{"4 KB + sync", 4096, 65536, false},
+	{"4 KB prealloc", 4096, 0, true},
+};
+
+static const uint32_t cluster_sizes[] = {512, 4096, 32768};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+DRESULT __real_disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count);
+DRESULT __real_disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector,
+			  UINT count);
+DRESULT __real_disk_ioctl(BYTE pdrv, BYTE cmd, void *buff);
+
+DRESULT __wrap_disk_read(BYTE pdrv, BYTE *buff, LBA_t sector, UINT count)
+{
+	stats.reads++;
+	stats.read_sectors += count;
+
+	return __real_disk_read(pdrv, buff, sector, count);
+}
+
+DRESULT __wrap_disk_write(BYTE pdrv, const BYTE *buff, LBA_t sector,
+			  UINT count)
+{
+	stats.writes++;
+	stats.write_sectors += count;
+
+	return __real_disk_write(pdrv, buff, sector, count);
+}
+
+DRESULT __wrap_disk_ioctl(BYTE pdrv, BYTE cmd, void *buff)
+{
+	if (cmd == CTRL_SYNC)
+		stats.syncs++;
+
+	return __real_disk_ioctl(pdrv, cmd, buff);
+}
+
+int32_t sd_read_blocks(struct sd_desc *desc, uint8_t *data, uint32_t block,
+		       uint32_t count)
+{
+	return FAILURE;
+}
+
+int32_t sd_write_blocks(struct sd_desc *desc, const uint8_t *data,
+			uint32_t block, uint32_t count)
+{
+	return FAILURE;
+}
+
+int32_t sd_sync(struct sd_desc *desc)
+{
+	return FAILURE;
+}
+
+DWORD get_fattime(void)
+{
+	/* 2021-01-01 00:00:00 */
+	return (DWORD)(2021 - 1980) << 25 | 1 << 21 | 1 << 16;
+}
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Capture content, a 32-bit word per 4 bytes of the file */
+static void pattern_fill(uint8_t *buff, uint32_t pos, uint32_t len)
+{
+	uint32_t i;
+
+	for (i = 0; i < len; i++)
+		buff[i] = ((pos + i) >> 2) * 2654435761u >> (8 * ((pos + i) & 3));
+}
+
+static int check_capture(const char *path, uint32_t total)
+{
+	static uint8_t buff[FATFS_BENCH_CHUNK];
+	static uint8_t expected[FATFS_BENCH_CHUNK];
+	uint32_t pos;
+	UINT n;
+	FIL f;
+
+	if (f_open(&f, path, FA_READ) != FR_OK)
+		return -1;
+	if (f_size(&f) != total) {
+		f_close(&f);
+		return -1;
+	}
+
+	for (pos = 0; pos < total; pos += n) {
+		if (f_read(&f, buff, FATFS_BENCH_CHUNK, &n) != FR_OK || !n)
+			break;
+		pattern_fill(expected, pos, n);
+		if (memcmp(buff, expected, n))
+			break;
+	}
+	f_close(&f);
+
+	return pos == total ? 0 : -1;
+}
+
+static int run_capture(const char *drive, const struct bench_pattern *p,
+		       uint32_t total)
+{
+	static uint8_t buff[FATFS_BENCH_CHUNK];
+	struct disk_stats start_stats = stats;
+	struct disk_stats d;
+	uint32_t pos = 0;
+	uint32_t synced = 0;
+	uint32_t n;
+	char path[16];
+	double start;
+	double t;
+	FRESULT res;
+	UINT bw;
+	FIL f;
+
+	snprintf(path, sizeof(path), "%sCAP.BIN", drive);
+	start = now_s();
+
+	res = f_open(&f, path, FA_WRITE | FA_CREATE_ALWAYS);
+	if (res == FR_OK && p->prealloc) {
+		res = f_lseek(&f, total);
+		if (res == FR_OK && f_tell(&f) != total)
+			res = FR_DENIED;
+		if (res == FR_OK)
+			res = f_lseek(&f, 0);
+	}
+	while (res == FR_OK && pos < total) {
+		n = total - pos < p->record ? total - pos : p->record;
+		pattern_fill(buff, pos, n);
+		res = f_write(&f, buff, n, &bw);
+		if (res == FR_OK && bw != n)
+			res = FR_DENIED;
+		pos += n;
+		if (res == FR_OK && p->sync_every &&
+		    pos - synced >= p->sync_every) {
+			res = f_sync(&f);
+			synced = pos;
+		}
+	}
+	if (res == FR_OK)
+		res = f_close(&f);
+	t = now_s() - start;
+	d.read_sectors = stats.read_sectors - start_stats.read_sectors;
+	d.writes = stats.writes - start_stats.writes;
+	d.write_sectors = stats.write_sectors - start_stats.write_sectors;
+	d.syncs = stats.syncs - start_stats.syncs;
+
+	if (res != FR_OK) {
+		fprintf(stderr, "%s %s: FatFs error %d\n", drive, p->name, res);
+		return -1;
+	}
+	if (check_capture(path, total)) {
+		fprintf(stderr, "%s %s: wrong capture content\n", drive,
+			p->name);
+		return -1;
+	}
+
+	printf("  %-14s %10.1f %10.3f %10" PRIu64 " %10" PRIu64 " %8" PRIu64
+	       "\n", p->name, total / t / 1e6,
+	       (double)d.write_sectors * FATFS_BENCH_SECTOR / total, d.writes,
+	       d.read_sectors, d.syncs);
+
+	return f_unlink(path) == FR_OK ? 0 : -1;
+}
+
+static int run_drive(const char *drive, uint32_t total)
+{
+	static const char *const fs_names[] = {"", "FAT12", "FAT16", "FAT32"};
+	static BYTE work[FF_MAX_SS];
+	static FATFS fs;
+	MKFS_PARM opt = { FM_FAT | FM_FAT32 | FM_SFD, 1, 0, 0, 0 };
+	FRESULT res;
+	uint32_t i;
+	uint32_t j;
+
+	for (i = 0; i < sizeof(cluster_sizes) / sizeof(cluster_sizes[0]); i++) {
+		opt.au_size = cluster_sizes[i];
+		res = f_mkfs(drive, &opt, work, sizeof(work));
+		if (res == FR_OK)
+			res = f_mount(&fs, drive, 1);
+		if (res != FR_OK) {
+			fprintf(stderr, "%s: cannot format with %" PRIu32
+				" B clusters (%d)\n", drive, cluster_sizes[i],
+				res);
+			return -1;
+		}
+
+		printf("\ndrive %s, %s, %" PRIu32 " B clusters\n", drive,
+		       fs.fs_type < 4 ? fs_names[fs.fs_type] : "?",
+		       cluster_sizes[i]);
+		printf("  %-14s %10s %10s %10s %10s %8s\n", "pattern", "MB/s",
+		       "written/B", "writes", "rd sectors", "syncs");
+		for (j = 0; j < sizeof(patterns) / sizeof(patterns[0]); j++)
+			if (run_capture(drive, &patterns[j], total)) {
+				f_unmount(drive);
+				return -1;
+			}
+
+		f_unmount(drive);
+	}
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	double mb = argc > 2 ? strtod(argv[2], NULL) : 4;
+	uint32_t sectors;
+	uint32_t total;
+	int ret;
+
+	if (argc < 2 || mb <= 0) {
+		fprintf(stderr, "usage: %s <image file> [<MB per capture>]\n",
+			argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	total = (uint32_t)(mb * 1e6) / FATFS_BENCH_CHUNK * FATFS_BENCH_CHUNK;
+	if (!total)
+		total = FATFS_BENCH_CHUNK;
+	/* Room for the file system and 512 B clusters */
+	sectors = total / FATFS_BENCH_SECTOR * 5 / 4 + 8192;
+
+	printf("%.2f MB per capture, %" PRIu32 " sectors per drive\n",
+	       total / 1e6, sectors);
+	printf("written/B is bytes written to the disk per payload byte\n");
+
+	ret = ram_disk_init(NULL, sectors);
+	if (ret != SUCCESS) {
+		fprintf(stderr, "ram_disk_init failed (%d)\n", ret);
+		return EXIT_FAILURE;
+	}
+	ret = run_drive("1:", total);
+	ram_disk_remove();
+	if (ret)
+		return EXIT_FAILURE;
+
+	remove(argv[1]);
+	ret = file_disk_init(argv[1], sectors);
+	if (ret != SUCCESS) {
+		fprintf(stderr, "%s: file_disk_init failed (%d)\n", argv[1],
+			ret);
+		return EXIT_FAILURE;
+	}
+	ret = run_drive("3:", total);
+	file_disk_remove();
+
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,1111 @@
+/***************************************************************************//**
+ *   @file   iio_bench.c
+ *   @brief  Host benchmark of the IIO server over a loopback link
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Runs the IIO server of iio/iio.c and libtinyiiod on the host. The UART
+ * functions are implemented here as a loopback: requests are replayed from
+ * memory and the responses are copied into a small link buffer, as a socket
+ * or a UART driver would do. Build on Linux, with the libtinyiiod submodule
+ * checked out, with:
+ *
+ *	gcc -O2 -I../../include -I../../iio -I../../libraries/iio/libtinyiiod \
+ *		-o iio_bench iio_bench.c ../../iio/iio.c ../../util/list.c \
+ *		../../util/util.c ../../libraries/iio/libtinyiiod/tinyiiod.c \
+ *		../../libraries/iio/libtinyiiod/parser.c
+ *
+ * Usage:
+ *
+ *	iio_bench buffer [<bytes> [<count>]]
+ *		Reads count buffers of bytes bytes with READBUF and prints
+ *		the bytes per second sent to the link.
+ *	iio_bench trace [<trace file> [<count>]]
+ *		Replays an attribute polling trace until count commands were
+ *		executed and prints the time per command. The trace file has
+ *		one text command per line, as sent by the client, for the
+ *		device registered by the benchmark (device0, see bench_device).
+ *		Without a trace file, all attributes of the device are read
+ *		in turn, as a GUI refreshing its view does.
+ *	iio_bench binary [<count>]
+ *		Reads count attribute values of the same device with text
+ *		READ commands, then with batched binary IIO_BIN_OP_READ
+ *		requests, served through show and through read_raw. The
+ *		values are checked to be equal and the values per second of
+ *		each protocol are printed.
+ *	iio_bench clients [<bytes> [<count>]]
+ *		Two network clients are served: the first one reads count
+ *		buffers of bytes bytes with READBUF, the second one reads
+ *		attributes, one command at a time. Prints the buffer
+ *		throughput and the time the attribute reads waited for their
+ *		answer. The buffer data received by the first client is
+ *		checked. Needs a build with the network server:
+ *
+ *	gcc -O2 -DENABLE_IIO_NETWORK -DDISABLE_SECURE_SOCKET \
+ *		-I../../include -I../../iio -I../../network \
+ *		-I../../libraries/iio/libtinyiiod -o iio_bench iio_bench.c \
+ *		../../iio/iio.c ../../util/list.c ../../util/util.c \
+ *		../../libraries/iio/libtinyiiod/tinyiiod.c \
+ *		../../libraries/iio/libtinyiiod/parser.c
+ *
+ * To compare with an older implementation of the server, build a second
+ * binary with ../../iio/iio.c replaced by the iio.c of that revision, for
+ * example the one before the buffer data was sent without copying:
+ *
+ *	git show <revision>:iio/iio.c > /tmp/iio_old.c
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "error.h"
+#include "util.h"
+#include "uart.h"
+#include "iio.h"
+#ifdef ENABLE_IIO_NETWORK
+#include "tcp_socket.h"
+#endif
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define BENCH_LINK_SIZE		1460
+#define BENCH_CMD_SIZE		64
+#define BENCH_NAME_SIZE		32
+/* Attribute polling device, about the size of iio_ad9361 */
+#define BENCH_NB_CH		8
+#define BENCH_DEV_ATTRS		64
+#define BENCH_DEBUG_ATTRS	16
+#define BENCH_CH_ATTRS		24
+#define BENCH_NB_ATTRS		(BENCH_DEV_ATTRS + BENCH_DEBUG_ATTRS + \
+				 BENCH_NB_CH * BENCH_CH_ATTRS)
+/* Attributes read by a binary request, as many as fit in a request */
+#define BENCH_BIN_BATCH		63u
+/* Network clients of the clients benchmark */
+#define BENCH_NB_CLIENTS	2
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* Loopback link between the benchmark and the server */
+struct bench_link {
+	/* Requests, replayed from the start when all were read */
+	const uint8_t	*in;
+	uint32_t	in_len;
+	uint32_t	in_pos;
+	/* Responses are copied here, as into a socket send buffer */
+	uint8_t		out[BENCH_LINK_SIZE];
+	uint32_t	out_pos;
+	uint64_t	out_bytes;
+	/* If not NULL, the responses are also stored here */
+	uint8_t		*capture;
+	uint32_t	capture_size;
+	uint32_t	capture_len;
+};
+
+#ifdef ENABLE_IIO_NETWORK
+/* Emulated connection of a network client */
+struct bench_socket {
+	/* Requests not yet received by the server */
+	uint8_t		*in;
+	uint32_t	in_len;
+	uint32_t	in_pos;
+	/* Responses of the server */
+	uint8_t		*out;
+	uint32_t	out_size;
+	uint32_t	out_len;
+};
+#endif
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+
+static struct bench_link link;
+
+#ifdef ENABLE_IIO_NETWORK
+static struct bench_socket bench_sockets[BENCH_NB_CLIENTS];
+/* Number of clients accepted by the server */
+static uint32_t bench_accepted;
+#endif
+
+static struct scan_type bench_scan_type = {
+	.sign = 's',
+	.realbits = 16,
+	.storagebits = 16,
+	.shift = 0,
+	.is_big_endian = false
+};
+
+static struct iio_channel bench_channels[] = {
+	{
+		.ch_type = IIO_VOLTAGE,
+		.channel = 0,
+		.scan_index = 0,
+		.scan_type = &bench_scan_type,
+		.indexed = true,
+	},
+	{
+		.ch_type = IIO_VOLTAGE,
+		.channel = 1,
+		.scan_index = 1,
+		.scan_type = &bench_scan_type,
+		.indexed = true,
+	},
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+int32_t uart_read(struct uart_desc *desc, uint8_t *data, uint32_t bytes_number)
+{
+	uint32_t n;
+	uint32_t i;
+
+	for (i = 0; i < bytes_number; i += n) {
+		if (link.in_pos == link.in_len)
+			link.in_pos = 0;
+		n = min(bytes_number - i, link.in_len - link.in_pos);
+		memcpy(data + i, link.in + link.in_pos, n);
+		link.in_pos += n;
+	}
+
+	return bytes_number;
+}
+
+int32_t uart_write(struct uart_desc *desc, const uint8_t *data,
+		   uint32_t bytes_number)
+{
+	uint32_t n;
+	uint32_t i;
+
+	if (link.capture) {
+		n = min(bytes_number, link.capture_size - link.capture_len);
+		memcpy(link.capture + link.capture_len, data, n);
+		link.capture_len += n;
+	}
+
+	for (i = 0; i < bytes_number; i += n) {
+		if (link.out_pos == BENCH_LINK_SIZE)
+			link.out_pos = 0;
+		n = min(bytes_number - i, BENCH_LINK_SIZE - link.out_pos);
+		memcpy(link.out + link.out_pos, data + i, n);
+		link.out_pos += n;
+	}
+	link.out_bytes += bytes_number;
+
+	return bytes_number;
+}
+
+int32_t uart_remove(struct uart_desc *desc)
+{
+	return SUCCESS;
+}
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+#ifdef ENABLE_IIO_NETWORK
+/* The server socket is the NULL descriptor, the clients are bench_sockets */
+int32_t socket_init(struct tcp_socket_desc **desc,
+		    struct tcp_socket_init_param *param)
+{
+	*desc = NULL;
+
+	return SUCCESS;
+}
+
+int32_t socket_remove(struct tcp_socket_desc *desc)
+{
+	return SUCCESS;
+}
+
+int32_t socket_bind(struct tcp_socket_desc *desc, uint16_t port)
+{
+	return SUCCESS;
+}
+
+int32_t socket_listen(struct tcp_socket_desc *desc, uint32_t back_log)
+{
+	return SUCCESS;
+}
+
+int32_t socket_accept(struct tcp_socket_desc *desc,
+		      struct tcp_socket_desc **new_client)
+{
+	if (bench_accepted == BENCH_NB_CLIENTS)
+		return -EAGAIN;
+
+	*new_client = (struct tcp_socket_desc *)
+		      &bench_sockets[bench_accepted++];
+
+	return SUCCESS;
+}
+
+int32_t socket_recv(struct tcp_socket_desc *desc, void *data, uint32_t len)
+{
+	struct bench_socket *sock = (struct bench_socket *)desc;
+
+	len = min(len, sock->in_len - sock->in_pos);
+	if (!len)
+		return -EAGAIN;
+	memcpy(data, sock->in + sock->in_pos, len);
+	sock->in_pos += len;
+
+	return len;
+}
+
+int32_t socket_send(struct tcp_socket_desc *desc, const void *data,
+		    uint32_t len)
+{
+	struct bench_socket *sock = (struct bench_socket *)desc;
+
+	if (len > sock->out_size - sock->out_len)
+		return -ENOMEM;
+	memcpy(sock->out + sock->out_len, data, len);
+	sock->out_len += len;
+
+	return len;
+}
+
+static uint32_t bench_time_us(void)
+{
+	/* Wraps around, as a hardware counter */
+	return (uint32_t)(uint64_t)(now_s() * 1e6);
+}
+#endif
+
+/* Value of the attribute with id priv */
+static int32_t bench_attr_read(void *device, int32_t *val, int32_t *val2,
+			       const struct iio_ch_info *channel, intptr_t priv)
+{
+	*val = priv * 1000 + (channel ? channel->ch_num : 0);
+	*val2 = (priv * 7919) % 1000000;
+
+	return IIO_VAL_INT_PLUS_MICRO;
+}
+
+static ssize_t bench_attr_show(void *device, char *buf, size_t len,
+			       const struct iio_ch_info *channel, intptr_t priv)
+{
+	int32_t vals[2];
+	int32_t fmt;
+
+	fmt = bench_attr_read(device, &vals[0], &vals[1], channel, priv);
+
+	return iio_format_value(buf, len, fmt, 2, vals);
+}
+
+static ssize_t bench_attr_store(void *device, char *buf, size_t len,
+				const struct iio_ch_info *channel, intptr_t priv)
+{
+	return len;
+}
+
+/* Allocate an attributes array named like the attributes of a driver */
+static struct iio_attribute *bench_attrs(const char *prefix, uint32_t count)
+{
+	struct iio_attribute *attrs;
+	char *names;
+	uint32_t i;
+
+	attrs = calloc(count + 1, sizeof(*attrs));
+	names = calloc(count, BENCH_NAME_SIZE);
+	if (!attrs || !names) {
+		free(attrs);
+		free(names);
+		return NULL;
+	}
+
+	for (i = 0; i < count; i++) {
+		snprintf(names + i * BENCH_NAME_SIZE, BENCH_NAME_SIZE,
+			 "%s_attribute_%"PRIu32, prefix, i);
+		attrs[i].name = names + i * BENCH_NAME_SIZE;
+		attrs[i].priv = i;
+		attrs[i].show = bench_attr_show;
+		attrs[i].store = bench_attr_store;
+		attrs[i].read_raw = bench_attr_read;
+	}
+
+	return attrs;
+}
+
+static void bench_free_attrs(struct iio_attribute *attrs)
+{
+	if (attrs)
+		free((char *)attrs[0].name);
+	free(attrs);
+}
+
+static void bench_set_read_raw(struct iio_device *dev,
+			       int32_t (*read_raw)(void *, int32_t *,
+					       int32_t *,
+					       const struct iio_ch_info *,
+					       intptr_t))
+{
+	struct iio_attribute *attrs[BENCH_NB_CH + 2];
+	uint32_t i;
+
+	attrs[0] = dev->attributes;
+	attrs[1] = dev->debug_attributes;
+	for (i = 0; i < BENCH_NB_CH; i++)
+		attrs[i + 2] = dev->channels[i].attributes;
+
+	for (i = 0; i < BENCH_NB_CH + 2; i++)
+		for (; attrs[i]->name; attrs[i]++)
+			attrs[i]->read_raw = read_raw;
+}
+
+static void bench_free_device(struct iio_device *dev)
+{
+	uint32_t i;
+
+	bench_free_attrs(dev->attributes);
+	bench_free_attrs(dev->debug_attributes);
+	if (dev->channels)
+		for (i = 0; i < dev->num_ch; i++)
+			bench_free_attrs(dev->channels[i].attributes);
+	free(dev->channels);
+}
+
+/* Fill dev with the attribute polling device */
+static int32_t bench_device(struct iio_device *dev)
+{
+	uint32_t i;
+
+	memset(dev, 0, sizeof(*dev));
+	dev->num_ch = BENCH_NB_CH;
+	dev->channels = calloc(BENCH_NB_CH, sizeof(*dev->channels));
+	dev->attributes = bench_attrs("device", BENCH_DEV_ATTRS);
+	dev->debug_attributes = bench_attrs("debug", BENCH_DEBUG_ATTRS);
+	if (!dev->channels || !dev->attributes || !dev->debug_attributes)
+		goto error;
+
+	for (i = 0; i < BENCH_NB_CH; i++) {
+		dev->channels[i].ch_type = IIO_VOLTAGE;
+		dev->channels[i].channel = i;
+		dev->channels[i].scan_index = i;
+		dev->channels[i].scan_type = &bench_scan_type;
+		dev->channels[i].indexed = true;
+		dev->channels[i].attributes = bench_attrs("channel",
+					      BENCH_CH_ATTRS);
+		if (!dev->channels[i].attributes)
+			goto error;
+	}
+
+	return SUCCESS;
+
+error:
+	bench_free_device(dev);
+
+	return -ENOMEM;
+}
+
+/* Text commands reading all attributes of the polling device */
+static char *bench_polling_trace(void)
+{
+	char *trace;
+	char *p;
+	uint32_t ch;
+	uint32_t i;
+
+	trace = malloc(BENCH_NB_ATTRS * BENCH_CMD_SIZE + 1);
+	if (!trace)
+		return NULL;
+
+	p = trace;
+	for (i = 0; i < BENCH_DEV_ATTRS; i++)
+		p += sprintf(p, "READ device0 device_attribute_%"PRIu32"\n", i);
+	for (i = 0; i < BENCH_DEBUG_ATTRS; i++)
+		p += sprintf(p, "READ device0 DEBUG debug_attribute_%"PRIu32"\n",
+			     i);
+	for (ch = 0; ch < BENCH_NB_CH; ch++)
+		for (i = 0; i < BENCH_CH_ATTRS; i++)
+			p += sprintf(p, "READ device0 INPUT voltage%"PRIu32
+				     " channel_attribute_%"PRIu32"\n", ch, i);
+
+	return trace;
+}
+
+/* Load a trace file, NULL if it can't be read */
+static char *bench_load_trace(const char *path)
+{
+	char *trace;
+	FILE *f;
+	long len;
+
+	f = fopen(path, "rb");
+	if (!f)
+		return NULL;
+
+	trace = NULL;
+	if (!fseek(f, 0, SEEK_END) && (len = ftell(f)) > 0 &&
+	    !fseek(f, 0, SEEK_SET)) {
+		trace = malloc(len + 1);
+		if (trace && fread(trace, 1, len, f) != (size_t)len) {
+			free(trace);
+			trace = NULL;
+		} else if (trace) {
+			trace[len] = '\0';
+		}
+	}
+	fclose(f);
+
+	return trace;
+}
+
+/* Number of text commands of a trace */
+static uint32_t bench_nb_commands(const char *trace)
+{
+	uint32_t n = 0;
+
+	while ((trace = strchr(trace, '\n'))) {
+		trace++;
+		n++;
+	}
+
+	return n;
+}
+
+/* Number of failed commands in the captured text responses */
+static uint32_t bench_nb_errors(const uint8_t *out, uint32_t len)
+{
+	uint32_t errors = 0;
+	const char *p = (const char *)out;
+	const char *end = p + len;
+	long val;
+	char *next;
+
+	while (p < end) {
+		val = strtol(p, &next, 10);
+		if (next == p || next >= end)
+			break;
+		if (val < 0)
+			errors++;
+		/* Skip the line of the value, then the data */
+		p = next + 1 + (val > 0 ? val + 1 : 0);
+	}
+
+	return errors;
+}
+
+/* Binary IDs of all attributes of the polling device, in the order of the
+ * polling trace */
+static void bench_polling_ids(uint32_t *ids)
+{
+	uint32_t ch;
+	uint32_t i;
+
+	for (i = 0; i < BENCH_DEV_ATTRS; i++)
+		*ids++ = IIO_BIN_ATTR_ID(0, IIO_BIN_GROUP_DEVICE, i);
+	for (i = 0; i < BENCH_DEBUG_ATTRS; i++)
+		*ids++ = IIO_BIN_ATTR_ID(0, IIO_BIN_GROUP_DEBUG, i);
+	for (ch = 0; ch < BENCH_NB_CH; ch++)
+		for (i = 0; i < BENCH_CH_ATTRS; i++)
+			*ids++ = IIO_BIN_ATTR_ID(0, IIO_BIN_GROUP_CH(ch), i);
+}
+
+/* IIO_BIN_OP_READ requests of up to BENCH_BIN_BATCH attributes, reading
+ * all attributes of the polling device. Returns the number of requests. */
+static uint32_t bench_bin_requests(uint8_t *out, uint32_t *len)
+{
+	uint32_t ids[BENCH_NB_ATTRS];
+	uint32_t nb_reqs = 0;
+	uint32_t count;
+	uint32_t i;
+	uint32_t j;
+	uint8_t *p = out;
+
+	bench_polling_ids(ids);
+	for (i = 0; i < BENCH_NB_ATTRS; i += count, nb_reqs++) {
+		count = min(BENCH_NB_ATTRS - i, BENCH_BIN_BATCH);
+		*p++ = IIO_BIN_OP_READ;
+		*p++ = 0;
+		*p++ = count;
+		*p++ = count >> 8;
+		for (j = 0; j < count; j++) {
+			*p++ = ids[i + j];
+			*p++ = ids[i + j] >> 8;
+			*p++ = ids[i + j] >> 16;
+			*p++ = ids[i + j] >> 24;
+		}
+	}
+	*len = p - out;
+
+	return nb_reqs;
+}
+
+static int32_t bench_get_le32(const uint8_t *p)
+{
+	return (int32_t)(p[0] | (p[1] << 8) | (p[2] << 16) |
+			 ((uint32_t)p[3] << 24));
+}
+
+/* Parse the captured text responses, the values are stored in vals */
+static uint32_t bench_text_values(const uint8_t *out, uint32_t len,
+				  int32_t (*vals)[2])
+{
+	const char *p = (const char *)out;
+	const char *end = p + len;
+	uint32_t n = 0;
+	char *next;
+	long size;
+
+	while (p < end && n < BENCH_NB_ATTRS) {
+		size = strtol(p, &next, 10);
+		if (next == p || next >= end || size <= 0)
+			break;
+		p = next + 1;
+		vals[n][0] = strtol(p, &next, 10);
+		vals[n][1] = *next == '.' ? strtol(next + 1, NULL, 10) : 0;
+		n++;
+		p += size + 1;
+	}
+
+	return n;
+}
+
+/* Parse the captured binary responses, the values are stored in vals */
+static uint32_t bench_bin_values(const uint8_t *out, uint32_t len,
+				 int32_t (*vals)[2])
+{
+	const uint8_t *end = out + len;
+	uint32_t n = 0;
+	uint32_t count;
+	uint32_t i;
+
+	while (out + IIO_BIN_HEADER_SIZE <= end) {
+		count = out[2] | (out[3] << 8);
+		out += IIO_BIN_HEADER_SIZE;
+		for (i = 0; i < count && out + 12 <= end &&
+		     n < BENCH_NB_ATTRS; i++, out += 12) {
+			if (bench_get_le32(out) < 0)
+				return n;
+			vals[n][0] = bench_get_le32(out + 4);
+			vals[n][1] = bench_get_le32(out + 8);
+			n++;
+		}
+	}
+
+	return n;
+}
+
+/* The samples are in the buffer already, as after a DMA transfer */
+static int32_t bench_read_dev(void *dev, void *buff, uint32_t nb_samples)
+{
+	return SUCCESS;
+}
+
+/* Replay requests until count commands were executed */
+static int32_t bench_run(struct iio_desc *desc, const void *requests,
+			 uint32_t len, uint32_t count)
+{
+	int32_t ret;
+
+	link.in = requests;
+	link.in_len = len;
+	link.in_pos = 0;
+	while (count--) {
+		ret = iio_step(desc);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	return SUCCESS;
+}
+
+static int32_t bench_buffer(struct iio_desc *desc, uint32_t bytes,
+			    uint32_t count)
+{
+	/* Registered until iio_remove() */
+	static struct iio_device dev = {
+		.num_ch = 2,
+		.channels = bench_channels,
+		.read_dev = bench_read_dev,
+	};
+	struct iio_data_buffer read_buff;
+	char cmd[BENCH_CMD_SIZE];
+	uint64_t sent;
+	uint32_t i;
+	double t;
+	int32_t ret;
+
+	read_buff.size = bytes;
+	read_buff.buff = malloc(bytes);
+	if (!read_buff.buff)
+		return -ENOMEM;
+	for (i = 0; i < bytes; i++)
+		((uint8_t *)read_buff.buff)[i] = i;
+
+	ret = iio_register(desc, &dev, "bench", NULL, &read_buff, NULL);
+	if (IS_ERR_VALUE(ret))
+		goto out;
+
+	sprintf(cmd, "OPEN device0 %"PRIu32" 3\n", bytes / 4);
+	ret = bench_run(desc, cmd, strlen(cmd), 1);
+	if (IS_ERR_VALUE(ret))
+		goto out;
+
+	sprintf(cmd, "READBUF device0 %"PRIu32"\n", bytes);
+	sent = link.out_bytes;
+	t = now_s();
+	ret = bench_run(desc, cmd, strlen(cmd), count);
+	t = now_s() - t;
+	if (IS_ERR_VALUE(ret))
+		goto out;
+	sent = link.out_bytes - sent;
+
+	printf("buffer: %"PRIu32" x %"PRIu32" bytes, %.1f MB/s\n", count, bytes,
+	       sent / t / 1e6);
+out:
+	free(read_buff.buff);
+
+	return ret;
+}
+
+static int32_t bench_trace(struct iio_desc *desc, const char *path,
+			   uint32_t count)
+{
+	static uint8_t capture[0x40000];
+	/* Registered until iio_remove() */
+	static struct iio_device dev;
+	uint32_t nb_cmds;
+	uint32_t errors;
+	char *trace;
+	double t;
+	int32_t ret;
+
+	trace = path ? bench_load_trace(path) : bench_polling_trace();
+	if (!trace)
+		return path ? -ENOENT : -ENOMEM;
+
+	nb_cmds = bench_nb_commands(trace);
+	if (!nb_cmds) {
+		free(trace);
+		return -EINVAL;
+	}
+	if (!count)
+		count = nb_cmds * 1000;
+
+	ret = bench_device(&dev);
+	if (IS_ERR_VALUE(ret))
+		goto out;
+
+	ret = iio_register(desc, &dev, "bench", NULL, NULL, NULL);
+	if (IS_ERR_VALUE(ret)) {
+		bench_free_device(&dev);
+		goto out;
+	}
+
+	/* Check the trace on a first pass, it also warms up the caches */
+	link.capture = capture;
+	link.capture_size = sizeof(capture);
+	link.capture_len = 0;
+	ret = bench_run(desc, trace, strlen(trace), nb_cmds);
+	link.capture = NULL;
+	if (IS_ERR_VALUE(ret))
+		goto out;
+	errors = bench_nb_errors(capture, link.capture_len);
+	if (errors)
+		printf("trace: %"PRIu32" of %"PRIu32" commands failed\n",
+		       errors, nb_cmds);
+
+	t = now_s();
+	ret = bench_run(desc, trace, strlen(trace), count);
+	t = now_s() - t;
+	if (IS_ERR_VALUE(ret))
+		goto out;
+
+	printf("trace: %"PRIu32" commands, %.0f ns per command, %.0f commands/s\n",
+	       count, t * 1e9 / count, count / t);
+out:
+	free(trace);
+
+	return ret;
+}
+
+/* Time the reading of count values, the responses of a first pass of nb_reqs
+ * requests are captured */
+static double bench_values(struct iio_desc *desc, const void *requests,
+			   uint32_t len, uint32_t nb_reqs, uint32_t count,
+			   uint8_t *capture, uint32_t capture_size)
+{
+	double t;
+	int32_t ret;
+
+	link.capture = capture;
+	link.capture_size = capture_size;
+	link.capture_len = 0;
+	ret = bench_run(desc, requests, len, nb_reqs);
+	link.capture = NULL;
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	/* Whole passes over the attributes */
+	count = (count + BENCH_NB_ATTRS - 1) / BENCH_NB_ATTRS * nb_reqs;
+	t = now_s();
+	ret = bench_run(desc, requests, len, count);
+	t = now_s() - t;
+
+	return IS_ERR_VALUE(ret) ? ret : t;
+}
+
+static int32_t bench_binary(struct iio_desc *desc, uint32_t count)
+{
+	static uint8_t capture[0x40000];
+	static int32_t text_vals[BENCH_NB_ATTRS][2];
+	static int32_t bin_vals[BENCH_NB_ATTRS][2];
+	/* Registered until iio_remove() */
+	static struct iio_device dev;
+	uint8_t requests[BENCH_NB_ATTRS * IIO_BIN_READ_SIZE +
+			 (BENCH_NB_ATTRS / BENCH_BIN_BATCH + 1) *
+			 IIO_BIN_HEADER_SIZE];
+	const char *names[] = {"text", "binary show", "binary read_raw"};
+	double t[3];
+	uint32_t nb_reqs;
+	uint32_t len;
+	uint32_t i;
+	uint32_t j;
+	char *trace;
+	int32_t ret;
+
+	trace = bench_polling_trace();
+	if (!trace)
+		return -ENOMEM;
+
+	ret = bench_device(&dev);
+	if (IS_ERR_VALUE(ret))
+		goto out;
+
+	ret = iio_register(desc, &dev, "bench", NULL, NULL, NULL);
+	if (IS_ERR_VALUE(ret)) {
+		bench_free_device(&dev);
+		goto out;
+	}
+
+	count = count ? count : BENCH_NB_ATTRS * 1000;
+	nb_reqs = bench_bin_requests(requests, &len);
+
+	t[0] = bench_values(desc, trace, strlen(trace), BENCH_NB_ATTRS, count,
+			    capture, sizeof(capture));
+	if (t[0] < 0) {
+		ret = t[0];
+		goto out;
+	}
+	if (bench_text_values(capture, link.capture_len, text_vals) !=
+	    BENCH_NB_ATTRS) {
+		printf("binary: text responses are not valid\n");
+		ret = -EINVAL;
+		goto out;
+	}
+
+	for (i = 1; i < 3; i++) {
+		/* Without read_raw the value is converted from show */
+		if (i == 1)
+			bench_set_read_raw(&dev, NULL);
+		else
+			bench_set_read_raw(&dev, bench_attr_read);
+
+		t[i] = bench_values(desc, requests, len, nb_reqs, count,
+				    capture, sizeof(capture));
+		if (t[i] < 0) {
+			ret = t[i];
+			goto out;
+		}
+		if (bench_bin_values(capture, link.capture_len, bin_vals) !=
+		    BENCH_NB_ATTRS) {
+			printf("binary: %s responses are not valid\n",
+			       names[i]);
+			ret = -EINVAL;
+			goto out;
+		}
+		for (j = 0; j < BENCH_NB_ATTRS; j++)
+			if (bin_vals[j][0] != text_vals[j][0] ||
+			    bin_vals[j][1] != text_vals[j][1]) {
+				printf("binary: %s value %"PRIu32" differs\n",
+				       names[i], j);
+				ret = -EINVAL;
+				goto out;
+			}
+	}
+
+	count = (count + BENCH_NB_ATTRS - 1) / BENCH_NB_ATTRS * BENCH_NB_ATTRS;
+	for (i = 0; i < 3; i++)
+		printf("binary: %-15s %"PRIu32" values, %.0f values/s, x%.1f\n",
+		       names[i], count, count / t[i], t[0] / t[i]);
+out:
+	free(trace);
+
+	return ret;
+}
+
+#ifdef ENABLE_IIO_NETWORK
+/* Check the READBUF answers: count buffers of bytes bytes, in chunks, each
+ * buffer starting with the channel mask */
+static int32_t bench_check_buffers(const uint8_t *out, uint32_t len,
+				   uint32_t bytes, uint32_t count)
+{
+	const char *p = (const char *)out;
+	const char *end = p + len;
+	uint32_t offset;
+	uint32_t i;
+	char *next;
+	long n;
+
+	for (; count; count--) {
+		for (offset = 0; offset < bytes; offset += n) {
+			n = strtol(p, &next, 10);
+			if (next == p || next >= end || n <= 0 ||
+			    n > bytes - offset)
+				return -EINVAL;
+			p = next + 1;
+			if (!offset) {
+				p = strchr(p, '\n');
+				if (!p)
+					return -EINVAL;
+				p++;
+			}
+			if (p + n > end)
+				return -EINVAL;
+			for (i = 0; i < n; i++)
+				if ((uint8_t)p[i] != (uint8_t)(offset + i))
+					return -EINVAL;
+			p += n;
+		}
+	}
+
+	return p == end ? SUCCESS : -EINVAL;
+}
+
+static int32_t bench_clients(struct iio_desc *desc, uint32_t bytes,
+			     uint32_t count)
+{
+	/* Registered until iio_remove() */
+	static struct iio_device dev;
+	struct bench_socket *stream = &bench_sockets[0];
+	struct bench_socket *poll = &bench_sockets[1];
+	struct iio_net_client_stats stats[BENCH_NB_CLIENTS];
+	struct iio_data_buffer read_buff;
+	uint32_t nb_polls = 0;
+	uint32_t poll_len;
+	uint32_t out_len;
+	uint32_t idle;
+	uint32_t i;
+	double max_wait = 0;
+	double sum_wait = 0;
+	double sent;
+	double t;
+	char *trace;
+	char *cmd;
+	int32_t ret;
+
+	read_buff.size = bytes;
+	read_buff.buff = malloc(bytes);
+	trace = bench_polling_trace();
+	stream->in = malloc(BENCH_CMD_SIZE * (count + 1));
+	/* Answers: a line per chunk of at least 256 bytes, the mask */
+	stream->out_size = (bytes + bytes / 256 * 8 + 32) * count + 32;
+	stream->out = malloc(stream->out_size);
+	poll->out_size = 0x10000;
+	poll->out = malloc(poll->out_size);
+	if (!read_buff.buff || !trace || !stream->in || !stream->out ||
+	    !poll->out) {
+		ret = -ENOMEM;
+		goto out;
+	}
+	for (i = 0; i < bytes; i++)
+		((uint8_t *)read_buff.buff)[i] = i;
+
+	ret = bench_device(&dev);
+	if (IS_ERR_VALUE(ret))
+		goto out;
+	dev.read_dev = bench_read_dev;
+
+	ret = iio_register(desc, &dev, "bench", NULL, &read_buff, NULL);
+	if (IS_ERR_VALUE(ret)) {
+		bench_free_device(&dev);
+		goto out;
+	}
+
+	/* All buffer requests are sent at once, the answer of OPEN is 0 */
+	cmd = (char *)stream->in;
+	cmd += sprintf(cmd, "OPEN device0 %"PRIu32" 3\n", bytes / 4);
+	for (i = 0; i < count; i++)
+		cmd += sprintf(cmd, "READBUF device0 %"PRIu32"\n", bytes);
+	stream->in_len = cmd - (char *)stream->in;
+
+	/* The attribute reads are sent one at a time, from the trace */
+	cmd = trace;
+	poll->in = (uint8_t *)cmd;
+	poll->in_len = strchr(cmd, '\n') + 1 - cmd;
+	t = now_s();
+	sent = t;
+	/* Done when the first client is not served for two rounds */
+	for (idle = 0; idle < 2 * BENCH_NB_CLIENTS;) {
+		out_len = stream->out_len;
+		poll_len = poll->out_len;
+		ret = iio_step(desc);
+		if (IS_ERR_VALUE(ret))
+			goto out;
+		if (stream->out_len != out_len ||
+		    stream->in_pos != stream->in_len)
+			idle = 0;
+		else
+			idle++;
+		if (poll->out_len == poll_len)
+			continue;
+
+		/* Answered, send the next attribute read */
+		max_wait = max(max_wait, now_s() - sent);
+		sum_wait += now_s() - sent;
+		nb_polls++;
+		poll->out_len = 0;
+		cmd = strchr(cmd, '\n') + 1;
+		if (!*cmd)
+			cmd = trace;
+		poll->in = (uint8_t *)cmd;
+		poll->in_len = strchr(cmd, '\n') + 1 - cmd;
+		poll->in_pos = 0;
+		sent = now_s();
+	}
+	t = now_s() - t;
+
+	ret = bench_check_buffers(stream->out + 2, stream->out_len - 2, bytes,
+				  count);
+	if (IS_ERR_VALUE(ret)) {
+		printf("clients: buffer data is not valid\n");
+		goto out;
+	}
+	for (i = 0; i < BENCH_NB_CLIENTS; i++)
+		iio_get_net_client_stats(desc, i, &stats[i]);
+
+	printf("clients: %"PRIu32" x %"PRIu32" bytes, %.1f MB/s\n", count,
+	       bytes, (double)bytes * count / t / 1e6);
+	printf("clients: %"PRIu32" attribute reads, wait %.1f us average, "
+	       "%.1f us max\n", nb_polls,
+	       nb_polls ? sum_wait * 1e6 / nb_polls : 0, max_wait * 1e6);
+	for (i = 0; i < BENCH_NB_CLIENTS; i++)
+		printf("clients: client %"PRIu32": %"PRIu32" commands, "
+		       "max_wait_us %"PRIu32"\n", i, stats[i].commands,
+		       stats[i].max_wait_us);
+out:
+	free(read_buff.buff);
+	free(trace);
+	free(stream->in);
+	free(stream->out);
+	free(poll->out);
+
+	return ret;
+}
+#endif
+
+int main(int argc, char **argv)
+{
+	struct iio_init_param param = {
+		.phy_type = USE_UART,
+	};
+	struct iio_desc *desc;
+	int32_t ret;
+
+	if (argc < 2) {
+		fprintf(stderr, "usage: %s buffer [<bytes> [<count>]]\n"
+			"       %s trace [<trace file> [<count>]]\n"
+			"       %s binary [<count>]\n"
+			"       %s clients [<bytes> [<count>]]\n",
+			argv[0], argv[0], argv[0], argv[0]);
+		return EXIT_FAILURE;
+	}
+
+#ifdef ENABLE_IIO_NETWORK
+	if (!strcmp(argv[1], "clients")) {
+		param.phy_type = USE_NETWORK;
+		param.max_net_clients = BENCH_NB_CLIENTS;
+		param.get_time_us = bench_time_us;
+	}
+#endif
+
+	ret = iio_init(&desc, &param);
+	if (IS_ERR_VALUE(ret)) {
+		fprintf(stderr, "iio_init failed: %"PRIi32"\n", ret);
+		return EXIT_FAILURE;
+	}
+
+	if (!strcmp(argv[1], "buffer")) {
+		ret = bench_buffer(desc,
+				   argc > 2 ? strtoul(argv[2], NULL, 0) : 0x100000,
+				   argc > 3 ? strtoul(argv[3], NULL, 0) : 256);
+	} else if (!strcmp(argv[1], "trace")) {
+		ret = bench_trace(desc, argc > 2 ? argv[2] : NULL,
+				  argc > 3 ? strtoul(argv[3], NULL, 0) : 0);
+	} else if (!strcmp(argv[1], "binary")) {
+		ret = bench_binary(desc,
+				   argc > 2 ? strtoul(argv[2], NULL, 0) : 0);
+#ifdef ENABLE_IIO_NETWORK
+	} else if (!strcmp(argv[1], "clients")) {
+		ret = bench_clients(desc,
+				    argc > 2 ? strtoul(argv[2], NULL, 0) :
+				    0x100000,
+				    argc > 3 ? strtoul(argv[3], NULL, 0) : 16);
+#endif
+	} else {
+		fprintf(stderr, "unknown benchmark %s\n", argv[1]);
+		ret = -EINVAL;
+	}
+
+	/* The registered devices are released too */
+	iio_remove(desc);
+	if (IS_ERR_VALUE(ret)) {
+		fprintf(stderr, "%s failed: %"PRIi32"\n", argv[1], ret);
+		return EXIT_FAILURE;
+	}
+
+	return EXIT_SUCCESS;
+}
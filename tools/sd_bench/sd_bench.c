@@ -0,0 +1,706 @@
+/***************************************************************************//**
+ *   @file   sd_bench.c
+ *   @brief  Throughput of the SD card driver against an emulated card
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Runs drivers/sd-card on the host against an SD card emulated at the SPI
+ * byte level, in SPI mode, and backed by an image file. The emulator keeps a
+ * virtual clock: every SPI byte takes 8 SPI clock periods, every SPI call
+ * has a fixed setup cost, mdelay() advances it, and the card answers reads
+ * and ends its busy time after typical access and programming times. The
+ * MB/s printed are computed on that clock, so they show the protocol cost of
+ * the driver (SPI bytes, calls, delays and waits) independently of the host.
+ * Build on Linux with:
+ *
+ *	gcc -O2 -I../../include -I../../drivers/sd-card -o sd_bench \
+ *		sd_bench.c ../../drivers/sd-card/sd.c ../../drivers/spi/spi.c
+ *
+ * Usage:
+ *
+ *	sd_bench <image file> [<MB per test> [<SPI MHz> [<us per SPI call>]]]
+ *
+ * The image file is created or truncated. Sequential and random writes and
+ * reads are run with several request sizes, without and with the
+ * write-behind cache. The image is checked after each write test and the
+ * data after each read test, the program exits with an error on a mismatch
+ * or on a protocol error of the driver, like a command sent while the card
+ * is busy.
+ *
+ * To compare with an older driver, build it with SD_BENCH_LEGACY defined,
+ * which only uses sd_read() and sd_write():
+ *
+ *	mkdir -p old && git show <rev>:drivers/sd-card/sd.h > old/sd.h
+ *	git show <rev>:drivers/sd-card/sd.c > old/sd.c
+ *	gcc -O2 -DSD_BENCH_LEGACY -Iold -I../../include -o sd_bench_old \
+ *		sd_bench.c old/sd.c ../../drivers/spi/spi.c *
+ * Drivers older than the block API poll for tokens by sending back the last
+ * byte read instead of 0xFF, which the emulator reports as a protocol error.
+ * Set *data_out to 0xFF in their wait_for_response() before measuring them.
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "delay.h"
+#include "error.h"
+#include "spi.h"
+#include "sd.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define SD_BENCH_BLOCK		512
+#define SD_BENCH_MAX_CHUNK	65536
+/* Write-behind cache of the cached configuration, in blocks */
+#define SD_BENCH_CACHE_BLOCKS	32
+
+/* Card timings, in us */
+/* From a read command to the first data token */
+#define CARD_READ_ACCESS_US	100
+/* Between two blocks of a multiple block read */
+#define CARD_READ_GAP_US	5
+/* Busy time after a single block write */
+#define CARD_PROG_SINGLE_US	400
+/* Busy time after each block of a multiple block write */
+#define CARD_PROG_MULTI_US	40
+/* Busy time after the stop transmission token */
+#define CARD_PROG_STOP_US	400
+/* Busy time after CMD12 */
+#define CARD_STOP_READ_US	10
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+enum card_state {
+	/** Waiting for a command */
+	CARD_CMD,
+	/** Sending data blocks of CMD17 or CMD18 */
+	CARD_READ,
+	/** Waiting for the start token of a data block of CMD24 or CMD25 */
+	CARD_WRITE_TOKEN,
+	/** Receiving a data block and its CRC */
+	CARD_WRITE_DATA,
+};
+
+/**
+ * @struct sd_card
+ * @brief Emulated card in SPI mode.
+ */
+struct sd_card {
+	int		fd;
+	uint32_t	blocks;
+	/** Virtual clock in ns and the cost of a SPI byte and of a SPI call */
+	double		now_ns;
+	double		byte_ns;
+	double		call_ns;
+	enum card_state	state;
+	/** Command being received, cmd_len is -1 between commands */
+	uint8_t		cmd[6];
+	int		cmd_len;
+	/** Bytes sent after the command: response, CSD... */
+	uint8_t		resp[32];
+	int		resp_len;
+	int		resp_pos;
+	bool		idle;
+	bool		app;
+	uint32_t	acmd41_polls;
+	/** Output is held low until then */
+	double		busy_until;
+	/** Current block and whether CMD18 or CMD25 is running */
+	uint32_t	block;
+	bool		multi;
+	/** Read: the data token is sent after ready_at, pos -1 before it */
+	double		ready_at;
+	int		pos;
+	uint8_t		data[SD_BENCH_BLOCK + 2];
+	/** Statistics */
+	uint64_t	spi_bytes;
+	uint64_t	spi_calls;
+	uint64_t	mdelays;
+	uint64_t	cmds[64];
+	uint64_t	errors;
+};
+
+struct bench_test {
+	const char	*name;
+	bool		write;
+	bool		random;
+	uint32_t	chunk;
+};
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+
+/* mdelay() has no descriptor, there is one card */
+static struct sd_card card;
+
+/* Pass of the pattern each block of the test region holds */
+static uint8_t *block_pass;
+
+static const struct bench_test tests[] = {
+	{"seq write", true, false, 512},
+	{"seq write", true, false, 4096},
+	{"seq write", true, false, 65536},
+	{"random write", true, true, 4096},
+	{"seq read", false, false, 512},
+	{"seq read", false, false, 4096},
+	{"seq read", false, false, 65536},
+	{"random read", false, true, 4096},
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static uint32_t xorshift32(uint32_t *state)
+{
+	uint32_t x = *state;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	*state = x;
+
+	return x;
+}
+
+void mdelay(uint32_t msecs)
+{
+	card.now_ns += msecs * 1e6;
+	card.mdelays++;
+}
+
+void udelay(uint32_t usecs)
+{
+	card.now_ns += usecs * 1e3;
+}
+
+static void card_respond(struct sd_card *c, const uint8_t *resp, int len)
+{
+	/* One byte of command response time */
+	c->resp[0] = 0xFF;
+	memcpy(c->resp + 1, resp, len);
+	c->resp_len = len + 1;
+	c->resp_pos = 0;
+}
+
+static void card_command(struct sd_card *c)
+{
+	static const uint8_t r7[] = {0x01, 0x00, 0x00, 0x01, 0xAA};
+	static const uint8_t r3[] = {0x00, 0xC0, 0xFF, 0x80, 0x00};
+	uint8_t cmd = c->cmd[0] & 0x3F;
+	uint32_t arg = (uint32_t)c->cmd[1] << 24 | c->cmd[2] << 16 |
+		       c->cmd[3] << 8 | c->cmd[4];
+	bool app = c->app;
+	uint8_t resp[24] = {0};
+	uint32_t c_size;
+
+	c->cmds[cmd]++;
+	c->app = false;
+	resp[0] = c->idle ? 0x01 : 0x00;
+
+	if (app && cmd == 41) {
+		/* Leave the idle state on the second poll */
+		if (++c->acmd41_polls >= 2)
+			c->idle = false;
+		resp[0] = c->idle ? 0x01 : 0x00;
+		card_respond(c, resp, 1);
+		return;
+	}
+	if (app && cmd == 23) {
+		card_respond(c, resp, 1);
+		return;
+	}
+
+	switch (cmd) {
+	case 0:
+		c->idle = true;
+		c->acmd41_polls = 0;
+		resp[0] = 0x01;
+		card_respond(c, resp, 1);
+		break;
+	case 8:
+		card_respond(c, r7, sizeof(r7));
+		break;
+	case 55:
+		c->app = true;
+		card_respond(c, resp, 1);
+		break;
+	case 58:
+		card_respond(c, r3, sizeof(r3));
+		break;
+	case 9:
+		/* R1, data token, CSD version 2.0 and CRC */
+		c_size = c->blocks / 1024 - 1;
+		resp[1] = 0xFF;
+		resp[2] = 0xFE;
+		resp[3] = 0x40;
+		resp[10] = (c_size >> 16) & 0x3F;
+		resp[11] = c_size >> 8;
+		resp[12] = c_size;
+		card_respond(c, resp, 3 + 18);
+		break;
+	case 17:
+	case 18:
+	case 24:
+	case 25:
+		if (c->idle || arg >= c->blocks) {
+			c->errors++;
+			resp[0] = 0x40;
+			card_respond(c, resp, 1);
+			break;
+		}
+		card_respond(c, resp, 1);
+		c->block = arg;
+		c->multi = cmd == 18 || cmd == 25;
+		if (cmd == 17 || cmd == 18) {
+			c->state = CARD_READ;
+			c->pos = -1;
+			c->ready_at = c->now_ns + CARD_READ_ACCESS_US * 1e3;
+		} else {
+			c->state = CARD_WRITE_TOKEN;
+		}
+		break;
+	case 12:
+		/* R1b, a stuff byte, R1 then busy */
+		resp[0] = 0xFF;
+		resp[1] = 0x00;
+		card_respond(c, resp, 2);
+		c->busy_until = c->now_ns + 3 * c->byte_ns +
+				CARD_STOP_READ_US * 1e3;
+		break;
+	default:
+		resp[0] |= 0x04;
+		card_respond(c, resp, 1);
+		break;
+	}
+}
+
+static uint8_t card_read_byte(struct sd_card *c)
+{
+	uint8_t out;
+
+	if (c->pos < 0) {
+		if (c->now_ns < c->ready_at)
+			return 0xFF;
+		if (c->block >= c->blocks) {
+			/* Out of range error token */
+			c->state = CARD_CMD;
+			return 0x08;
+		}
+		if (pread(c->fd, c->data, SD_BENCH_BLOCK,
+			  (off_t)c->block * SD_BENCH_BLOCK) != SD_BENCH_BLOCK)
+			c->errors++;
+		c->data[SD_BENCH_BLOCK] = 0;
+		c->data[SD_BENCH_BLOCK + 1] = 0;
+		c->pos = 0;
+		return 0xFE;
+	}
+
+	out = c->data[c->pos++];
+	if (c->pos == SD_BENCH_BLOCK + 2) {
+		c->block++;
+		c->pos = -1;
+		c->ready_at = c->now_ns + CARD_READ_GAP_US * 1e3;
+		if (!c->multi)
+			c->state = CARD_CMD;
+	}
+
+	return out;
+}
+
+static uint8_t card_write_byte(struct sd_card *c, uint8_t mosi)
+{
+	c->data[c->pos++] = mosi;
+	if (c->pos < SD_BENCH_BLOCK + 2)
+		return 0xFF;
+
+	if (pwrite(c->fd, c->data, SD_BENCH_BLOCK,
+		   (off_t)c->block * SD_BENCH_BLOCK) != SD_BENCH_BLOCK)
+		c->errors++;
+	c->block++;
+	/* Data accepted on the next byte, then busy */
+	c->resp[0] = 0xE5;
+	c->resp_len = 1;
+	c->resp_pos = 0;
+	c->busy_until = c->now_ns + c->byte_ns + 1e3 *
+			(c->multi ? CARD_PROG_MULTI_US : CARD_PROG_SINGLE_US);
+	c->state = c->multi ? CARD_WRITE_TOKEN : CARD_CMD;
+
+	return 0xFF;
+}
+
+/* Exchange one SPI byte with the card */
+static uint8_t card_xfer(struct sd_card *c, uint8_t mosi)
+{
+	bool busy;
+	bool cmd_start = (mosi & 0xC0) == 0x40;
+
+	c->now_ns += c->byte_ns;
+	c->spi_bytes++;
+
+	if (c->cmd_len >= 0) {
+		c->cmd[c->cmd_len++] = mosi;
+		if (c->cmd_len == 6) {
+			c->cmd_len = -1;
+			card_command(c);
+		}
+		return 0xFF;
+	}
+
+	if (c->state == CARD_WRITE_DATA)
+		return card_write_byte(c, mosi);
+
+	if (c->resp_pos < c->resp_len && !cmd_start)
+		return c->resp[c->resp_pos++];
+
+	busy = c->now_ns < c->busy_until;
+	switch (c->state) {
+	case CARD_READ:
+		if (cmd_start) {
+			/* CMD12 ends CMD18, nothing else is expected */
+			if (!c->multi)
+				c->errors++;
+			c->state = CARD_CMD;
+			break;
+		}
+		return card_read_byte(c);
+	case CARD_WRITE_TOKEN:
+		if (busy) {
+			if (mosi != 0xFF)
+				c->errors++;
+			return 0x00;
+		}
+		if (mosi == 0xFE || mosi == 0xFC) {
+			if (c->multi != (mosi == 0xFC))
+				c->errors++;
+			c->state = CARD_WRITE_DATA;
+			c->pos = 0;
+		} else if (mosi == 0xFD && c->multi) {
+			c->state = CARD_CMD;
+			c->busy_until = c->now_ns + c->byte_ns +
+					CARD_PROG_STOP_US * 1e3;
+		} else if (mosi != 0xFF) {
+			c->errors++;
+		}
+		return 0xFF;
+	default:
+		break;
+	}
+
+	if (busy) {
+		/* The card ignores commands while it is programming */
+		if (mosi != 0xFF)
+			c->errors++;
+		return 0x00;
+	}
+	if (cmd_start) {
+		c->resp_len = 0;
+		c->resp_pos = 0;
+		c->cmd_len = 0;
+		c->cmd[c->cmd_len++] = mosi;
+	}
+
+	return 0xFF;
+}
+
+static int32_t bench_spi_init(struct spi_desc **desc,
+			      const struct spi_init_param *param)
+{
+	struct spi_desc *d;
+
+	d = calloc(1, sizeof(*d));
+	if (!d)
+		return FAILURE;
+	d->max_speed_hz = param->max_speed_hz;
+	d->extra = param->extra;
+	*desc = d;
+
+	return SUCCESS;
+}
+
+static int32_t bench_spi_write_and_read(struct spi_desc *desc, uint8_t *data,
+					uint16_t bytes_number)
+{
+	struct sd_card *c = desc->extra;
+	uint16_t i;
+
+	c->now_ns += c->call_ns;
+	c->spi_calls++;
+	for (i = 0; i < bytes_number; i++)
+		data[i] = card_xfer(c, data[i]);
+
+	return SUCCESS;
+}
+
+static int32_t bench_spi_remove(struct spi_desc *desc)
+{
+	free(desc);
+
+	return SUCCESS;
+}
+
+static const struct spi_platform_ops bench_spi_ops = {
+	.init = bench_spi_init,
+	.write_and_read = bench_spi_write_and_read,
+	.remove = bench_spi_remove,
+};
+
+/* Content of the test region: one 32-bit word per address, salted by pass */
+static void pattern_fill(uint8_t *buff, uint64_t addr, uint32_t len)
+{
+	uint32_t word;
+	uint32_t i;
+
+	for (i = 0; i < len; i++) {
+		word = (uint32_t)((addr + i) >> 2) * 2654435761u +
+		       block_pass[(addr + i) / SD_BENCH_BLOCK] * 40503u;
+		buff[i] = word >> (8 * ((addr + i) & 3));
+	}
+}
+
+static int pattern_check(const uint8_t *buff, uint64_t addr, uint32_t len,
+			 uint8_t *expected)
+{
+	pattern_fill(expected, addr, len);
+
+	return memcmp(buff, expected, len);
+}
+
+/* Compare the image file with the content the test region should have */
+static int check_image(uint32_t region)
+{
+	static uint8_t file[SD_BENCH_MAX_CHUNK];
+	static uint8_t expected[SD_BENCH_MAX_CHUNK];
+	uint32_t addr;
+
+	for (addr = 0; addr < region; addr += SD_BENCH_MAX_CHUNK) {
+		if (pread(card.fd, file, SD_BENCH_MAX_CHUNK, addr) !=
+		    SD_BENCH_MAX_CHUNK ||
+		    pattern_check(file, addr, SD_BENCH_MAX_CHUNK, expected)) {
+			fprintf(stderr, "image differs near 0x%" PRIx32 "\n",
+				addr);
+			return -1;
+		}
+	}
+
+	return 0;
+}
+
+static int run_test(struct sd_desc *sd, const struct bench_test *t,
+		    uint32_t region, uint8_t pass, bool sync)
+{
+	static uint8_t buff[SD_BENCH_MAX_CHUNK];
+	static uint8_t expected[SD_BENCH_MAX_CHUNK];
+	uint32_t chunks = region / t->chunk;
+	uint32_t rnd = 0x2545f491 ^ t->chunk;
+	uint64_t spi_bytes = card.spi_bytes;
+	uint64_t spi_calls = card.spi_calls;
+	uint64_t mdelays = card.mdelays;
+	uint64_t errors = card.errors;
+	double vstart = card.now_ns;
+	double start = now_s();
+	uint64_t addr;
+	uint32_t i;
+	uint32_t b;
+	int32_t ret = SUCCESS;
+
+	for (i = 0; i < chunks && ret == SUCCESS; i++) {
+		addr = (uint64_t)(t->random ? xorshift32(&rnd) % chunks : i) *
+		       t->chunk;
+		if (t->write) {
+			for (b = 0; b < t->chunk / SD_BENCH_BLOCK; b++)
+				block_pass[addr / SD_BENCH_BLOCK + b] = pass;
+			pattern_fill(buff, addr, t->chunk);
+			ret = sd_write(sd, buff, addr, t->chunk);
+		} else {
+			ret = sd_read(sd, buff, addr, t->chunk);
+			if (ret == SUCCESS &&
+			    pattern_check(buff, addr, t->chunk, expected)) {
+				fprintf(stderr, "%s %" PRIu32 ": wrong data at "
+					"0x%" PRIx64 "\n", t->name, t->chunk,
+					addr);
+				return -1;
+			}
+		}
+	}
+#ifndef SD_BENCH_LEGACY
+	if (ret == SUCCESS && sync)
+		ret = sd_sync(sd);
+#endif
+	if (ret != SUCCESS) {
+		fprintf(stderr, "%s %" PRIu32 ": driver error %" PRId32 "\n",
+			t->name, t->chunk, ret);
+		return -1;
+	}
+	if (card.errors != errors) {
+		fprintf(stderr, "%s %" PRIu32 ": %" PRIu64 " protocol errors\n",
+			t->name, t->chunk, card.errors - errors);
+		return -1;
+	}
+
+	printf("%-13s %6" PRIu32 " %10.2f %10.1f %10.3f %10.2f %8" PRIu64
+	       "\n", t->name, t->chunk,
+	       (double)chunks * t->chunk / (card.now_ns - vstart) * 1e3,
+	       (double)chunks * t->chunk / (now_s() - start) / 1e6,
+	       (double)(card.spi_bytes - spi_bytes) / chunks / t->chunk,
+	       (double)(card.spi_calls - spi_calls) * SD_BENCH_BLOCK /
+	       chunks / t->chunk, card.mdelays - mdelays);
+
+	if (t->write && check_image(region))
+		return -1;
+
+	return 0;
+}
+
+static int run_config(uint32_t cache_blocks, uint32_t region)
+{
+	struct spi_init_param spi_ip = {
+		.platform_ops = &bench_spi_ops,
+		.extra = &card,
+	};
+	struct sd_init_param sd_ip = { 0 };
+	struct spi_desc *spi;
+	struct sd_desc *sd;
+	uint8_t pass = 0;
+	uint32_t i;
+	int ret = 0;
+
+	if (spi_init(&spi, &spi_ip) != SUCCESS)
+		return -1;
+
+	card.state = CARD_CMD;
+	card.cmd_len = -1;
+	card.resp_len = 0;
+	card.app = false;
+	card.busy_until = 0;
+	sd_ip.spi_desc = spi;
+#ifndef SD_BENCH_LEGACY
+	sd_ip.cache_blocks = cache_blocks;
+#endif
+	if (sd_init(&sd, &sd_ip) != SUCCESS) {
+		fprintf(stderr, "sd_init failed\n");
+		spi_remove(spi);
+		return -1;
+	}
+
+	printf("\nwrite-behind cache: %" PRIu32 " blocks\n", cache_blocks);
+	printf("%-13s %6s %10s %10s %10s %10s %8s\n", "test", "bytes",
+	       "MB/s", "host MB/s", "SPI B/B", "calls/blk", "mdelay");
+	for (i = 0; i < sizeof(tests) / sizeof(tests[0]) && !ret; i++)
+		ret = run_test(sd, &tests[i], region, tests[i].write ? ++pass :
+			       pass, true);
+
+	if (sd_remove(sd) != SUCCESS)
+		ret = -1;
+	spi_remove(spi);
+
+	return ret;
+}
+
+int main(int argc, char **argv)
+{
+	double mb = argc > 2 ? strtod(argv[2], NULL) : 2;
+	double spi_mhz = argc > 3 ? strtod(argv[3], NULL) : 25;
+	double call_us = argc > 4 ? strtod(argv[4], NULL) : 2;
+	uint32_t region;
+	int ret;
+
+	if (argc < 2 || mb <= 0 || spi_mhz <= 0) {
+		fprintf(stderr, "usage: %s <image file> [<MB per test> "
+			"[<SPI MHz> [<us per SPI call>]]]\n", argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	region = (uint32_t)(mb * 1e6) / SD_BENCH_MAX_CHUNK * SD_BENCH_MAX_CHUNK;
+	if (!region)
+		region = SD_BENCH_MAX_CHUNK;
+
+	/* Card sizes are multiples of 512 KB, keep some room after the region */
+	card.blocks = (region / SD_BENCH_BLOCK + 1024) / 1024 * 1024 + 1024;
+	card.byte_ns = 8e3 / spi_mhz;
+	card.call_ns = call_us * 1e3;
+	card.fd = open(argv[1], O_RDWR | O_CREAT | O_TRUNC, 0644);
+	if (card.fd < 0 || ftruncate(card.fd, (off_t)card.blocks *
+				     SD_BENCH_BLOCK)) {
+		perror(argv[1]);
+		return EXIT_FAILURE;
+	}
+
+	block_pass = calloc(card.blocks, 1);
+	if (!block_pass) {
+		close(card.fd);
+		return EXIT_FAILURE;
+	}
+
+	printf("%.2f MB per test, SPI %.1f MHz, %.1f us per SPI call\n",
+	       region / 1e6, spi_mhz, call_us);
+	printf("MB/s on the emulated bus, SPI B/B is SPI bytes per payload "
+	       "byte\n");
+
+	ret = run_config(0, region);
+#ifndef SD_BENCH_LEGACY
+	if (!ret)
+		ret = run_config(SD_BENCH_CACHE_BLOCKS, region);
+#endif
+
+	free(block_pass);
+	close(card.fd);
+
+	return ret ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,156 @@
+/***************************************************************************//**
+ *   @file   uio_bench.c
+ *   @brief  Per access cost of the Linux UIO axi_io backend
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Compares the cost of a register read through axi_io_read(), which keeps
+ * the UIO window mapped, with the previous implementation that opened and
+ * mapped /dev/uioN for every access. Only reads are done, offset 0 is the
+ * version register of the ADI cores. Build on the Linux target with:
+ *
+ *	gcc -O2 -I../../include -o uio_bench uio_bench.c \
+ *		../../drivers/platform/linux/axi_io.c
+ *
+ * Usage:
+ *
+ *	uio_bench <uio index> [<offset> [<count>]]
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <fcntl.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include "error.h"
+#include "axi_io.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static double now_ns(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/* The access path used before the mapping cache */
+static int32_t uncached_read(uint32_t base, uint32_t offset, uint32_t *data)
+{
+	char buf[32];
+	void *addr;
+	int fd;
+
+	sprintf(buf, "/dev/uio%"PRIu32, base);
+	fd = open(buf, O_RDWR);
+	if (fd < 0)
+		return FAILURE;
+
+	addr = mmap(NULL, offset + sizeof(*data), PROT_READ | PROT_WRITE,
+		    MAP_SHARED, fd, 0);
+	if (addr == MAP_FAILED) {
+		close(fd);
+		return FAILURE;
+	}
+
+	*data = *(volatile uint32_t *)((uintptr_t)addr + offset);
+
+	munmap(addr, offset + sizeof(*data));
+	close(fd);
+
+	return SUCCESS;
+}
+
+int main(int argc, char **argv)
+{
+	uint32_t base, offset = 0, count = 100000;
+	uint32_t cached_val, uncached_val;
+	double start, cached_ns, uncached_ns;
+	uint32_t i;
+
+	if (argc < 2) {
+		fprintf(stderr, "Usage: %s <uio index> [<offset> [<count>]]\n",
+			argv[0]);
+		return EXIT_FAILURE;
+	}
+
+	base = strtoul(argv[1], NULL, 0);
+	if (argc > 2)
+		offset = strtoul(argv[2], NULL, 0);
+	if (argc > 3)
+		count = strtoul(argv[3], NULL, 0);
+	if (!count || offset % sizeof(uint32_t)) {
+		fprintf(stderr, "Invalid offset or count\n");
+		return EXIT_FAILURE;
+	}
+
+	/* The first access maps the window, keep it out of the timing */
+	if (axi_io_read(base, offset, &cached_val) != SUCCESS ||
+	    uncached_read(base, offset, &uncached_val) != SUCCESS) {
+		fprintf(stderr, "Can't access /dev/uio%"PRIu32"\n", base);
+		return EXIT_FAILURE;
+	}
+
+	start = now_ns();
+	for (i = 0; i < count; i++)
+		axi_io_read(base, offset, &cached_val);
+	cached_ns = (now_ns() - start) / count;
+
+	start = now_ns();
+	for (i = 0; i < count; i++)
+		uncached_read(base, offset, &uncached_val);
+	uncached_ns = (now_ns() - start) / count;
+
+	axi_io_remove(base);
+
+	printf("uio%"PRIu32" offset 0x%"PRIx32" value 0x%08"PRIx32"\n", base,
+	       offset, cached_val);
+	printf("mapped once:      %10.1f ns/access\n", cached_ns);
+	printf("mapped on access: %10.1f ns/access\n", uncached_ns);
+	printf("speedup:          %10.1fx\n", uncached_ns / cached_ns);
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,413 @@
+/***************************************************************************//**
+ *   @file   unpack_bench.c
+ *   @brief  Bit-exactness suite and throughput of the sample unpacking
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/*
+ * Checks unpack_be_u32() and unpack_be_u16() bit-exact against a bitwise
+ * reference, for every stride and width, with and without sign extension,
+ * on random lengths and source alignments. The SIMD path is taken for
+ * 16-bit strides when the compiler enables SSE2. The driver loops
+ * replaced by the unpacking functions (ad7606 18-bit, 26-bit, 16-bit and
+ * 24-bit frames, adxl372 FIFO entries) are checked against them too, then
+ * their throughput is compared, as the fastest of many batches of calls.
+ * Build on Linux with:
+ *
+ *	gcc -O2 -I../../include -o unpack_bench unpack_bench.c \
+ *		../../util/unpack.c
+ *
+ * Add -mno-sse2 on x86-64 hosts to measure the scalar path only.
+ *
+ * Usage:
+ *
+ *	unpack_bench [<seconds per measurement>]
+ *
+ * The program exits with an error if any sample differs.
+ */
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "error.h"
+#include "unpack.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+#define UNPACK_MAX_COUNT	300
+#define UNPACK_GUARD		0x5A5A5A5Au
+#define UNPACK_BENCH_SAMPLES	1024
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/* Driver loop and the unpacking call replacing it, for count samples */
+struct unpack_case {
+	const char	*name;
+	uint8_t		stride;
+	uint8_t		bits;
+	/* Samples converted by a call of legacy */
+	uint32_t	group;
+	void		(*legacy)(uint32_t *dst, const uint8_t *src,
+				  uint32_t count);
+};
+
+/******************************************************************************/
+/************************ Variable Declarations *******************************/
+/******************************************************************************/
+
+/* Benchmark sink, so the results are not optimized out */
+static volatile uint32_t unpack_sink;
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static double now_s(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+/* Word i of the stream, one bit at a time */
+static uint32_t ref_word(const uint8_t *src, uint32_t i, uint8_t stride,
+			 uint8_t bits, bool sign_ext)
+{
+	uint64_t pos = (uint64_t)i * stride;
+	uint32_t word = 0;
+	uint8_t b;
+
+	for (b = 0; b < bits; b++, pos++)
+		word = (word << 1) | ((src[pos / 8] >> (7 - pos % 8)) & 1);
+
+	if (sign_ext && bits < 32 && (word >> (bits - 1)) & 1)
+		word |= 0xFFFFFFFFu << bits;
+
+	return word;
+}
+
+/* cpy18b32b() of ad7606 */
+static void legacy_ad7606_18(uint32_t *pdst, const uint8_t *psrc,
+			     uint32_t count)
+{
+	uint32_t srcsz = count / 4 * 9;
+	uint32_t i, j;
+
+	for (i = 0; i < srcsz; i += 9) {
+		j = 4 * (i / 9);
+		pdst[j + 0] = ((uint32_t)(psrc[i + 0] & 0xff) << 10) |
+			      ((uint32_t)psrc[i + 1] << 2) |
+			      ((uint32_t)psrc[i + 2] >> 6);
+		pdst[j + 1] = ((uint32_t)(psrc[i + 2] & 0x3f) << 12) |
+			      ((uint32_t)psrc[i + 3] << 4) |
+			      ((uint32_t)psrc[i + 4] >> 4);
+		pdst[j + 2] = ((uint32_t)(psrc[i + 4] & 0x0f) << 14) |
+			      ((uint32_t)psrc[i + 5] << 6) |
+			      ((uint32_t)psrc[i + 6] >> 2);
+		pdst[j + 3] = ((uint32_t)(psrc[i + 6] & 0x03) << 16) |
+			      ((uint32_t)psrc[i + 7] << 8) |
+			      ((uint32_t)psrc[i + 8] >> 0);
+	}
+}
+
+/* cpy26b32b() of ad7606, 18-bit samples with the status byte */
+static void legacy_ad7606_26(uint32_t *pdst, const uint8_t *psrc,
+			     uint32_t count)
+{
+	uint32_t srcsz = count / 4 * 13;
+	uint32_t i, j;
+
+	for (i = 0; i < srcsz; i += 13) {
+		j = 4 * (i / 13);
+		pdst[j + 0] = ((uint32_t)(psrc[i + 0] & 0xff) << 18) |
+			      ((uint32_t)psrc[i + 1] << 10) |
+			      ((uint32_t)psrc[i + 2] << 2) |
+			      ((uint32_t)psrc[i + 3] >> 6);
+		pdst[j + 1] = ((uint32_t)(psrc[i + 3] & 0x3f) << 20) |
+			      ((uint32_t)psrc[i + 4] << 12) |
+			      ((uint32_t)psrc[i + 5] << 4) |
+			      ((uint32_t)psrc[i + 6] >> 4);
+		pdst[j + 2] = ((uint32_t)(psrc[i + 6] & 0x0f) << 22) |
+			      ((uint32_t)psrc[i + 7] << 14) |
+			      ((uint32_t)psrc[i + 8] << 6) |
+			      ((uint32_t)psrc[i + 9] >> 2);
+		pdst[j + 3] = ((uint32_t)(psrc[i + 9] & 0x03) << 24) |
+			      ((uint32_t)psrc[i + 10] << 16) |
+			      ((uint32_t)psrc[i + 11] << 8) |
+			      ((uint32_t)psrc[i + 12] >> 0);
+	}
+}
+
+/* 16-bit loop of ad7606 */
+static void legacy_ad7606_16(uint32_t *data, const uint8_t *src,
+			     uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		data[i] = (uint32_t)src[i * 2] << 8;
+		data[i] |= (uint32_t)src[i * 2 + 1];
+	}
+}
+
+/* 16-bit samples with the status byte, loop of ad7606 */
+static void legacy_ad7606_24(uint32_t *data, const uint8_t *src,
+			     uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count; i++) {
+		data[i] = (uint32_t)src[i * 3] << 16;
+		data[i] |= (uint32_t)src[i * 3 + 1] << 8;
+		data[i] |= (uint32_t)src[i * 3 + 2];
+	}
+}
+
+/* adxl372_get_fifo_xyz_data() loop, the samples are widened to 32 bits to
+ * share the comparison code */
+static void legacy_adxl372(uint32_t *data, const uint8_t *buf, uint32_t count)
+{
+	uint32_t i;
+
+	for (i = 0; i < count * 2; i += 2)
+		*data++ = (uint16_t)((buf[i] << 4) | (buf[i + 1] >> 4));
+}
+
+static const struct unpack_case cases[] = {
+	{"ad7606 18-bit", 18, 18, 4, legacy_ad7606_18},
+	{"ad7606 18+8-bit", 26, 26, 4, legacy_ad7606_26},
+	{"ad7606 16-bit", 16, 16, 1, legacy_ad7606_16},
+	{"ad7606 16+8-bit", 24, 24, 1, legacy_ad7606_24},
+	{"adxl372 12-bit", 16, 12, 1, legacy_adxl372},
+};
+
+static void fill_random(uint8_t *buff, uint32_t len)
+{
+	while (len--)
+		*buff++ = rand();
+}
+
+/* Check both functions for one stride and width */
+static int check_params(const uint8_t *src, uint8_t stride, uint8_t bits,
+			bool sign_ext)
+{
+	uint32_t dst32[UNPACK_MAX_COUNT + 1];
+	uint16_t dst16[UNPACK_MAX_COUNT + 1];
+	uint32_t count;
+	uint32_t ref;
+	uint32_t i;
+	int32_t ret;
+
+	for (count = 0; count <= UNPACK_MAX_COUNT;
+	     count += (count < 20) ? 1 : 1 + rand() % 40) {
+		dst32[count] = UNPACK_GUARD;
+		ret = unpack_be_u32(dst32, src, count, stride, bits, sign_ext);
+		if (ret != SUCCESS || dst32[count] != UNPACK_GUARD) {
+			printf("unpack_be_u32(stride %u, bits %u): %s\n",
+			       stride, bits, ret ? "fails" :
+			       "writes past the end");
+			return -1;
+		}
+
+		dst16[count] = (uint16_t)UNPACK_GUARD;
+		if (bits <= 16) {
+			ret = unpack_be_u16(dst16, src, count, stride, bits,
+					    sign_ext);
+			if (ret != SUCCESS ||
+			    dst16[count] != (uint16_t)UNPACK_GUARD) {
+				printf("unpack_be_u16(stride %u, bits %u): %s\n",
+				       stride, bits, ret ? "fails" :
+				       "writes past the end");
+				return -1;
+			}
+		}
+
+		for (i = 0; i < count; i++) {
+			ref = ref_word(src, i, stride, bits, sign_ext);
+			if (dst32[i] != ref ||
+			    (bits <= 16 && dst16[i] != (uint16_t)ref)) {
+				printf("stride %u, bits %u, sign %d, count %"
+				       PRIu32": sample %"PRIu32" is 0x%"PRIx32
+				       "/0x%x instead of 0x%"PRIx32"\n",
+				       stride, bits, sign_ext, count, i,
+				       dst32[i], bits <= 16 ? dst16[i] : 0,
+				       ref);
+				return -1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+/* Every stride, width and sign extension, at every source alignment */
+static int check_all(void)
+{
+	uint8_t buff[UNPACK_MAX_COUNT * 4 + 8];
+	uint32_t checks = 0;
+	uint8_t stride;
+	uint8_t bits;
+	uint8_t offset;
+	int sign;
+
+	for (offset = 0; offset < 4; offset++)
+		for (stride = 1; stride <= 32; stride++)
+			for (bits = 1; bits <= stride; bits++)
+				for (sign = 0; sign < 2; sign++) {
+					fill_random(buff, sizeof(buff));
+					if (check_params(buff + offset, stride,
+							 bits, sign))
+						return -1;
+					checks++;
+				}
+	printf("bit-exact for %"PRIu32" stride, width, sign and alignment "
+	       "combinations\n", checks);
+
+	return 0;
+}
+
+/* Invalid parameters are refused */
+static int check_invalid(void)
+{
+	uint32_t dst32[1];
+	uint16_t dst16[1];
+	uint8_t src[8] = {0};
+
+	if (unpack_be_u32(dst32, src, 1, 16, 0, false) != -EINVAL ||
+	    unpack_be_u32(dst32, src, 1, 16, 17, false) != -EINVAL ||
+	    unpack_be_u32(dst32, src, 1, 33, 32, false) != -EINVAL ||
+	    unpack_be_u32(NULL, src, 1, 16, 16, false) != -EINVAL ||
+	    unpack_be_u32(dst32, NULL, 1, 16, 16, false) != -EINVAL ||
+	    unpack_be_u16(dst16, src, 1, 24, 17, false) != -EINVAL ||
+	    unpack_be_u16(dst16, src, 1, 8, 9, false) != -EINVAL) {
+		printf("invalid parameters are accepted\n");
+		return -1;
+	}
+
+	return 0;
+}
+
+/* The drivers get the same samples as with their former loops */
+static int check_legacy(const uint8_t *src)
+{
+	uint32_t ref[UNPACK_BENCH_SAMPLES];
+	uint32_t dst[UNPACK_BENCH_SAMPLES];
+	uint32_t i;
+
+	for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		cases[i].legacy(ref, src, UNPACK_BENCH_SAMPLES);
+		unpack_be_u32(dst, src, UNPACK_BENCH_SAMPLES, cases[i].stride,
+			      cases[i].bits, false);
+		if (memcmp(ref, dst, sizeof(ref))) {
+			printf("%s: differs from the driver loop\n",
+			       cases[i].name);
+			return -1;
+		}
+	}
+	printf("same samples as the driver loops\n\n");
+
+	return 0;
+}
+
+/* Million samples per second of the legacy loop or of unpack_be_u32(), for
+ * the fastest batch of 256 calls, which filters out the host noise */
+static double measure(const struct unpack_case *c, const uint8_t *src,
+		      bool legacy, double seconds)
+{
+	uint32_t dst[UNPACK_BENCH_SAMPLES];
+	double best = 0;
+	uint32_t i;
+	double start;
+	double batch;
+	double t;
+
+	start = now_s();
+	do {
+		batch = now_s();
+		for (i = 0; i < 256; i++) {
+			if (legacy)
+				c->legacy(dst, src, UNPACK_BENCH_SAMPLES);
+			else
+				unpack_be_u32(dst, src, UNPACK_BENCH_SAMPLES,
+					      c->stride, c->bits, false);
+			unpack_sink = dst[i];
+		}
+		t = now_s();
+		batch = 256.0 * UNPACK_BENCH_SAMPLES / (t - batch) / 1e6;
+		if (batch > best)
+			best = batch;
+	} while (t - start < seconds);
+
+	return best;
+}
+
+int main(int argc, char **argv)
+{
+	static uint8_t src[UNPACK_BENCH_SAMPLES * 4];
+	double seconds = argc > 1 ? strtod(argv[1], NULL) : 0.2;
+	double legacy;
+	double unpack;
+	uint32_t i;
+
+	srand(1);
+	if (check_invalid() || check_all())
+		return EXIT_FAILURE;
+
+	fill_random(src, sizeof(src));
+	if (check_legacy(src))
+		return EXIT_FAILURE;
+
+	printf("%-16s %12s %12s  (Msamples/s, %u samples per call)\n", "",
+	       "driver loop", "unpack", UNPACK_BENCH_SAMPLES);
+	for (i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+		legacy = measure(&cases[i], src, true, seconds);
+		unpack = measure(&cases[i], src, false, seconds);
+		printf("%-16s %12.1f %12.1f\n", cases[i].name, legacy, unpack);
+	}
+
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,573 @@
+/***************************************************************************//**
+ *   @file   binlog.c
+ *   @brief  Deferred binary logging
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include <inttypes.h>
+#include "error.h"
+#include "binlog.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/** Longest message formatted on the target */
+#define BINLOG_LINE_SIZE	256
+/** Longest conversion specification */
+#define BINLOG_SPEC_SIZE	24
+
+/******************************************************************************/
+/*************************** Types Declarations *******************************/
+/******************************************************************************/
+
+/**
+ * @struct binlog_slot
+ * @brief Recorded message
+ */
+struct binlog_slot {
+	/** Position the slot is ready for, see binlog_record() */
+	_Atomic uint32_t		seq;
+	uint8_t				level;
+	uint8_t				nargs;
+	uint32_t			timestamp;
+	const char			*fmt;
+	const struct binlog_module	*mod;
+	uint64_t			args[BINLOG_MAX_ARGS];
+};
+
+/**
+ * @struct binlog_desc
+ * @brief Deferred logger state
+ */
+struct binlog_desc {
+	struct binlog_slot	*slots;
+	uint32_t		mask;
+	/** Next position to be reserved by a writer */
+	_Atomic uint32_t	head;
+	/** Next position to be drained */
+	uint32_t		tail;
+	/** Messages lost because the ring was full */
+	_Atomic uint32_t	dropped;
+	enum binlog_output	output;
+	int32_t			(*write)(void *ctx, const uint8_t *data,
+					 uint32_t len);
+	void			*write_ctx;
+	uint32_t		(*timestamp)(void);
+	char			line[BINLOG_LINE_SIZE];
+	uint8_t			record[BINLOG_HDR_SIZE + 8 * BINLOG_MAX_ARGS];
+};
+
+/******************************************************************************/
+/************************ Variable Definitions ********************************/
+/******************************************************************************/
+
+BINLOG_MODULE_DEFINE(global, LOG_LEVEL);
+
+/* Defined by the linker, start of the binlog_fmt section */
+extern const char __start_binlog_fmt[];
+
+static struct binlog_desc *binlog_desc;
+
+static const struct binlog_fmt_param binlog_native = {
+	.long_size = sizeof(long),
+	.ptr_size = sizeof(void *),
+	.str = NULL,
+	.str_ctx = NULL
+};
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+static uint64_t binlog_mask(uint64_t val, uint8_t bits)
+{
+	if (bits >= 64)
+		return val;
+
+	return val & ((1ull << bits) - 1);
+}
+
+static uint64_t binlog_sign_extend(uint64_t val, uint8_t bits)
+{
+	uint64_t sign;
+
+	if (bits >= 64)
+		return val;
+
+	sign = 1ull << (bits - 1);
+
+	return (binlog_mask(val, bits) ^ sign) - sign;
+}
+
+static void binlog_spec_add(char *spec, uint32_t *len, char c)
+{
+	if (*len < BINLOG_SPEC_SIZE - 4)
+		spec[(*len)++] = c;
+}
+
+/**
+ * @brief Format a recorded message.
+ *
+ * Length modifiers are applied to the recorded 64-bit words using the sizes
+ * of the target in param, so that records of a 32-bit target can be
+ * formatted on a 64-bit host. %n is ignored.
+ *
+ * @param buff - Where to store the message.
+ * @param size - Size of buff, the message is truncated to size - 1 bytes.
+ * @param fmt - printf format string.
+ * @param args - Recorded arguments.
+ * @param nargs - Number of recorded arguments.
+ * @param param - Target description.
+ * @return Length of the message, negative error code otherwise.
+ */
+int32_t binlog_format(char *buff, uint32_t size, const char *fmt,
+		      const uint64_t *args, uint32_t nargs,
+		      const struct binlog_fmt_param *param)
+{
+	char spec[BINLOG_SPEC_SIZE];
+	uint32_t arg = 0;
+	uint32_t len = 0;
+	uint32_t slen;
+	const char *str;
+	uint64_t val;
+	uint8_t bits;
+	double dval;
+	char conv;
+	int n;
+
+	if (!buff || !size || !fmt || !param)
+		return -EINVAL;
+
+#define BINLOG_NEXT_ARG()	(arg < nargs ? args[arg++] : 0)
+
+	while (*fmt && len < size - 1) {
+		if (*fmt != '%' || fmt[1] == '%') {
+			buff[len++] = *fmt;
+			fmt += *fmt == '%' ? 2 : 1;
+			continue;
+		}
+
+		slen = 0;
+		spec[slen++] = *fmt++;
+		while (*fmt && strchr("-+ #0", *fmt))
+			binlog_spec_add(spec, &slen, *fmt++);
+		/* Width and precision */
+		while ((*fmt >= '0' && *fmt <= '9') || *fmt == '.' ||
+		       *fmt == '*') {
+			if (*fmt == '*') {
+				n = snprintf(spec + slen, BINLOG_SPEC_SIZE - 4 - slen,
+					     "%"PRId32, (int32_t)BINLOG_NEXT_ARG());
+				if (n > 0)
+					slen += n;
+				if (slen > BINLOG_SPEC_SIZE - 4)
+					slen = BINLOG_SPEC_SIZE - 4;
+				fmt++;
+			} else {
+				binlog_spec_add(spec, &slen, *fmt++);
+			}
+		}
+
+		/* Length */
+		bits = 32;
+		switch (*fmt) {
+		case 'h':
+			bits = fmt[1] == 'h' ? 8 : 16;
+			fmt += fmt[1] == 'h' ? 2 : 1;
+			break;
+		case 'l':
+			bits = fmt[1] == 'l' ? 64 : param->long_size * 8;
+			fmt += fmt[1] == 'l' ? 2 : 1;
+			break;
+		case 'j':
+		case 'q':
+		case 'L':
+			bits = 64;
+			fmt++;
+			break;
+		case 'z':
+		case 't':
+			bits = param->ptr_size * 8;
+			fmt++;
+			break;
+		default:
+			break;
+		}
+
+		conv = *fmt;
+		if (!conv)
+			break;
+		fmt++;
+
+		n = 0;
+		switch (conv) {
+		case 'd':
+		case 'i':
+			binlog_spec_add(spec, &slen, 'l');
+			binlog_spec_add(spec, &slen, 'l');
+			binlog_spec_add(spec, &slen, 'd');
+			spec[slen] = '\0';
+			val = binlog_sign_extend(BINLOG_NEXT_ARG(), bits);
+			n = snprintf(buff + len, size - len, spec,
+				     (long long)(int64_t)val);
+			break;
+		case 'u':
+		case 'o':
+		case 'x':
+		case 'X':
+			binlog_spec_add(spec, &slen, 'l');
+			binlog_spec_add(spec, &slen, 'l');
+			binlog_spec_add(spec, &slen, conv);
+			spec[slen] = '\0';
+			val = binlog_mask(BINLOG_NEXT_ARG(), bits);
+			n = snprintf(buff + len, size - len, spec,
+				     (unsigned long long)val);
+			break;
+		case 'p':
+			val = binlog_mask(BINLOG_NEXT_ARG(),
+					  param->ptr_size * 8);
+			n = snprintf(buff + len, size - len, "0x%"PRIx64, val);
+			break;
+		case 'c':
+			binlog_spec_add(spec, &slen, 'c');
+			spec[slen] = '\0';
+			n = snprintf(buff + len, size - len, spec,
+				     (int)(uint8_t)BINLOG_NEXT_ARG());
+			break;
+		case 's':
+			val = binlog_mask(BINLOG_NEXT_ARG(),
+					  param->ptr_size * 8);
+			if (param->str)
+				str = param->str(param->str_ctx, val);
+			else
+				str = (const char *)(uintptr_t)val;
+			binlog_spec_add(spec, &slen, 's');
+			spec[slen] = '\0';
+			n = snprintf(buff + len, size - len, spec,
+				     str ? str : "(null)");
+			break;
+		case 'f':
+		case 'F':
+		case 'e':
+		case 'E':
+		case 'g':
+		case 'G':
+		case 'a':
+		case 'A':
+			val = BINLOG_NEXT_ARG();
+			memcpy(&dval, &val, sizeof(dval));
+			binlog_spec_add(spec, &slen, conv);
+			spec[slen] = '\0';
+			n = snprintf(buff + len, size - len, spec, dval);
+			break;
+		case 'n':
+			BINLOG_NEXT_ARG();
+			break;
+		default:
+			break;
+		}
+
+		if (n > 0)
+			len += (uint32_t)n < size - 1 - len ? (uint32_t)n :
+			       size - 1 - len;
+	}
+
+#undef BINLOG_NEXT_ARG
+
+	buff[len] = '\0';
+
+	return len;
+}
+
+/**
+ * @brief Initialize the deferred logger.
+ *
+ * Messages recorded before the initialization are printed right away.
+ *
+ * @param param - The initialization parameters.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t binlog_init(const struct binlog_init_param *param)
+{
+	struct binlog_desc *desc;
+	uint32_t i;
+
+	if (!param || !param->slots || (param->slots & (param->slots - 1)))
+		return -EINVAL;
+
+	if (param->output == BINLOG_OUTPUT_BINARY && !param->write)
+		return -EINVAL;
+
+	if (binlog_desc)
+		return -EBUSY;
+
+	desc = (struct binlog_desc *)calloc(1, sizeof(*desc));
+	if (!desc)
+		return -ENOMEM;
+
+	desc->slots = (struct binlog_slot *)calloc(param->slots,
+			sizeof(*desc->slots));
+	if (!desc->slots) {
+		free(desc);
+		return -ENOMEM;
+	}
+
+	for (i = 0; i < param->slots; i++)
+		atomic_init(&desc->slots[i].seq, i);
+	atomic_init(&desc->head, 0);
+	atomic_init(&desc->dropped, 0);
+	desc->mask = param->slots - 1;
+	desc->output = param->output;
+	desc->write = param->write;
+	desc->write_ctx = param->write_ctx;
+	desc->timestamp = param->timestamp;
+
+	binlog_desc = desc;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by binlog_init().
+ *
+ * The messages still in the ring are lost, call binlog_drain() first. No
+ * message may be recorded while the logger is removed.
+ *
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t binlog_remove(void)
+{
+	struct binlog_desc *desc = binlog_desc;
+
+	if (!desc)
+		return -EINVAL;
+
+	binlog_desc = NULL;
+	free(desc->slots);
+	free(desc);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Record a message, use binlog_print() or the pr_* macros instead.
+ *
+ * Safe to call from interrupts and from several contexts at once: the writer
+ * reserves a slot by advancing head, fills it and then publishes it by
+ * setting the sequence number of the slot. The message is dropped when the
+ * ring is full.
+ *
+ * @param mod - Module of the message.
+ * @param level - Level of the message.
+ * @param fmt - Format string, in the binlog_fmt section.
+ * @param args - Arguments captured with BINLOG_ARG().
+ * @param nargs - Number of arguments.
+ */
+void binlog_record(const struct binlog_module *mod, uint8_t level,
+		   const char *fmt, const uint64_t *args, uint32_t nargs)
+{
+	struct binlog_desc *desc = binlog_desc;
+	struct binlog_slot *slot;
+	char line[BINLOG_LINE_SIZE];
+	uint32_t pos;
+	int32_t diff;
+
+	if (nargs > BINLOG_MAX_ARGS)
+		nargs = BINLOG_MAX_ARGS;
+
+	if (!desc) {
+		if (binlog_format(line, sizeof(line), fmt, args, nargs,
+				  &binlog_native) > 0)
+			printf("%s", line);
+		return;
+	}
+
+	pos = atomic_load_explicit(&desc->head, memory_order_relaxed);
+	while (1) {
+		slot = &desc->slots[pos & desc->mask];
+		diff = (int32_t)(atomic_load_explicit(&slot->seq,
+						      memory_order_acquire) - pos);
+		if (diff == 0) {
+			if (atomic_compare_exchange_weak_explicit(&desc->head,
+					&pos, pos + 1, memory_order_relaxed,
+					memory_order_relaxed))
+				break;
+		} else if (diff < 0) {
+			atomic_fetch_add_explicit(&desc->dropped, 1,
+						  memory_order_relaxed);
+			return;
+		} else {
+			pos = atomic_load_explicit(&desc->head,
+						   memory_order_relaxed);
+		}
+	}
+
+	slot->level = level;
+	slot->nargs = nargs;
+	slot->timestamp = desc->timestamp ? desc->timestamp() : 0;
+	slot->fmt = fmt;
+	slot->mod = mod;
+	memcpy(slot->args, args, nargs * sizeof(*args));
+
+	atomic_store_explicit(&slot->seq, pos + 1, memory_order_release);
+}
+
+static void binlog_put_le32(uint8_t *buff, uint32_t val)
+{
+	buff[0] = val;
+	buff[1] = val >> 8;
+	buff[2] = val >> 16;
+	buff[3] = val >> 24;
+}
+
+static int32_t binlog_emit(struct binlog_desc *desc, uint8_t level,
+			   uint32_t timestamp, const char *fmt,
+			   const struct binlog_module *mod,
+			   const uint64_t *args, uint32_t nargs)
+{
+	uint8_t *rec = desc->record;
+	int32_t len;
+	uint32_t i;
+
+	if (desc->output == BINLOG_OUTPUT_TEXT) {
+		len = binlog_format(desc->line, sizeof(desc->line), fmt, args,
+				    nargs, &binlog_native);
+		if (len <= 0)
+			return len;
+		if (!desc->write)
+			return printf("%s", desc->line) < 0 ? FAILURE : SUCCESS;
+
+		return desc->write(desc->write_ctx, (uint8_t *)desc->line, len);
+	}
+
+	rec[0] = BINLOG_SYNC;
+	rec[1] = level;
+	rec[2] = nargs;
+	rec[3] = 0;
+	binlog_put_le32(&rec[4], fmt ? (uint32_t)(fmt - __start_binlog_fmt) :
+			BINLOG_ID_DROPPED);
+	binlog_put_le32(&rec[8], (uint32_t)(mod->name - __start_binlog_fmt));
+	binlog_put_le32(&rec[12], timestamp);
+	len = BINLOG_HDR_SIZE;
+	for (i = 0; i < nargs; i++) {
+		binlog_put_le32(&rec[len], args[i]);
+		binlog_put_le32(&rec[len + 4], args[i] >> 32);
+		len += 8;
+	}
+
+	return desc->write(desc->write_ctx, rec, len);
+}
+
+/**
+ * @brief Output the recorded messages.
+ *
+ * Must be called from a single context, typically the main loop or a low
+ * priority task, never from the code paths being timed.
+ *
+ * @param max_records - Maximum number of messages to output, 0 for all.
+ * @return Number of messages output, negative error code otherwise.
+ */
+int32_t binlog_drain(uint32_t max_records)
+{
+	struct binlog_desc *desc = binlog_desc;
+	struct binlog_slot *slot;
+	uint64_t dropped;
+	int32_t count = 0;
+	int32_t ret;
+
+	if (!desc)
+		return -EINVAL;
+
+	while (!max_records || (uint32_t)count < max_records) {
+		slot = &desc->slots[desc->tail & desc->mask];
+		if (atomic_load_explicit(&slot->seq, memory_order_acquire) !=
+		    desc->tail + 1)
+			break;
+
+		ret = binlog_emit(desc, slot->level, slot->timestamp,
+				  slot->fmt, slot->mod, slot->args,
+				  slot->nargs);
+
+		atomic_store_explicit(&slot->seq, desc->tail + desc->mask + 1,
+				      memory_order_release);
+		desc->tail++;
+		if (ret < 0)
+			return ret;
+		count++;
+	}
+
+	/* Report the losses once the ring is empty, after the older messages */
+	if (max_records && (uint32_t)count == max_records)
+		return count;
+
+	dropped = atomic_exchange_explicit(&desc->dropped, 0,
+					   memory_order_relaxed);
+	if (dropped) {
+		if (desc->output == BINLOG_OUTPUT_TEXT)
+			ret = binlog_emit(desc, LOG_WARNING, 0,
+					  "binlog: %"PRIu64" messages dropped\n",
+					  &binlog_module_global, &dropped, 1);
+		else
+			ret = binlog_emit(desc, LOG_WARNING, 0, NULL,
+					  &binlog_module_global, &dropped, 1);
+		if (ret < 0)
+			return ret;
+	}
+
+	return count;
+}
+
+/**
+ * @brief Change the runtime level of a module.
+ * @param mod - The module, see BINLOG_MODULE_DEFINE().
+ * @param level - Messages above this level are not recorded anymore.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t binlog_set_level(struct binlog_module *mod, uint8_t level)
+{
+	if (!mod || level > LOG_DEBUG)
+		return -EINVAL;
+
+	mod->level = level;
+
+	return SUCCESS;
+}
@@ -45,10 +45,16 @@
 #include <string.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <stdatomic.h>
 #include "circular_buffer.h"
 #include "error.h"
 #include "util.h"
 
+#ifdef ENABLE_CB_IRQ_WAIT
+#include "irq.h"
+#include "timer.h"
+#endif
+
 /******************************************************************************/
 /*************************** Types Declarations *******************************/
 /******************************************************************************/
@@ -56,16 +62,19 @@
 /**
  * @struct cb_ptr
  * @brief Circular buffer pointer
+ *
+ * The count runs freely and is only reduced to a buffer index when the data
+ * is accessed. The difference between the write and the read counts is the
+ * number of bytes in the buffer, even when it exceeds the buffer size after an
+ * overrun.
  */
 struct cb_ptr {
-	/** Index of data in the buffer */
-	uint32_t	idx;
-	/** Counts the number of times idx exceeds the liniar buffer */
-	uint32_t	spin_count;
+	/** Number of bytes that went through the pointer, modulo wrap */
+	_Atomic uint32_t	count;
 	/** Set if async transaction is active */
-	bool		async_started;
+	bool			async_started;
 	/** Number of bytes to update after an async transaction is finished */
-	uint32_t	async_size;
+	uint32_t		async_size;
 };
 
 /**
@@ -75,26 +84,79 @@ struct cb_ptr {
 struct circular_buffer {
 	/** Size of the buffer in bytes */
 	uint32_t	size;
+	/** size - 1 if size is a power of two, 0 otherwise */
+	uint32_t	mask;
+	/** Value where the counts wrap to 0, a multiple of size. Not used for
+	 *  power of two sizes, where the counts wrap with the uint32_t. */
+	uint32_t	wrap;
 	/** Address of the buffer */
 	int8_t		*buff;
-	/** Write pointer */
+	/** Write pointer, only updated by the writer */
 	struct cb_ptr	write;
-	/** Read pointer */
+	/** Read pointer, only updated by the reader */
 	struct cb_ptr	read;
+	/** Used by the blocking functions, see cb_set_wait() */
+	struct cb_wait_param wait;
 };
 
 /******************************************************************************/
 /************************ Functions Definitions *******************************/
 /******************************************************************************/
 
+/* Buffer index of a count */
+static inline uint32_t cb_index(struct circular_buffer *desc, uint32_t count)
+{
+	if (desc->mask)
+		return count & desc->mask;
+
+	return count % desc->size;
+}
+
+/* Add n bytes to a count, n is at most desc->size */
+static inline uint32_t cb_advance(struct circular_buffer *desc,
+				  uint32_t count, uint32_t n)
+{
+	if (desc->mask)
+		return count + n;
+
+	count += n;
+	if (count >= desc->wrap)
+		count -= desc->wrap;
+
+	return count;
+}
+
+/* Number of bytes from count from to count to */
+static inline uint32_t cb_distance(struct circular_buffer *desc,
+				   uint32_t from, uint32_t to)
+{
+	if (desc->mask || to >= from)
+		return to - from;
+
+	return desc->wrap - from + to;
+}
+
+/* Count of the reader pointer, owned by the reader */
+static inline uint32_t cb_read_count(struct circular_buffer *desc)
+{
+	return atomic_load_explicit(&desc->read.count, memory_order_relaxed);
+}
+
+/* Count of the writer pointer, owned by the writer */
+static inline uint32_t cb_write_count(struct circular_buffer *desc)
+{
+	return atomic_load_explicit(&desc->write.count, memory_order_relaxed);
+}
+
 /**
  * @brief Create circular buffer structure
  *
- * @note Circular buffer implementation is thread safe for one write
- * and one reader.
+ * @note Circular buffer implementation is lock free for one writer
+ * and one reader, which may run in interrupt context.
  * If multiple writer or multiple readers access the circular buffer then
  * function that updates the structure should be called inside a critical
  * critical section.
+ * Power of two sizes avoid a division on each access.
  *
  * @param desc - Where to store the circular buffer reference
  * @param buff_size - Buffer size
@@ -106,22 +168,28 @@ int32_t cb_init(struct circular_buffer **desc, uint32_t buff_size)
 {
 	struct circular_buffer	*ldesc;
 
-	if (!desc || !buff_size)
+	if (!desc || !buff_size || buff_size > 0x80000000)
 		return -EINVAL;
 
 	ldesc = (struct circular_buffer*)calloc(1, sizeof(*ldesc));
 	if (!ldesc)
 		return -ENOMEM;
 
-	*desc = ldesc;
-
 	ldesc->size = buff_size;
+	if (!(buff_size & (buff_size - 1)))
+		ldesc->mask = buff_size - 1;
+	ldesc->wrap = (0x80000000 / buff_size) * buff_size;
+	atomic_init(&ldesc->write.count, 0);
+	atomic_init(&ldesc->read.count, 0);
+
 	ldesc->buff = calloc(1, buff_size);
 	if (!ldesc->buff) {
 		free(ldesc);
 		return -ENOMEM;
 	}
 
+	*desc = ldesc;
+
 	return SUCCESS;
 }
 
@@ -155,23 +223,17 @@ int32_t cb_remove(struct circular_buffer *desc)
  */
 int32_t cb_size(struct circular_buffer *desc, uint32_t *size)
 {
-	uint32_t nb_spins;
+	uint32_t	write_count;
+	uint32_t	read_count;
 
 	if (!desc || !size)
 		return -EINVAL;
 
-	if (desc->write.spin_count > desc->read.spin_count)
-		nb_spins = desc->write.spin_count - desc->read.spin_count;
-	else
-		/* Integer overflow on desc->write.spin_count */
-		nb_spins = UINT32_MAX - desc->read.spin_count +
-			   desc->write.spin_count + 1;
-
-	if (nb_spins > 0)
-		*size = desc->size + desc->write.idx - desc->read.idx;
-	else
-		*size = desc->write.idx - desc->read.idx;
-
+	read_count = atomic_load_explicit(&desc->read.count,
+					  memory_order_acquire);
+	write_count = atomic_load_explicit(&desc->write.count,
+					   memory_order_acquire);
+	*size = cb_distance(desc, read_count, write_count);
 	if (*size > desc->size) {
 		*size = desc->size;
 		return -EOVERRUN;
@@ -180,6 +242,62 @@ int32_t cb_size(struct circular_buffer *desc, uint32_t *size)
 	return SUCCESS;
 }
 
+/*
+ * Number of bytes the reader can access. After an overrun the read pointer
+ * skips the overwritten data and -EOVERRUN is returned.
+ */
+static int32_t cb_read_available(struct circular_buffer *desc,
+				 uint32_t *read_count, uint32_t *available)
+{
+	uint32_t	write_count;
+
+	*read_count = cb_read_count(desc);
+	/* Pairs with the release in the writer, the data is visible */
+	write_count = atomic_load_explicit(&desc->write.count,
+					   memory_order_acquire);
+	*available = cb_distance(desc, *read_count, write_count);
+	if (*available > desc->size) {
+		*available = desc->size;
+		/* Skip the overwritten data, write_count - size */
+		*read_count = cb_distance(desc, desc->size, write_count);
+		atomic_store_explicit(&desc->read.count, *read_count,
+				      memory_order_release);
+		return -EOVERRUN;
+	}
+
+	return SUCCESS;
+}
+
+/* Number of bytes the writer can add without overwriting unread data */
+static uint32_t cb_write_available(struct circular_buffer *desc,
+				   uint32_t *write_count)
+{
+	uint32_t	read_count;
+	uint32_t	used;
+
+	*write_count = cb_write_count(desc);
+	/* Pairs with the release in the reader, the space is free */
+	read_count = atomic_load_explicit(&desc->read.count,
+					  memory_order_acquire);
+	used = cb_distance(desc, read_count, *write_count);
+
+	return used >= desc->size ? 0 : desc->size - used;
+}
+
+/* Split count bytes starting at a count into at most two segments */
+static uint32_t cb_segments(struct circular_buffer *desc, uint32_t count,
+			    uint32_t size, struct cb_segment seg[2])
+{
+	uint32_t	idx = cb_index(desc, count);
+
+	seg[0].buff = desc->buff + idx;
+	seg[0].size = min(size, desc->size - idx);
+	seg[1].buff = desc->buff;
+	seg[1].size = size - seg[0].size;
+
+	return size;
+}
+
 /*
  * Functionality described at cb_prepare_async_write/read having the is_read
  * parameter to specifiy if it is a read or write operation
@@ -192,6 +310,8 @@ static int32_t cb_prepare_async_operation(struct circular_buffer *desc,
 {
 	struct cb_ptr	*ptr;
 	uint32_t	available_size;
+	uint32_t	count;
+	uint32_t	idx;
 	int32_t		ret;
 
 	if (!desc || !buff || !raw_size_available)
@@ -206,26 +326,25 @@ static int32_t cb_prepare_async_operation(struct circular_buffer *desc,
 		return -EBUSY;
 
 	if (is_read) {
-		ret = cb_size(desc, &available_size);
-		if (ret == -EOVERRUN) {
-			/* Update read index */
-			desc->read.spin_count = desc->write.spin_count - 1;
-			desc->read.idx = desc->write.idx;
-		}
+		ret = cb_read_available(desc, &count, &available_size);
 
 		/* We can only read available data */
 		requested_size = min(requested_size, available_size);
 		if (!requested_size)
 			return -EAGAIN;
+	} else {
+		/* The writer overwrites unread data, the reader detects it */
+		count = cb_write_count(desc);
 	}
 
 	/* Size to end of buffer */
-	ptr->async_size = min(requested_size, desc->size - ptr->idx);
+	idx = cb_index(desc, count);
+	ptr->async_size = min(requested_size, desc->size - idx);
 
 	*raw_size_available = ptr->async_size;
 
 	/* Convert index to address in the buffer */
-	*buff = (void *)(desc->buff + ptr->idx);
+	*buff = (void *)(desc->buff + idx);
 
 	ptr->async_started = true;
 
@@ -240,8 +359,7 @@ static int32_t cb_end_async_operation(struct circular_buffer *desc,
 				      bool is_read)
 {
 	struct cb_ptr	*ptr;
-	uint32_t	new_val;
-
+	uint32_t	count;
 
 	if (!desc)
 		return -EINVAL;
@@ -253,19 +371,101 @@ static int32_t cb_end_async_operation(struct circular_buffer *desc,
 	if (!ptr->async_started)
 		return FAILURE;
 
-	/* Update pointer value */
-	new_val = ptr->idx + ptr->async_size;
-	if (new_val >= desc->size) {
-		ptr->spin_count++;
-		new_val %= desc->size;
-	}
-	ptr->idx = new_val;
+	/* Publish the data, or the free space, to the other side */
+	count = atomic_load_explicit(&ptr->count, memory_order_relaxed);
+	atomic_store_explicit(&ptr->count,
+			      cb_advance(desc, count, ptr->async_size),
+			      memory_order_release);
 	ptr->async_size = 0;
 	ptr->async_started = false;
 
 	return SUCCESS;
 }
 
+#ifdef ENABLE_CB_IRQ_WAIT
+/*
+ * Number of ticks between two samples of the timer counter. The timers count
+ * down and reload with load_value, at most one reload is expected between two
+ * samples.
+ */
+static uint32_t cb_timer_delta(struct timer_desc *timer, uint32_t prev,
+			       uint32_t now)
+{
+	if (now <= prev)
+		return prev - now;
+
+	return prev + timer->load_value - now;
+}
+
+/* Sleep until an interrupt is pending */
+static inline void cb_wait_for_irq(void)
+{
+#if defined(__arm__) || defined(__aarch64__)
+	__asm__ volatile("wfi");
+#endif
+}
+#endif
+
+/*
+ * Wait until size bytes can be read, or written without overwriting unread
+ * data. Interrupts are masked while the buffer is checked, a pending
+ * interrupt still wakes up the core, so an update from the other side can not
+ * be missed.
+ */
+static int32_t cb_wait(struct circular_buffer *desc, uint32_t size,
+		       bool is_read)
+{
+	uint32_t	available;
+	uint32_t	count;
+	int32_t		ret;
+#ifdef ENABLE_CB_IRQ_WAIT
+	struct cb_wait_param *wait = &desc->wait;
+	uint32_t	prev = 0, now, freq_hz = 0;
+	uint64_t	elapsed = 0;
+
+	if (wait->timer) {
+		ret = timer_count_clk_get(wait->timer, &freq_hz);
+		if (IS_ERR_VALUE(ret) || !freq_hz)
+			return FAILURE;
+		timer_counter_get(wait->timer, &prev);
+	}
+
+	if (wait->irq_ctrl)
+		irq_global_disable(wait->irq_ctrl);
+#endif
+	while (true) {
+		ret = SUCCESS;
+		if (is_read)
+			ret = cb_read_available(desc, &count, &available);
+		else
+			available = cb_write_available(desc, &count);
+		if (available >= size)
+			break;
+#ifdef ENABLE_CB_IRQ_WAIT
+		if (wait->timer && wait->timeout_us) {
+			timer_counter_get(wait->timer, &now);
+			elapsed += cb_timer_delta(wait->timer, prev, now);
+			prev = now;
+			if (elapsed * 1000000 / freq_hz >= wait->timeout_us) {
+				ret = -ETIMEDOUT;
+				break;
+			}
+		}
+		if (wait->irq_ctrl) {
+			cb_wait_for_irq();
+			irq_global_enable(wait->irq_ctrl);
+			irq_global_disable(wait->irq_ctrl);
+		}
+#endif
+	}
+#ifdef ENABLE_CB_IRQ_WAIT
+	if (wait->irq_ctrl)
+		irq_global_enable(wait->irq_ctrl);
+#endif
+
+	return ret;
+}
+
 /*
  * Functionality described at cb_write/read having the is_read
  * parameter to specifiy if it is a read or write operation
@@ -286,14 +486,22 @@ static int32_t cb_operation(struct circular_buffer *desc,
 	sticky_overrun = 0;
 	i = 0;
 	while (i < size) {
-		do {
-			ret = cb_prepare_async_operation(desc, size - i,
-							 (void **)&buff,
-							 &available_size,
-							 is_read);
-		} while (ret == -EBUSY || ret == -EAGAIN);
+		ret = cb_prepare_async_operation(desc, size - i,
+						 (void **)&buff,
+						 &available_size,
+						 is_read);
+		if (ret == -EAGAIN) {
+			ret = cb_wait(desc, 1, is_read);
+			if (ret == -EOVERRUN)
+				sticky_overrun = true;
+			else if (IS_ERR_VALUE(ret))
+				return ret;
+			continue;
+		}
 		if (ret == -EOVERRUN)
 			sticky_overrun = true;
+		else if (IS_ERR_VALUE(ret))
+			return ret;
 
 		if (is_read)
 			memcpy((uint8_t *)data + i, buff, available_size);
@@ -311,6 +519,165 @@ static int32_t cb_operation(struct circular_buffer *desc,
 	return SUCCESS;
 }
 
+/**
+ * @brief Set how the blocking functions wait for the other side.
+ *
+ * Without an irq controller the blocking functions poll the buffer. With one,
+ * the core sleeps until the next interrupt between two checks, which requires
+ * ENABLE_CB_IRQ_WAIT to be defined by the project. The timeout needs a running
+ * timer and is only checked when the core wakes up.
+ *
+ * @param desc - Circular buffer reference
+ * @param param - Wait parameters, copied in the descriptor
+ * @return
+ *  - \ref SUCCESS - No errors
+ *  - -EINVAL      - Wrong parameters used
+ */
+int32_t cb_set_wait(struct circular_buffer *desc,
+		    const struct cb_wait_param *param)
+{
+	if (!desc || !param)
+		return -EINVAL;
+
+	desc->wait = *param;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Wait until data is available to read (Blocking)
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes to wait for, at most the buffer size
+ * @return
+ *  - \ref SUCCESS   - No errors
+ *  - -EINVAL   - Wrong parameters used
+ *  - -ETIMEDOUT - The timeout set with cb_set_wait() expired
+ *  - -EOVERRUN - An overrun occurred and some data have been overwritten
+ */
+int32_t cb_wait_data(struct circular_buffer *desc, uint32_t size)
+{
+	if (!desc || size > desc->size)
+		return -EINVAL;
+
+	return cb_wait(desc, size, 1);
+}
+
+/**
+ * @brief Wait until data can be written without overwriting unread data
+ * (Blocking)
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes to wait for, at most the buffer size
+ * @return
+ *  - \ref SUCCESS   - No errors
+ *  - -EINVAL   - Wrong parameters used
+ *  - -ETIMEDOUT - The timeout set with cb_set_wait() expired
+ */
+int32_t cb_wait_space(struct circular_buffer *desc, uint32_t size)
+{
+	if (!desc || size > desc->size)
+		return -EINVAL;
+
+	return cb_wait(desc, size, 0);
+}
+
+/**
+ * @brief Get the data available to read without copying it
+ *
+ * The data may wrap around the end of the buffer, so it is returned in two
+ * segments, the second one being empty when it does not. The data stays in
+ * the buffer until cb_read_commit() is called.
+ *
+ * @param desc - Circular buffer reference
+ * @param seg - Where to store the two segments
+ * @param size - Where to store the total size of the segments
+ * @return
+ *  - \ref SUCCESS   - No errors
+ *  - -EINVAL   - Wrong parameters used
+ *  - -EOVERRUN - An overrun occurred and some data have been overwritten
+ */
+int32_t cb_read_peek(struct circular_buffer *desc, struct cb_segment seg[2],
+		     uint32_t *size)
+{
+	uint32_t	count;
+	int32_t		ret;
+
+	if (!desc || !seg || !size)
+		return -EINVAL;
+
+	ret = cb_read_available(desc, &count, size);
+	cb_segments(desc, count, *size, seg);
+
+	return ret;
+}
+
+/**
+ * @brief Release data returned by cb_read_peek()
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes consumed, at most the size peeked
+ * @return
+ *  - \ref SUCCESS   - No errors
+ *  - -EINVAL   - Wrong parameters used
+ */
+int32_t cb_read_commit(struct circular_buffer *desc, uint32_t size)
+{
+	if (!desc || size > desc->size)
+		return -EINVAL;
+
+	atomic_store_explicit(&desc->read.count,
+			      cb_advance(desc, cb_read_count(desc), size),
+			      memory_order_release);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the free space of the buffer without copying data
+ *
+ * Unlike cb_write(), only space not holding unread data is returned. It is
+ * split in two segments when it wraps around the end of the buffer. The data
+ * written there is visible to the reader after cb_write_commit().
+ *
+ * @param desc - Circular buffer reference
+ * @param seg - Where to store the two segments
+ * @param size - Where to store the total size of the segments
+ * @return
+ *  - \ref SUCCESS   - No errors
+ *  - -EINVAL   - Wrong parameters used
+ */
+int32_t cb_write_peek(struct circular_buffer *desc, struct cb_segment seg[2],
+		      uint32_t *size)
+{
+	uint32_t	count;
+
+	if (!desc || !seg || !size)
+		return -EINVAL;
+
+	*size = cb_write_available(desc, &count);
+	cb_segments(desc, count, *size, seg);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Publish data written in the segments returned by cb_write_peek()
+ * @param desc - Circular buffer reference
+ * @param size - Number of bytes written, at most the size peeked
+ * @return
+ *  - \ref SUCCESS   - No errors
+ *  - -EINVAL   - Wrong parameters used
+ */
+int32_t cb_write_commit(struct circular_buffer *desc, uint32_t size)
+{
+	if (!desc || size > desc->size)
+		return -EINVAL;
+
+	atomic_store_explicit(&desc->write.count,
+			      cb_advance(desc, cb_write_count(desc), size),
+			      memory_order_release);
+
+	return SUCCESS;
+}
+
 /**
  * @brief Prepare asynchronous write
  *
@@ -384,6 +751,10 @@ int32_t cb_end_async_read(struct circular_buffer *desc)
 
 /**
  * @brief Write data to the buffer (Blocking)
+ *
+ * Unread data is overwritten when the buffer is full, the reader detects it.
+ * Use cb_wait_space() first to avoid it.
+ *
  * @param desc - Circular buffer reference
  * @param data - Buffer from where data is copied to the circular buffer
  * @param size - Size to write
@@ -398,12 +769,16 @@ int32_t cb_write(struct circular_buffer *desc, const void *data, uint32_t size)
 
 /**
  * @brief Read data from the buffer (Blocking)
+ *
+ * Waits for missing data as set with cb_set_wait().
+ *
  * @param desc - Circular buffer reference
  * @param data - Buffer where to data is copied from the circular buffer
  * @param size - Size to read
  * @return
  *  - \ref SUCCESS   - No errors
  *  - -EINVAL   - Wrong parameters used
+ *  - -ETIMEDOUT - The timeout set with cb_set_wait() expired
  *  - -EOVERRUN - An overrun occurred and some data have been overwritten
  */
 int32_t cb_read(struct circular_buffer *desc, void *data, uint32_t size)
@@ -100,3 +100,60 @@ uint16_t crc16(const uint16_t * table, const uint8_t *pdata, size_t nbytes,
 
 	return crc;
 }
+
+/***************************************************************************//**
+ * @brief Creates the CRC-16 slice-by-4 lookup tables for a given polynomial.
+ *
+ * table[0] is the table built by crc16_populate_msb(). table[k] holds the CRC
+ * of each byte value followed by k zero bytes, which allows crc16_slice() to
+ * process 4 bytes with independent lookups.
+ *
+ * @param table      - Pointer to CRC16_SLICE_SIZE lookup tables to write to.
+ * @param polynomial - msb-first representation of desired polynomial.
+ *
+ * @return None.
+*******************************************************************************/
+void crc16_populate_msb_slice(uint16_t (*table)[CRC16_TABLE_SIZE],
+			      const uint16_t polynomial)
+{
+	uint16_t prev;
+
+	if (!table)
+		return;
+
+	crc16_populate_msb(table[0], polynomial);
+
+	for (int16_t n = 0; n < CRC16_TABLE_SIZE; n++) {
+		for (uint8_t k = 1; k < CRC16_SLICE_SIZE; k++) {
+			prev = table[k - 1][n];
+			table[k][n] = table[0][prev >> 8] ^ (uint16_t)(prev << 8);
+		}
+	}
+}
+
+/***************************************************************************//**
+ * @brief Computes the CRC-16 over a buffer of data, 4 bytes per iteration.
+ *
+ * @param table     - Pointer to the CRC-16 slice-by-4 lookup tables for the
+ *                    desired polynomial.
+ * @param pdata     - Pointer to 8-bit data buffer.
+ * @param nbytes    - Number of bytes to compute the CRC-16 over.
+ * @param crc       - Initial value for the CRC-16 computation. Can be used to
+ *                    cascade calls to this function by providing a previous
+ *                    output of this function as the crc parameter.
+ *
+ * @return crc      - Computed CRC-16 value, same as crc16() with table[0].
+*******************************************************************************/
+uint16_t crc16_slice(const uint16_t (*table)[CRC16_TABLE_SIZE],
+		     const uint8_t *pdata, size_t nbytes, uint16_t crc)
+{
+	while (nbytes >= CRC16_SLICE_SIZE) {
+		crc = table[3][(crc >> 8) ^ pdata[0]] ^
+		      table[2][(crc & 0xff) ^ pdata[1]] ^
+		      table[1][pdata[2]] ^ table[0][pdata[3]];
+		pdata += CRC16_SLICE_SIZE;
+		nbytes -= CRC16_SLICE_SIZE;
+	}
+
+	return crc16(table[0], pdata, nbytes, crc);
+}
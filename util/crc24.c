@@ -101,3 +101,61 @@ uint32_t crc24(const uint32_t * table, const uint8_t *pdata, size_t nbytes,
 
 	return (crc & 0xffffff);
 }
+
+/***************************************************************************//**
+ * @brief Creates the CRC-24 slice-by-4 lookup tables for a given polynomial.
+ *
+ * table[0] is the table built by crc24_populate_msb(). table[k] holds the CRC
+ * of each byte value followed by k zero bytes, which allows crc24_slice() to
+ * process 4 bytes with independent lookups.
+ *
+ * @param table      - Pointer to CRC24_SLICE_SIZE lookup tables to write to.
+ * @param polynomial - msb-first representation of desired polynomial.
+ *
+ * @return None.
+*******************************************************************************/
+void crc24_populate_msb_slice(uint32_t (*table)[CRC24_TABLE_SIZE],
+			      const uint32_t polynomial)
+{
+	uint32_t prev;
+
+	if (!table)
+		return;
+
+	crc24_populate_msb(table[0], polynomial);
+
+	for (int16_t n = 0; n < CRC24_TABLE_SIZE; n++) {
+		for (uint8_t k = 1; k < CRC24_SLICE_SIZE; k++) {
+			prev = table[k - 1][n];
+			table[k][n] = (table[0][(prev >> 16) & 0xff] ^
+				       (prev << 8)) & 0xffffff;
+		}
+	}
+}
+
+/***************************************************************************//**
+ * @brief Computes the CRC-24 over a buffer of data, 4 bytes per iteration.
+ *
+ * @param table     - Pointer to the CRC-24 slice-by-4 lookup tables for the
+ *                    desired polynomial.
+ * @param pdata     - Pointer to 8-bit data buffer.
+ * @param nbytes    - Number of bytes to compute the CRC-24 over.
+ * @param crc       - Initial value for the CRC-24 computation. Can be used to
+ *                    cascade calls to this function by providing a previous
+ *                    output of this function as the crc parameter.
+ *
+ * @return crc      - Computed CRC-24 value, same as crc24() with table[0].
+*******************************************************************************/
+uint32_t crc24_slice(const uint32_t (*table)[CRC24_TABLE_SIZE],
+		     const uint8_t *pdata, size_t nbytes, uint32_t crc)
+{
+	while (nbytes >= CRC24_SLICE_SIZE) {
+		crc = table[3][((crc >> 16) ^ pdata[0]) & 0xff] ^
+		      table[2][((crc >> 8) ^ pdata[1]) & 0xff] ^
+		      table[1][(crc ^ pdata[2]) & 0xff] ^ table[0][pdata[3]];
+		pdata += CRC24_SLICE_SIZE;
+		nbytes -= CRC24_SLICE_SIZE;
+	}
+
+	return crc24(table[0], pdata, nbytes, crc);
+}
@@ -0,0 +1,670 @@
+/***************************************************************************//**
+ *   @file   regmap.c
+ *   @brief  Register map with a write-back cache.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include "regmap.h"
+#include "error.h"
+#include "util.h"
+
+/******************************************************************************/
+/********************** Macros and Constants Definitions **********************/
+/******************************************************************************/
+
+/* Size of the buffer holding the messages of a regmap_sync() batch */
+#define REGMAP_SYNC_BUFF_SIZE	(REGMAP_SYNC_BATCH * 4)
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Check if a register is part of a list of ranges.
+ * @param ranges - The list of ranges.
+ * @param no_ranges - Number of ranges.
+ * @param reg - The register address.
+ * @return true if the register is part of a range, false otherwise.
+ */
+static bool regmap_in_ranges(const struct regmap_range *ranges,
+			     uint32_t no_ranges, uint32_t reg)
+{
+	uint32_t i;
+
+	for (i = 0; i < no_ranges; i++)
+		if (reg >= ranges[i].start && reg <= ranges[i].end)
+			return true;
+
+	return false;
+}
+
+/**
+ * @brief Check if a register is precious.
+ * @param map - The register map.
+ * @param reg - The register address.
+ * @return true if the register must not be read by the register map.
+ */
+static bool regmap_is_precious(struct regmap *map, uint32_t reg)
+{
+	return regmap_in_ranges(map->precious_ranges, map->no_precious_ranges,
+				reg);
+}
+
+/**
+ * @brief Check if a register value can be cached.
+ * @param map - The register map.
+ * @param reg - The register address.
+ * @return true if the register is neither volatile nor precious.
+ */
+static bool regmap_is_cacheable(struct regmap *map, uint32_t reg)
+{
+	return !regmap_in_ranges(map->volatile_ranges, map->no_volatile_ranges,
+				 reg) && !regmap_is_precious(map, reg);
+}
+
+/**
+ * @brief Test a bit of a register bitmap.
+ * @param bitmap - The bitmap.
+ * @param reg - The register address.
+ * @return true if the bit is set.
+ */
+static inline bool regmap_test(const uint8_t *bitmap, uint32_t reg)
+{
+	return bitmap[reg >> 3] & BIT(reg & 7);
+}
+
+/**
+ * @brief Store a register value in the cache.
+ * @param map - The register map.
+ * @param reg - The register address.
+ * @param val - The register value.
+ * @param dirty - Set if the value was not written to the device.
+ */
+static void regmap_cache_set(struct regmap *map, uint32_t reg, uint8_t val,
+			     bool dirty)
+{
+	map->cache[reg] = val;
+	map->valid[reg >> 3] |= BIT(reg & 7);
+	if (dirty && !regmap_test(map->dirty, reg)) {
+		map->dirty[reg >> 3] |= BIT(reg & 7);
+		map->no_dirty++;
+	} else if (!dirty && regmap_test(map->dirty, reg)) {
+		map->dirty[reg >> 3] &= ~BIT(reg & 7);
+		map->no_dirty--;
+	}
+}
+
+/**
+ * @brief Encode the SPI address phase of a register access.
+ * @param map - The register map.
+ * @param reg - The register address.
+ * @param read - Set for a read access.
+ * @param buf - Buffer receiving addr_bytes bytes.
+ */
+static void regmap_spi_addr(struct regmap *map, uint32_t reg, bool read,
+			    uint8_t *buf)
+{
+	uint32_t addr = reg | (read ? map->read_flag_mask :
+			       map->write_flag_mask);
+	uint8_t i;
+
+	for (i = 0; i < map->addr_bytes; i++)
+		buf[i] = addr >> (8 * (map->addr_bytes - i - 1));
+}
+
+/**
+ * @brief Read a register from the device.
+ * @param map - The register map.
+ * @param reg - The register address.
+ * @param val - The register value.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t regmap_bus_read(struct regmap *map, uint32_t reg, uint8_t *val)
+{
+	uint8_t buf[3];
+	int32_t ret;
+
+	map->bus_reads++;
+	if (!map->spi)
+		return map->reg_read(map->ctx, reg, val);
+
+	regmap_spi_addr(map, reg, true, buf);
+	buf[map->addr_bytes] = 0;
+	ret = spi_write_and_read(map->spi, buf, map->addr_bytes + 1);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	*val = buf[map->addr_bytes];
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Write a register to the device.
+ * @param map - The register map.
+ * @param reg - The register address.
+ * @param val - The register value.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t regmap_bus_write(struct regmap *map, uint32_t reg, uint8_t val)
+{
+	uint8_t buf[3];
+
+	map->bus_writes++;
+	if (!map->spi)
+		return map->reg_write(map->ctx, reg, val);
+
+	regmap_spi_addr(map, reg, false, buf);
+	buf[map->addr_bytes] = val;
+
+	return spi_write_and_read(map->spi, buf, map->addr_bytes + 1);
+}
+
+/**
+ * @brief Stream consecutive registers over SPI in a single transfer.
+ * @param map - The register map.
+ * @param reg - The lowest register address.
+ * @param val - The register values, in ascending address order.
+ * @param count - Number of registers.
+ * @param read - Set to read the registers, clear to write them.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+static int32_t regmap_spi_stream(struct regmap *map, uint32_t reg,
+				 uint8_t *val, uint32_t count, bool read)
+{
+	uint8_t *buf;
+	uint32_t i;
+	int32_t ret;
+
+	buf = (uint8_t *)calloc(map->addr_bytes + count, sizeof(*buf));
+	if (!buf)
+		return -ENOMEM;
+
+	/* the device walks the addresses from the first one sent */
+	regmap_spi_addr(map, map->addr_step > 0 ? reg : reg + count - 1, read,
+			buf);
+	for (i = 0; i < count && !read; i++)
+		buf[map->addr_bytes + i] = map->addr_step > 0 ? val[i] :
+					   val[count - i - 1];
+
+	ret = spi_write_and_read(map->spi, buf, map->addr_bytes + count);
+	if (IS_ERR_VALUE(ret))
+		goto out;
+
+	for (i = 0; i < count && read; i++)
+		val[i] = map->addr_step > 0 ? buf[map->addr_bytes + i] :
+			 buf[map->addr_bytes + count - i - 1];
+
+	if (read)
+		map->bus_reads++;
+	else
+		map->bus_writes++;
+out:
+	free(buf);
+
+	return ret;
+}
+
+/**
+ * @brief Initialize the register map.
+ * @param map - The register map.
+ * @param init_param - The initialization parameters.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t regmap_init(struct regmap **map,
+		    const struct regmap_init_param *init_param)
+{
+	struct regmap *m;
+	uint32_t bitmap_size;
+
+	if (!map || !init_param)
+		return -EINVAL;
+
+	if (init_param->spi) {
+		if (init_param->addr_bytes < 1 || init_param->addr_bytes > 2)
+			return -EINVAL;
+	} else if (!init_param->reg_read || !init_param->reg_write) {
+		return -EINVAL;
+	}
+
+	m = (struct regmap *)calloc(1, sizeof(*m));
+	if (!m)
+		return -ENOMEM;
+
+	m->max_register = init_param->max_register;
+	m->volatile_ranges = init_param->volatile_ranges;
+	m->no_volatile_ranges = init_param->no_volatile_ranges;
+	m->precious_ranges = init_param->precious_ranges;
+	m->no_precious_ranges = init_param->no_precious_ranges;
+	m->reg_defaults = init_param->reg_defaults;
+	m->spi = init_param->spi;
+	m->addr_bytes = init_param->addr_bytes;
+	m->read_flag_mask = init_param->read_flag_mask;
+	m->write_flag_mask = init_param->write_flag_mask;
+	m->addr_step = init_param->addr_step;
+	m->reg_read = init_param->reg_read;
+	m->reg_write = init_param->reg_write;
+	m->ctx = init_param->ctx;
+
+	bitmap_size = DIV_ROUND_UP(m->max_register + 1, 8);
+	m->cache = (uint8_t *)calloc(m->max_register + 1, sizeof(*m->cache));
+	m->valid = (uint8_t *)calloc(bitmap_size, sizeof(*m->valid));
+	m->dirty = (uint8_t *)calloc(bitmap_size, sizeof(*m->dirty));
+	if (!m->cache || !m->valid || !m->dirty) {
+		regmap_remove(m);
+		return -ENOMEM;
+	}
+
+	regmap_cache_reset(m);
+
+	*map = m;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by regmap_init().
+ * @param map - The register map.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t regmap_remove(struct regmap *map)
+{
+	if (!map)
+		return -EINVAL;
+
+	free(map->cache);
+	free(map->valid);
+	free(map->dirty);
+	free(map);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Read a register.
+ *
+ * Cached registers are read from memory. Other non-volatile registers are
+ * read from the device and cached.
+ * @param map - The register map.
+ * @param reg - The register address.
+ * @param val - The register value.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t regmap_read(struct regmap *map, uint32_t reg, uint8_t *val)
+{
+	int32_t ret;
+
+	if (!map || !val || reg > map->max_register)
+		return -EINVAL;
+
+	if (regmap_test(map->valid, reg)) {
+		*val = map->cache[reg];
+		return SUCCESS;
+	}
+
+	ret = regmap_bus_read(map, reg, val);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	if (regmap_is_cacheable(map, reg))
+		regmap_cache_set(map, reg, *val, false);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Write a register.
+ *
+ * In cache only mode the writes of non-volatile registers are deferred until
+ * regmap_sync(). Volatile registers are always written to the device, after
+ * the deferred writes, to keep the order of the accesses.
+ * @param map - The register map.
+ * @param reg - The register address.
+ * @param val - The register value.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t regmap_write(struct regmap *map, uint32_t reg, uint8_t val)
+{
+	bool cacheable;
+	int32_t ret;
+
+	if (!map || reg > map->max_register)
+		return -EINVAL;
+
+	cacheable = regmap_is_cacheable(map, reg);
+	if (cacheable && map->cache_only) {
+		regmap_cache_set(map, reg, val, true);
+		return SUCCESS;
+	}
+
+	if (map->no_dirty) {
+		ret = regmap_sync(map);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	ret = regmap_bus_write(map, reg, val);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	if (cacheable)
+		regmap_cache_set(map, reg, val, false);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Update the bits of a register selected by mask.
+ *
+ * The register is read from the cache when possible and it is not written if
+ * its value does not change.
+ * @param map - The register map.
+ * @param reg - The register address.
+ * @param mask - The bits to update.
+ * @param val - The new value of the bits.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t regmap_update_bits(struct regmap *map, uint32_t reg, uint8_t mask,
+			   uint8_t val)
+{
+	uint8_t old;
+	int32_t ret;
+
+	if (!map || reg > map->max_register || regmap_is_precious(map, reg))
+		return -EINVAL;
+
+	ret = regmap_read(map, reg, &old);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	val = (old & ~mask) | (val & mask);
+	if (val == old && regmap_test(map->valid, reg))
+		return SUCCESS;
+
+	return regmap_write(map, reg, val);
+}
+
+/**
+ * @brief Read consecutive registers.
+ *
+ * When the device supports SPI streaming, the registers missing from the
+ * cache are read in a single transfer.
+ * @param map - The register map.
+ * @param reg - The first register address.
+ * @param val - The register values.
+ * @param count - Number of registers.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t regmap_bulk_read(struct regmap *map, uint32_t reg, uint8_t *val,
+			 uint32_t count)
+{
+	uint32_t i, first, last;
+	int32_t ret;
+
+	if (!map || !val || !count || reg + count - 1 > map->max_register)
+		return -EINVAL;
+
+	for (i = 0; i < count; i++)
+		if (regmap_is_precious(map, reg + i))
+			return -EINVAL;
+
+	/* narrow the access down to the registers missing from the cache */
+	for (first = 0; first < count; first++)
+		if (!regmap_test(map->valid, reg + first))
+			break;
+	if (first == count) {
+		memcpy(val, &map->cache[reg], count);
+		return SUCCESS;
+	}
+	for (last = count - 1; last > first; last--)
+		if (!regmap_test(map->valid, reg + last))
+			break;
+
+	if (!map->spi || !map->addr_step) {
+		for (i = 0; i < count; i++) {
+			ret = regmap_read(map, reg + i, &val[i]);
+			if (IS_ERR_VALUE(ret))
+				return ret;
+		}
+
+		return SUCCESS;
+	}
+
+	ret = regmap_spi_stream(map, reg + first, &val[first],
+				last - first + 1, true);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	for (i = 0; i < count; i++) {
+		if (regmap_test(map->valid, reg + i))
+			val[i] = map->cache[reg + i];
+		else if (regmap_is_cacheable(map, reg + i))
+			regmap_cache_set(map, reg + i, val[i], false);
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Write consecutive registers.
+ *
+ * When the device supports SPI streaming and the cache only mode is off, the
+ * registers are written in a single transfer.
+ * @param map - The register map.
+ * @param reg - The first register address.
+ * @param val - The register values.
+ * @param count - Number of registers.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t regmap_bulk_write(struct regmap *map, uint32_t reg, const uint8_t *val,
+			  uint32_t count)
+{
+	uint32_t i;
+	int32_t ret;
+
+	if (!map || !val || !count || reg + count - 1 > map->max_register)
+		return -EINVAL;
+
+	if (map->cache_only || !map->spi || !map->addr_step) {
+		for (i = 0; i < count; i++) {
+			ret = regmap_write(map, reg + i, val[i]);
+			if (IS_ERR_VALUE(ret))
+				return ret;
+		}
+
+		return SUCCESS;
+	}
+
+	if (map->no_dirty) {
+		ret = regmap_sync(map);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+	}
+
+	ret = regmap_spi_stream(map, reg, (uint8_t *)val, count, false);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	for (i = 0; i < count; i++)
+		if (regmap_is_cacheable(map, reg + i))
+			regmap_cache_set(map, reg + i, val[i], false);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Defer the register writes until regmap_sync().
+ * @param map - The register map.
+ * @param enable - Set to defer the writes, clear to sync and write through.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t regmap_cache_only(struct regmap *map, bool enable)
+{
+	if (!map)
+		return -EINVAL;
+
+	map->cache_only = enable;
+	if (enable)
+		return SUCCESS;
+
+	return regmap_sync(map);
+}
+
+/**
+ * @brief Write the dirty registers to the device.
+ *
+ * Over SPI, the writes are grouped in spi_transfer() calls of up to
+ * REGMAP_SYNC_BATCH messages and runs of consecutive registers are streamed
+ * when the device supports it.
+ * @param map - The register map.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t regmap_sync(struct regmap *map)
+{
+	struct spi_msg msgs[REGMAP_SYNC_BATCH];
+	uint8_t buf[REGMAP_SYNC_BUFF_SIZE];
+	uint32_t reg, run, i, used = 0, no_msgs = 0;
+	uint32_t first = 0;
+	int32_t ret;
+
+	if (!map)
+		return -EINVAL;
+
+	for (reg = 0; reg <= map->max_register && map->no_dirty; reg++) {
+		if (!regmap_test(map->dirty, reg))
+			continue;
+
+		if (!map->spi) {
+			ret = regmap_bus_write(map, reg, map->cache[reg]);
+			if (IS_ERR_VALUE(ret))
+				return ret;
+			regmap_cache_set(map, reg, map->cache[reg], false);
+			continue;
+		}
+
+		/* length of the run of dirty registers fitting in a message */
+		run = 1;
+		while (map->addr_step && reg + run <= map->max_register &&
+		       regmap_test(map->dirty, reg + run) &&
+		       map->addr_bytes + run < REGMAP_SYNC_BUFF_SIZE)
+			run++;
+
+		if (used + map->addr_bytes + run > REGMAP_SYNC_BUFF_SIZE) {
+			ret = spi_transfer(map->spi, msgs, no_msgs);
+			if (IS_ERR_VALUE(ret))
+				return ret;
+			for (i = first; i < reg; i++)
+				if (regmap_test(map->dirty, i))
+					regmap_cache_set(map, i, map->cache[i],
+							 false);
+			used = 0;
+			no_msgs = 0;
+		}
+
+		regmap_spi_addr(map, map->addr_step >= 0 ? reg : reg + run - 1,
+				false, &buf[used]);
+		for (i = 0; i < run; i++)
+			buf[used + map->addr_bytes + i] = map->addr_step >= 0 ?
+							  map->cache[reg + i] :
+							  map->cache[reg + run - i - 1];
+		msgs[no_msgs].tx_buff = &buf[used];
+		msgs[no_msgs].rx_buff = &buf[used];
+		msgs[no_msgs].bytes_number = map->addr_bytes + run;
+		msgs[no_msgs].cs_change = 1;
+		if (no_msgs == 0)
+			first = reg;
+		no_msgs++;
+		used += map->addr_bytes + run;
+		map->bus_writes++;
+		reg += run - 1;
+
+		if (no_msgs == REGMAP_SYNC_BATCH) {
+			ret = spi_transfer(map->spi, msgs, no_msgs);
+			if (IS_ERR_VALUE(ret))
+				return ret;
+			for (i = first; i <= reg; i++)
+				if (regmap_test(map->dirty, i))
+					regmap_cache_set(map, i, map->cache[i],
+							 false);
+			used = 0;
+			no_msgs = 0;
+		}
+	}
+
+	if (no_msgs) {
+		ret = spi_transfer(map->spi, msgs, no_msgs);
+		if (IS_ERR_VALUE(ret))
+			return ret;
+		for (i = first; i <= map->max_register && map->no_dirty; i++)
+			if (regmap_test(map->dirty, i))
+				regmap_cache_set(map, i, map->cache[i], false);
+	}
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Drop the cache, to be called after a device reset.
+ *
+ * The deferred writes are discarded and the cache is loaded with the reset
+ * values, if known.
+ * @param map - The register map.
+ */
+void regmap_cache_reset(struct regmap *map)
+{
+	uint32_t bitmap_size, reg;
+
+	if (!map)
+		return;
+
+	bitmap_size = DIV_ROUND_UP(map->max_register + 1, 8);
+	memset(map->valid, 0, bitmap_size);
+	memset(map->dirty, 0, bitmap_size);
+	map->no_dirty = 0;
+
+	if (!map->reg_defaults)
+		return;
+
+	for (reg = 0; reg <= map->max_register; reg++)
+		if (regmap_is_cacheable(map, reg))
+			regmap_cache_set(map, reg, map->reg_defaults[reg],
+					 false);
+}
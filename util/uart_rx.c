@@ -0,0 +1,236 @@
+/***************************************************************************//**
+ *   @file   uart_rx.c
+ *   @brief  Receive ring shared by the UART platform drivers.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stdlib.h>
+#include "error.h"
+#include "circular_buffer.h"
+#include "uart_rx.h"
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Allocate the receive ring.
+ * @param rx - Where to store the ring descriptor.
+ * @param size - Ring size in bytes, a power of two is faster.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_rx_init(struct uart_rx **rx, uint32_t size)
+{
+	struct uart_rx *desc;
+	int32_t ret;
+
+	if (!rx || !size)
+		return -EINVAL;
+
+	desc = (struct uart_rx *)calloc(1, sizeof(*desc));
+	if (!desc)
+		return -ENOMEM;
+
+	ret = cb_init(&desc->cb, size);
+	if (ret != SUCCESS) {
+		free(desc);
+		return ret;
+	}
+
+	*rx = desc;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Free the resources allocated by uart_rx_init().
+ * @param rx - The ring descriptor.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_rx_remove(struct uart_rx *rx)
+{
+	if (!rx)
+		return -EINVAL;
+
+	cb_remove(rx->cb);
+	free(rx);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Get the buffer where the receiver stores the next bytes.
+ *
+ * Called from the interrupt, or when the next DMA transfer is set up. The
+ * buffer is the contiguous free space of the ring, up to max_len bytes. When
+ * the ring is full, the single scratch byte is returned instead so that the
+ * receiver keeps running and the ring is used again as soon as the
+ * application frees some space.
+ *
+ * @param rx - The ring descriptor.
+ * @param max_len - Maximum number of bytes the receiver should store.
+ * @param buff - Where to store the buffer.
+ * @param len - Where to store the buffer size, at least 1.
+ */
+void uart_rx_fill_get(struct uart_rx *rx, uint32_t max_len, uint8_t **buff,
+		      uint32_t *len)
+{
+	struct cb_segment seg[2];
+	uint32_t size;
+
+	cb_write_peek(rx->cb, seg, &size);
+	if (!size || !max_len) {
+		if (!rx->dropping)
+			rx->stats.overflows++;
+		rx->dropping = true;
+		*buff = &rx->scratch;
+		*len = 1;
+		return;
+	}
+
+	rx->dropping = false;
+	*buff = seg[0].buff;
+	*len = seg[0].size < max_len ? seg[0].size : max_len;
+}
+
+/**
+ * @brief Publish the bytes stored in the buffer from uart_rx_fill_get().
+ * @param rx - The ring descriptor.
+ * @param len - Number of bytes the receiver stored.
+ */
+void uart_rx_fill_done(struct uart_rx *rx, uint32_t len)
+{
+	uint32_t used;
+
+	if (rx->dropping) {
+		rx->stats.dropped += len;
+		return;
+	}
+
+	cb_write_commit(rx->cb, len);
+	rx->stats.received += len;
+
+	cb_size(rx->cb, &used);
+	if (used > rx->stats.max_used)
+		rx->stats.max_used = used;
+}
+
+/**
+ * @brief Count a receive error reported by the UART.
+ * @param rx - The ring descriptor.
+ */
+void uart_rx_error(struct uart_rx *rx)
+{
+	rx->stats.errors++;
+}
+
+/**
+ * @brief Get received data without copying it.
+ *
+ * Only the data up to the end of the ring is returned, the rest is returned
+ * by the next call, after uart_rx_release().
+ *
+ * @param rx - The ring descriptor.
+ * @param data - Where to store the address of the data.
+ * @param len - Where to store the number of bytes, 0 if nothing was received.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_rx_peek(struct uart_rx *rx, const uint8_t **data, uint32_t *len)
+{
+	struct cb_segment seg[2];
+	uint32_t size;
+	int32_t ret;
+
+	if (!rx || !data || !len)
+		return -EINVAL;
+
+	ret = cb_read_peek(rx->cb, seg, &size);
+	if (IS_ERR_VALUE(ret))
+		return ret;
+
+	*data = seg[0].buff;
+	*len = seg[0].size;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Release data returned by uart_rx_peek().
+ * @param rx - The ring descriptor.
+ * @param len - Number of bytes consumed.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_rx_release(struct uart_rx *rx, uint32_t len)
+{
+	if (!rx)
+		return -EINVAL;
+
+	return cb_read_commit(rx->cb, len);
+}
+
+/**
+ * @brief Copy received data, waiting until len bytes are available.
+ * @param rx - The ring descriptor.
+ * @param data - Where to copy the data.
+ * @param len - Number of bytes to read.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_rx_read(struct uart_rx *rx, uint8_t *data, uint32_t len)
+{
+	if (!rx)
+		return -EINVAL;
+
+	return cb_read(rx->cb, data, len);
+}
+
+/**
+ * @brief Get the statistics of the ring.
+ * @param rx - The ring descriptor.
+ * @param stats - Where to store the statistics.
+ * @return SUCCESS in case of success, negative error code otherwise.
+ */
+int32_t uart_rx_get_stats(struct uart_rx *rx, struct uart_rx_stats *stats)
+{
+	if (!rx || !stats)
+		return -EINVAL;
+
+	*stats = rx->stats;
+
+	return SUCCESS;
+}
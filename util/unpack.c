@@ -0,0 +1,323 @@
+/***************************************************************************//**
+ *   @file   unpack.c
+ *   @brief  Unpacking of big-endian packed sample words.
+********************************************************************************
+ * Copyright 2021(c) Analog Devices, Inc.
+ *
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *  - Redistributions of source code must retain the above copyright
+ *    notice, this list of conditions and the following disclaimer.
+ *  - Redistributions in binary form must reproduce the above copyright
+ *    notice, this list of conditions and the following disclaimer in
+ *    the documentation and/or other materials provided with the
+ *    distribution.
+ *  - Neither the name of Analog Devices, Inc. nor the names of its
+ *    contributors may be used to endorse or promote products derived
+ *    from this software without specific prior written permission.
+ *  - The use of this software may or may not infringe the patent rights
+ *    of one or more patent holders.  This license does not release you
+ *    from the requirement that you obtain separate licenses from these
+ *    patent holders to use this software.
+ *  - Use of the software either in source or binary form, must be run
+ *    on or directly connected to an Analog Devices Inc. component.
+ *
+ * THIS SOFTWARE IS PROVIDED BY ANALOG DEVICES "AS IS" AND ANY EXPRESS OR
+ * IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, NON-INFRINGEMENT,
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED.
+ * IN NO EVENT SHALL ANALOG DEVICES BE LIABLE FOR ANY DIRECT, INDIRECT,
+ * INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, INTELLECTUAL PROPERTY RIGHTS, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*******************************************************************************/
+
+/******************************************************************************/
+/***************************** Include Files **********************************/
+/******************************************************************************/
+
+#include <stddef.h>
+#include "unpack.h"
+#include "error.h"
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+/******************************************************************************/
+/************************ Functions Definitions *******************************/
+/******************************************************************************/
+
+/**
+ * @brief Check the unpacking parameters.
+ * @param stride - Size of a packed word, in bits.
+ * @param bits - Number of significant bits, at the top of the word.
+ * @param max_bits - Size of the output samples, in bits.
+ * @return SUCCESS in case of success, -EINVAL otherwise.
+ */
+static int32_t unpack_check(uint8_t stride, uint8_t bits, uint8_t max_bits)
+{
+	if (!bits || bits > stride || bits > max_bits || stride > 32)
+		return -EINVAL;
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Extract a word from the source bit stream.
+ *
+ * The accumulator is refilled with 32 bits at a time while the source has 4
+ * bytes left, then byte by byte, so a word costs at most one refill and a
+ * single shift and mask, whatever its alignment.
+ * @param src - Pointer to the next source byte, advanced as bytes are used.
+ * @param end - End of the source buffer.
+ * @param acc - Bit accumulator.
+ * @param nbits - Number of valid bits in the accumulator.
+ * @param stride - Size of a packed word, in bits.
+ * @param bits - Number of significant bits, at the top of the word.
+ * @param sign_ext - Set to sign extend the samples.
+ * @return The sample.
+ */
+static inline uint32_t unpack_word(const uint8_t **src, const uint8_t *end,
+				   uint64_t *acc, uint8_t *nbits,
+				   uint8_t stride, uint8_t bits, bool sign_ext)
+{
+	const uint8_t *p = *src;
+	uint32_t word;
+
+	if (*nbits < stride) {
+		if (end - p >= 4) {
+			/* At most 31 bits are left, so 32 more fit */
+			*acc = (*acc << 32) | ((uint32_t)p[0] << 24) |
+			       ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) |
+			       p[3];
+			*src = p + 4;
+			*nbits += 32;
+		} else {
+			while (*nbits < stride) {
+				*acc = (*acc << 8) | *(*src)++;
+				*nbits += 8;
+			}
+		}
+	}
+	*nbits -= stride;
+	word = (uint32_t)(*acc >> (*nbits + stride - bits)) &
+	       (0xFFFFFFFFul >> (32 - bits));
+
+	if (sign_ext && bits < 32 && (word & (1ul << (bits - 1))))
+		word |= 0xFFFFFFFFul << bits;
+
+	return word;
+}
+
+/**
+ * @brief Unpack the full width words of the ADC frames, a group at a time.
+ *
+ * 18-bit and 26-bit words are read in groups of 4 words, from 9 and 13
+ * bytes, 24-bit words one at a time. Each word is read with constant shifts,
+ * which is faster than the generic accumulator.
+ * @param dst - The samples.
+ * @param src - The packed words.
+ * @param count - Number of words.
+ * @param stride - Size of a packed word, in bits.
+ * @return Number of words unpacked, the caller handles the rest.
+ */
+static uint32_t unpack_be_frame(uint32_t *dst, const uint8_t *src,
+				uint32_t count, uint8_t stride)
+{
+	uint32_t i = 0;
+
+	switch (stride) {
+	case 18:
+		for (; i + 4 <= count; i += 4, src += 9) {
+			dst[i] = ((uint32_t)src[0] << 10) |
+				 ((uint32_t)src[1] << 2) | (src[2] >> 6);
+			dst[i + 1] = ((uint32_t)(src[2] & 0x3f) << 12) |
+				     ((uint32_t)src[3] << 4) | (src[4] >> 4);
+			dst[i + 2] = ((uint32_t)(src[4] & 0x0f) << 14) |
+				     ((uint32_t)src[5] << 6) | (src[6] >> 2);
+			dst[i + 3] = ((uint32_t)(src[6] & 0x03) << 16) |
+				     ((uint32_t)src[7] << 8) | src[8];
+		}
+		break;
+	case 24:
+		for (; i < count; i++, src += 3)
+			dst[i] = ((uint32_t)src[0] << 16) |
+				 ((uint32_t)src[1] << 8) | src[2];
+		break;
+	case 26:
+		for (; i + 4 <= count; i += 4, src += 13) {
+			dst[i] = ((uint32_t)src[0] << 18) |
+				 ((uint32_t)src[1] << 10) |
+				 ((uint32_t)src[2] << 2) | (src[3] >> 6);
+			dst[i + 1] = ((uint32_t)(src[3] & 0x3f) << 20) |
+				     ((uint32_t)src[4] << 12) |
+				     ((uint32_t)src[5] << 4) | (src[6] >> 4);
+			dst[i + 2] = ((uint32_t)(src[6] & 0x0f) << 22) |
+				     ((uint32_t)src[7] << 14) |
+				     ((uint32_t)src[8] << 6) | (src[9] >> 2);
+			dst[i + 3] = ((uint32_t)(src[9] & 0x03) << 24) |
+				     ((uint32_t)src[10] << 16) |
+				     ((uint32_t)src[11] << 8) | src[12];
+		}
+		break;
+	default:
+		break;
+	}
+
+	return i;
+}
+
+/**
+ * @brief Unpack a 16-bit big-endian word.
+ * @param src - The packed word.
+ * @param shift - Number of dropped bits, at the bottom of the word.
+ * @param sign - Sign bit of the sample, 0 if it is not sign extended.
+ * @return The sample.
+ */
+static inline uint32_t unpack_be16_word(const uint8_t *src, uint8_t shift,
+					uint32_t sign)
+{
+	uint32_t word = (((uint32_t)src[0] << 8) | src[1]) >> shift;
+
+	return (word ^ sign) - sign;
+}
+
+/**
+ * @brief Unpack 16-bit big-endian words, 8 at a time when SIMD is available.
+ *
+ * The words left over by the SIMD loop, or all of them without SIMD, are
+ * unpacked one at a time.
+ * @param dst16 - 16-bit output, NULL if dst32 is used.
+ * @param dst32 - 32-bit output, NULL if dst16 is used.
+ * @param src - Source buffer.
+ * @param count - Number of words.
+ * @param bits - Number of significant bits, at the top of the word.
+ * @param sign_ext - Set to sign extend the samples.
+ */
+static void unpack_be16(uint16_t *dst16, uint32_t *dst32,
+			const uint8_t *src, uint32_t count, uint8_t bits,
+			bool sign_ext)
+{
+	uint32_t sign = sign_ext ? 1ul << (bits - 1) : 0;
+	uint8_t shift = 16 - bits;
+	uint32_t i = 0;
+#if defined(__SSE2__)
+	__m128i vshift = _mm_cvtsi32_si128(shift);
+	__m128i v, hi;
+
+	for (; i + 8 <= count; i += 8) {
+		v = _mm_loadu_si128((const __m128i *)(src + 2 * i));
+		v = _mm_or_si128(_mm_slli_epi16(v, 8), _mm_srli_epi16(v, 8));
+		if (sign_ext) {
+			v = _mm_sra_epi16(v, vshift);
+			hi = _mm_srai_epi16(v, 15);
+		} else {
+			v = _mm_srl_epi16(v, vshift);
+			hi = _mm_setzero_si128();
+		}
+		if (dst16) {
+			_mm_storeu_si128((__m128i *)&dst16[i], v);
+		} else {
+			_mm_storeu_si128((__m128i *)&dst32[i],
+					 _mm_unpacklo_epi16(v, hi));
+			_mm_storeu_si128((__m128i *)&dst32[i + 4],
+					 _mm_unpackhi_epi16(v, hi));
+		}
+	}
+#endif
+
+	if (dst16)
+		for (; i < count; i++)
+			dst16[i] = unpack_be16_word(src + 2 * i, shift, sign);
+	else if (!shift && !sign)
+		for (; i < count; i++)
+			dst32[i] = ((uint32_t)src[2 * i] << 8) | src[2 * i + 1];
+	else
+		for (; i < count; i++)
+			dst32[i] = unpack_be16_word(src + 2 * i, shift, sign);
+}
+
+/**
+ * @brief Unpack big-endian words of stride bits into 32-bit samples.
+ *
+ * The source is a stream of count packed words, msb first, with no padding
+ * between them. The bits msb of each word are the sample, the remaining
+ * stride - bits are dropped, which strips a trailing status byte.
+ * @param dst - The samples.
+ * @param src - The packed words.
+ * @param count - Number of words.
+ * @param stride - Size of a packed word, in bits, up to 32.
+ * @param bits - Number of significant bits, at the top of the word.
+ * @param sign_ext - Set to sign extend the samples.
+ * @return SUCCESS in case of success, -EINVAL otherwise.
+ */
+int32_t unpack_be_u32(uint32_t *dst, const uint8_t *src, uint32_t count,
+		      uint8_t stride, uint8_t bits, bool sign_ext)
+{
+	const uint8_t *end;
+	uint64_t acc = 0;
+	uint8_t nbits = 0;
+	uint32_t i = 0;
+
+	if (!dst || !src || unpack_check(stride, bits, 32))
+		return -EINVAL;
+
+	end = src + ((uint64_t)count * stride + 7) / 8;
+
+	if (stride == 16) {
+		unpack_be16(NULL, dst, src, count, bits, sign_ext);
+		return SUCCESS;
+	}
+
+	if (bits == stride && !sign_ext)
+		i = unpack_be_frame(dst, src, count, stride);
+	src += (i * stride) / 8;
+
+	for (; i < count; i++)
+		dst[i] = unpack_word(&src, end, &acc, &nbits, stride, bits,
+				     sign_ext);
+
+	return SUCCESS;
+}
+
+/**
+ * @brief Unpack big-endian words of stride bits into 16-bit samples.
+ *
+ * Same as unpack_be_u32(), for samples of up to 16 bits.
+ * @param dst - The samples.
+ * @param src - The packed words.
+ * @param count - Number of words.
+ * @param stride - Size of a packed word, in bits, up to 32.
+ * @param bits - Number of significant bits, at the top of the word, up to 16.
+ * @param sign_ext - Set to sign extend the samples.
+ * @return SUCCESS in case of success, -EINVAL otherwise.
+ */
+int32_t unpack_be_u16(uint16_t *dst, const uint8_t *src, uint32_t count,
+		      uint8_t stride, uint8_t bits, bool sign_ext)
+{
+	const uint8_t *end;
+	uint64_t acc = 0;
+	uint8_t nbits = 0;
+	uint32_t i = 0;
+
+	if (!dst || !src || unpack_check(stride, bits, 16))
+		return -EINVAL;
+
+	end = src + ((uint64_t)count * stride + 7) / 8;
+
+	if (stride == 16) {
+		unpack_be16(dst, NULL, src, count, bits, sign_ext);
+		return SUCCESS;
+	}
+
+	for (; i < count; i++)
+		dst[i] = unpack_word(&src, end, &acc, &nbits, stride, bits,
+				     sign_ext);
+
+	return SUCCESS;
+}